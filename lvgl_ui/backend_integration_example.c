@@ -4,70 +4,563 @@
  * 
  * This file demonstrates how to integrate the LVGL UI with a CAN bus backend.
  * Copy and modify this file for your specific CAN implementation.
+ *
+ * Threading model (Tasks in ui_config.h):
+ * - Core UI_TASK_CORE: the UI task (LVGL, display flush, touch).
+ * - Core CAN_TASK_CORE: per channel an RX task and a TX scheduler task, and
+ *   one control task that runs the UI callbacks below. RX > TX > control,
+ *   all above the UI, so a redraw never delays a frame.
+ * The two sides only talk through the ui_binding queues: the backend posts
+ * log entries and status updates, the UI posts its callbacks.
  */
 
 #include <stdio.h>
 #include <string.h>
-#include "freertos/FreeRTOS.h"
-#include "freertos/task.h"
+#include <stdlib.h>
 #include "esp_log.h"
-#include "driver/twai.h" // ESP32 CAN driver
+#include "soc/soc_caps.h"
 
 #include "lvgl.h"
 #include "ui_main.h"
 #include "ui_binding.h"
+#include "ui_state.h"
 #include "ui_config.h"
+#include "ui_loop.h"
+#include "can_port.h"
+#include "can_transport.h"
+#include "can_scheduler.h"
+#include "can_rules.h"
+#include "can_health.h"
 
 static const char* TAG = "CAN_UI";
 
-// CAN configuration (example)
-#define CAN_TX_PIN GPIO_NUM_21
-#define CAN_RX_PIN GPIO_NUM_22
-#define CAN_BITRATE TWAI_TIMING_CONFIG_500KBITS()
+// CAN channels (indices into UI_CHANNELS)
+#define CH_PT           0       // Powertrain bus
+#define CH_BODY         1       // Body bus
+#define SCENE_CHANNEL   CH_BODY // Power-mode sequences talk to the BCM
 
-// Periodic transmission timer
-static TimerHandle_t periodic_timer = NULL;
-static twai_message_t periodic_msg = {0};
+/**
+ * @brief Per-channel pipeline: transport, TX scheduler, RX rules, health
+ * monitor and tasks
+ *
+ * Channels share nothing but the UI, so a flooded or bus-off channel never
+ * delays frames on the other one.
+ */
+typedef struct {
+    uint8_t index;
+    can_transport_t bus;
+    can_scheduler_t sched;
+    can_rules_t rules;
+    can_health_t health;
+    can_port_sem_t* rx_exited;      // Given by the RX task when it returns
+    bool rx_started;                // Control task only: an RX task runs or is exiting
+} can_channel_t;
+
+static can_channel_t channels[UI_CHANNEL_COUNT];
+
+// The UI's repeating function (one at a time, on any channel) and the
+// function frame sent when a scene sequence completes. Written by the
+// control task and by the scene channel's TX task (SEQ_DONE): periodic_lock
+// guards all of them.
+static can_port_mutex_t* periodic_lock = NULL;
+static uint8_t periodic_channel = CH_PT;
+static int periodic_handle = -1;
+static uint8_t pending_channel = CH_PT;
+static can_frame_t pending_msg = {0};
+static bool pending_repeat = false;
+static uint32_t pending_interval = 0;
+static const can_xform_t* pending_xforms = NULL;
+static uint8_t pending_xform_count = 0;
+
+// Manual-mode ID/payload sweep (one at a time)
+static uint8_t sweep_channel = CH_PT;
+
+// ==================== Payload Transforms ====================
+// Alive counter and checksum of each repeating function's frame, applied by
+// the TX task right before every send. Example layout - match your ECU's
+// E2E profile. Byte 6 low nibble = counter, byte 7 = checksum over 0..6.
+
+static const can_xform_t XFORM_COUNTER_CRC_J1850[] = {
+    CAN_XFORM_COUNTER(6, 0x0F),
+    CAN_XFORM_CRC8_J1850(7, 0, 7),
+};
+
+static const can_xform_t XFORM_COUNTER_CRC_AUTOSAR[] = {
+    CAN_XFORM_COUNTER(6, 0x0F),
+    CAN_XFORM_CRC8_AUTOSAR(7, 0, 7),
+};
+
+static const can_xform_t XFORM_COUNTER_XOR[] = {
+    CAN_XFORM_COUNTER(6, 0x0F),
+    CAN_XFORM_XOR(7, 0, 7),
+};
+
+typedef struct {
+    uint8_t category;
+    uint8_t function;
+    const can_xform_t* xforms;
+    uint8_t count;
+} payload_xform_config_t;
+
+// Keyed like REPEATING_FUNCTIONS in ui_config.c
+static const payload_xform_config_t PAYLOAD_XFORMS[] = {
+    {1, 2, XFORM_COUNTER_CRC_J1850,   2},     // 调节座椅
+    {2, 1, XFORM_COUNTER_CRC_AUTOSAR, 2},     // 气囊检测
+    {0, 1, XFORM_COUNTER_XOR,         2},     // 油门控制
+};
+
+static const can_xform_t* find_payload_xforms(uint8_t category, uint8_t function, uint8_t* count) {
+    for (size_t i = 0; i < sizeof(PAYLOAD_XFORMS) / sizeof(PAYLOAD_XFORMS[0]); i++) {
+        if (PAYLOAD_XFORMS[i].category == category && PAYLOAD_XFORMS[i].function == function) {
+            *count = PAYLOAD_XFORMS[i].count;
+            return PAYLOAD_XFORMS[i].xforms;
+        }
+    }
+    *count = 0;
+    return NULL;
+}
+
+// ==================== Scene Sequences ====================
+// Example power-state sequences - replace IDs and payloads with your protocol.
+// 0x3B0 = power mode command, 0x3B1 = keep-alive, 0x7B0 = BCM acknowledge.
+
+static const uint8_t SEQ_SCENE_B[] = {
+    CAN_SEQ_SEND(0x3B0, 2, 0x00, 0x00, 0, 0, 0, 0, 0, 0),
+    CAN_SEQ_WAIT(20),
+    CAN_SEQ_END
+};
+
+static const uint8_t SEQ_SCENE_BA[] = {
+    CAN_SEQ_SEND(0x3B0, 2, 0x01, 0x00, 0, 0, 0, 0, 0, 0),
+    CAN_SEQ_WAIT(20),
+    CAN_SEQ_SEND(0x3B0, 2, 0x01, 0x01, 0, 0, 0, 0, 0, 0),
+    CAN_SEQ_WAIT(20),
+    CAN_SEQ_END
+};
+
+static const uint8_t SEQ_SCENE_IGP[] = {
+    CAN_SEQ_SEND(0x3B0, 2, 0x02, 0x00, 0, 0, 0, 0, 0, 0),
+    CAN_SEQ_WAIT_RX(0x7B0, 0x7FF, 500),
+    CAN_SEQ_MARK,
+        CAN_SEQ_SEND(0x3B1, 1, 0x55, 0, 0, 0, 0, 0, 0, 0),
+        CAN_SEQ_WAIT(100),
+    CAN_SEQ_LOOP(3),
+    CAN_SEQ_SEND(0x3B0, 2, 0x02, 0x01, 0, 0, 0, 0, 0, 0),
+    CAN_SEQ_WAIT(50),
+    CAN_SEQ_END
+};
+
+static const uint8_t SEQ_SCENE_IGR[] = {
+    CAN_SEQ_SEND(0x3B0, 2, 0x03, 0x00, 0, 0, 0, 0, 0, 0),
+    CAN_SEQ_WAIT_RX(0x7B0, 0x7FF, 500),
+    CAN_SEQ_SEND(0x3B0, 2, 0x03, 0x01, 0, 0, 0, 0, 0, 0),
+    CAN_SEQ_WAIT(50),
+    CAN_SEQ_END
+};
+
+static const uint8_t SEQ_SCENE_ST[] = {
+    CAN_SEQ_SEND(0x3B0, 2, 0x04, 0x00, 0, 0, 0, 0, 0, 0),
+    CAN_SEQ_WAIT_RX(0x7B0, 0x7FF, 500),
+    CAN_SEQ_MARK,
+        CAN_SEQ_SEND(0x3B0, 2, 0x04, 0x01, 0, 0, 0, 0, 0, 0),
+        CAN_SEQ_WAIT(10),
+    CAN_SEQ_LOOP(10),
+    CAN_SEQ_SEND(0x3B0, 2, 0x02, 0x01, 0, 0, 0, 0, 0, 0),
+    CAN_SEQ_WAIT(50),
+    CAN_SEQ_END
+};
+
+static const uint8_t SEQ_SCENE_ACC[] = {
+    CAN_SEQ_SEND(0x3B0, 2, 0x05, 0x00, 0, 0, 0, 0, 0, 0),
+    CAN_SEQ_WAIT(20),
+    CAN_SEQ_END
+};
+
+typedef struct {
+    const char* scene;
+    const uint8_t* code;
+    size_t len;
+} scene_sequence_t;
+
+static const scene_sequence_t SCENE_SEQUENCES[] = {
+    {"B",   SEQ_SCENE_B,   sizeof(SEQ_SCENE_B)},
+    {"BA",  SEQ_SCENE_BA,  sizeof(SEQ_SCENE_BA)},
+    {"IGP", SEQ_SCENE_IGP, sizeof(SEQ_SCENE_IGP)},
+    {"IGR", SEQ_SCENE_IGR, sizeof(SEQ_SCENE_IGR)},
+    {"ST",  SEQ_SCENE_ST,  sizeof(SEQ_SCENE_ST)},
+    {"ACC", SEQ_SCENE_ACC, sizeof(SEQ_SCENE_ACC)},
+};
+
+static const scene_sequence_t* find_scene_sequence(const char* scene) {
+    for (size_t i = 0; i < sizeof(SCENE_SEQUENCES) / sizeof(SCENE_SEQUENCES[0]); i++) {
+        if (strcmp(SCENE_SEQUENCES[i].scene, scene) == 0) {
+            return &SCENE_SEQUENCES[i];
+        }
+    }
+    return NULL;
+}
+
+// ==================== Trigger Rules ====================
+// Answered in the RX task without going through the UI. Example HIL
+// responses - replace with the requests your ECU under test sends.
+
+static const can_periodic_def_t HEARTBEAT_7B1 = {
+    .frame = {.id = 0x7B1, .dlc = 2, .data = {0x01, 0x00}},
+    .period_ms = 100,
+    .xform_count = 1,
+    .xforms = {CAN_XFORM_COUNTER(1, 0x0F)}
+};
+
+static const can_rule_t PT_RX_RULES[] = {
+    // Tester present (0x7DF 02 3E xx) -> positive response, echo sub-function
+    {
+        .id = 0x7DF, .id_mask = CAN_RULE_ID_EXACT,
+        .data_mask  = {0xFF, 0xFF},
+        .data_value = {0x02, 0x3E},
+        .action = CAN_RULE_SEND,
+        .reply = {.id = 0x7E8, .dlc = 3, .data = {0x02, 0x7E}},
+        .copy_mask = 1u << 2
+    },
+};
+
+static const can_rule_t BODY_RX_RULES[] = {
+    // BCM wake (0x7B0 01) -> start heartbeat, (0x7B0 00) -> stop it
+    {
+        .id = 0x7B0, .id_mask = CAN_RULE_ID_EXACT,
+        .data_mask  = {0xFF},
+        .data_value = {0x01},
+        .action = CAN_RULE_START_PERIODIC,
+        .periodic = &HEARTBEAT_7B1,
+        .slot = 0
+    },
+    {
+        .id = 0x7B0, .id_mask = CAN_RULE_ID_EXACT,
+        .data_mask  = {0xFF},
+        .data_value = {0x00},
+        .action = CAN_RULE_STOP_PERIODIC,
+        .slot = 0
+    },
+};
+
+// ==================== Channel Configuration ====================
+// Both channels use TWAI on chips with two controllers (ESP32-C6/P4). With a
+// single controller the body bus goes through an SLCAN adapter on UART1.
+
+#if SOC_TWAI_CONTROLLER_NUM > 1
+#define BODY_OPS    (&can_transport_twai_ops)
+#define BODY_CONFIG {.bitrate = 125000, .tx_pin = 4, .rx_pin = 5, .controller = 1}
+#else
+#define BODY_OPS    (&can_transport_slcan_ops)
+#define BODY_CONFIG {.device = "uart1", .bitrate = 125000, .tx_pin = 4, .rx_pin = 5, .serial_baud = 921600}
+#endif
+
+typedef struct {
+    const can_transport_ops_t* ops;
+    can_transport_config_t config;
+    const can_rule_t* rules;
+    size_t rule_count;
+    const char* rx_task_name;
+    const char* tx_task_name;
+    const char* overlay_name;       // Debug overlay label (periodic peak load)
+    const char* overlay_txq[CAN_TXQ_CLASS_COUNT];   // Debug overlay labels (TX queue depths)
+} can_channel_config_t;
+
+static const can_channel_config_t CHANNEL_CONFIGS[UI_CHANNEL_COUNT] = {
+    [CH_PT] = {
+        .ops = &can_transport_twai_ops,
+        .config = {.bitrate = 500000, .tx_pin = 21, .rx_pin = 22, .controller = 0},
+        .rules = PT_RX_RULES,
+        .rule_count = sizeof(PT_RX_RULES) / sizeof(PT_RX_RULES[0]),
+        .rx_task_name = "pt_rx",
+        .tx_task_name = "pt_tx",
+        .overlay_name = "ptpk",
+        .overlay_txq = {"ptU", "ptP", "ptB"}
+    },
+    [CH_BODY] = {
+        .ops = BODY_OPS,
+        .config = BODY_CONFIG,
+        .rules = BODY_RX_RULES,
+        .rule_count = sizeof(BODY_RX_RULES) / sizeof(BODY_RX_RULES[0]),
+        .rx_task_name = "body_rx",
+        .tx_task_name = "body_tx",
+        .overlay_name = "bdpk",
+        .overlay_txq = {"bdU", "bdP", "bdB"}
+    },
+};
+
+// Auto mode: channel carrying each category's function frames
+static const uint8_t CATEGORY_CHANNELS[] = {
+    CH_PT,      // 显示: engine, throttle, brake
+    CH_BODY,    // 声音: lights, doors, seat
+    CH_PT       // 检查: ABS, airbag, TPMS
+};
+
+// ==================== Bus Health ====================
+
+static ui_bus_state_t ui_bus_state(can_bus_state_t state) {
+    switch (state) {
+        case CAN_BUS_ERROR_WARNING: return UI_BUS_WARNING;
+        case CAN_BUS_ERROR_PASSIVE: return UI_BUS_PASSIVE;
+        case CAN_BUS_OFF:           return UI_BUS_OFF;
+        case CAN_BUS_RECOVERING:
+        case CAN_BUS_STOPPED:       return UI_BUS_RECOVERING;
+        default:                    return UI_BUS_OK;
+    }
+}
+
+/**
+ * @brief Health events (channel's RX task): header badge and log
+ */
+static void health_event_cb(const can_health_event_t* event, void* user_data) {
+    can_channel_t* ch = (can_channel_t*)user_data;
+    char log_msg[64];
+    
+    ui_binding_update_bus_state(ch->index, ui_bus_state(event->state),
+                                (uint16_t)event->status->tx_error_counter);
+    
+    switch (event->type) {
+        case CAN_HEALTH_EVENT_STATE:
+            ESP_LOGW(TAG, "%s %s -> %s (TEC %lu, REC %lu)", UI_CHANNELS[ch->index],
+                     can_bus_state_to_name(event->prev_state), can_bus_state_to_name(event->state),
+                     (unsigned long)event->status->tx_error_counter,
+                     (unsigned long)event->status->rx_error_counter);
+            if (event->state == CAN_BUS_OFF) {
+                // Queued and generated traffic would only fail: drop the sweep
+                if (sweep_channel == ch->index) {
+                    can_scheduler_stop_sweep(&ch->sched);
+                }
+                ui_binding_add_channel_log(ch->index, "TX", "总线关闭 (bus-off), 发送暂停");
+            } else if (event->state == CAN_BUS_ERROR_PASSIVE) {
+                snprintf(log_msg, sizeof(log_msg), "总线错误被动 (TEC %lu, REC %lu)",
+                         (unsigned long)event->status->tx_error_counter,
+                         (unsigned long)event->status->rx_error_counter);
+                ui_binding_add_channel_log(ch->index, "RX", log_msg);
+            }
+            break;
+            
+        case CAN_HEALTH_EVENT_RECOVERY:
+            snprintf(log_msg, sizeof(log_msg), "总线恢复尝试 %lu (等待 %lu ms)",
+                     (unsigned long)event->attempt, (unsigned long)event->backoff_ms);
+            ui_binding_add_channel_log(ch->index, "TX", log_msg);
+            break;
+            
+        case CAN_HEALTH_EVENT_RECOVERED:
+            snprintf(log_msg, sizeof(log_msg), "总线已恢复 (中断 %lu ms)", (unsigned long)event->down_ms);
+            ui_binding_add_channel_log(ch->index, "TX", log_msg);
+            break;
+    }
+}
+
+// ==================== RX Task ====================
+
+// Frames go to the log binary: indexed by ID for the log filter, formatted when drawn
+static void log_frame(uint8_t channel, const char* type, const can_frame_t* frame) {
+    ui_binding_add_frame_log(channel, type, frame->id, (frame->flags & CAN_FRAME_FLAG_EXT) != 0,
+                             frame->dlc, frame->data, frame->timestamp_us);
+}
+
+/**
+ * @brief Receive frames from one channel's transport and log them; polls
+ *        the channel's bus health between frames
+ */
+static void can_rx_task(void* arg) {
+    can_channel_t* ch = (can_channel_t*)arg;
+    can_frame_t frame;
+    uint64_t health_due_us = 0;
+
+    while (1) {
+        uint64_t now_us = can_port_time_us();
+        if (now_us >= health_due_us) {
+            health_due_us = now_us + (uint64_t)can_health_poll(&ch->health, now_us) * 1000u;
+        }
+
+        uint32_t wait_ms = (uint32_t)((health_due_us - now_us) / 1000u);
+        can_err_t err = can_transport_recv(&ch->bus, &frame, (wait_ms < 100) ? wait_ms : 100);
+        if (err == CAN_OK) {
+            can_rules_process(&ch->rules, &frame);      // Reactive replies first
+            can_scheduler_on_rx(&ch->sched, &frame);    // WAIT_RX steps
+            log_frame(ch->index, "RX", &frame);
+        } else if (err == CAN_ERR_NOT_OPEN) {
+            break;
+        }
+    }
+
+    can_rules_reset(&ch->rules);
+    ui_binding_update_bus_state(ch->index, UI_BUS_OK, 0);
+    can_port_sem_give(ch->rx_exited);
+}
+
+// ==================== TX Task ====================
+
+static void start_periodic(uint8_t channel, const can_frame_t* msg, uint32_t interval,
+                           const can_xform_t* xforms, uint8_t xform_count);
+static can_err_t send_frame(uint8_t channel, const can_frame_t* msg);
+
+/**
+ * @brief Scheduler events (channel's TX task): footer progress, then the function frame
+ */
+static void tx_sched_event_cb(const can_sched_event_t* event, void* user_data) {
+    can_channel_t* ch = (can_channel_t*)user_data;
+    char log_msg[64];
+    
+    switch (event->type) {
+        case CAN_SCHED_EVENT_SEQ_PROGRESS:
+            ui_binding_update_sequence_progress(event->name, event->step, event->step_count);
+            break;
+            
+        case CAN_SCHED_EVENT_SEQ_DONE:
+            ui_binding_update_sequence_progress(NULL, 0, 0);
+            can_port_mutex_lock(periodic_lock);
+            if (pending_repeat) {
+                start_periodic(pending_channel, &pending_msg, pending_interval,
+                               pending_xforms, pending_xform_count);
+            } else if (send_frame(pending_channel, &pending_msg) == CAN_OK) {
+                ui_binding_update_transmission_status(false, false);
+            } else {
+                ui_binding_add_channel_log(pending_channel, "TX", "发送失败");
+                ui_binding_update_transmission_status(false, false);
+            }
+            can_port_mutex_unlock(periodic_lock);
+            break;
+            
+        case CAN_SCHED_EVENT_SEQ_CANCELLED:
+            ui_binding_update_sequence_progress(NULL, 0, 0);
+            break;
+            
+        case CAN_SCHED_EVENT_SEQ_FAILED:
+            ui_binding_update_sequence_progress(NULL, 0, 0);
+            snprintf(log_msg, sizeof(log_msg), "场景 %s 序列失败 (%s)",
+                     event->name, can_err_to_name(event->error));
+            ui_binding_add_channel_log(ch->index, "TX", log_msg);
+            ui_binding_update_transmission_status(false, false);
+            break;
+            
+        case CAN_SCHED_EVENT_PERIODIC_TX:
+            if (event->error == CAN_OK) {
+                log_frame(ch->index, "TX", event->frame);
+            }
+            break;
+            
+        case CAN_SCHED_EVENT_TX_BACKPRESSURE:
+            ui_binding_update_tx_backpressure(ch->index, event->congested);
+            ui_binding_add_channel_log(ch->index, "TX", event->congested ? "发送队列拥塞" : "发送队列恢复");
+            break;
+            
+        case CAN_SCHED_EVENT_SWEEP_PROGRESS:
+        case CAN_SCHED_EVENT_SWEEP_DONE: {
+            const can_sweep_progress_t* p = event->sweep;
+            uint16_t permille = (p->total > 0) ? (uint16_t)((p->sent * 1000u) / p->total) : 0;
+            bool running = (event->type == CAN_SCHED_EVENT_SWEEP_PROGRESS);
+            ui_binding_update_sweep_progress(running, permille, p->rate_fps, p->errors);
+            if (!running) {
+                snprintf(log_msg, sizeof(log_msg), "扫描%s: %llu 帧, %lu 帧/s, 错误 %lu",
+                         (p->sent < p->total) ? "停止" : "完成", (unsigned long long)p->sent,
+                         (unsigned long)p->rate_fps, (unsigned long)p->errors);
+                ui_binding_add_channel_log(ch->index, "TX", log_msg);
+            }
+            break;
+        }
+    }
+}
+
+/**
+ * @brief Run one channel's TX scheduler (sleeps until the next deadline)
+ */
+static void can_tx_task(void* arg) {
+    can_channel_t* ch = (can_channel_t*)arg;
+    can_scheduler_run(&ch->sched);
+}
+
+// ==================== Control Task ====================
+
+/**
+ * @brief Run the UI callbacks (connect, transmit, stop...) on the CAN core
+ */
+static void can_ctl_task(void* arg) {
+    (void)arg;
+    while (1) {
+        ui_binding_dispatch_callbacks(CAN_PORT_WAIT_FOREVER);
+    }
+}
+
+static bool start_can_task(const char* name, uint8_t priority, can_port_task_fn_t fn, void* arg) {
+    can_port_task_config_t config = {
+        .name = name,
+        .stack_size = CAN_TASK_STACK,
+        .priority = priority,
+        .core = CAN_TASK_CORE
+    };
+    if (!can_port_task_create(&config, fn, arg)) {
+        ESP_LOGE(TAG, "Task %s not started", name);
+        return false;
+    }
+    return true;
+}
 
 // ==================== Backend Callback Implementations ====================
 
 /**
- * @brief Handle connection state change
+ * @brief Handle a channel's connection toggle
  */
-void backend_connection_handler(bool connected) {
+void backend_connection_handler(uint8_t channel, bool connected) {
+    if (channel >= UI_CHANNEL_COUNT) {
+        return;
+    }
+    can_channel_t* ch = &channels[channel];
+    const can_channel_config_t* cfg = &CHANNEL_CONFIGS[channel];
+    
     if (connected) {
-        // Initialize CAN bus
-        twai_general_config_t g_config = TWAI_GENERAL_CONFIG_DEFAULT(CAN_TX_PIN, CAN_RX_PIN, TWAI_MODE_NORMAL);
-        twai_timing_config_t t_config = CAN_BITRATE;
-        twai_filter_config_t f_config = TWAI_FILTER_CONFIG_ACCEPT_ALL();
+        if (ch->rx_started) {
+            return;     // Already connected: one RX task per channel
+        }
         
-        esp_err_t err = twai_driver_install(&g_config, &t_config, &f_config);
-        if (err == ESP_OK) {
-            twai_start();
-            ESP_LOGI(TAG, "CAN bus started");
-            ui_binding_add_log("TX", "CAN 总线已连接");
+        // Open the channel's bus and start its RX task
+        can_err_t err = can_transport_open(&ch->bus, &cfg->config);
+        if (err == CAN_OK) {
+            can_health_reset(&ch->health, can_port_time_us());
+            ch->rx_started = start_can_task(cfg->rx_task_name, CAN_RX_TASK_PRIO, can_rx_task, ch);
+            if (!ch->rx_started) {
+                can_transport_close(&ch->bus);
+                err = CAN_ERR_NO_SPACE;
+            }
+        }
+        if (err == CAN_OK) {
+            ESP_LOGI(TAG, "%s bus started (%s)", UI_CHANNELS[channel], ch->bus.ops->name);
+            ui_binding_add_channel_log(channel, "TX", "CAN 总线已连接");
         } else {
-            ESP_LOGE(TAG, "CAN driver install failed: %s", esp_err_to_name(err));
-            ui_binding_update_connection_status(false);
-            ui_binding_add_log("TX", "CAN 连接失败");
+            ESP_LOGE(TAG, "%s open failed: %s", UI_CHANNELS[channel], can_err_to_name(err));
+            ui_binding_update_connection_status(channel, false);
+            ui_binding_add_channel_log(channel, "TX", "CAN 连接失败");
         }
     } else {
-        // Stop CAN bus
-        if (periodic_timer != NULL) {
-            xTimerStop(periodic_timer, 0);
+        // Stop the channel; the other channel keeps running
+        can_scheduler_stop_sequence(&ch->sched);
+        can_scheduler_stop_sweep(&ch->sched);
+        can_scheduler_clear_periodic(&ch->sched);
+        can_port_mutex_lock(periodic_lock);
+        if (periodic_handle >= 0 && periodic_channel == channel) {
+            periodic_handle = -1;
+            ui_binding_update_transmission_status(false, false);
+        }
+        can_port_mutex_unlock(periodic_lock);
+        can_transport_close(&ch->bus);
+        
+        // The RX task returns on CAN_ERR_NOT_OPEN; wait for it so a
+        // reconnect never runs two RX tasks on the channel
+        if (ch->rx_started) {
+            can_port_sem_take(ch->rx_exited, CAN_PORT_WAIT_FOREVER);
+            ch->rx_started = false;
         }
-        twai_stop();
-        twai_driver_uninstall();
-        ESP_LOGI(TAG, "CAN bus stopped");
-        ui_binding_add_log("TX", "CAN 总线已断开");
+        ESP_LOGI(TAG, "%s bus stopped", UI_CHANNELS[channel]);
+        ui_binding_add_channel_log(channel, "TX", "CAN 总线已断开");
     }
 }
 
 /**
  * @brief Build CAN message based on scene and function
  */
-static twai_message_t build_can_message_from_function(const char* scene, uint8_t category, uint8_t function) {
-    twai_message_t msg = {0};
+static can_frame_t build_can_message_from_function(const char* scene, uint8_t category, uint8_t function) {
+    can_frame_t msg = {0};
     
     // Example: Build CAN ID based on scene and category
     // This is just an example - modify based on your CAN protocol
@@ -80,10 +573,9 @@ static twai_message_t build_can_message_from_function(const char* scene, uint8_t
     else if (strcmp(scene, "ST") == 0) base_id = 0x500;
     else if (strcmp(scene, "ACC") == 0) base_id = 0x600;
     
-    msg.identifier = base_id + (category << 4) + function;
-    msg.data_length_code = 8;
-    msg.extd = 0; // Standard frame
-    msg.rtr = 0;  // Data frame
+    msg.id = base_id + (category << 4) + function;
+    msg.dlc = 8;
+    msg.flags = 0; // Standard data frame
     
     // Example data payload
     msg.data[0] = scene[0];
@@ -99,33 +591,120 @@ static twai_message_t build_can_message_from_function(const char* scene, uint8_t
 }
 
 /**
- * @brief Periodic timer callback for repeating transmission
+ * @brief Stop the UI's repeating function, whichever channel it runs on
+ *        (periodic_lock held)
+ */
+static void stop_periodic(void) {
+    if (periodic_handle >= 0) {
+        can_scheduler_remove_periodic(&channels[periodic_channel].sched, periodic_handle);
+        periodic_handle = -1;
+    }
+}
+
+/**
+ * @brief Queue a one-shot frame at user priority on a connected channel
+ */
+static can_err_t send_frame(uint8_t channel, const can_frame_t* msg) {
+    if (!channels[channel].bus.is_open) {
+        return CAN_ERR_NOT_OPEN;
+    }
+    if (channels[channel].bus.bus_off) {
+        return CAN_ERR_BUS_OFF;     // Fail now rather than from the TX task
+    }
+    return can_scheduler_send(&channels[channel].sched, CAN_TXQ_USER, msg);
+}
+
+/**
+ * @brief Replace the periodic entry; the channel's TX task sends the first
+ *        frame at its planned phase (periodic_lock held)
  */
-static void periodic_timer_callback(TimerHandle_t timer) {
-    // Send the periodic message
-    esp_err_t err = twai_transmit(&periodic_msg, pdMS_TO_TICKS(100));
+static void start_periodic(uint8_t channel, const can_frame_t* msg, uint32_t interval,
+                           const can_xform_t* xforms, uint8_t xform_count) {
+    can_periodic_def_t def = {
+        .frame = *msg,
+        .period_ms = interval,
+        .xform_count = xform_count
+    };
+    if (xform_count > 0) {
+        memcpy(def.xforms, xforms, xform_count * sizeof(can_xform_t));
+    }
     
-    if (err == ESP_OK) {
-        // Log transmission
-        char log_msg[64];
-        snprintf(log_msg, sizeof(log_msg), "CAN ID: 0x%03X | Data: [...]", periodic_msg.identifier);
-        ui_binding_add_log("TX", log_msg);
-        
-        // Simulate response after 500ms
-        vTaskDelay(pdMS_TO_TICKS(500));
-        ui_binding_add_log("RX", "ACK: OK");
+    stop_periodic();
+    if (!channels[channel].bus.is_open) {
+        ui_binding_add_channel_log(channel, "TX", "通道未连接");
+        ui_binding_update_transmission_status(false, false);
+        return;
     }
+    periodic_channel = channel;
+    periodic_handle = can_scheduler_add_periodic(&channels[channel].sched, &def);
+    if (periodic_handle < 0) {
+        ui_binding_add_channel_log(channel, "TX", "周期发送失败");
+        ui_binding_update_transmission_status(false, false);
+        return;
+    }
+    
+    // Phases are planned per channel; report the resulting burst size
+    char log_msg[48];
+    snprintf(log_msg, sizeof(log_msg), "周期负载峰值: %u 帧/%d ms",
+             (unsigned)can_scheduler_get_peak_load(&channels[channel].sched), CAN_SCHED_PHASE_SLOT_MS);
+    ui_binding_add_channel_log(channel, "TX", log_msg);
+}
+
+#if UI_DEBUG_OVERLAY_ENABLE
+// One TX queue class of one channel, as seen by the debug overlay
+typedef struct {
+    can_txq_t* txq;
+    can_txq_class_t cls;
+} txq_probe_t;
+
+static txq_probe_t txq_probes[UI_CHANNEL_COUNT][CAN_TXQ_CLASS_COUNT];
+
+/**
+ * @brief Debug overlay: frames waiting in one TX queue class
+ */
+static uint32_t txq_depth_cb(void* user_data) {
+    const txq_probe_t* probe = (const txq_probe_t*)user_data;
+    return can_txq_depth(probe->txq, probe->cls);
+}
+
+/**
+ * @brief Debug overlay: worst-case periodic frames per phase slot (peak)
+ */
+static uint32_t tx_peak_load_cb(void* user_data) {
+    return can_scheduler_get_peak_load((can_scheduler_t*)user_data);
 }
 
+/**
+ * @brief Debug overlay: log entries waiting for the UI task now
+ */
+static uint32_t log_queue_depth_cb(void* user_data) {
+    (void)user_data;
+    ui_binding_queue_stats_t stats;
+    ui_binding_get_queue_stats(&stats);
+    return stats.log.count;
+}
+
+/**
+ * @brief Debug overlay: most log entries ever waiting at once (high-water)
+ */
+static uint32_t log_queue_high_water_cb(void* user_data) {
+    (void)user_data;
+    ui_binding_queue_stats_t stats;
+    ui_binding_get_queue_stats(&stats);
+    return stats.log.high_water;
+}
+#endif
+
 /**
  * @brief Handle auto mode transmission
  */
 void backend_transmit_auto_handler(const char* scene, uint8_t category, 
                                    uint8_t function, bool repeat, uint32_t interval) {
     const char* func_name = ui_config_get_function_name(category, function);
+    uint8_t channel = (category < sizeof(CATEGORY_CHANNELS)) ? CATEGORY_CHANNELS[category] : CH_PT;
     
     // Build CAN message
-    twai_message_t msg = build_can_message_from_function(scene, category, function);
+    can_frame_t msg = build_can_message_from_function(scene, category, function);
     
     // Log the transmission
     char log_msg[128];
@@ -135,121 +714,173 @@ void backend_transmit_auto_handler(const char* scene, uint8_t category,
     else if (category == 2) cat_name = "检查 (Inspection)";
     
     snprintf(log_msg, sizeof(log_msg), "%s - %s", cat_name, func_name);
-    ui_binding_add_log("TX", log_msg);
+    ui_binding_add_channel_log(channel, "TX", log_msg);
+    
+    // Bring the vehicle into the scene's power state first (scene channel);
+    // its TX task sends the function frame when the sequence completes
+    uint8_t xform_count = 0;
+    const can_xform_t* xforms = find_payload_xforms(category, function, &xform_count);
+    
+    const scene_sequence_t* seq = find_scene_sequence(scene);
+    if (seq != NULL) {
+        can_port_mutex_lock(periodic_lock);
+        stop_periodic();
+        pending_channel = channel;
+        pending_msg = msg;
+        pending_repeat = repeat;
+        pending_interval = interval;
+        pending_xforms = xforms;
+        pending_xform_count = xform_count;
+        can_scheduler_start_sequence(&channels[SCENE_CHANNEL].sched, seq->scene, seq->code, seq->len);
+        can_port_mutex_unlock(periodic_lock);
+        return;
+    }
     
     if (repeat) {
-        // Save message for periodic transmission
-        periodic_msg = msg;
-        
-        // Create or restart timer
-        if (periodic_timer == NULL) {
-            periodic_timer = xTimerCreate("periodic_tx", pdMS_TO_TICKS(interval),
-                                         pdTRUE, NULL, periodic_timer_callback);
-        } else {
-            xTimerChangePeriod(periodic_timer, pdMS_TO_TICKS(interval), 0);
-        }
-        xTimerStart(periodic_timer, 0);
-        
-        // Send first message immediately
-        twai_transmit(&msg, pdMS_TO_TICKS(100));
-        
-        // Simulate response
-        vTaskDelay(pdMS_TO_TICKS(500));
-        ui_binding_add_log("RX", "CAN ID: 0x123 | Data: [0x01, 0x02, 0x03]");
-        
+        can_port_mutex_lock(periodic_lock);
+        start_periodic(channel, &msg, interval, xforms, xform_count);
+        can_port_mutex_unlock(periodic_lock);
     } else {
-        // Single transmission
-        esp_err_t err = twai_transmit(&msg, pdMS_TO_TICKS(100));
+        // Single transmission at user priority (responses arrive through the RX task)
+        can_err_t err = send_frame(channel, &msg);
         
-        if (err == ESP_OK) {
-            // Simulate response after 1 second
-            vTaskDelay(pdMS_TO_TICKS(1000));
-            ui_binding_add_log("RX", "CAN ID: 0x123 | Data: [0x01, 0x02, 0x03]");
+        if (err == CAN_OK) {
             ui_binding_update_transmission_status(false, false);
         } else {
-            ESP_LOGE(TAG, "CAN transmit failed: %s", esp_err_to_name(err));
-            ui_binding_add_log("TX", "发送失败");
+            ESP_LOGE(TAG, "CAN transmit failed: %s", can_err_to_name(err));
+            ui_binding_add_channel_log(channel, "TX", (err == CAN_ERR_BUS_OFF) ? "发送失败: 总线关闭" : "发送失败");
             ui_binding_update_transmission_status(false, false);
         }
     }
 }
 
-/**
- * @brief Parse hex string to uint32_t
- */
-static uint32_t parse_hex(const char* str) {
-    uint32_t value = 0;
-    sscanf(str, "0x%x", &value);
-    return value;
-}
-
 /**
  * @brief Handle manual mode transmission
  */
-void backend_transmit_manual_handler(const char* can_id, const char* data,
+void backend_transmit_manual_handler(uint8_t channel, const char* can_id, const char* data,
                                      bool repeat, uint32_t interval) {
-    // Parse CAN ID
-    uint32_t id = parse_hex(can_id);
-    
-    // Build message
-    twai_message_t msg = {0};
-    msg.identifier = id;
-    msg.extd = 0;
-    msg.rtr = 0;
-    msg.data_length_code = 8;
-    
-    // For simplicity, just use example data
-    // In real implementation, parse the data string
-    for (int i = 0; i < 8; i++) {
-        msg.data[i] = i + 1;
+    // Parse CAN ID and data
+    can_frame_t msg;
+    if (!can_frame_parse(can_id, data, &msg)) {
+        ui_binding_add_log("TX", "ID/DATA 格式错误");
+        ui_binding_update_transmission_status(false, false);
+        return;
     }
     
     // Log
-    char log_msg[128];
-    snprintf(log_msg, sizeof(log_msg), "CAN ID: %s | Data: %s", can_id, data);
-    ui_binding_add_log("TX", log_msg);
+    log_frame(channel, "TX", &msg);
     
     if (repeat) {
-        // Save and start periodic transmission
-        periodic_msg = msg;
-        
-        if (periodic_timer == NULL) {
-            periodic_timer = xTimerCreate("periodic_tx", pdMS_TO_TICKS(interval),
-                                         pdTRUE, NULL, periodic_timer_callback);
-        } else {
-            xTimerChangePeriod(periodic_timer, pdMS_TO_TICKS(interval), 0);
-        }
-        xTimerStart(periodic_timer, 0);
-        
-        // Send first message
-        twai_transmit(&msg, pdMS_TO_TICKS(100));
-        
-        vTaskDelay(pdMS_TO_TICKS(500));
-        ui_binding_add_log("RX", "ACK: OK");
-        
+        can_port_mutex_lock(periodic_lock);
+        start_periodic(channel, &msg, interval, NULL, 0);
+        can_port_mutex_unlock(periodic_lock);
     } else {
-        // Single transmission
-        esp_err_t err = twai_transmit(&msg, pdMS_TO_TICKS(100));
+        // Single transmission at user priority
+        can_err_t err = send_frame(channel, &msg);
         
-        if (err == ESP_OK) {
-            vTaskDelay(pdMS_TO_TICKS(1000));
-            ui_binding_add_log("RX", "ACK: OK");
+        if (err == CAN_OK) {
             ui_binding_update_transmission_status(false, false);
         } else {
-            ui_binding_add_log("TX", "发送失败");
+            ui_binding_add_channel_log(channel, "TX", (err == CAN_ERR_BUS_OFF) ? "发送失败: 总线关闭" : "发送失败");
             ui_binding_update_transmission_status(false, false);
         }
     }
 }
 
+/**
+ * @brief Handle an edit of the running manual repeat (no STOP needed)
+ */
+void backend_manual_update_handler(uint8_t channel, const char* can_id, const char* data,
+                                   uint32_t interval) {
+    can_frame_t msg;
+    if (!can_frame_parse(can_id, data, &msg)) {
+        ui_binding_add_log("TX", "ID/DATA 格式错误, 保持原帧");
+        return;
+    }
+    
+    // Swapped in by the next scheduled send: no gap, no duplicate
+    can_periodic_def_t def = {
+        .frame = msg,
+        .period_ms = interval
+    };
+    can_port_mutex_lock(periodic_lock);
+    if (periodic_handle < 0 || channel != periodic_channel) {
+        // Not running (it failed to start or the channel dropped), or the
+        // channel changed and an entry cannot move between schedulers
+        start_periodic(channel, &msg, interval, NULL, 0);
+    } else if (can_scheduler_update_periodic(&channels[channel].sched, periodic_handle, &def)) {
+        char log_msg[128];
+        snprintf(log_msg, sizeof(log_msg), "已更新: %s | %s | %lu ms",
+                 can_id, data, (unsigned long)interval);
+        ui_binding_add_channel_log(channel, "TX", log_msg);
+    }
+    can_port_mutex_unlock(periodic_lock);
+}
+
+/**
+ * @brief Start an ID/payload sweep at full bus rate on one channel
+ */
+void backend_sweep_start_handler(uint8_t channel, const char* id_first, const char* id_last,
+                                 uint8_t pattern, uint32_t seed) {
+    if (channel >= UI_CHANNEL_COUNT) {
+        return;
+    }
+    char* end_first = NULL;
+    char* end_last = NULL;
+    unsigned long first = strtoul(id_first, &end_first, 16);
+    unsigned long last = strtoul(id_last, &end_last, 16);
+    if (end_first == id_first || end_last == id_last || last > CAN_EXT_ID_MASK) {
+        ui_binding_add_log("TX", "扫描 ID 范围错误");
+        return;
+    }
+    
+    // 8-byte frames; ui_sweep_pattern_t lists the patterns in can_sweep_pattern_t order
+    can_sweep_config_t config = {
+        .id_first = (uint32_t)first,
+        .id_last = (uint32_t)last,
+        .extended = (last > CAN_STD_ID_MASK),
+        .dlc = 8,
+        .pattern = (can_sweep_pattern_t)pattern,
+        .seed = seed,
+        .rate_fps = 0
+    };
+    if (!channels[channel].bus.is_open) {
+        ui_binding_add_channel_log(channel, "TX", "通道未连接");
+        return;
+    }
+    
+    // One sweep at a time: a new one replaces the old, also across channels
+    if (sweep_channel != channel) {
+        can_scheduler_stop_sweep(&channels[sweep_channel].sched);
+    }
+    sweep_channel = channel;
+    if (!can_scheduler_start_sweep(&channels[channel].sched, &config)) {
+        ui_binding_add_log("TX", "扫描 ID 范围错误");
+        return;
+    }
+    
+    char log_msg[64];
+    snprintf(log_msg, sizeof(log_msg), "扫描开始: 0x%lX-0x%lX", first, last);
+    ui_binding_add_channel_log(channel, "TX", log_msg);
+}
+
+/**
+ * @brief Stop the running sweep (progress arrives as SWEEP_DONE)
+ */
+void backend_sweep_stop_handler(void) {
+    can_scheduler_stop_sweep(&channels[sweep_channel].sched);
+}
+
 /**
  * @brief Handle stop request
  */
 void backend_stop_handler(void) {
-    // Stop periodic transmission
-    if (periodic_timer != NULL) {
-        xTimerStop(periodic_timer, 0);
-    }
+    // Cancel a running scene sequence and sweep, and stop periodic transmission
+    can_scheduler_stop_sequence(&channels[SCENE_CHANNEL].sched);
+    can_scheduler_stop_sweep(&channels[sweep_channel].sched);
+    can_port_mutex_lock(periodic_lock);
+    stop_periodic();
+    can_port_mutex_unlock(periodic_lock);
     
     ui_binding_update_transmission_status(false, false);
     ui_binding_add_log("TX", "停止发送");
@@ -277,36 +908,88 @@ void backend_clear_logs_handler(void) {
 // ==================== Application Entry Point ====================
 
 /**
- * @brief Initialize and run the application
+ * @brief UI task: LVGL, then the CAN tasks once the UI can take their updates
  */
-void app_main(void) {
+static void ui_task(void* arg) {
+    (void)arg;
+    
     // Initialize LVGL and display driver
     // (This is platform-specific - add your display driver init here)
     
     lv_init();
-    // ... display driver init ...
+    ui_loop_init();
+    // ... display driver init (ui_display_create, see README) ...
     // ... input driver init ...
+    // ui_loop_add_indev(touch_indev);  // touch IRQ calls ui_loop_notify_from_isr()
     
     // Initialize UI
     ESP_LOGI(TAG, "Initializing UI...");
     ui_init();
     
-    // Register backend callbacks
+    // Per channel: select the CAN backend, compile its rules and start its
+    // TX scheduler task (RX tasks start when the channel is connected)
+    periodic_lock = can_port_mutex_create();
+    for (uint8_t i = 0; i < UI_CHANNEL_COUNT; i++) {
+        can_channel_t* ch = &channels[i];
+        const can_channel_config_t* cfg = &CHANNEL_CONFIGS[i];
+        ch->index = i;
+        ch->rx_exited = can_port_sem_create();
+        can_transport_init(&ch->bus, cfg->ops);
+        can_scheduler_init(&ch->sched, &ch->bus);
+        can_scheduler_set_event_cb(&ch->sched, tx_sched_event_cb, ch);
+        can_rules_compile(&ch->rules, cfg->rules, cfg->rule_count, &ch->sched);
+        can_health_init(&ch->health, &ch->bus);
+        can_health_set_event_cb(&ch->health, health_event_cb, ch);
+        start_can_task(cfg->tx_task_name, CAN_TX_TASK_PRIO, can_tx_task, ch);
+    }
+#if UI_DEBUG_OVERLAY_ENABLE
+    for (uint8_t i = 0; i < UI_CHANNEL_COUNT; i++) {
+        for (uint8_t cls = 0; cls < CAN_TXQ_CLASS_COUNT; cls++) {
+            txq_probes[i][cls] = (txq_probe_t){.txq = &channels[i].sched.txq, .cls = (can_txq_class_t)cls};
+            ui_debug_overlay_add_queue(CHANNEL_CONFIGS[i].overlay_txq[cls], txq_depth_cb, &txq_probes[i][cls]);
+        }
+    }
+    ui_debug_overlay_add_queue("log", log_queue_depth_cb, NULL);
+    for (uint8_t i = 0; i < UI_CHANNEL_COUNT; i++) {
+        ui_debug_overlay_add_peak(CHANNEL_CONFIGS[i].overlay_name, tx_peak_load_cb, &channels[i].sched);
+    }
+    ui_debug_overlay_add_peak("logHW", log_queue_high_water_cb, NULL);
+#endif
+    
+    // Register backend callbacks; they run in the control task on the CAN core
     ui_callbacks_t callbacks = {
         .on_connection_changed = backend_connection_handler,
         .on_transmit_auto = backend_transmit_auto_handler,
         .on_transmit_manual = backend_transmit_manual_handler,
         .on_stop = backend_stop_handler,
         .on_scene_selected = backend_scene_handler,
-        .on_clear_logs = backend_clear_logs_handler
+        .on_clear_logs = backend_clear_logs_handler,
+        .on_manual_update = backend_manual_update_handler,
+        .on_sweep_start = backend_sweep_start_handler,
+        .on_sweep_stop = backend_sweep_stop_handler
     };
     ui_binding_register_callbacks(&callbacks);
+    ui_binding_defer_callbacks(true);
+    start_can_task("can_ctl", CAN_CTL_TASK_PRIO, can_ctl_task, NULL);
     
     ESP_LOGI(TAG, "UI initialized successfully");
     
-    // Main LVGL task loop
-    while (1) {
-        lv_timer_handler();
-        vTaskDelay(pdMS_TO_TICKS(10));
+    // Main LVGL task loop (sleeps until the next timer deadline or a notification)
+    ui_loop_run();
+}
+
+/**
+ * @brief Initialize and run the application
+ */
+void app_main(void) {
+    // The UI gets its own core; app_main returns and its task is deleted
+    can_port_task_config_t config = {
+        .name = "ui",
+        .stack_size = UI_TASK_STACK,
+        .priority = UI_TASK_PRIO,
+        .core = UI_TASK_CORE
+    };
+    if (!can_port_task_create(&config, ui_task, NULL)) {
+        ESP_LOGE(TAG, "UI task not started");
     }
 }
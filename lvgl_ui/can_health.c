@@ -0,0 +1,134 @@
+/**
+ * @file can_health.c
+ * @brief Bus Health Monitor Implementation
+ */
+
+#include "can_health.h"
+#include <string.h>
+
+static void emit(can_health_t* health, can_health_event_t* event) {
+    event->state = health->state;
+    event->status = &health->status;
+    if (health->event_cb != NULL) {
+        health->event_cb(event, health->event_user_data);
+    }
+}
+
+static bool state_is_down(can_bus_state_t state) {
+    return state == CAN_BUS_OFF || state == CAN_BUS_RECOVERING || state == CAN_BUS_STOPPED;
+}
+
+static uint32_t ms_until(uint64_t deadline_us, uint64_t now_us) {
+    return (deadline_us > now_us) ? (uint32_t)((deadline_us - now_us + 999u) / 1000u) : 0;
+}
+
+void can_health_init(can_health_t* health, can_transport_t* bus) {
+    memset(health, 0, sizeof(can_health_t));
+    health->bus = bus;
+    health->backoff_ms = CAN_HEALTH_BACKOFF_MIN_MS;
+}
+
+void can_health_set_event_cb(can_health_t* health, can_health_event_cb_t cb, void* user_data) {
+    health->event_cb = cb;
+    health->event_user_data = user_data;
+}
+
+void can_health_reset(can_health_t* health, uint64_t now_us) {
+    memset(&health->status, 0, sizeof(can_bus_status_t));
+    health->state = CAN_BUS_ERROR_ACTIVE;
+    health->down = false;
+    health->up_us = now_us;
+    health->backoff_ms = CAN_HEALTH_BACKOFF_MIN_MS;
+    health->attempts = 0;
+    health->bus_off_count = 0;
+    health->recoveries = 0;
+    can_transport_set_bus_off(health->bus, false);
+}
+
+uint32_t can_health_poll(can_health_t* health, uint64_t now_us) {
+    can_bus_status_t status;
+    if (can_transport_get_status(health->bus, &status) != CAN_OK) {
+        return CAN_HEALTH_POLL_MS;
+    }
+    health->status = status;
+
+    if (status.state != health->state) {
+        can_health_event_t event = {
+            .type = CAN_HEALTH_EVENT_STATE,
+            .prev_state = health->state
+        };
+        health->state = status.state;
+        if (status.state == CAN_BUS_OFF) {
+            health->bus_off_count++;
+        }
+        emit(health, &event);
+    }
+
+    bool down = state_is_down(status.state);
+    if (down && !health->down) {
+        // Stop the TX pipeline first so nothing blocks on the dead bus
+        health->down = true;
+        health->down_us = now_us;
+        health->retry_us = now_us + (uint64_t)health->backoff_ms * 1000u;
+        health->attempts = 0;
+        can_transport_set_bus_off(health->bus, true);
+    } else if (!down && health->down) {
+        can_transport_set_bus_off(health->bus, false);
+        health->down = false;
+        health->up_us = now_us;
+        health->recoveries++;
+        can_health_event_t event = {
+            .type = CAN_HEALTH_EVENT_RECOVERED,
+            .attempt = health->attempts,
+            .down_ms = (uint32_t)((now_us - health->down_us) / 1000u)
+        };
+        emit(health, &event);
+    }
+
+    if (!down) {
+        if (status.state != CAN_BUS_ERROR_ACTIVE) {
+            health->up_us = now_us;     // Only a clean bus counts as stable
+        } else if (health->backoff_ms > CAN_HEALTH_BACKOFF_MIN_MS &&
+                   now_us - health->up_us >= (uint64_t)CAN_HEALTH_STABLE_MS * 1000u) {
+            health->backoff_ms = CAN_HEALTH_BACKOFF_MIN_MS;
+        }
+        return CAN_HEALTH_POLL_MS;
+    }
+
+    switch (status.state) {
+        case CAN_BUS_STOPPED:
+            // Recovery sequence finished: restart the controller right away
+            can_transport_recover(health->bus);
+            return CAN_HEALTH_RECOVER_POLL_MS;
+
+        case CAN_BUS_RECOVERING:
+            return CAN_HEALTH_RECOVER_POLL_MS;
+
+        default:
+            break;
+    }
+
+    // Bus-off: wait out the backoff, then start the recovery sequence
+    if (now_us < health->retry_us) {
+        uint32_t wait_ms = ms_until(health->retry_us, now_us);
+        return (wait_ms < CAN_HEALTH_POLL_MS) ? wait_ms : CAN_HEALTH_POLL_MS;
+    }
+    uint32_t waited_ms = health->backoff_ms;
+    uint32_t next_ms = health->backoff_ms * 2u;
+    health->backoff_ms = (next_ms < CAN_HEALTH_BACKOFF_MAX_MS) ? next_ms : CAN_HEALTH_BACKOFF_MAX_MS;
+    health->retry_us = now_us + (uint64_t)health->backoff_ms * 1000u;
+
+    if (can_transport_recover(health->bus) == CAN_OK) {
+        health->attempts++;
+        can_health_event_t event = {
+            .type = CAN_HEALTH_EVENT_RECOVERY,
+            .attempt = health->attempts,
+            .backoff_ms = waited_ms
+        };
+        emit(health, &event);
+        return CAN_HEALTH_RECOVER_POLL_MS;
+    }
+    // The backend leaves recovery to the controller or the OS (SocketCAN
+    // restart-ms); keep the bus down until it reports error-active again
+    return CAN_HEALTH_POLL_MS;
+}
@@ -0,0 +1,114 @@
+/**
+ * @file can_health.h
+ * @brief Bus Health Monitor (Error States and Bus-Off Recovery)
+ *
+ * Polls a transport's controller status, reports fault confinement changes
+ * (error-active -> warning -> passive -> bus-off) and brings the controller
+ * back from bus-off without user action. Recovery of a bus-off starts after a
+ * backoff delay that doubles with every bus-off in a row, so a shorted or
+ * unterminated bus is not hammered with recoveries; the delay drops back to
+ * the minimum once the bus has stayed error-active for CAN_HEALTH_STABLE_MS.
+ *
+ * While the controller is bus-off or recovering the transport is marked down
+ * and every send fails at once with CAN_ERR_BUS_OFF instead of waiting for a
+ * TX slot that cannot free up.
+ *
+ * can_health_poll() never blocks and returns how long the caller may wait
+ * before the next poll; the backend runs it from each channel's RX task.
+ */
+
+#ifndef CAN_HEALTH_H
+#define CAN_HEALTH_H
+
+#include "can_transport.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define CAN_HEALTH_POLL_MS          100     // Status poll interval while the bus is up
+#define CAN_HEALTH_RECOVER_POLL_MS  10      // ... while it is down
+#define CAN_HEALTH_BACKOFF_MIN_MS   50      // Delay before the first recovery
+#define CAN_HEALTH_BACKOFF_MAX_MS   5000
+#define CAN_HEALTH_STABLE_MS        2000    // Error-active this long resets the backoff
+
+/**
+ * @brief Health event types (delivered on the polling task)
+ */
+typedef enum {
+    CAN_HEALTH_EVENT_STATE = 0,     // Bus state changed
+    CAN_HEALTH_EVENT_RECOVERY,      // Recovery of a bus-off started
+    CAN_HEALTH_EVENT_RECOVERED      // Bus back up after bus-off
+} can_health_event_type_t;
+
+/**
+ * @brief Health event
+ */
+typedef struct {
+    can_health_event_type_t type;
+    can_bus_state_t state;              // Current state
+    can_bus_state_t prev_state;         // For CAN_HEALTH_EVENT_STATE
+    const can_bus_status_t* status;     // Counters and latched events of this poll
+    uint32_t attempt;                   // For RECOVERY / RECOVERED: attempts in this bus-off
+    uint32_t backoff_ms;                // For RECOVERY: delay that was waited
+    uint32_t down_ms;                   // For RECOVERED: time the bus was down
+} can_health_event_t;
+
+typedef void (*can_health_event_cb_t)(const can_health_event_t* event, void* user_data);
+
+/**
+ * @brief Health monitor of one transport (owned by the polling task)
+ */
+typedef struct {
+    can_transport_t* bus;
+    can_health_event_cb_t event_cb;
+    void* event_user_data;
+
+    can_bus_status_t status;    // Last status read
+    can_bus_state_t state;
+    bool down;                  // Bus-off, recovering or stopped
+    uint64_t down_us;           // When the bus went down
+    uint64_t up_us;             // When the bus last came back (or the monitor started)
+    uint64_t retry_us;          // Next recovery attempt
+    uint32_t backoff_ms;        // Delay before recovering the next bus-off
+    uint32_t attempts;          // Recovery attempts in the current bus-off
+
+    uint32_t bus_off_count;     // Since reset
+    uint32_t recoveries;        // Since reset
+} can_health_t;
+
+/**
+ * @brief Bind a monitor to a transport
+ * @param health Monitor
+ * @param bus Transport to watch
+ */
+void can_health_init(can_health_t* health, can_transport_t* bus);
+
+/**
+ * @brief Set the event callback (before polling starts)
+ * @param health Monitor
+ * @param cb Callback (NULL to disable)
+ * @param user_data Passed to the callback
+ */
+void can_health_set_event_cb(can_health_t* health, can_health_event_cb_t cb, void* user_data);
+
+/**
+ * @brief Forget the previous session (call after opening the transport)
+ * @param health Monitor
+ * @param now_us Current time (can_port_time_us)
+ */
+void can_health_reset(can_health_t* health, uint64_t now_us);
+
+/**
+ * @brief Read the controller status and run the recovery state machine
+ * @param health Monitor
+ * @param now_us Current time (can_port_time_us)
+ * @return Milliseconds until the next poll is due
+ */
+uint32_t can_health_poll(can_health_t* health, uint64_t now_us);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // CAN_HEALTH_H
@@ -0,0 +1,82 @@
+/**
+ * @file can_pool.c
+ * @brief Fixed-Size Block Pools Implementation
+ */
+
+#include "can_pool.h"
+#include <stdio.h>
+
+static const can_pool_t* g_pools[CAN_POOL_MAX_REGISTERED];
+static uint8_t g_pool_count = 0;
+
+void can_pool_init(can_pool_t* pool, const char* name, void* storage, size_t block_size, uint32_t count) {
+    block_size = CAN_POOL_BLOCK_SIZE(block_size < sizeof(void*) ? sizeof(void*) : block_size);
+
+    pool->name = name;
+    pool->storage = (uint8_t*)storage;
+    pool->storage_end = pool->storage + block_size * count;
+    pool->stats.block_size = (uint32_t)block_size;
+    pool->stats.capacity = count;
+    pool->stats.in_use = 0;
+    pool->stats.high_water = 0;
+    pool->stats.exhausted = 0;
+
+    // Chain the blocks in address order
+    pool->free_list = NULL;
+    for (uint32_t i = count; i > 0; i--) {
+        void** block = (void**)(pool->storage + (size_t)(i - 1) * block_size);
+        *block = pool->free_list;
+        pool->free_list = block;
+    }
+
+    for (uint8_t i = 0; i < g_pool_count; i++) {
+        if (g_pools[i] == pool) {
+            return;
+        }
+    }
+    if (g_pool_count < CAN_POOL_MAX_REGISTERED) {
+        g_pools[g_pool_count++] = pool;
+    }
+}
+
+void* can_pool_alloc(can_pool_t* pool) {
+    void** block = (void**)pool->free_list;
+    if (block == NULL) {
+        pool->stats.exhausted++;
+        return NULL;
+    }
+    pool->free_list = *block;
+    pool->stats.in_use++;
+    if (pool->stats.in_use > pool->stats.high_water) {
+        pool->stats.high_water = pool->stats.in_use;
+    }
+    return block;
+}
+
+void can_pool_free(can_pool_t* pool, void* block) {
+    if (block == NULL) {
+        return;
+    }
+    *(void**)block = pool->free_list;
+    pool->free_list = block;
+    pool->stats.in_use--;
+}
+
+void can_pool_get_stats(const can_pool_t* pool, can_pool_stats_t* stats) {
+    *stats = pool->stats;
+}
+
+int can_pool_format(char* buf, size_t size) {
+    int len = 0;
+    if (size > 0) {
+        buf[0] = '\0';
+    }
+    for (uint8_t i = 0; i < g_pool_count && len >= 0 && (size_t)len < size; i++) {
+        const can_pool_stats_t* s = &g_pools[i]->stats;
+        len += snprintf(buf + len, size - len, "%s%s %lu/%lu hw %lu !%lu",
+                        (i == 0) ? "" : "\n", g_pools[i]->name,
+                        (unsigned long)s->in_use, (unsigned long)s->capacity,
+                        (unsigned long)s->high_water, (unsigned long)s->exhausted);
+    }
+    return len;
+}
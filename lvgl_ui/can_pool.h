@@ -0,0 +1,129 @@
+/**
+ * @file can_pool.h
+ * @brief Fixed-Size Block Pools
+ *
+ * A pool hands out blocks of one size from storage reserved at startup.
+ * Free blocks are chained through their own first word, so alloc and free
+ * are a pointer swap each and the pool never fragments. An empty pool
+ * refuses the allocation and counts it; the caller decides whether to fall
+ * back to the heap. In-use and high-water counts show how close a pool got
+ * to its capacity.
+ *
+ * Storage declared with CAN_POOL_STORAGE() goes to PSRAM on ESP32 builds
+ * with CAN_POOL_PSRAM=1 (needs CONFIG_SPIRAM_ALLOW_BSS_SEG_EXTERNAL_MEMORY).
+ *
+ * A pool is not locked: it belongs to one task, or its users serialize
+ * access (the LVGL allocator pools are only used on the LVGL task).
+ */
+
+#ifndef CAN_POOL_H
+#define CAN_POOL_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#if defined(ESP_PLATFORM) && defined(CAN_POOL_PSRAM) && CAN_POOL_PSRAM
+#include "esp_attr.h"
+#define CAN_POOL_ATTR   EXT_RAM_BSS_ATTR
+#else
+#define CAN_POOL_ATTR
+#endif
+
+#define CAN_POOL_ALIGN          8   // Block alignment (and size granularity)
+#define CAN_POOL_MAX_REGISTERED 8   // Pools listed by can_pool_format()
+
+/**
+ * @brief Round a block size up to the pool alignment
+ */
+#define CAN_POOL_BLOCK_SIZE(size)   (((size) + CAN_POOL_ALIGN - 1) & ~(size_t)(CAN_POOL_ALIGN - 1))
+
+/**
+ * @brief Declare static storage for count blocks of size bytes
+ */
+#define CAN_POOL_STORAGE(name, size, count) \
+    static uint8_t name[CAN_POOL_BLOCK_SIZE(size) * (count)] CAN_POOL_ATTR __attribute__((aligned(CAN_POOL_ALIGN)))
+
+/**
+ * @brief Pool counters
+ */
+typedef struct {
+    uint32_t block_size;
+    uint32_t capacity;      // Blocks
+    uint32_t in_use;
+    uint32_t high_water;    // Most blocks in use at once since init
+    uint32_t exhausted;     // Allocations refused: pool empty
+} can_pool_stats_t;
+
+/**
+ * @brief Block pool
+ */
+typedef struct {
+    const char* name;
+    uint8_t* storage;
+    uint8_t* storage_end;
+    void* free_list;        // First free block (next pointer in its first word)
+    can_pool_stats_t stats;
+} can_pool_t;
+
+/**
+ * @brief Carve storage into blocks
+ * @param pool Pool
+ * @param name Short name for reports (static string)
+ * @param storage Storage (CAN_POOL_ALIGN aligned, CAN_POOL_BLOCK_SIZE(block_size) * count bytes)
+ * @param block_size Bytes per block (rounded up to CAN_POOL_ALIGN)
+ * @param count Number of blocks
+ */
+void can_pool_init(can_pool_t* pool, const char* name, void* storage, size_t block_size, uint32_t count);
+
+/**
+ * @brief Take a block
+ * @param pool Pool
+ * @return Block, or NULL if the pool is empty (counted in exhausted)
+ */
+void* can_pool_alloc(can_pool_t* pool);
+
+/**
+ * @brief Return a block
+ * @param pool Pool the block came from
+ * @param block Block (NULL is ignored)
+ */
+void can_pool_free(can_pool_t* pool, void* block);
+
+/**
+ * @brief Check whether a pointer is a block of this pool
+ * @param pool Pool
+ * @param ptr Pointer
+ * @return true if ptr lies in the pool's storage
+ */
+static inline bool can_pool_owns(const can_pool_t* pool, const void* ptr) {
+    return (const uint8_t*)ptr >= pool->storage && (const uint8_t*)ptr < pool->storage_end;
+}
+
+/**
+ * @brief Read a pool's counters
+ * @param pool Pool
+ * @param stats Output
+ */
+void can_pool_get_stats(const can_pool_t* pool, can_pool_stats_t* stats);
+
+/**
+ * @brief Format one line per initialized pool (for the debug overlay)
+ *
+ * "name in_use/capacity hw N !N" - high-water and refused allocations.
+ *
+ * @param buf Output buffer
+ * @param size Buffer size
+ * @return Number of characters written
+ */
+int can_pool_format(char* buf, size_t size);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // CAN_POOL_H
@@ -0,0 +1,335 @@
+/**
+ * @file can_port.c
+ * @brief OS Portability Layer Implementation
+ *
+ * FreeRTOS implementation when built with ESP-IDF, POSIX otherwise.
+ */
+
+#ifndef ESP_PLATFORM
+#define _GNU_SOURCE     // pthread_setaffinity_np, sched_getcpu
+#endif
+
+#include "can_port.h"
+#include <stdlib.h>
+
+typedef struct {
+    can_port_task_fn_t fn;
+    void* arg;
+} task_start_t;
+
+#ifdef ESP_PLATFORM
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "esp_timer.h"
+
+struct can_port_mutex {
+    SemaphoreHandle_t handle;
+};
+
+struct can_port_sem {
+    SemaphoreHandle_t handle;
+};
+
+// Rounds up: pdMS_TO_TICKS truncates, which turns 1-9 ms at 100 Hz into a
+// zero-tick wait and the TX task into a busy loop
+static TickType_t ms_to_ticks(uint32_t ms) {
+    if (ms == CAN_PORT_WAIT_FOREVER) {
+        return portMAX_DELAY;
+    }
+    return (TickType_t)(((uint64_t)ms + portTICK_PERIOD_MS - 1) / portTICK_PERIOD_MS);
+}
+
+uint64_t can_port_time_us(void) {
+    return (uint64_t)esp_timer_get_time();
+}
+
+void can_port_sleep_ms(uint32_t ms) {
+    vTaskDelay(ms_to_ticks(ms));
+}
+
+can_port_mutex_t* can_port_mutex_create(void) {
+    can_port_mutex_t* mutex = malloc(sizeof(can_port_mutex_t));
+    if (mutex != NULL) {
+        mutex->handle = xSemaphoreCreateMutex();
+        if (mutex->handle == NULL) {
+            free(mutex);
+            mutex = NULL;
+        }
+    }
+    return mutex;
+}
+
+void can_port_mutex_destroy(can_port_mutex_t* mutex) {
+    if (mutex != NULL) {
+        vSemaphoreDelete(mutex->handle);
+        free(mutex);
+    }
+}
+
+void can_port_mutex_lock(can_port_mutex_t* mutex) {
+    xSemaphoreTake(mutex->handle, portMAX_DELAY);
+}
+
+void can_port_mutex_unlock(can_port_mutex_t* mutex) {
+    xSemaphoreGive(mutex->handle);
+}
+
+can_port_sem_t* can_port_sem_create(void) {
+    can_port_sem_t* sem = malloc(sizeof(can_port_sem_t));
+    if (sem != NULL) {
+        sem->handle = xSemaphoreCreateBinary();
+        if (sem->handle == NULL) {
+            free(sem);
+            sem = NULL;
+        }
+    }
+    return sem;
+}
+
+void can_port_sem_destroy(can_port_sem_t* sem) {
+    if (sem != NULL) {
+        vSemaphoreDelete(sem->handle);
+        free(sem);
+    }
+}
+
+void can_port_sem_give(can_port_sem_t* sem) {
+    xSemaphoreGive(sem->handle);
+}
+
+void can_port_sem_give_from_isr(can_port_sem_t* sem) {
+    BaseType_t woken = pdFALSE;
+    xSemaphoreGiveFromISR(sem->handle, &woken);
+    portYIELD_FROM_ISR(woken);
+}
+
+bool can_port_sem_take(can_port_sem_t* sem, uint32_t timeout_ms) {
+    return xSemaphoreTake(sem->handle, ms_to_ticks(timeout_ms)) == pdTRUE;
+}
+
+static void task_entry(void* arg) {
+    task_start_t start = *(task_start_t*)arg;
+    free(arg);
+    start.fn(start.arg);
+    vTaskDelete(NULL);
+}
+
+bool can_port_task_create(const can_port_task_config_t* config, can_port_task_fn_t fn, void* arg) {
+    task_start_t* start = malloc(sizeof(task_start_t));
+    if (start == NULL) {
+        return false;
+    }
+    start->fn = fn;
+    start->arg = arg;
+
+    BaseType_t core = (config->core >= 0 && config->core < portNUM_PROCESSORS) ? config->core : tskNO_AFFINITY;
+    UBaseType_t priority = (config->priority < configMAX_PRIORITIES) ? config->priority : configMAX_PRIORITIES - 1;
+    if (xTaskCreatePinnedToCore(task_entry, config->name, config->stack_size, start,
+                                priority, NULL, core) != pdPASS) {
+        free(start);
+        return false;
+    }
+    return true;
+}
+
+int can_port_task_core(void) {
+    return (int)xPortGetCoreID();
+}
+
+bool can_port_task_is_realtime(void) {
+    return true;
+}
+
+#else // POSIX
+
+#include <pthread.h>
+#include <sched.h>
+#include <limits.h>
+#include <unistd.h>
+#include <time.h>
+#include <errno.h>
+
+struct can_port_mutex {
+    pthread_mutex_t handle;
+};
+
+struct can_port_sem {
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    bool signaled;
+};
+
+uint64_t can_port_time_us(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000ull + (uint64_t)ts.tv_nsec / 1000ull;
+}
+
+void can_port_sleep_ms(uint32_t ms) {
+    struct timespec ts = {
+        .tv_sec = ms / 1000,
+        .tv_nsec = (long)(ms % 1000) * 1000000L
+    };
+    while (nanosleep(&ts, &ts) != 0 && errno == EINTR) {
+    }
+}
+
+can_port_mutex_t* can_port_mutex_create(void) {
+    can_port_mutex_t* mutex = malloc(sizeof(can_port_mutex_t));
+    if (mutex != NULL) {
+        pthread_mutex_init(&mutex->handle, NULL);
+    }
+    return mutex;
+}
+
+void can_port_mutex_destroy(can_port_mutex_t* mutex) {
+    if (mutex != NULL) {
+        pthread_mutex_destroy(&mutex->handle);
+        free(mutex);
+    }
+}
+
+void can_port_mutex_lock(can_port_mutex_t* mutex) {
+    pthread_mutex_lock(&mutex->handle);
+}
+
+void can_port_mutex_unlock(can_port_mutex_t* mutex) {
+    pthread_mutex_unlock(&mutex->handle);
+}
+
+can_port_sem_t* can_port_sem_create(void) {
+    can_port_sem_t* sem = malloc(sizeof(can_port_sem_t));
+    if (sem != NULL) {
+        pthread_condattr_t attr;
+        pthread_condattr_init(&attr);
+        pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+        pthread_mutex_init(&sem->lock, NULL);
+        pthread_cond_init(&sem->cond, &attr);
+        pthread_condattr_destroy(&attr);
+        sem->signaled = false;
+    }
+    return sem;
+}
+
+void can_port_sem_destroy(can_port_sem_t* sem) {
+    if (sem != NULL) {
+        pthread_cond_destroy(&sem->cond);
+        pthread_mutex_destroy(&sem->lock);
+        free(sem);
+    }
+}
+
+void can_port_sem_give(can_port_sem_t* sem) {
+    pthread_mutex_lock(&sem->lock);
+    sem->signaled = true;
+    pthread_cond_signal(&sem->cond);
+    pthread_mutex_unlock(&sem->lock);
+}
+
+bool can_port_sem_take(can_port_sem_t* sem, uint32_t timeout_ms) {
+    struct timespec deadline;
+    if (timeout_ms != CAN_PORT_WAIT_FOREVER) {
+        clock_gettime(CLOCK_MONOTONIC, &deadline);
+        deadline.tv_sec += timeout_ms / 1000;
+        deadline.tv_nsec += (long)(timeout_ms % 1000) * 1000000L;
+        if (deadline.tv_nsec >= 1000000000L) {
+            deadline.tv_sec++;
+            deadline.tv_nsec -= 1000000000L;
+        }
+    }
+
+    pthread_mutex_lock(&sem->lock);
+    while (!sem->signaled) {
+        if (timeout_ms == CAN_PORT_WAIT_FOREVER) {
+            pthread_cond_wait(&sem->cond, &sem->lock);
+        } else if (pthread_cond_timedwait(&sem->cond, &sem->lock, &deadline) == ETIMEDOUT) {
+            break;
+        }
+    }
+    bool taken = sem->signaled;
+    sem->signaled = false;
+    pthread_mutex_unlock(&sem->lock);
+    return taken;
+}
+
+// Host "interrupts" are threads: a plain give is enough
+void can_port_sem_give_from_isr(can_port_sem_t* sem) {
+    can_port_sem_give(sem);
+}
+
+static void* task_entry(void* arg) {
+    task_start_t start = *(task_start_t*)arg;
+    free(arg);
+    start.fn(start.arg);
+    return NULL;
+}
+
+static bool task_start(const can_port_task_config_t* config, task_start_t* start, bool realtime) {
+    pthread_attr_t attr;
+    pthread_attr_init(&attr);
+    pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
+    if (config->stack_size >= PTHREAD_STACK_MIN) {
+        pthread_attr_setstacksize(&attr, config->stack_size);
+    }
+
+#ifdef __linux__
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    if (config->core >= 0 && config->core < cpus) {
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(config->core, &set);
+        pthread_attr_setaffinity_np(&attr, sizeof(set), &set);
+    }
+#endif
+
+    if (realtime) {
+        int lo = sched_get_priority_min(SCHED_FIFO);
+        int hi = sched_get_priority_max(SCHED_FIFO);
+        struct sched_param param = {
+            .sched_priority = (config->priority < lo) ? lo : (config->priority > hi) ? hi : config->priority
+        };
+        pthread_attr_setinheritsched(&attr, PTHREAD_EXPLICIT_SCHED);
+        pthread_attr_setschedpolicy(&attr, SCHED_FIFO);
+        pthread_attr_setschedparam(&attr, &param);
+    }
+
+    pthread_t thread;
+    int err = pthread_create(&thread, &attr, task_entry, start);
+    pthread_attr_destroy(&attr);
+    return err == 0;
+}
+
+bool can_port_task_create(const can_port_task_config_t* config, can_port_task_fn_t fn, void* arg) {
+    task_start_t* start = malloc(sizeof(task_start_t));
+    if (start == NULL) {
+        return false;
+    }
+    start->fn = fn;
+    start->arg = arg;
+
+    // SCHED_FIFO needs privileges: retry with the default policy
+    if (task_start(config, start, config->priority > 0) ||
+        (config->priority > 0 && task_start(config, start, false))) {
+        return true;
+    }
+    free(start);
+    return false;
+}
+
+int can_port_task_core(void) {
+#ifdef __linux__
+    return sched_getcpu();
+#else
+    return -1;
+#endif
+}
+
+bool can_port_task_is_realtime(void) {
+    int policy;
+    struct sched_param param;
+    return pthread_getschedparam(pthread_self(), &policy, &param) == 0 && policy == SCHED_FIFO;
+}
+
+#endif // ESP_PLATFORM
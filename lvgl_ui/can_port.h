@@ -0,0 +1,157 @@
+/**
+ * @file can_port.h
+ * @brief OS Portability Layer for the CAN Backend
+ *
+ * Minimal time, synchronization and task primitives used by the CAN backend
+ * modules, implemented on FreeRTOS (ESP-IDF) and POSIX (Linux host build).
+ *
+ * Tasks are created with a core and a priority. On FreeRTOS these are the
+ * core affinity and task priority. On POSIX the thread is pinned to the CPU
+ * and runs SCHED_FIFO at the same priority value. Without the privilege for
+ * that (CAP_SYS_NICE), it keeps the default policy and only the pinning
+ * applies.
+ */
+
+#ifndef CAN_PORT_H
+#define CAN_PORT_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Wait forever (timeout value)
+ */
+#define CAN_PORT_WAIT_FOREVER 0xFFFFFFFFu
+
+/**
+ * @brief No core affinity (task config)
+ */
+#define CAN_PORT_CORE_ANY     (-1)
+
+/**
+ * @brief Opaque mutex handle
+ */
+typedef struct can_port_mutex can_port_mutex_t;
+
+/**
+ * @brief Opaque binary semaphore handle (event flag)
+ */
+typedef struct can_port_sem can_port_sem_t;
+
+/**
+ * @brief Task entry point; the task ends when it returns
+ */
+typedef void (*can_port_task_fn_t)(void* arg);
+
+/**
+ * @brief Task placement
+ */
+typedef struct {
+    const char* name;
+    uint32_t stack_size;    // Bytes (POSIX: at least PTHREAD_STACK_MIN)
+    uint8_t priority;       // Higher runs first (FreeRTOS priority, SCHED_FIFO priority)
+    int8_t core;            // Core to pin to, or CAN_PORT_CORE_ANY
+} can_port_task_config_t;
+
+/**
+ * @brief Get monotonic time
+ * @return Microseconds since an arbitrary epoch
+ */
+uint64_t can_port_time_us(void);
+
+/**
+ * @brief Sleep the calling task
+ * @param ms Milliseconds to sleep
+ */
+void can_port_sleep_ms(uint32_t ms);
+
+/**
+ * @brief Create a mutex
+ * @return Mutex handle, or NULL on failure
+ */
+can_port_mutex_t* can_port_mutex_create(void);
+
+/**
+ * @brief Destroy a mutex
+ * @param mutex Mutex handle
+ */
+void can_port_mutex_destroy(can_port_mutex_t* mutex);
+
+/**
+ * @brief Lock a mutex
+ * @param mutex Mutex handle
+ */
+void can_port_mutex_lock(can_port_mutex_t* mutex);
+
+/**
+ * @brief Unlock a mutex
+ * @param mutex Mutex handle
+ */
+void can_port_mutex_unlock(can_port_mutex_t* mutex);
+
+/**
+ * @brief Create a binary semaphore (initially not signaled)
+ * @return Semaphore handle, or NULL on failure
+ */
+can_port_sem_t* can_port_sem_create(void);
+
+/**
+ * @brief Destroy a binary semaphore
+ * @param sem Semaphore handle
+ */
+void can_port_sem_destroy(can_port_sem_t* sem);
+
+/**
+ * @brief Signal a binary semaphore
+ * @param sem Semaphore handle
+ */
+void can_port_sem_give(can_port_sem_t* sem);
+
+/**
+ * @brief Wait for a binary semaphore
+ * @param sem Semaphore handle
+ * @param timeout_ms Timeout in ms (CAN_PORT_WAIT_FOREVER to block)
+ * @return true if signaled, false on timeout
+ */
+bool can_port_sem_take(can_port_sem_t* sem, uint32_t timeout_ms);
+
+/**
+ * @brief Signal a binary semaphore from an interrupt (e.g. DMA completion)
+ * @param sem Semaphore handle
+ */
+void can_port_sem_give_from_isr(can_port_sem_t* sem);
+
+/**
+ * @brief Start a task
+ *
+ * A core that does not exist (single-core chip, smaller host) falls back to
+ * no affinity.
+ *
+ * @param config Name, stack, priority and core
+ * @param fn Entry point
+ * @param arg Argument of fn
+ * @return true if the task was created
+ */
+bool can_port_task_create(const can_port_task_config_t* config, can_port_task_fn_t fn, void* arg);
+
+/**
+ * @brief Core the calling task runs on
+ * @return Core index (-1 if unknown)
+ */
+int can_port_task_core(void);
+
+/**
+ * @brief Check whether the calling task got its real-time priority
+ * @return true on FreeRTOS; on POSIX true if it runs SCHED_FIFO
+ */
+bool can_port_task_is_realtime(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // CAN_PORT_H
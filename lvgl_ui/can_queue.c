@@ -0,0 +1,111 @@
+/**
+ * @file can_queue.c
+ * @brief Bounded Lock-Free Queues Implementation
+ *
+ * Slot i starts with sequence number i. A producer that claimed position
+ * pos writes the element, then publishes sequence pos + 1; the consumer at
+ * pos frees the slot for the next round with pos + capacity. Positions are
+ * free-running 32-bit counters, compared by signed difference.
+ */
+
+#include "can_queue.h"
+#include <string.h>
+
+static atomic_uint_least32_t* slot_seq(const can_queue_t* queue, uint32_t pos) {
+    return (atomic_uint_least32_t*)(queue->slots + (size_t)(pos & queue->mask) * queue->slot_size);
+}
+
+static void* slot_data(const can_queue_t* queue, uint32_t pos) {
+    return queue->slots + (size_t)(pos & queue->mask) * queue->slot_size + CAN_QUEUE_ALIGN;
+}
+
+bool can_queue_init(can_queue_t* queue, const char* name, void* storage, size_t elem_size, uint32_t count) {
+    if (count == 0 || (count & (count - 1)) != 0) {
+        return false;
+    }
+
+    queue->name = name;
+    queue->slots = (uint8_t*)storage;
+    queue->slot_size = (uint32_t)CAN_QUEUE_SLOT_SIZE(elem_size);
+    queue->elem_size = (uint32_t)elem_size;
+    queue->mask = count - 1;
+    for (uint32_t i = 0; i < count; i++) {
+        atomic_init(slot_seq(queue, i), i);
+    }
+    atomic_init(&queue->head, 0);
+    atomic_init(&queue->tail, 0);
+    atomic_init(&queue->high_water, 0);
+    atomic_init(&queue->dropped, 0);
+    return true;
+}
+
+bool can_queue_push(can_queue_t* queue, const void* elem) {
+    uint32_t pos = atomic_load_explicit(&queue->head, memory_order_relaxed);
+
+    while (1) {
+        uint32_t seq = atomic_load_explicit(slot_seq(queue, pos), memory_order_acquire);
+        int32_t diff = (int32_t)(seq - pos);
+        if (diff == 0) {
+            // Slot free for this round: claim the position
+            if (atomic_compare_exchange_weak_explicit(&queue->head, &pos, pos + 1,
+                                                      memory_order_relaxed, memory_order_relaxed)) {
+                break;
+            }
+        } else if (diff < 0) {
+            // Not yet popped from the previous round
+            atomic_fetch_add_explicit(&queue->dropped, 1, memory_order_relaxed);
+            return false;
+        } else {
+            pos = atomic_load_explicit(&queue->head, memory_order_relaxed);
+        }
+    }
+
+    memcpy(slot_data(queue, pos), elem, queue->elem_size);
+    atomic_store_explicit(slot_seq(queue, pos), pos + 1, memory_order_release);
+
+    uint32_t count = pos + 1 - atomic_load_explicit(&queue->tail, memory_order_relaxed);
+    uint32_t high = atomic_load_explicit(&queue->high_water, memory_order_relaxed);
+    while (count > high && count <= queue->mask + 1 &&
+           !atomic_compare_exchange_weak_explicit(&queue->high_water, &high, count,
+                                                  memory_order_relaxed, memory_order_relaxed)) {
+    }
+    return true;
+}
+
+bool can_queue_pop(can_queue_t* queue, void* elem) {
+    uint32_t pos = atomic_load_explicit(&queue->tail, memory_order_relaxed);
+
+    while (1) {
+        uint32_t seq = atomic_load_explicit(slot_seq(queue, pos), memory_order_acquire);
+        int32_t diff = (int32_t)(seq - (pos + 1));
+        if (diff == 0) {
+            if (atomic_compare_exchange_weak_explicit(&queue->tail, &pos, pos + 1,
+                                                      memory_order_relaxed, memory_order_relaxed)) {
+                break;
+            }
+        } else if (diff < 0) {
+            return false;   // Empty, or the producer has not finished writing
+        } else {
+            pos = atomic_load_explicit(&queue->tail, memory_order_relaxed);
+        }
+    }
+
+    memcpy(elem, slot_data(queue, pos), queue->elem_size);
+    atomic_store_explicit(slot_seq(queue, pos), pos + queue->mask + 1, memory_order_release);
+    return true;
+}
+
+uint32_t can_queue_count(const can_queue_t* queue) {
+    uint32_t tail = atomic_load_explicit(&((can_queue_t*)queue)->tail, memory_order_relaxed);
+    uint32_t head = atomic_load_explicit(&((can_queue_t*)queue)->head, memory_order_relaxed);
+    uint32_t count = head - tail;
+    return (count <= queue->mask + 1) ? count : 0;
+}
+
+void can_queue_get_stats(const can_queue_t* queue, can_queue_stats_t* stats) {
+    can_queue_t* q = (can_queue_t*)queue;
+    stats->capacity = queue->mask + 1;
+    stats->count = can_queue_count(queue);
+    stats->high_water = atomic_load_explicit(&q->high_water, memory_order_relaxed);
+    stats->dropped = atomic_load_explicit(&q->dropped, memory_order_relaxed);
+}
@@ -0,0 +1,113 @@
+/**
+ * @file can_queue.h
+ * @brief Bounded Lock-Free Queues
+ *
+ * Fixed-size element queue between tasks on different cores: any number of
+ * producers and consumers, no mutex and no blocking. Each slot carries a
+ * sequence number that tells whether it is free for the producer at that
+ * position or filled for the consumer, so push and pop are one compare-and-
+ * swap on the queue position plus a copy. A full queue refuses the element
+ * and counts it; the producer never waits for the consumer. Waking the
+ * consumer (semaphore, task notification) is left to the caller.
+ *
+ * Storage is reserved at startup with CAN_QUEUE_STORAGE(); the capacity
+ * must be a power of two.
+ */
+
+#ifndef CAN_QUEUE_H
+#define CAN_QUEUE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdatomic.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define CAN_QUEUE_ALIGN         8   // Slot alignment (and element size granularity)
+
+/**
+ * @brief Bytes per slot: sequence number plus the element rounded up
+ */
+#define CAN_QUEUE_SLOT_SIZE(size) \
+    (CAN_QUEUE_ALIGN + (((size) + CAN_QUEUE_ALIGN - 1) & ~(size_t)(CAN_QUEUE_ALIGN - 1)))
+
+/**
+ * @brief Declare static storage for count elements of size bytes
+ */
+#define CAN_QUEUE_STORAGE(name, size, count) \
+    static uint8_t name[CAN_QUEUE_SLOT_SIZE(size) * (count)] __attribute__((aligned(CAN_QUEUE_ALIGN)))
+
+/**
+ * @brief Queue counters
+ */
+typedef struct {
+    uint32_t capacity;      // Elements
+    uint32_t count;         // Elements queued now
+    uint32_t high_water;    // Most elements queued at once since init
+    uint32_t dropped;       // Pushes refused: queue full
+} can_queue_stats_t;
+
+/**
+ * @brief Bounded lock-free queue
+ */
+typedef struct {
+    const char* name;
+    uint8_t* slots;
+    uint32_t slot_size;
+    uint32_t elem_size;
+    uint32_t mask;                      // Capacity - 1
+    atomic_uint_least32_t head;         // Next push position
+    atomic_uint_least32_t tail;         // Next pop position
+    atomic_uint_least32_t high_water;
+    atomic_uint_least32_t dropped;
+} can_queue_t;
+
+/**
+ * @brief Prepare a queue on its storage (no producer or consumer may run)
+ * @param queue Queue
+ * @param name Short name for reports (static string)
+ * @param storage Storage (CAN_QUEUE_ALIGN aligned, CAN_QUEUE_SLOT_SIZE(elem_size) * count bytes)
+ * @param elem_size Bytes per element
+ * @param count Capacity (power of two)
+ * @return false if count is not a power of two
+ */
+bool can_queue_init(can_queue_t* queue, const char* name, void* storage, size_t elem_size, uint32_t count);
+
+/**
+ * @brief Copy an element into the queue (any task or ISR)
+ * @param queue Queue
+ * @param elem Element (elem_size bytes)
+ * @return false if the queue is full (counted in dropped)
+ */
+bool can_queue_push(can_queue_t* queue, const void* elem);
+
+/**
+ * @brief Take the oldest element (any task)
+ * @param queue Queue
+ * @param elem Output (elem_size bytes)
+ * @return false if the queue is empty
+ */
+bool can_queue_pop(can_queue_t* queue, void* elem);
+
+/**
+ * @brief Number of queued elements (a snapshot while others push and pop)
+ * @param queue Queue
+ * @return Elements queued
+ */
+uint32_t can_queue_count(const can_queue_t* queue);
+
+/**
+ * @brief Read a queue's counters
+ * @param queue Queue
+ * @param stats Output
+ */
+void can_queue_get_stats(const can_queue_t* queue, can_queue_stats_t* stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // CAN_QUEUE_H
@@ -0,0 +1,164 @@
+/**
+ * @file can_rules.c
+ * @brief Reactive Trigger Rules Implementation
+ */
+
+#include "can_rules.h"
+#include <string.h>
+
+#define RULE_NONE           0xFF
+#define RULE_BUCKET_MASK    ((1u << CAN_RULES_HASH_BITS) - 1)
+
+static uint32_t id_full_mask(bool extended) {
+    return extended ? CAN_EXT_ID_MASK : CAN_STD_ID_MASK;
+}
+
+static uint8_t id_bucket(uint32_t id) {
+    return (uint8_t)((id * 2654435761u) >> (32 - CAN_RULES_HASH_BITS)) & RULE_BUCKET_MASK;
+}
+
+static uint64_t pack_data(const uint8_t* data) {
+    uint64_t v = 0;
+    memcpy(&v, data, CAN_MAX_DLC);
+    return v;
+}
+
+bool can_rules_compile(can_rules_t* rs, const can_rule_t* rules, uint8_t count, can_scheduler_t* sched) {
+    if (rs == NULL || sched == NULL || count > CAN_RULES_MAX || (count > 0 && rules == NULL)) {
+        return false;
+    }
+
+    memset(rs, 0, sizeof(can_rules_t));
+    memset(rs->bucket, RULE_NONE, sizeof(rs->bucket));
+    for (uint8_t s = 0; s < CAN_RULES_MAX_SLOTS; s++) {
+        rs->slot_handle[s] = -1;
+    }
+    rs->rules = rules;
+    rs->count = count;
+    rs->sched = sched;
+
+    // Insert in reverse so each bucket chain keeps declaration order
+    for (int i = count - 1; i >= 0; i--) {
+        const can_rule_t* rule = &rules[i];
+        can_rule_match_t* m = &rs->match[i];
+
+        switch (rule->action) {
+            case CAN_RULE_SEND:
+                if (rule->reply.dlc > CAN_MAX_DLC) {
+                    return false;
+                }
+                break;
+            case CAN_RULE_START_PERIODIC:
+                if (rule->periodic == NULL || rule->slot >= CAN_RULES_MAX_SLOTS) {
+                    return false;
+                }
+                break;
+            case CAN_RULE_STOP_PERIODIC:
+                if (rule->slot >= CAN_RULES_MAX_SLOTS) {
+                    return false;
+                }
+                break;
+            default:
+                return false;
+        }
+
+        uint32_t full = id_full_mask(rule->extended);
+        m->extended = rule->extended;
+        m->id_mask = rule->id_mask & full;
+        m->id = rule->id & m->id_mask;
+        m->data_mask = pack_data(rule->data_mask);
+        m->data_value = pack_data(rule->data_value) & m->data_mask;
+        m->min_dlc = rule->min_dlc;
+        for (uint8_t b = 0; b < CAN_MAX_DLC; b++) {
+            if (rule->data_mask[b] != 0 && m->min_dlc < b + 1) {
+                m->min_dlc = b + 1;
+            }
+        }
+
+        if (m->id_mask == full) {
+            uint8_t bucket = id_bucket(m->id);
+            rs->next[i] = rs->bucket[bucket];
+            rs->bucket[bucket] = (uint8_t)i;
+        } else {
+            rs->next[i] = RULE_NONE;
+        }
+    }
+
+    for (uint8_t i = 0; i < count; i++) {
+        if (rs->match[i].id_mask != id_full_mask(rs->match[i].extended)) {
+            rs->wildcard[rs->wildcard_count++] = i;
+        }
+    }
+    return true;
+}
+
+static bool rule_matches(const can_rule_match_t* m, const can_frame_t* frame, bool extended, uint64_t data) {
+    return m->extended == extended &&
+           (frame->id & m->id_mask) == m->id &&
+           frame->dlc >= m->min_dlc &&
+           (data & m->data_mask) == m->data_value;
+}
+
+static void fire(can_rules_t* rs, uint8_t index, const can_frame_t* frame) {
+    const can_rule_t* rule = &rs->rules[index];
+    rs->hits[index]++;
+
+    switch (rule->action) {
+        case CAN_RULE_SEND: {
+            can_frame_t reply = rule->reply;
+            for (uint8_t b = 0; b < CAN_MAX_DLC; b++) {
+                if (rule->copy_mask & (1u << b)) {
+                    reply.data[b] = frame->data[b];
+                }
+            }
+            can_scheduler_send(rs->sched, CAN_TXQ_USER, &reply);
+            break;
+        }
+        case CAN_RULE_START_PERIODIC:
+            if (rs->slot_handle[rule->slot] < 0) {
+                rs->slot_handle[rule->slot] = can_scheduler_add_periodic(rs->sched, rule->periodic);
+            }
+            break;
+        case CAN_RULE_STOP_PERIODIC:
+            can_scheduler_remove_periodic(rs->sched, rs->slot_handle[rule->slot]);
+            rs->slot_handle[rule->slot] = -1;
+            break;
+    }
+}
+
+uint8_t can_rules_process(can_rules_t* rs, const can_frame_t* frame) {
+    if (rs->count == 0 || (frame->flags & CAN_FRAME_FLAG_RTR)) {
+        return 0;
+    }
+
+    bool extended = (frame->flags & CAN_FRAME_FLAG_EXT) != 0;
+    uint64_t data = 0;
+    memcpy(&data, frame->data, frame->dlc);
+    uint8_t fired = 0;
+
+    // Exact-ID rules: one bucket
+    for (uint8_t i = rs->bucket[id_bucket(frame->id & id_full_mask(extended))]; i != RULE_NONE; i = rs->next[i]) {
+        if (rule_matches(&rs->match[i], frame, extended, data)) {
+            fire(rs, i, frame);
+            fired++;
+        }
+    }
+
+    // Masked-ID rules
+    for (uint8_t w = 0; w < rs->wildcard_count; w++) {
+        uint8_t i = rs->wildcard[w];
+        if (rule_matches(&rs->match[i], frame, extended, data)) {
+            fire(rs, i, frame);
+            fired++;
+        }
+    }
+    return fired;
+}
+
+void can_rules_reset(can_rules_t* rs) {
+    for (uint8_t s = 0; s < CAN_RULES_MAX_SLOTS; s++) {
+        can_scheduler_remove_periodic(rs->sched, rs->slot_handle[s]);
+        rs->slot_handle[s] = -1;
+    }
+    memset(rs->hits, 0, sizeof(rs->hits));
+}
@@ -0,0 +1,127 @@
+/**
+ * @file can_rules.h
+ * @brief Reactive Trigger Rules (RX -> TX)
+ *
+ * A rule matches received frames by ID/mask and per-byte mask/value and then
+ * queues a reply frame or starts/stops a periodic entry. Rules are compiled
+ * once into a hashed ID index, so can_rules_process() costs one bucket walk
+ * plus a short list of masked-ID rules per frame. It runs in the RX task;
+ * replies go to the TX queue at user priority, where the higher-priority TX
+ * task picks them up at once.
+ *
+ * Example (answer a tester-present request, echoing byte 2):
+ *   static const can_rule_t RULES[] = {
+ *       {
+ *           .id = 0x7DF, .id_mask = CAN_RULE_ID_EXACT,
+ *           .data_mask  = {0xFF, 0xFF},
+ *           .data_value = {0x02, 0x3E},
+ *           .action = CAN_RULE_SEND,
+ *           .reply = {.id = 0x7E8, .dlc = 3, .data = {0x02, 0x7E}},
+ *           .copy_mask = 1u << 2
+ *       },
+ *   };
+ */
+
+#ifndef CAN_RULES_H
+#define CAN_RULES_H
+
+#include "can_scheduler.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define CAN_RULES_MAX           32  // Rules per rule set
+#define CAN_RULES_HASH_BITS     5   // Exact-ID index buckets (power of two)
+#define CAN_RULES_MAX_SLOTS     8   // Periodic entries controlled by rules
+
+#define CAN_RULE_ID_EXACT       0xFFFFFFFFu     // id_mask for a single ID
+
+/**
+ * @brief Rule actions
+ */
+typedef enum {
+    CAN_RULE_SEND = 0,          // Queue reply (CAN_TXQ_USER)
+    CAN_RULE_START_PERIODIC,    // Start *periodic in slot (no-op if running)
+    CAN_RULE_STOP_PERIODIC      // Stop the entry in slot
+} can_rule_action_t;
+
+/**
+ * @brief Rule definition
+ */
+typedef struct {
+    // Match
+    uint32_t id;
+    uint32_t id_mask;               // CAN_RULE_ID_EXACT, or bits that must match
+    bool extended;                  // Match extended frames (standard otherwise)
+    uint8_t min_dlc;                // Raised to cover data_mask automatically
+    uint8_t data_mask[CAN_MAX_DLC];
+    uint8_t data_value[CAN_MAX_DLC];
+
+    // Action
+    can_rule_action_t action;
+    can_frame_t reply;              // CAN_RULE_SEND
+    uint8_t copy_mask;              // CAN_RULE_SEND: bit i copies request byte i
+    const can_periodic_def_t* periodic;     // CAN_RULE_START_PERIODIC
+    uint8_t slot;                   // CAN_RULE_START/STOP_PERIODIC
+} can_rule_t;
+
+/**
+ * @brief Compiled match entry
+ */
+typedef struct {
+    uint32_t id;
+    uint32_t id_mask;
+    uint64_t data_mask;             // Data bytes packed like the frame
+    uint64_t data_value;
+    uint8_t min_dlc;
+    bool extended;
+} can_rule_match_t;
+
+/**
+ * @brief Compiled rule set (owned by the RX task once compiled)
+ */
+typedef struct {
+    const can_rule_t* rules;
+    uint8_t count;
+    can_scheduler_t* sched;
+
+    can_rule_match_t match[CAN_RULES_MAX];
+    uint8_t bucket[1u << CAN_RULES_HASH_BITS];  // First exact-ID rule per bucket
+    uint8_t next[CAN_RULES_MAX];                // Chain within a bucket
+    uint8_t wildcard[CAN_RULES_MAX];            // Masked-ID rules, in order
+    uint8_t wildcard_count;
+
+    int slot_handle[CAN_RULES_MAX_SLOTS];       // Periodic handle per slot (-1 = stopped)
+    uint32_t hits[CAN_RULES_MAX];
+} can_rules_t;
+
+/**
+ * @brief Compile a rule set (before the RX task uses it)
+ * @param rs Rule set
+ * @param rules Definitions (static lifetime)
+ * @param count Number of rules
+ * @param sched Scheduler that sends replies and owns periodic entries
+ * @return false if a rule is invalid or there are too many
+ */
+bool can_rules_compile(can_rules_t* rs, const can_rule_t* rules, uint8_t count, can_scheduler_t* sched);
+
+/**
+ * @brief Run every matching rule for a received frame (RX task)
+ * @param rs Rule set
+ * @param frame Received frame
+ * @return Number of rules fired
+ */
+uint8_t can_rules_process(can_rules_t* rs, const can_frame_t* frame);
+
+/**
+ * @brief Stop periodic entries started by rules and clear hit counters
+ * @param rs Rule set
+ */
+void can_rules_reset(can_rules_t* rs);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // CAN_RULES_H
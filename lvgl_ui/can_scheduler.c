@@ -0,0 +1,669 @@
+/**
+ * @file can_scheduler.c
+ * @brief TX Scheduler Implementation
+ */
+
+#include "can_scheduler.h"
+#include <string.h>
+
+static void emit(can_scheduler_t* sched, can_sched_event_type_t type) {
+    if (sched->event_cb == NULL) {
+        return;
+    }
+    can_sched_event_t event = {
+        .type = type,
+        .name = sched->seq.name,
+        .error = sched->seq.last_error,
+        .handle = -1
+    };
+    can_seq_get_progress(&sched->seq, &event.step, &event.step_count);
+    sched->event_cb(&event, sched->event_user_data);
+}
+
+// Report progress and the terminal state of the sequence exactly once
+static void report_sequence(can_scheduler_t* sched) {
+    if (!sched->seq_active) {
+        return;
+    }
+
+    uint16_t step = 0;
+    uint16_t step_count = 0;
+    can_seq_get_progress(&sched->seq, &step, &step_count);
+    uint32_t progress = ((uint32_t)step << 16) | step_count;
+    if (progress != sched->seq_progress) {
+        sched->seq_progress = progress;
+        emit(sched, CAN_SCHED_EVENT_SEQ_PROGRESS);
+    }
+
+    switch (can_seq_get_status(&sched->seq)) {
+        case CAN_SEQ_DONE:
+            sched->seq_active = false;
+            emit(sched, CAN_SCHED_EVENT_SEQ_DONE);
+            break;
+        case CAN_SEQ_CANCELLED:
+            sched->seq_active = false;
+            emit(sched, CAN_SCHED_EVENT_SEQ_CANCELLED);
+            break;
+        case CAN_SEQ_FAILED:
+            sched->seq_active = false;
+            emit(sched, CAN_SCHED_EVENT_SEQ_FAILED);
+            break;
+        default:
+            break;
+    }
+}
+
+bool can_scheduler_init(can_scheduler_t* sched, can_transport_t* bus) {
+    memset(sched, 0, sizeof(can_scheduler_t));
+    sched->bus = bus;
+    sched->lock = can_port_mutex_create();
+    sched->wake = can_port_sem_create();
+    can_seq_runner_init(&sched->seq);
+    sched->running = true;
+
+    bool txq_ok = can_txq_init(&sched->txq);
+    if (sched->lock == NULL || sched->wake == NULL || !txq_ok) {
+        can_scheduler_deinit(sched);
+        return false;
+    }
+    can_txq_set_limit(&sched->txq, CAN_TXQ_PERIODIC, CAN_SCHED_PERIODIC_RATE_FPS, CAN_SCHED_PERIODIC_BURST);
+    can_txq_set_limit(&sched->txq, CAN_TXQ_BULK, CAN_SCHED_BULK_RATE_FPS, CAN_SCHED_BULK_BURST);
+    return true;
+}
+
+void can_scheduler_deinit(can_scheduler_t* sched) {
+    if (sched->lock != NULL) {
+        can_port_mutex_destroy(sched->lock);
+        sched->lock = NULL;
+    }
+    if (sched->wake != NULL) {
+        can_port_sem_destroy(sched->wake);
+        sched->wake = NULL;
+    }
+    can_txq_deinit(&sched->txq);
+}
+
+void can_scheduler_set_event_cb(can_scheduler_t* sched, can_sched_event_cb_t cb, void* user_data) {
+    sched->event_cb = cb;
+    sched->event_user_data = user_data;
+}
+
+bool can_scheduler_start_sequence(can_scheduler_t* sched, const char* name,
+                                  const uint8_t* code, size_t len) {
+    if (!can_seq_validate(code, len, NULL)) {
+        return false;
+    }
+
+    can_port_mutex_lock(sched->lock);
+    sched->seq_request = true;
+    sched->seq_request_name = name;
+    sched->seq_request_code = code;
+    sched->seq_request_len = len;
+    can_port_mutex_unlock(sched->lock);
+
+    can_scheduler_wake(sched);
+    return true;
+}
+
+void can_scheduler_stop_sequence(can_scheduler_t* sched) {
+    // Under the lock, so it is ordered against run_once taking a request
+    can_port_mutex_lock(sched->lock);
+    sched->seq_request = false;
+    can_seq_cancel(&sched->seq);
+    can_port_mutex_unlock(sched->lock);
+
+    can_scheduler_wake(sched);
+}
+
+can_err_t can_scheduler_send(can_scheduler_t* sched, can_txq_class_t cls, const can_frame_t* frame) {
+    can_err_t err = can_txq_push(&sched->txq, cls, frame);
+    if (err == CAN_OK) {
+        can_scheduler_wake(sched);
+    }
+    return err;
+}
+
+// ==================== Phase Planner ====================
+// Two entries with periods Pa and Pb and phases a and b release together at
+// some point of the hyperperiod iff (a - b) mod gcd(Pa, Pb) == 0, so the
+// distance of the phases modulo the gcd is all the planner needs.
+
+static uint32_t gcd_u32(uint32_t a, uint32_t b) {
+    while (b != 0) {
+        uint32_t t = a % b;
+        a = b;
+        b = t;
+    }
+    return a;
+}
+
+// Phase of ref_ms relative to base_ms (ms clock, wraps), modulo g
+static uint32_t phase_mod(uint32_t ref_ms, uint32_t base_ms, uint32_t g) {
+    int32_t d = (int32_t)(ref_ms - base_ms);
+    if (d >= 0) {
+        return (uint32_t)d % g;
+    }
+    return (g - (uint32_t)(-(int64_t)d) % g) % g;
+}
+
+static uint32_t circular_distance(uint32_t s, uint32_t g) {
+    return (s < g - s) ? s : g - s;
+}
+
+// Live definition as seen by an editor (lock held; only editors write buffers)
+static const can_periodic_def_t* live_def(const can_periodic_t* entry) {
+    return &entry->buf[atomic_load_explicit(&entry->gen, memory_order_relaxed) & 1u];
+}
+
+static bool entry_running(const can_periodic_t* entry) {
+    return atomic_load_explicit(&entry->run, memory_order_relaxed) != 0;
+}
+
+// Pick the offset in [0, period) with the fewest collisions, then the widest gap
+static uint32_t plan_phase(can_scheduler_t* sched, uint32_t period_ms, uint32_t base_ms) {
+    uint32_t g[CAN_SCHED_MAX_PERIODIC];
+    uint32_t r[CAN_SCHED_MAX_PERIODIC];
+    uint8_t n = 0;
+
+    for (int i = 0; i < CAN_SCHED_MAX_PERIODIC; i++) {
+        const can_periodic_t* entry = &sched->periodic[i];
+        if (entry_running(entry)) {
+            g[n] = gcd_u32(period_ms, live_def(entry)->period_ms);
+            r[n] = phase_mod(atomic_load_explicit(&entry->phase_ms, memory_order_relaxed), base_ms, g[n]);
+            n++;
+        }
+    }
+    if (n == 0) {
+        return 0;
+    }
+
+    uint32_t best_offset = 0;
+    uint32_t best_hits = UINT32_MAX;
+    uint32_t best_gap = 0;
+    for (uint32_t offset = 0; offset < period_ms; offset += CAN_SCHED_PHASE_SLOT_MS) {
+        uint32_t hits = 0;
+        uint32_t gap = UINT32_MAX;
+        for (uint8_t j = 0; j < n; j++) {
+            uint32_t d = circular_distance((offset % g[j] + g[j] - r[j]) % g[j], g[j]);
+            if (d < CAN_SCHED_PHASE_SLOT_MS) {
+                hits++;
+            }
+            if (d < gap) {
+                gap = d;
+            }
+        }
+        if (hits < best_hits || (hits == best_hits && gap > best_gap)) {
+            best_offset = offset;
+            best_hits = hits;
+            best_gap = gap;
+        }
+    }
+    return best_offset;
+}
+
+// Recompute the worst-case frames per slot (lock held)
+static void update_peak_load(can_scheduler_t* sched) {
+    uint8_t peak = 0;
+
+    for (int i = 0; i < CAN_SCHED_MAX_PERIODIC; i++) {
+        const can_periodic_t* a = &sched->periodic[i];
+        if (!entry_running(a)) {
+            continue;
+        }
+        uint32_t a_ms = atomic_load_explicit(&a->phase_ms, memory_order_relaxed);
+        uint8_t load = 1;
+        for (int j = 0; j < CAN_SCHED_MAX_PERIODIC; j++) {
+            const can_periodic_t* b = &sched->periodic[j];
+            if (j == i || !entry_running(b)) {
+                continue;
+            }
+            uint32_t b_ms = atomic_load_explicit(&b->phase_ms, memory_order_relaxed);
+            uint32_t g = gcd_u32(live_def(a)->period_ms, live_def(b)->period_ms);
+            if (circular_distance(phase_mod(a_ms, b_ms, g), g) < CAN_SCHED_PHASE_SLOT_MS) {
+                load++;
+            }
+        }
+        if (load > peak) {
+            peak = load;
+        }
+    }
+    sched->periodic_peak = peak;
+}
+
+// ==================== Periodic Entries ====================
+
+static bool periodic_def_valid(const can_periodic_def_t* def) {
+    return def != NULL && def->period_ms != 0 && def->frame.dlc <= CAN_MAX_DLC &&
+           def->xform_count <= CAN_SCHED_MAX_XFORMS &&
+           can_xform_validate(def->xforms, def->xform_count, def->frame.dlc);
+}
+
+// Write the spare buffer and make it live (lock held)
+static void publish_def(can_periodic_t* entry, const can_periodic_def_t* def) {
+    uint32_t gen = atomic_load_explicit(&entry->gen, memory_order_relaxed);
+    entry->buf[(gen + 1u) & 1u] = *def;
+    atomic_store_explicit(&entry->gen, gen + 1u, memory_order_release);
+}
+
+// Copy the live definition (TX task); retries if an edit raced the copy
+static void read_def(can_periodic_t* entry, can_periodic_def_t* out) {
+    uint32_t gen_begin;
+    uint32_t gen_end;
+
+    do {
+        gen_begin = atomic_load_explicit(&entry->gen, memory_order_acquire);
+        *out = entry->buf[gen_begin & 1u];
+        atomic_thread_fence(memory_order_acquire);
+        gen_end = atomic_load_explicit(&entry->gen, memory_order_relaxed);
+    } while (gen_begin != gen_end);
+}
+
+int can_scheduler_add_periodic(can_scheduler_t* sched, const can_periodic_def_t* def) {
+    if (!periodic_def_valid(def)) {
+        return -1;
+    }
+
+    int handle = -1;
+    can_port_mutex_lock(sched->lock);
+    for (int i = 0; i < CAN_SCHED_MAX_PERIODIC; i++) {
+        can_periodic_t* entry = &sched->periodic[i];
+        if (!entry_running(entry)) {
+            uint32_t now_ms = (uint32_t)(can_port_time_us() / 1000u);
+            publish_def(entry, def);
+            atomic_store_explicit(&entry->phase_ms, now_ms + plan_phase(sched, def->period_ms, now_ms),
+                                  memory_order_relaxed);
+
+            // Activation id tells the TX task to restart the entry's timing
+            if (++sched->periodic_runs == 0) {
+                sched->periodic_runs = 1;
+            }
+            atomic_store_explicit(&entry->run, sched->periodic_runs, memory_order_release);
+            update_peak_load(sched);
+            handle = i;
+            break;
+        }
+    }
+    can_port_mutex_unlock(sched->lock);
+
+    if (handle >= 0) {
+        can_scheduler_wake(sched);
+    }
+    return handle;
+}
+
+bool can_scheduler_update_periodic(can_scheduler_t* sched, int handle, const can_periodic_def_t* def) {
+    if (handle < 0 || handle >= CAN_SCHED_MAX_PERIODIC || !periodic_def_valid(def)) {
+        return false;
+    }
+
+    bool ok = false;
+    can_port_mutex_lock(sched->lock);
+    can_periodic_t* entry = &sched->periodic[handle];
+    if (entry_running(entry)) {
+        bool period_changed = (live_def(entry)->period_ms != def->period_ms);
+        publish_def(entry, def);
+        if (period_changed) {
+            update_peak_load(sched);
+        }
+        ok = true;
+    }
+    can_port_mutex_unlock(sched->lock);
+    return ok;
+}
+
+void can_scheduler_remove_periodic(can_scheduler_t* sched, int handle) {
+    if (handle < 0 || handle >= CAN_SCHED_MAX_PERIODIC) {
+        return;
+    }
+    can_port_mutex_lock(sched->lock);
+    atomic_store_explicit(&sched->periodic[handle].run, 0, memory_order_relaxed);
+    update_peak_load(sched);
+    can_port_mutex_unlock(sched->lock);
+}
+
+void can_scheduler_clear_periodic(can_scheduler_t* sched) {
+    can_port_mutex_lock(sched->lock);
+    for (int i = 0; i < CAN_SCHED_MAX_PERIODIC; i++) {
+        atomic_store_explicit(&sched->periodic[i].run, 0, memory_order_relaxed);
+    }
+    sched->periodic_peak = 0;
+    can_port_mutex_unlock(sched->lock);
+    can_txq_clear(&sched->txq, CAN_TXQ_PERIODIC);
+}
+
+uint8_t can_scheduler_get_peak_load(can_scheduler_t* sched) {
+    can_port_mutex_lock(sched->lock);
+    uint8_t peak = sched->periodic_peak;
+    can_port_mutex_unlock(sched->lock);
+    return peak;
+}
+
+// Queue every due periodic entry; returns ms until the next one is due
+static uint32_t run_periodic(can_scheduler_t* sched, uint64_t now_us) {
+    uint64_t next_us = UINT64_MAX;
+
+    for (int i = 0; i < CAN_SCHED_MAX_PERIODIC; i++) {
+        can_periodic_t* entry = &sched->periodic[i];
+        uint32_t run = atomic_load_explicit(&entry->run, memory_order_acquire);
+        if (run == 0) {
+            continue;
+        }
+        if (run != entry->run_seen) {
+            // New activation: first frame at the planned phase
+            int32_t delay_ms = (int32_t)(atomic_load_explicit(&entry->phase_ms, memory_order_relaxed) -
+                                         (uint32_t)(now_us / 1000u));
+            entry->run_seen = run;
+            entry->next_us = now_us + ((delay_ms > 0) ? (uint64_t)delay_ms * 1000u : 0);
+            entry->counter = 0;
+        }
+
+        if (now_us >= entry->next_us) {
+            can_periodic_def_t def;
+            read_def(entry, &def);
+
+            can_frame_t frame = def.frame;
+            can_xform_apply(def.xforms, def.xform_count, entry->counter, &frame);
+            entry->counter++;
+
+            uint64_t period_us = (uint64_t)def.period_ms * 1000u;
+            entry->next_us += period_us;
+            if (entry->next_us <= now_us) {
+                // Fell behind: skip the missed sends (no burst) but keep the phase
+                entry->next_us += ((now_us - entry->next_us) / period_us + 1) * period_us;
+            }
+            atomic_store_explicit(&entry->phase_ms, (uint32_t)(entry->next_us / 1000u), memory_order_relaxed);
+
+            can_err_t err = can_txq_push(&sched->txq, CAN_TXQ_PERIODIC, &frame);
+            if (sched->event_cb != NULL) {
+                can_sched_event_t event = {
+                    .type = CAN_SCHED_EVENT_PERIODIC_TX,
+                    .name = "",
+                    .error = err,
+                    .handle = i,
+                    .frame = &frame
+                };
+                sched->event_cb(&event, sched->event_user_data);
+            }
+        }
+        if (entry->next_us < next_us) {
+            next_us = entry->next_us;
+        }
+    }
+
+    if (next_us == UINT64_MAX) {
+        return CAN_PORT_WAIT_FOREVER;
+    }
+    uint64_t now = can_port_time_us();
+    return (next_us > now) ? (uint32_t)((next_us - now + 999) / 1000) : 0;
+}
+
+// ==================== Sweep ====================
+
+bool can_scheduler_start_sweep(can_scheduler_t* sched, const can_sweep_config_t* config) {
+    can_sweep_t probe;
+    if (!can_sweep_init(&probe, config)) {
+        return false;
+    }
+
+    can_port_mutex_lock(sched->lock);
+    sched->sweep_request = true;
+    sched->sweep_stop_request = false;
+    sched->sweep_request_config = *config;
+    can_port_mutex_unlock(sched->lock);
+
+    can_scheduler_wake(sched);
+    return true;
+}
+
+void can_scheduler_stop_sweep(can_scheduler_t* sched) {
+    can_port_mutex_lock(sched->lock);
+    sched->sweep_request = false;
+    sched->sweep_stop_request = true;
+    can_port_mutex_unlock(sched->lock);
+
+    can_scheduler_wake(sched);
+}
+
+static void emit_sweep(can_scheduler_t* sched, can_sched_event_type_t type) {
+    if (sched->event_cb == NULL) {
+        return;
+    }
+    can_sched_event_t event = {
+        .type = type,
+        .name = "",
+        .handle = -1,
+        .sweep = &sched->sweep_progress
+    };
+    sched->event_cb(&event, sched->event_user_data);
+}
+
+// Fold the bulk class counters and the controller's error count into the
+// sweep progress. Rejected frames count as sent so the sweep still ends.
+static void sweep_account(can_scheduler_t* sched) {
+    can_txq_stats_t stats;
+    can_txq_get_stats(&sched->txq, CAN_TXQ_BULK, &stats);
+    uint32_t rejected = stats.errors - sched->sweep_errors_seen;
+    sched->sweep_progress.sent += (uint32_t)(stats.sent - sched->sweep_sent_seen) + rejected;
+    sched->sweep_progress.errors = can_transport_get_bus_errors(sched->bus) - sched->sweep_bus_errors;
+    sched->sweep_sent_seen = stats.sent;
+    sched->sweep_errors_seen = stats.errors;
+    if (sched->sweep_progress.sent > 0) {
+        sched->sweep_progress.current_id = can_sweep_id_at(&sched->sweep, sched->sweep_progress.sent - 1);
+    }
+}
+
+static void sweep_end(can_scheduler_t* sched) {
+    sweep_account(sched);
+    can_txq_clear(&sched->txq, CAN_TXQ_BULK);
+    can_txq_set_limit(&sched->txq, CAN_TXQ_BULK, CAN_SCHED_BULK_RATE_FPS, CAN_SCHED_BULK_BURST);
+    sched->sweep_active = false;
+    emit_sweep(sched, CAN_SCHED_EVENT_SWEEP_DONE);
+}
+
+static void sweep_begin(can_scheduler_t* sched, const can_sweep_config_t* config, uint64_t now_us) {
+    if (sched->sweep_active) {
+        sweep_end(sched);
+    }
+    if (!can_sweep_init(&sched->sweep, config)) {
+        return;
+    }
+
+    can_txq_stats_t stats;
+    can_txq_get_stats(&sched->txq, CAN_TXQ_BULK, &stats);
+    sched->sweep_sent_seen = stats.sent;
+    sched->sweep_errors_seen = stats.errors;
+    sched->sweep_bus_errors = can_transport_get_bus_errors(sched->bus);
+    memset(&sched->sweep_progress, 0, sizeof(can_sweep_progress_t));
+    sched->sweep_progress.total = sched->sweep.total;
+    sched->sweep_progress.current_id = config->id_first;
+    sched->sweep_report_us = now_us;
+    sched->sweep_report_sent = 0;
+
+    // The sweep owns the bulk class until it ends (0 = no limit)
+    can_txq_set_limit(&sched->txq, CAN_TXQ_BULK, config->rate_fps, CAN_SCHED_BULK_BURST);
+    sched->sweep_active = true;
+    emit_sweep(sched, CAN_SCHED_EVENT_SWEEP_PROGRESS);
+}
+
+// Top the bulk class up from the generator
+static void sweep_fill(can_scheduler_t* sched) {
+    if (!sched->sweep_active) {
+        return;
+    }
+    uint32_t room = CAN_TXQ_DEPTH - can_txq_depth(&sched->txq, CAN_TXQ_BULK);
+    can_frame_t frame;
+    while (room > 0 && can_sweep_next(&sched->sweep, &frame)) {
+        if (can_txq_push(&sched->txq, CAN_TXQ_BULK, &frame) != CAN_OK) {
+            sched->sweep.next--;    // Regenerated on the next fill
+            break;
+        }
+        room--;
+    }
+}
+
+// Report progress and detect the end; returns ms until the sweep needs the TX task
+static uint32_t run_sweep(can_scheduler_t* sched, uint64_t now_us) {
+    if (!sched->sweep_active) {
+        return CAN_PORT_WAIT_FOREVER;
+    }
+
+    sweep_account(sched);
+    bool exhausted = sched->sweep.next >= sched->sweep.total;
+    uint32_t depth = can_txq_depth(&sched->txq, CAN_TXQ_BULK);
+
+    uint64_t elapsed_us = now_us - sched->sweep_report_us;
+    if (elapsed_us >= (uint64_t)CAN_SCHED_SWEEP_REPORT_MS * 1000u || (exhausted && depth == 0)) {
+        if (elapsed_us > 0) {
+            uint64_t frames = sched->sweep_progress.sent - sched->sweep_report_sent;
+            sched->sweep_progress.rate_fps = (uint32_t)((frames * 1000000u) / elapsed_us);
+        }
+        sched->sweep_report_us = now_us;
+        sched->sweep_report_sent = sched->sweep_progress.sent;
+        if (exhausted && depth == 0) {
+            sweep_end(sched);
+            return CAN_PORT_WAIT_FOREVER;
+        }
+        emit_sweep(sched, CAN_SCHED_EVENT_SWEEP_PROGRESS);
+    }
+
+    if (!exhausted && depth == 0) {
+        return 0;   // Drained everything: refill right away
+    }
+    return CAN_SCHED_SWEEP_REPORT_MS;
+}
+
+// Report TX queue congestion on/off (hysteresis on the lower classes' depth)
+static void update_backpressure(can_scheduler_t* sched) {
+    uint32_t depth = 0;
+    uint32_t dropped = 0;
+    for (int cls = 0; cls < CAN_TXQ_CLASS_COUNT; cls++) {
+        can_txq_stats_t stats;
+        can_txq_get_stats(&sched->txq, (can_txq_class_t)cls, &stats);
+        dropped += stats.dropped;
+        if (cls == CAN_TXQ_BULK && sched->sweep_active) {
+            continue;   // A sweep keeps the bulk class full on purpose
+        }
+        uint32_t d = can_txq_depth(&sched->txq, (can_txq_class_t)cls);
+        if (d > depth) {
+            depth = d;
+        }
+    }
+
+    bool congested = sched->tx_congested;
+    if (dropped != sched->tx_dropped_seen || depth >= (CAN_TXQ_DEPTH * 3) / 4) {
+        congested = true;
+    } else if (depth <= CAN_TXQ_DEPTH / 4) {
+        congested = false;
+    }
+    sched->tx_dropped_seen = dropped;
+
+    if (congested != sched->tx_congested) {
+        sched->tx_congested = congested;
+        if (sched->event_cb != NULL) {
+            can_sched_event_t event = {
+                .type = CAN_SCHED_EVENT_TX_BACKPRESSURE,
+                .name = "",
+                .handle = -1,
+                .congested = congested
+            };
+            sched->event_cb(&event, sched->event_user_data);
+        }
+    }
+}
+
+void can_scheduler_on_rx(can_scheduler_t* sched, const can_frame_t* frame) {
+    if (can_seq_on_rx(&sched->seq, frame)) {
+        can_scheduler_wake(sched);
+    }
+}
+
+void can_scheduler_wake(can_scheduler_t* sched) {
+    can_port_sem_give(sched->wake);
+}
+
+uint32_t can_scheduler_run_once(can_scheduler_t* sched) {
+    // Take a pending sequence request
+    bool start = false;
+    const char* name = NULL;
+    const uint8_t* code = NULL;
+    size_t len = 0;
+    bool sweep_start = false;
+    bool sweep_stop = false;
+    can_sweep_config_t sweep_config;
+
+    can_port_mutex_lock(sched->lock);
+    if (sched->seq_request) {
+        start = true;
+        name = sched->seq_request_name;
+        code = sched->seq_request_code;
+        len = sched->seq_request_len;
+        sched->seq_request = false;
+        can_seq_clear_cancel(&sched->seq);     // Only a STOP from after this point counts
+    }
+    if (sched->sweep_request) {
+        sweep_start = true;
+        sweep_config = sched->sweep_request_config;
+        sched->sweep_request = false;
+    }
+    sweep_stop = sched->sweep_stop_request;
+    sched->sweep_stop_request = false;
+    can_port_mutex_unlock(sched->lock);
+
+    if (start) {
+        if (sched->seq_active && can_seq_get_status(&sched->seq) == CAN_SEQ_RUNNING) {
+            sched->seq_active = false;
+            emit(sched, CAN_SCHED_EVENT_SEQ_CANCELLED);
+        }
+        if (can_seq_start(&sched->seq, name, code, len)) {
+            sched->seq_active = true;
+            sched->seq_progress = 0xFFFFFFFFu;      // Force an initial progress event
+        }
+    }
+
+    // User frames queued meanwhile go out before anything else
+    uint64_t now_us = can_port_time_us();
+    if (sweep_stop && sched->sweep_active) {
+        sweep_end(sched);
+    }
+    if (sweep_start) {
+        sweep_begin(sched, &sweep_config, now_us);
+    }
+    sweep_fill(sched);
+    can_txq_drain(&sched->txq, sched->bus, now_us);
+
+    uint32_t wait_ms = can_seq_run(&sched->seq, sched->bus, now_us);
+    report_sequence(sched);
+
+    uint32_t periodic_ms = run_periodic(sched, now_us);
+    if (periodic_ms < wait_ms) {
+        wait_ms = periodic_ms;
+    }
+
+    sweep_fill(sched);
+    uint32_t txq_ms = can_txq_drain(&sched->txq, sched->bus, can_port_time_us());
+    if (txq_ms < wait_ms) {
+        wait_ms = txq_ms;
+    }
+    can_transport_flush(sched->bus);   // Batching backends write the pass out at once
+
+    uint32_t sweep_ms = run_sweep(sched, can_port_time_us());
+    if (sweep_ms < wait_ms) {
+        wait_ms = sweep_ms;
+    }
+    update_backpressure(sched);
+    return wait_ms;
+}
+
+void can_scheduler_run(can_scheduler_t* sched) {
+    while (sched->running) {
+        uint32_t wait_ms = can_scheduler_run_once(sched);
+        if (wait_ms > 0 && sched->running) {
+            can_port_sem_take(sched->wake, wait_ms);
+        }
+    }
+}
+
+void can_scheduler_shutdown(can_scheduler_t* sched) {
+    sched->running = false;
+    can_scheduler_wake(sched);
+}
@@ -0,0 +1,305 @@
+/**
+ * @file can_scheduler.h
+ * @brief TX Scheduler (TX Task Loop)
+ *
+ * Owns everything that transmits on a timeline. Other tasks post requests
+ * (start/stop a scene sequence, add/remove periodic entries, queue one-shot
+ * frames) and the TX task executes them in can_scheduler_run_once(), which
+ * returns how long it may sleep until the next deadline. Requests and
+ * matching RX frames wake it early.
+ *
+ * All frames except sequence steps (sent inline by the TX task) go through
+ * a priority TX queue (can_txq): user frames first, then periodic, then bulk.
+ * A running ID/payload sweep keeps the bulk class topped up from its
+ * generator, so it fills whatever bus time the other classes leave.
+ */
+
+#ifndef CAN_SCHEDULER_H
+#define CAN_SCHEDULER_H
+
+#include "can_transport.h"
+#include "can_sequence.h"
+#include "can_xform.h"
+#include "can_sweep.h"
+#include "can_txq.h"
+#include "can_port.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define CAN_SCHED_MAX_PERIODIC      32  // Periodic entries per scheduler
+#define CAN_SCHED_MAX_XFORMS        4   // Payload transforms per entry
+#define CAN_SCHED_PHASE_SLOT_MS     2   // Releases closer than this count as simultaneous
+#define CAN_SCHED_SWEEP_REPORT_MS   250 // Sweep progress event interval
+
+// Default class limits (frames/s, burst); user frames are never limited
+#define CAN_SCHED_PERIODIC_RATE_FPS 2000
+#define CAN_SCHED_PERIODIC_BURST    32
+#define CAN_SCHED_BULK_RATE_FPS     1000
+#define CAN_SCHED_BULK_BURST        8
+
+/**
+ * @brief Scheduler event types (delivered on the TX task)
+ */
+typedef enum {
+    CAN_SCHED_EVENT_SEQ_PROGRESS = 0,   // Step advanced
+    CAN_SCHED_EVENT_SEQ_DONE,           // Reached END
+    CAN_SCHED_EVENT_SEQ_CANCELLED,      // Stopped or replaced
+    CAN_SCHED_EVENT_SEQ_FAILED,         // Send error or WAIT_RX timeout
+    CAN_SCHED_EVENT_PERIODIC_TX,        // Periodic frame queued (or refused, see error)
+    CAN_SCHED_EVENT_TX_BACKPRESSURE,    // TX queue congestion started or ended
+    CAN_SCHED_EVENT_SWEEP_PROGRESS,     // Sweep running (every CAN_SCHED_SWEEP_REPORT_MS)
+    CAN_SCHED_EVENT_SWEEP_DONE          // Sweep finished or stopped (sent < total)
+} can_sched_event_type_t;
+
+/**
+ * @brief Scheduler event
+ */
+typedef struct {
+    can_sched_event_type_t type;
+    const char* name;           // Sequence name
+    uint16_t step;              // Current step (0-based)
+    uint16_t step_count;        // Steps in the sequence
+    can_err_t error;            // For CAN_SCHED_EVENT_SEQ_FAILED / PERIODIC_TX
+    int handle;                 // For CAN_SCHED_EVENT_PERIODIC_TX
+    const can_frame_t* frame;   // For CAN_SCHED_EVENT_PERIODIC_TX (as sent)
+    bool congested;             // For CAN_SCHED_EVENT_TX_BACKPRESSURE
+    const can_sweep_progress_t* sweep;  // For CAN_SCHED_EVENT_SWEEP_*
+} can_sched_event_t;
+
+typedef void (*can_sched_event_cb_t)(const can_sched_event_t* event, void* user_data);
+
+/**
+ * @brief Periodic entry definition
+ */
+typedef struct {
+    can_frame_t frame;          // Template payload
+    uint32_t period_ms;
+    uint8_t xform_count;
+    can_xform_t xforms[CAN_SCHED_MAX_XFORMS];   // Applied in order before each send
+} can_periodic_def_t;
+
+/**
+ * @brief Periodic entry
+ *
+ * The definition is double-buffered: an edit writes the spare buffer and
+ * bumps gen; the TX task copies buf[gen & 1] and retries if gen moved while
+ * it copied. The send path takes no lock and an edit lands whole on the
+ * next scheduled send, without a gap or a duplicate.
+ */
+typedef struct {
+    can_periodic_def_t buf[2];
+    atomic_uint_least32_t gen;          // buf[gen & 1] is live
+    atomic_uint_least32_t run;          // Activation id, 0 = free
+    atomic_uint_least32_t phase_ms;     // Next planned send (ms clock, wraps)
+
+    // TX task only
+    uint32_t run_seen;                  // Activation the fields below belong to
+    uint64_t next_us;                   // Next due time
+    uint8_t counter;                    // Alive counter for the next send
+} can_periodic_t;
+
+/**
+ * @brief Scheduler instance
+ */
+typedef struct {
+    can_transport_t* bus;
+    can_port_mutex_t* lock;     // Guards the request fields
+    can_port_sem_t* wake;
+
+    can_seq_runner_t seq;
+    bool seq_active;            // Terminal event not yet reported
+    uint32_t seq_progress;      // Last reported step << 16 | step_count
+
+    // Pending sequence request (any task -> TX task)
+    bool seq_request;
+    const char* seq_request_name;
+    const uint8_t* seq_request_code;
+    size_t seq_request_len;
+
+    // Periodic entries (editors serialize on lock; the TX task reads lock-free)
+    can_periodic_t periodic[CAN_SCHED_MAX_PERIODIC];
+    uint32_t periodic_runs;     // Last activation id
+    uint8_t periodic_peak;      // Worst-case frames per phase slot
+
+    // Priority TX queue and backpressure tracking (TX task)
+    can_txq_t txq;
+    bool tx_congested;
+    uint32_t tx_dropped_seen;
+
+    // Sweep (requests under lock; generator and counters TX task only)
+    bool sweep_request;
+    bool sweep_stop_request;
+    can_sweep_config_t sweep_request_config;
+    can_sweep_t sweep;
+    bool sweep_active;
+    can_sweep_progress_t sweep_progress;
+    uint32_t sweep_sent_seen;   // Bulk class counters at the last report
+    uint32_t sweep_errors_seen;
+    uint32_t sweep_bus_errors;  // Transport bus error count at the sweep start
+    uint64_t sweep_report_us;   // Last progress event
+    uint64_t sweep_report_sent;
+
+    can_sched_event_cb_t event_cb;
+    void* event_user_data;
+    volatile bool running;
+} can_scheduler_t;
+
+/**
+ * @brief Initialize a scheduler
+ * @param sched Scheduler
+ * @param bus Transport used for all sends
+ * @return false if OS objects could not be created
+ */
+bool can_scheduler_init(can_scheduler_t* sched, can_transport_t* bus);
+
+/**
+ * @brief Release OS objects (after can_scheduler_run has returned)
+ * @param sched Scheduler
+ */
+void can_scheduler_deinit(can_scheduler_t* sched);
+
+/**
+ * @brief Set the event callback (call before starting the TX task)
+ * @param sched Scheduler
+ * @param cb Callback, invoked on the TX task
+ * @param user_data Passed to the callback
+ */
+void can_scheduler_set_event_cb(can_scheduler_t* sched, can_sched_event_cb_t cb, void* user_data);
+
+/**
+ * @brief Request a sequence start (any task); replaces a running sequence
+ * @param sched Scheduler
+ * @param name Static display name
+ * @param code Bytecode (static lifetime)
+ * @param len Length in bytes
+ * @return false if the program is invalid
+ */
+bool can_scheduler_start_sequence(can_scheduler_t* sched, const char* name,
+                                  const uint8_t* code, size_t len);
+
+/**
+ * @brief Cancel the running or pending sequence (any task)
+ * @param sched Scheduler
+ */
+void can_scheduler_stop_sequence(can_scheduler_t* sched);
+
+/**
+ * @brief Queue a frame for transmission (any task)
+ * @param sched Scheduler
+ * @param cls Traffic class (CAN_TXQ_USER for one-shot commands)
+ * @param frame Frame (copied)
+ * @return CAN_OK, or CAN_ERR_NO_SPACE if the class queue is full
+ */
+can_err_t can_scheduler_send(can_scheduler_t* sched, can_txq_class_t cls, const can_frame_t* frame);
+
+/**
+ * @brief Add a periodic entry (any task)
+ *
+ * The first frame goes out at a phase offset (within one period) chosen so
+ * that the entry's releases collide with as few other entries as possible
+ * over the hyperperiod; with no other entry running that is immediately.
+ *
+ * @param sched Scheduler
+ * @param def Definition (copied)
+ * @return Handle, or -1 if the table is full or a transform does not fit
+ */
+int can_scheduler_add_periodic(can_scheduler_t* sched, const can_periodic_def_t* def);
+
+/**
+ * @brief Replace the payload, period or transforms of a running entry (any task)
+ *
+ * The next scheduled send uses the new payload and transforms; the alive
+ * counter and the pending deadline carry over. A period change takes effect
+ * only after that send: the deadline already planned is kept, and the
+ * interval following it is the new period.
+ *
+ * @param sched Scheduler
+ * @param handle Handle from can_scheduler_add_periodic
+ * @param def New definition (copied)
+ * @return false if the handle is not running or the definition is invalid
+ */
+bool can_scheduler_update_periodic(can_scheduler_t* sched, int handle, const can_periodic_def_t* def);
+
+/**
+ * @brief Remove a periodic entry (any task)
+ * @param sched Scheduler
+ * @param handle Handle from can_scheduler_add_periodic
+ */
+void can_scheduler_remove_periodic(can_scheduler_t* sched, int handle);
+
+/**
+ * @brief Remove all periodic entries (any task)
+ * @param sched Scheduler
+ */
+void can_scheduler_clear_periodic(can_scheduler_t* sched);
+
+/**
+ * @brief Start an ID/payload sweep (any task); replaces a running sweep
+ *
+ * Frames are generated on the TX task as the bulk class drains, at
+ * config->rate_fps or, with 0, as fast as the bus takes them. User and
+ * periodic frames keep priority. Progress arrives as
+ * CAN_SCHED_EVENT_SWEEP_PROGRESS events and the end as SWEEP_DONE.
+ *
+ * @param sched Scheduler
+ * @param config Sweep definition (copied)
+ * @return false if the definition is invalid
+ */
+bool can_scheduler_start_sweep(can_scheduler_t* sched, const can_sweep_config_t* config);
+
+/**
+ * @brief Stop a running sweep and drop its queued frames (any task)
+ * @param sched Scheduler
+ */
+void can_scheduler_stop_sweep(can_scheduler_t* sched);
+
+/**
+ * @brief Worst-case instantaneous periodic load (any task)
+ *
+ * Upper bound on the periodic frames released within one
+ * CAN_SCHED_PHASE_SLOT_MS window, from pairwise phase collisions.
+ *
+ * @param sched Scheduler
+ * @return Frames per slot (0 if no periodic entries)
+ */
+uint8_t can_scheduler_get_peak_load(can_scheduler_t* sched);
+
+/**
+ * @brief Offer a received frame to the scheduler (RX task)
+ * @param sched Scheduler
+ * @param frame Received frame
+ */
+void can_scheduler_on_rx(can_scheduler_t* sched, const can_frame_t* frame);
+
+/**
+ * @brief Wake the TX task (any task)
+ * @param sched Scheduler
+ */
+void can_scheduler_wake(can_scheduler_t* sched);
+
+/**
+ * @brief Process requests and due work once (TX task)
+ * @param sched Scheduler
+ * @return Milliseconds until the next deadline (CAN_PORT_WAIT_FOREVER if none)
+ */
+uint32_t can_scheduler_run_once(can_scheduler_t* sched);
+
+/**
+ * @brief TX task body: run until can_scheduler_shutdown()
+ * @param sched Scheduler
+ */
+void can_scheduler_run(can_scheduler_t* sched);
+
+/**
+ * @brief Make can_scheduler_run() return (any task)
+ * @param sched Scheduler
+ */
+void can_scheduler_shutdown(can_scheduler_t* sched);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // CAN_SCHEDULER_H
@@ -0,0 +1,296 @@
+/**
+ * @file can_sequence.c
+ * @brief Scripted Frame Sequences Implementation
+ *
+ * Programs are validated once in can_seq_start(), so the interpreter loop in
+ * can_seq_run() decodes operands without bounds checks. Timed waits are
+ * chained from the previous deadline rather than from the wakeup time, so
+ * loops do not drift with TX task latency.
+ */
+
+#include "can_sequence.h"
+#include "can_port.h"
+#include <string.h>
+
+#define SEQ_SEND_TIMEOUT_MS     20  // Per-frame TX slot timeout
+#define SEQ_MAX_OPS_PER_RUN     64  // Yield after this many ops without a wait
+
+// Encoded op sizes (opcode + operands)
+#define SEQ_SIZE_END            1
+#define SEQ_SIZE_SEND           15
+#define SEQ_SIZE_WAIT           5
+#define SEQ_SIZE_WAIT_RX        13
+#define SEQ_SIZE_MARK           1
+#define SEQ_SIZE_LOOP           3
+
+static uint16_t rd16(const uint8_t* p) {
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+static uint32_t rd32(const uint8_t* p) {
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static size_t op_size(uint8_t op) {
+    switch (op) {
+        case CAN_SEQ_OP_END:     return SEQ_SIZE_END;
+        case CAN_SEQ_OP_SEND:    return SEQ_SIZE_SEND;
+        case CAN_SEQ_OP_WAIT:    return SEQ_SIZE_WAIT;
+        case CAN_SEQ_OP_WAIT_RX: return SEQ_SIZE_WAIT_RX;
+        case CAN_SEQ_OP_MARK:    return SEQ_SIZE_MARK;
+        case CAN_SEQ_OP_LOOP:    return SEQ_SIZE_LOOP;
+        default:                 return 0;
+    }
+}
+
+bool can_seq_validate(const uint8_t* code, size_t len, uint16_t* step_count) {
+    bool body_waits[CAN_SEQ_MAX_DEPTH] = {false};
+    uint8_t depth = 0;
+    uint16_t steps = 0;
+    size_t pc = 0;
+
+    if (code == NULL) {
+        return false;
+    }
+
+    while (pc < len) {
+        uint8_t op = code[pc];
+        size_t size = op_size(op);
+        if (size == 0 || pc + size > len) {
+            return false;
+        }
+
+        switch (op) {
+            case CAN_SEQ_OP_END:
+                if (depth != 0 || pc + size != len) {
+                    return false;
+                }
+                if (step_count != NULL) {
+                    *step_count = steps;
+                }
+                return true;
+
+            case CAN_SEQ_OP_SEND:
+                if (code[pc + 6] > CAN_MAX_DLC) {
+                    return false;
+                }
+                steps++;
+                break;
+
+            case CAN_SEQ_OP_WAIT:
+            case CAN_SEQ_OP_WAIT_RX:
+                for (uint8_t d = 0; d < depth; d++) {
+                    body_waits[d] = true;
+                }
+                steps++;
+                break;
+
+            case CAN_SEQ_OP_MARK:
+                if (depth >= CAN_SEQ_MAX_DEPTH) {
+                    return false;
+                }
+                body_waits[depth++] = false;
+                break;
+
+            case CAN_SEQ_OP_LOOP:
+                if (depth == 0) {
+                    return false;
+                }
+                depth--;
+                // An endless loop must wait somewhere or it would flood the bus
+                if (rd16(&code[pc + 1]) == 0 && !body_waits[depth]) {
+                    return false;
+                }
+                break;
+        }
+        pc += size;
+    }
+    return false;   // No END
+}
+
+// ==================== Runner ====================
+
+static void publish_progress(can_seq_runner_t* runner) {
+    atomic_store_explicit(&runner->progress,
+                          ((uint32_t)runner->step << 16) | runner->step_count,
+                          memory_order_relaxed);
+}
+
+static uint32_t finish(can_seq_runner_t* runner, can_seq_status_t status) {
+    atomic_store_explicit(&runner->rx_armed, 0, memory_order_relaxed);
+    runner->waiting = false;
+    atomic_store_explicit(&runner->status, status, memory_order_release);
+    return CAN_PORT_WAIT_FOREVER;
+}
+
+static uint32_t ms_until(uint64_t deadline_us, uint64_t now_us) {
+    return (uint32_t)((deadline_us - now_us + 999) / 1000);
+}
+
+void can_seq_runner_init(can_seq_runner_t* runner) {
+    memset(runner, 0, sizeof(can_seq_runner_t));
+    atomic_store_explicit(&runner->status, CAN_SEQ_IDLE, memory_order_relaxed);
+}
+
+bool can_seq_start(can_seq_runner_t* runner, const char* name, const uint8_t* code, size_t len) {
+    uint16_t steps = 0;
+    if (!can_seq_validate(code, len, &steps)) {
+        return false;
+    }
+
+    runner->code = code;
+    runner->len = len;
+    runner->name = (name != NULL) ? name : "";
+    runner->pc = 0;
+    runner->step = 0;
+    runner->step_count = steps;
+    runner->depth = 0;
+    runner->waiting = false;
+    runner->last_error = CAN_OK;
+    atomic_store_explicit(&runner->rx_armed, 0, memory_order_relaxed);
+    atomic_store_explicit(&runner->rx_matched, 0, memory_order_relaxed);
+    publish_progress(runner);
+    atomic_store_explicit(&runner->status, CAN_SEQ_RUNNING, memory_order_release);
+    return true;
+}
+
+uint32_t can_seq_run(can_seq_runner_t* runner, can_transport_t* bus, uint64_t now_us) {
+    if (atomic_load_explicit(&runner->status, memory_order_acquire) != CAN_SEQ_RUNNING) {
+        return CAN_PORT_WAIT_FOREVER;
+    }
+    if (atomic_exchange_explicit(&runner->cancel_req, 0, memory_order_relaxed) != 0) {
+        return finish(runner, CAN_SEQ_CANCELLED);
+    }
+
+    uint64_t t_us = now_us;     // Base for the next timed wait
+
+    if (runner->waiting) {
+        if (atomic_load_explicit(&runner->rx_armed, memory_order_relaxed) != 0) {
+            if (atomic_exchange_explicit(&runner->rx_matched, 0, memory_order_acquire) != 0) {
+                atomic_store_explicit(&runner->rx_armed, 0, memory_order_relaxed);
+            } else if (now_us >= runner->wake_us) {
+                runner->last_error = CAN_ERR_TIMEOUT;
+                return finish(runner, CAN_SEQ_FAILED);
+            } else {
+                return ms_until(runner->wake_us, now_us);
+            }
+        } else {
+            if (now_us < runner->wake_us) {
+                return ms_until(runner->wake_us, now_us);
+            }
+            t_us = runner->wake_us;
+        }
+        runner->waiting = false;
+        runner->step++;
+        publish_progress(runner);
+    }
+
+    const uint8_t* code = runner->code;
+
+    for (uint32_t ops = 0; ops < SEQ_MAX_OPS_PER_RUN; ops++) {
+        const uint8_t* p = &code[runner->pc];
+
+        switch (p[0]) {
+            case CAN_SEQ_OP_END:
+                return finish(runner, CAN_SEQ_DONE);
+
+            case CAN_SEQ_OP_SEND: {
+                can_frame_t frame = {
+                    .id = rd32(&p[1]),
+                    .flags = p[5],
+                    .dlc = p[6]
+                };
+                memcpy(frame.data, &p[7], CAN_MAX_DLC);
+                can_err_t err = can_transport_send(bus, &frame, SEQ_SEND_TIMEOUT_MS);
+                if (err != CAN_OK) {
+                    runner->last_error = err;
+                    return finish(runner, CAN_SEQ_FAILED);
+                }
+                runner->pc += SEQ_SIZE_SEND;
+                runner->step++;
+                publish_progress(runner);
+                break;
+            }
+
+            case CAN_SEQ_OP_WAIT:
+                runner->wake_us = t_us + (uint64_t)rd32(&p[1]) * 1000u;
+                runner->waiting = true;
+                runner->pc += SEQ_SIZE_WAIT;
+                return (runner->wake_us > now_us) ? ms_until(runner->wake_us, now_us) : 0;
+
+            case CAN_SEQ_OP_WAIT_RX:
+                runner->rx_id = rd32(&p[1]);
+                runner->rx_mask = rd32(&p[5]);
+                runner->wake_us = now_us + (uint64_t)rd32(&p[9]) * 1000u;
+                runner->waiting = true;
+                runner->pc += SEQ_SIZE_WAIT_RX;
+                atomic_store_explicit(&runner->rx_matched, 0, memory_order_relaxed);
+                atomic_store_explicit(&runner->rx_armed, 1, memory_order_release);
+                return ms_until(runner->wake_us, now_us);
+
+            case CAN_SEQ_OP_MARK:
+                runner->loops[runner->depth].pc = (uint16_t)(runner->pc + SEQ_SIZE_MARK);
+                runner->loops[runner->depth].step = runner->step;
+                runner->loops[runner->depth].armed = false;
+                runner->depth++;
+                runner->pc += SEQ_SIZE_MARK;
+                break;
+
+            case CAN_SEQ_OP_LOOP: {
+                uint16_t count = rd16(&p[1]);
+                uint8_t top = runner->depth - 1;
+                if (!runner->loops[top].armed) {
+                    runner->loops[top].armed = true;
+                    runner->loops[top].forever = (count == 0);
+                    runner->loops[top].remaining = (count > 0) ? count - 1 : 0;
+                }
+                if (runner->loops[top].forever || runner->loops[top].remaining > 0) {
+                    if (!runner->loops[top].forever) {
+                        runner->loops[top].remaining--;
+                    }
+                    runner->pc = runner->loops[top].pc;
+                    runner->step = runner->loops[top].step;
+                    publish_progress(runner);
+                } else {
+                    runner->depth--;
+                    runner->pc += SEQ_SIZE_LOOP;
+                }
+                break;
+            }
+        }
+    }
+    return 0;   // More to do; let other work run first
+}
+
+void can_seq_cancel(can_seq_runner_t* runner) {
+    atomic_store_explicit(&runner->cancel_req, 1, memory_order_relaxed);
+}
+
+void can_seq_clear_cancel(can_seq_runner_t* runner) {
+    atomic_store_explicit(&runner->cancel_req, 0, memory_order_relaxed);
+}
+
+bool can_seq_on_rx(can_seq_runner_t* runner, const can_frame_t* frame) {
+    if (atomic_load_explicit(&runner->rx_armed, memory_order_acquire) == 0) {
+        return false;
+    }
+    if ((frame->id & runner->rx_mask) != (runner->rx_id & runner->rx_mask)) {
+        return false;
+    }
+    atomic_store_explicit(&runner->rx_matched, 1, memory_order_release);
+    return true;
+}
+
+can_seq_status_t can_seq_get_status(can_seq_runner_t* runner) {
+    return (can_seq_status_t)atomic_load_explicit(&runner->status, memory_order_acquire);
+}
+
+void can_seq_get_progress(can_seq_runner_t* runner, uint16_t* step, uint16_t* step_count) {
+    uint32_t progress = atomic_load_explicit(&runner->progress, memory_order_relaxed);
+    if (step != NULL) {
+        *step = (uint16_t)(progress >> 16);
+    }
+    if (step_count != NULL) {
+        *step_count = (uint16_t)progress;
+    }
+}
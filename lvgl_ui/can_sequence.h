@@ -0,0 +1,194 @@
+/**
+ * @file can_sequence.h
+ * @brief Scripted Frame Sequences (Bytecode Engine)
+ *
+ * A sequence is a compact bytecode program (send frame, wait, wait for a
+ * matching RX frame, loop) built at compile time with the CAN_SEQ_* macros
+ * and executed step by step on the TX task by a can_seq_runner_t. The runner
+ * never blocks: can_seq_run() executes until the next wait and returns how
+ * long the TX task may sleep.
+ *
+ * Example:
+ *   static const uint8_t SEQ_IGP[] = {
+ *       CAN_SEQ_SEND(0x3B0, 2, 0x01, 0x00, 0, 0, 0, 0, 0, 0),
+ *       CAN_SEQ_WAIT(20),
+ *       CAN_SEQ_WAIT_RX(0x7B0, 0x7FF, 500),
+ *       CAN_SEQ_MARK,
+ *           CAN_SEQ_SEND(0x3B1, 1, 0x55, 0, 0, 0, 0, 0, 0, 0),
+ *           CAN_SEQ_WAIT(100),
+ *       CAN_SEQ_LOOP(5),
+ *       CAN_SEQ_END
+ *   };
+ */
+
+#ifndef CAN_SEQUENCE_H
+#define CAN_SEQUENCE_H
+
+#include "can_transport.h"
+#include <stdatomic.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// ==================== Bytecode ====================
+
+/**
+ * @brief Opcodes (operands little-endian)
+ */
+typedef enum {
+    CAN_SEQ_OP_END     = 0x00,  // -
+    CAN_SEQ_OP_SEND    = 0x01,  // id:u32 flags:u8 dlc:u8 data:8
+    CAN_SEQ_OP_WAIT    = 0x02,  // ms:u32
+    CAN_SEQ_OP_WAIT_RX = 0x03,  // id:u32 mask:u32 timeout_ms:u32
+    CAN_SEQ_OP_MARK    = 0x04,  // - (loop start)
+    CAN_SEQ_OP_LOOP    = 0x05   // count:u16 (total passes, 0 = forever)
+} can_seq_op_t;
+
+#define CAN_SEQ_MAX_DEPTH   2   // Nested MARK/LOOP levels
+
+#define CAN_SEQ_U16(v)      (uint8_t)((v) & 0xFF), (uint8_t)(((v) >> 8) & 0xFF)
+#define CAN_SEQ_U32(v)      (uint8_t)((v) & 0xFF), (uint8_t)(((v) >> 8) & 0xFF), \
+                            (uint8_t)(((v) >> 16) & 0xFF), (uint8_t)(((v) >> 24) & 0xFF)
+
+// Send a standard / extended frame; always list 8 data bytes (only dlc are sent)
+#define CAN_SEQ_SEND(id, dlc, ...)      CAN_SEQ_OP_SEND, CAN_SEQ_U32(id), 0, (dlc), __VA_ARGS__
+#define CAN_SEQ_SEND_EXT(id, dlc, ...)  CAN_SEQ_OP_SEND, CAN_SEQ_U32(id), CAN_FRAME_FLAG_EXT, (dlc), __VA_ARGS__
+#define CAN_SEQ_WAIT(ms)                CAN_SEQ_OP_WAIT, CAN_SEQ_U32(ms)
+#define CAN_SEQ_WAIT_RX(id, mask, timeout_ms) \
+                                        CAN_SEQ_OP_WAIT_RX, CAN_SEQ_U32(id), CAN_SEQ_U32(mask), CAN_SEQ_U32(timeout_ms)
+#define CAN_SEQ_MARK                    CAN_SEQ_OP_MARK
+#define CAN_SEQ_LOOP(count)             CAN_SEQ_OP_LOOP, CAN_SEQ_U16(count)
+#define CAN_SEQ_END                     CAN_SEQ_OP_END
+
+/**
+ * @brief Check a program for well-formed operands, balanced loops and END
+ * @param code Bytecode
+ * @param len Length in bytes
+ * @param step_count Output: number of SEND/WAIT/WAIT_RX steps (may be NULL)
+ * @return true if valid
+ */
+bool can_seq_validate(const uint8_t* code, size_t len, uint16_t* step_count);
+
+// ==================== Runner ====================
+
+/**
+ * @brief Runner status
+ */
+typedef enum {
+    CAN_SEQ_IDLE = 0,
+    CAN_SEQ_RUNNING,
+    CAN_SEQ_DONE,
+    CAN_SEQ_CANCELLED,
+    CAN_SEQ_FAILED          // Send error or WAIT_RX timeout (see last_error)
+} can_seq_status_t;
+
+/**
+ * @brief Sequence runner
+ *
+ * can_seq_start() and can_seq_run() belong to the TX task; can_seq_cancel(),
+ * can_seq_on_rx() and the getters may be called from any task.
+ */
+typedef struct {
+    const uint8_t* code;
+    size_t len;
+    const char* name;
+    uint16_t pc;
+    uint16_t step;              // Index of the current step
+    uint16_t step_count;
+    uint8_t depth;
+    struct {
+        uint16_t pc;            // First op after MARK
+        uint16_t step;          // Step index at MARK
+        uint16_t remaining;     // Passes left (valid once armed)
+        bool armed;
+        bool forever;
+    } loops[CAN_SEQ_MAX_DEPTH];
+    bool waiting;
+    uint64_t wake_us;           // WAIT / WAIT_RX deadline
+    uint32_t rx_id;
+    uint32_t rx_mask;
+    can_err_t last_error;       // CAN_ERR_TIMEOUT for a WAIT_RX timeout
+
+    atomic_uint_least32_t status;       // can_seq_status_t
+    atomic_uint_least32_t progress;     // step << 16 | step_count
+    atomic_uint_least32_t cancel_req;
+    atomic_uint_least32_t rx_armed;
+    atomic_uint_least32_t rx_matched;
+} can_seq_runner_t;
+
+/**
+ * @brief Initialize a runner (idle)
+ * @param runner Runner
+ */
+void can_seq_runner_init(can_seq_runner_t* runner);
+
+/**
+ * @brief Start a program (TX task)
+ *
+ * A cancel requested since the last can_seq_clear_cancel() stays pending, so
+ * the program ends on its first can_seq_run(): a STOP that raced the start
+ * is not lost.
+ *
+ * @param runner Runner
+ * @param name Static display name (e.g. scene "IGP")
+ * @param code Bytecode (must stay valid while running)
+ * @param len Length in bytes
+ * @return false if the program is invalid
+ */
+bool can_seq_start(can_seq_runner_t* runner, const char* name, const uint8_t* code, size_t len);
+
+/**
+ * @brief Execute until the next wait or the end (TX task)
+ * @param runner Runner
+ * @param bus Transport used for SEND steps
+ * @param now_us Current time (can_port_time_us)
+ * @return Milliseconds until the runner needs to run again,
+ *         CAN_PORT_WAIT_FOREVER if it is not running
+ */
+uint32_t can_seq_run(can_seq_runner_t* runner, can_transport_t* bus, uint64_t now_us);
+
+/**
+ * @brief Request cancellation (any task); takes effect on the next can_seq_run
+ * @param runner Runner
+ */
+void can_seq_cancel(can_seq_runner_t* runner);
+
+/**
+ * @brief Drop a pending cancellation (any task)
+ *
+ * Call when accepting a start request, under the lock that also orders the
+ * can_seq_cancel() calls, so a cancel is dropped only if it came first.
+ *
+ * @param runner Runner
+ */
+void can_seq_clear_cancel(can_seq_runner_t* runner);
+
+/**
+ * @brief Offer a received frame to a pending WAIT_RX (RX task)
+ * @param runner Runner
+ * @param frame Received frame
+ * @return true if it satisfied the wait (wake the TX task)
+ */
+bool can_seq_on_rx(can_seq_runner_t* runner, const can_frame_t* frame);
+
+/**
+ * @brief Get runner status (any task)
+ * @param runner Runner
+ * @return Status
+ */
+can_seq_status_t can_seq_get_status(can_seq_runner_t* runner);
+
+/**
+ * @brief Get progress (any task)
+ * @param runner Runner
+ * @param step Output: current step index (0-based)
+ * @param step_count Output: steps in the program
+ */
+void can_seq_get_progress(can_seq_runner_t* runner, uint16_t* step, uint16_t* step_count);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // CAN_SEQUENCE_H
@@ -0,0 +1,101 @@
+/**
+ * @file can_sweep.c
+ * @brief ID / Payload Sweep Generator Implementation
+ *
+ * Random payloads hash (seed, index) instead of stepping an RNG, so every
+ * frame can be rebuilt on its own and a run is reproducible from its seed.
+ */
+
+#include "can_sweep.h"
+#include <string.h>
+
+// 32-bit finalizer (lowbias32): good avalanche for a counter input
+static uint32_t mix32(uint32_t x) {
+    x ^= x >> 16;
+    x *= 0x7FEB352Du;
+    x ^= x >> 15;
+    x *= 0x846CA68Bu;
+    x ^= x >> 16;
+    return x;
+}
+
+bool can_sweep_init(can_sweep_t* sweep, const can_sweep_config_t* config) {
+    if (sweep == NULL || config == NULL) {
+        return false;
+    }
+    uint32_t id_mask = config->extended ? CAN_EXT_ID_MASK : CAN_STD_ID_MASK;
+    if (config->id_first > config->id_last || config->id_last > id_mask ||
+        config->dlc > CAN_MAX_DLC || config->pattern >= CAN_SWEEP_PATTERN_COUNT) {
+        return false;
+    }
+
+    uint32_t per_id = config->per_id;
+    if (per_id == 0) {
+        switch (config->pattern) {
+            case CAN_SWEEP_INCREMENT:   per_id = CAN_SWEEP_DEFAULT_INCREMENT; break;
+            case CAN_SWEEP_WALKING_BIT: per_id = (config->dlc > 0) ? config->dlc * 8u : 1u; break;
+            default:                    per_id = CAN_SWEEP_DEFAULT_RANDOM; break;
+        }
+    }
+
+    sweep->config = *config;
+    sweep->per_id = per_id;
+    sweep->total = (uint64_t)(config->id_last - config->id_first + 1u) * per_id;
+    sweep->next = 0;
+    return true;
+}
+
+uint32_t can_sweep_id_at(const can_sweep_t* sweep, uint64_t index) {
+    if (index >= sweep->total) {
+        return sweep->config.id_last;
+    }
+    return sweep->config.id_first + (uint32_t)(index / sweep->per_id);
+}
+
+void can_sweep_frame(const can_sweep_t* sweep, uint64_t index, can_frame_t* frame) {
+    const can_sweep_config_t* cfg = &sweep->config;
+    uint8_t dlc = (cfg->dlc < CAN_MAX_DLC) ? cfg->dlc : CAN_MAX_DLC;
+    uint32_t k = (uint32_t)(index % sweep->per_id);     // Payload within the ID
+
+    memset(frame, 0, sizeof(can_frame_t));
+    frame->id = can_sweep_id_at(sweep, index);
+    frame->dlc = dlc;
+    frame->flags = cfg->extended ? CAN_FRAME_FLAG_EXT : 0;
+
+    switch (cfg->pattern) {
+        case CAN_SWEEP_INCREMENT:
+            for (uint8_t i = 0; i < dlc && i < sizeof(k); i++) {
+                frame->data[i] = (uint8_t)(k >> (i * 8));
+            }
+            break;
+
+        case CAN_SWEEP_WALKING_BIT:
+            if (dlc > 0) {
+                uint32_t bit = k % (dlc * 8u);
+                frame->data[bit / 8] = (uint8_t)(1u << (bit % 8));
+            }
+            break;
+
+        case CAN_SWEEP_RANDOM: {
+            uint32_t h0 = mix32(cfg->seed ^ mix32((uint32_t)index + 0x9E3779B9u * (uint32_t)(index >> 32)));
+            uint32_t h1 = mix32(h0 ^ 0x85EBCA6Bu);
+            for (uint8_t i = 0; i < dlc; i++) {
+                uint32_t h = (i < 4) ? h0 : h1;
+                frame->data[i] = (uint8_t)(h >> ((i % 4) * 8));
+            }
+            break;
+        }
+
+        default:
+            break;
+    }
+}
+
+bool can_sweep_next(can_sweep_t* sweep, can_frame_t* frame) {
+    if (sweep->next >= sweep->total) {
+        return false;
+    }
+    can_sweep_frame(sweep, sweep->next, frame);
+    sweep->next++;
+    return true;
+}
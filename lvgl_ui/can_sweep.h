@@ -0,0 +1,108 @@
+/**
+ * @file can_sweep.h
+ * @brief ID / Payload Sweep Generator
+ *
+ * Walks an ID range and, for every ID, a run of payloads from a pattern
+ * (robustness testing of ECUs). Frame N is computed from the configuration
+ * and N alone, so the generator is a few words of state whatever the range
+ * and nothing is pre-built. The TX scheduler feeds it into the bulk class
+ * (can_scheduler_start_sweep).
+ *
+ * Order: id_first with payloads 0..per_id-1, then id_first + 1, ...
+ */
+
+#ifndef CAN_SWEEP_H
+#define CAN_SWEEP_H
+
+#include "can_transport.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Payload patterns
+ */
+typedef enum {
+    CAN_SWEEP_INCREMENT = 0,    // Payload index as a little-endian counter
+    CAN_SWEEP_WALKING_BIT,      // A single set bit, walking across the payload
+    CAN_SWEEP_RANDOM,           // Pseudo-random bytes, reproducible from seed
+    CAN_SWEEP_PATTERN_COUNT
+} can_sweep_pattern_t;
+
+// Payloads per ID when per_id is 0
+#define CAN_SWEEP_DEFAULT_INCREMENT 256     // Every value of byte 0
+#define CAN_SWEEP_DEFAULT_RANDOM    16      // (walking bit: one pass, dlc * 8)
+
+/**
+ * @brief Sweep definition
+ */
+typedef struct {
+    uint32_t id_first;
+    uint32_t id_last;           // Inclusive
+    bool extended;              // 29-bit identifiers
+    uint8_t dlc;
+    can_sweep_pattern_t pattern;
+    uint32_t seed;              // CAN_SWEEP_RANDOM
+    uint32_t per_id;            // Payloads per ID, 0 = pattern default
+    uint32_t rate_fps;          // Bulk class limit while sweeping, 0 = bus rate
+} can_sweep_config_t;
+
+/**
+ * @brief Generator state
+ */
+typedef struct {
+    can_sweep_config_t config;
+    uint32_t per_id;            // Resolved payloads per ID
+    uint64_t total;             // Frames in the sweep
+    uint64_t next;              // Index of the next frame
+} can_sweep_t;
+
+/**
+ * @brief Sweep progress (reported by the scheduler)
+ */
+typedef struct {
+    uint64_t sent;              // Frames handed to the transport
+    uint64_t total;
+    uint32_t rate_fps;          // Achieved over the last report interval
+    uint32_t errors;            // Controller bus errors since the sweep started
+    uint32_t current_id;        // ID of the last frame sent
+} can_sweep_progress_t;
+
+/**
+ * @brief Validate a definition and rewind the generator
+ * @param sweep Generator
+ * @param config Definition (copied)
+ * @return false if the range, DLC or pattern is invalid
+ */
+bool can_sweep_init(can_sweep_t* sweep, const can_sweep_config_t* config);
+
+/**
+ * @brief Build frame N of the sweep
+ * @param sweep Generator
+ * @param index Frame index (< total)
+ * @param frame Output frame
+ */
+void can_sweep_frame(const can_sweep_t* sweep, uint64_t index, can_frame_t* frame);
+
+/**
+ * @brief Build the next frame and advance
+ * @param sweep Generator
+ * @param frame Output frame
+ * @return false when the sweep is exhausted
+ */
+bool can_sweep_next(can_sweep_t* sweep, can_frame_t* frame);
+
+/**
+ * @brief ID of frame N
+ * @param sweep Generator
+ * @param index Frame index
+ * @return Identifier (id_last for indexes past the end)
+ */
+uint32_t can_sweep_id_at(const can_sweep_t* sweep, uint64_t index);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // CAN_SWEEP_H
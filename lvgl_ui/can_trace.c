@@ -0,0 +1,187 @@
+/**
+ * @file can_trace.c
+ * @brief End-to-End Latency Tracing Implementation
+ *
+ * All state is 32-bit atomics so recording is lock-free on both the ESP32-S3
+ * (no native 64-bit atomics) and the host. Timestamps are kept as wrapping
+ * 32-bit microseconds; chain latencies are far below the 71 minute wrap.
+ */
+
+#include "can_trace.h"
+#include "can_port.h"
+#include <stdatomic.h>
+#include <stdio.h>
+#include <string.h>
+
+typedef struct {
+    atomic_uint_least32_t buckets[CAN_TRACE_BUCKETS];
+    atomic_uint_least32_t max_us;
+} trace_histogram_t;
+
+static trace_histogram_t g_histograms[CAN_TRACE_STAGE_COUNT];
+
+// Time of the last tap not yet claimed by a frame (0 = none)
+static atomic_uint_least32_t g_tap;
+
+static const char* const STAGE_NAMES[CAN_TRACE_STAGE_COUNT] = {
+    "tap",
+    "binding",
+    "tx_enq",
+    "tx_done",
+    "rx_cap",
+    "log_draw"
+};
+
+static bool stage_starts_chain(can_trace_stage_t stage) {
+    return stage == CAN_TRACE_TAP || stage == CAN_TRACE_RX_CAPTURE;
+}
+
+// Exclusive upper bound of a bucket
+static uint32_t bucket_upper_us(uint8_t bucket) {
+    return 1u << bucket;
+}
+
+#if CAN_TRACE_ENABLE
+
+static uint8_t latency_bucket(uint32_t latency_us) {
+    uint8_t bucket = 0;
+    while (latency_us != 0 && bucket < CAN_TRACE_BUCKETS - 1) {
+        latency_us >>= 1;
+        bucket++;
+    }
+    return bucket;
+}
+
+static void histogram_record(trace_histogram_t* h, uint32_t latency_us) {
+    atomic_fetch_add_explicit(&h->buckets[latency_bucket(latency_us)], 1, memory_order_relaxed);
+
+    uint32_t prev = atomic_load_explicit(&h->max_us, memory_order_relaxed);
+    while (latency_us > prev &&
+           !atomic_compare_exchange_weak_explicit(&h->max_us, &prev, latency_us,
+                                                  memory_order_relaxed, memory_order_relaxed)) {
+    }
+}
+
+void can_trace_mark_at(can_trace_stage_t stage, uint64_t timestamp_us) {
+    uint32_t now = CAN_TRACE_TAG(timestamp_us);
+
+    if (stage == CAN_TRACE_TAP) {
+        atomic_store_explicit(&g_tap, now, memory_order_relaxed);
+        histogram_record(&g_histograms[stage], 0);
+    } else if (stage == CAN_TRACE_RX_CAPTURE) {
+        histogram_record(&g_histograms[stage], 0);     // The frame carries its own tag
+    } else if (stage == CAN_TRACE_BINDING) {
+        uint32_t start = atomic_load_explicit(&g_tap, memory_order_relaxed);
+        if (start != 0 && now - start <= CAN_TRACE_TAP_MAX_US) {
+            histogram_record(&g_histograms[stage], now - start);
+        }
+    }
+    // TX_ENQUEUE, TX_DONE and LOG_DRAW are per frame: see below
+}
+
+void can_trace_mark(can_trace_stage_t stage) {
+    can_trace_mark_at(stage, can_port_time_us());
+}
+
+uint32_t can_trace_claim_tap(void) {
+    uint32_t start = atomic_exchange_explicit(&g_tap, 0, memory_order_relaxed);
+    if (start == 0) {
+        return 0;
+    }
+    uint32_t latency_us = CAN_TRACE_TAG(can_port_time_us()) - start;
+    if (latency_us > CAN_TRACE_TAP_MAX_US) {
+        return 0;       // Tap that queued nothing (e.g. a send that failed early)
+    }
+    histogram_record(&g_histograms[CAN_TRACE_TX_ENQUEUE], latency_us);
+    return start;
+}
+
+void can_trace_mark_from(can_trace_stage_t stage, uint32_t start_tag) {
+    if (stage >= CAN_TRACE_STAGE_COUNT || start_tag == 0) {
+        return;
+    }
+    histogram_record(&g_histograms[stage], CAN_TRACE_TAG(can_port_time_us()) - start_tag);
+}
+
+#endif // CAN_TRACE_ENABLE
+
+void can_trace_get_stats(can_trace_stage_t stage, can_trace_stats_t* stats) {
+    memset(stats, 0, sizeof(can_trace_stats_t));
+    if (stage >= CAN_TRACE_STAGE_COUNT) {
+        return;
+    }
+
+    const trace_histogram_t* h = &g_histograms[stage];
+    uint32_t total = 0;
+    for (uint8_t i = 0; i < CAN_TRACE_BUCKETS; i++) {
+        stats->buckets[i] = atomic_load_explicit(&h->buckets[i], memory_order_relaxed);
+        total += stats->buckets[i];
+    }
+    stats->count = total;
+    stats->max_us = atomic_load_explicit(&h->max_us, memory_order_relaxed);
+
+    // Percentiles from the bucket counts (exclusive upper bound of the bucket)
+    uint32_t seen = 0;
+    bool have_p50 = false;
+    for (uint8_t i = 0; i < CAN_TRACE_BUCKETS && total > 0; i++) {
+        seen += stats->buckets[i];
+        if (!have_p50 && seen * 2 >= total) {
+            stats->p50_us = bucket_upper_us(i);
+            have_p50 = true;
+        }
+        if ((uint64_t)seen * 100 >= (uint64_t)total * 99) {
+            stats->p99_us = bucket_upper_us(i);
+            break;
+        }
+    }
+}
+
+void can_trace_reset(void) {
+    for (uint8_t s = 0; s < CAN_TRACE_STAGE_COUNT; s++) {
+        for (uint8_t i = 0; i < CAN_TRACE_BUCKETS; i++) {
+            atomic_store_explicit(&g_histograms[s].buckets[i], 0, memory_order_relaxed);
+        }
+        atomic_store_explicit(&g_histograms[s].max_us, 0, memory_order_relaxed);
+    }
+    atomic_store_explicit(&g_tap, 0, memory_order_relaxed);
+}
+
+const char* can_trace_stage_name(can_trace_stage_t stage) {
+    return (stage < CAN_TRACE_STAGE_COUNT) ? STAGE_NAMES[stage] : "?";
+}
+
+int can_trace_format(char* buf, size_t size) {
+    int len = 0;
+    buf[0] = '\0';
+
+    for (uint8_t s = 0; s < CAN_TRACE_STAGE_COUNT && (size_t)len < size; s++) {
+        if (stage_starts_chain((can_trace_stage_t)s)) {
+            continue;   // Always 0 us
+        }
+        can_trace_stats_t st;
+        can_trace_get_stats((can_trace_stage_t)s, &st);
+        len += snprintf(buf + len, size - len, "%-8s p50<%u p99<%u max %u\n",
+                        STAGE_NAMES[s], (unsigned)st.p50_us, (unsigned)st.p99_us,
+                        (unsigned)st.max_us);
+    }
+    return len;
+}
+
+void can_trace_dump(void) {
+    printf("=== CAN latency trace (us, relative to tap / rx capture) ===\n");
+    for (uint8_t s = 0; s < CAN_TRACE_STAGE_COUNT; s++) {
+        can_trace_stats_t st;
+        can_trace_get_stats((can_trace_stage_t)s, &st);
+        printf("%-8s n=%-8u p50<%-7u p99<%-7u max=%u\n", STAGE_NAMES[s],
+               (unsigned)st.count, (unsigned)st.p50_us, (unsigned)st.p99_us,
+               (unsigned)st.max_us);
+        if (stage_starts_chain((can_trace_stage_t)s)) {
+            continue;
+        }
+        for (uint8_t i = 0; i < CAN_TRACE_BUCKETS; i++) {
+            if (st.buckets[i] != 0) {
+                printf("    <%-8u %u\n", (unsigned)bucket_upper_us(i), (unsigned)st.buckets[i]);
+            }
+        }
+    }
+}
@@ -0,0 +1,150 @@
+/**
+ * @file can_trace.h
+ * @brief End-to-End Latency Tracing
+ *
+ * Trace points along the TRANSMIT path (tap -> binding -> TX enqueue -> TX
+ * done) and the receive path (RX capture -> log row drawn). Each stage keeps a
+ * lock-free log2 histogram of its latency relative to the start of its chain.
+ *
+ * A tap stays pending until the next user-class frame pushed to a TX queue
+ * claims it; from then on the frame carries its own start tag, as does each
+ * received frame, so concurrent frames never share a chain start.
+ *
+ * Build with CAN_TRACE_ENABLE=1 to enable. When disabled (default) the
+ * CAN_TRACE_* macros expand to nothing and can_trace.c need not be linked.
+ */
+
+#ifndef CAN_TRACE_H
+#define CAN_TRACE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#ifndef CAN_TRACE_ENABLE
+#define CAN_TRACE_ENABLE 0
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Trace stages
+ *
+ * TAP and RX_CAPTURE start a chain. BINDING is measured from the pending
+ * tap, TX_ENQUEUE when a frame claims it; TX_DONE and LOG_DRAW are measured
+ * from the start tag their frame carries.
+ */
+typedef enum {
+    CAN_TRACE_TAP = 0,          // TRANSMIT button pressed (transmit_btn_cb)
+    CAN_TRACE_BINDING,          // ui_binding_trigger_transmit_* reached
+    CAN_TRACE_TX_ENQUEUE,       // User frame pushed to the software TX queue
+    CAN_TRACE_TX_DONE,          // That frame accepted by the controller
+    CAN_TRACE_RX_CAPTURE,       // Frame received from the controller
+    CAN_TRACE_LOG_DRAW,         // Refresh that rendered the frame's log row done
+    CAN_TRACE_STAGE_COUNT
+} can_trace_stage_t;
+
+#define CAN_TRACE_BUCKETS 24    // Bucket n holds latencies in [2^(n-1), 2^n) us
+
+#ifndef CAN_TRACE_TAP_MAX_US
+#define CAN_TRACE_TAP_MAX_US 1000000    // Older taps queued nothing: not claimed
+#endif
+
+/**
+ * @brief Snapshot of one stage histogram
+ */
+typedef struct {
+    uint32_t count;
+    uint32_t max_us;
+    uint32_t p50_us;            // Exclusive upper bound of the median bucket
+    uint32_t p99_us;            // Exclusive upper bound of the 99th percentile bucket
+    uint32_t buckets[CAN_TRACE_BUCKETS];
+} can_trace_stats_t;
+
+#if CAN_TRACE_ENABLE
+
+/**
+ * @brief Record a trace point now
+ * @param stage Trace stage (TAP, BINDING or RX_CAPTURE)
+ */
+void can_trace_mark(can_trace_stage_t stage);
+
+/**
+ * @brief Record a trace point with an explicit timestamp
+ * @param stage Trace stage (TAP, BINDING or RX_CAPTURE)
+ * @param timestamp_us Monotonic timestamp (can_port_time_us() base)
+ */
+void can_trace_mark_at(can_trace_stage_t stage, uint64_t timestamp_us);
+
+/**
+ * @brief Claim the pending tap for a frame entering a TX queue
+ *
+ * Records TX_ENQUEUE and clears the tap, so one tap is attributed to one
+ * frame.
+ *
+ * @return Start tag for the frame (0 = no tap pending)
+ */
+uint32_t can_trace_claim_tap(void);
+
+/**
+ * @brief Record a trace point measured from a frame's start tag (now)
+ * @param stage Trace stage (TX_DONE or LOG_DRAW)
+ * @param start_tag Tag from can_trace_claim_tap() or CAN_TRACE_TAG(); 0 is ignored
+ */
+void can_trace_mark_from(can_trace_stage_t stage, uint32_t start_tag);
+
+#define CAN_TRACE_MARK(stage)               can_trace_mark(stage)
+#define CAN_TRACE_MARK_AT(stage, ts)        can_trace_mark_at((stage), (ts))
+#define CAN_TRACE_CLAIM_TAP()               can_trace_claim_tap()
+#define CAN_TRACE_MARK_FROM(stage, tag)     can_trace_mark_from((stage), (tag))
+#define CAN_TRACE_TAG(ts)                   ((uint32_t)(ts) | 1u)   // Never 0 (0 = untraced)
+
+#else
+
+#define CAN_TRACE_MARK(stage)               ((void)0)
+#define CAN_TRACE_MARK_AT(stage, ts)        ((void)0)
+#define CAN_TRACE_CLAIM_TAP()               0u
+#define CAN_TRACE_MARK_FROM(stage, tag)     ((void)(tag))
+#define CAN_TRACE_TAG(ts)                   0u
+
+#endif // CAN_TRACE_ENABLE
+
+/**
+ * @brief Read one stage histogram
+ * @param stage Trace stage
+ * @param stats Output snapshot
+ */
+void can_trace_get_stats(can_trace_stage_t stage, can_trace_stats_t* stats);
+
+/**
+ * @brief Clear all histograms
+ */
+void can_trace_reset(void);
+
+/**
+ * @brief Get the short name of a stage
+ * @param stage Trace stage
+ * @return Static string
+ */
+const char* can_trace_stage_name(can_trace_stage_t stage);
+
+/**
+ * @brief Format a compact one-line-per-stage summary (for the debug overlay)
+ * @param buf Output buffer
+ * @param size Buffer size
+ * @return Number of characters written
+ */
+int can_trace_format(char* buf, size_t size);
+
+/**
+ * @brief Print all histograms to stdout (serial console on target)
+ */
+void can_trace_dump(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // CAN_TRACE_H
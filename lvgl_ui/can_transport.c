@@ -0,0 +1,325 @@
+/**
+ * @file can_transport.c
+ * @brief CAN Transport Abstraction Implementation
+ */
+
+#include "can_transport.h"
+#include "can_port.h"
+#include "can_trace.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+
+// ==================== Backend Access ====================
+// Calls into an open backend are counted in transport->active. Close raises
+// transport->closing first, so a call either sees it and backs out, or is
+// counted and waited for before the backend frees its state.
+
+static bool backend_enter(can_transport_t* transport) {
+    atomic_fetch_add(&transport->active, 1);
+    if (atomic_load(&transport->closing) || !transport->is_open) {
+        atomic_fetch_sub(&transport->active, 1);
+        return false;
+    }
+    return true;
+}
+
+static void backend_leave(can_transport_t* transport) {
+    atomic_fetch_sub(&transport->active, 1);
+}
+
+// ==================== Transport API ====================
+
+void can_transport_init(can_transport_t* transport, const can_transport_ops_t* ops) {
+    memset(transport, 0, sizeof(can_transport_t));
+    transport->ops = ops;
+    atomic_init(&transport->closing, false);
+    atomic_init(&transport->active, 0);
+    atomic_init(&transport->bus_errors, 0);
+}
+
+can_err_t can_transport_open(can_transport_t* transport, const can_transport_config_t* config) {
+    if (transport == NULL || transport->ops == NULL || config == NULL) {
+        return CAN_ERR_INVALID_ARG;
+    }
+    if (transport->is_open) {
+        return CAN_OK;
+    }
+
+    memset(&transport->stats, 0, sizeof(can_transport_stats_t));
+    transport->bus_off = false;
+    atomic_store(&transport->bus_errors, 0);
+    can_err_t err = transport->ops->open(transport, config);
+    if (err != CAN_OK) {
+        return err;
+    }
+    transport->is_open = true;
+
+    // Re-apply filters configured before open
+    if (transport->filter_count > 0 && transport->ops->set_filters != NULL) {
+        transport->ops->set_filters(transport, transport->filters, transport->filter_count);
+    }
+    return CAN_OK;
+}
+
+void can_transport_close(can_transport_t* transport) {
+    if (transport == NULL || !transport->is_open) {
+        return;
+    }
+
+    atomic_store(&transport->closing, true);
+    while (atomic_load(&transport->active) != 0) {
+        can_port_sleep_ms(1);
+    }
+    transport->ops->close(transport);
+    transport->is_open = false;
+    atomic_store(&transport->closing, false);
+}
+
+can_err_t can_transport_send(can_transport_t* transport, const can_frame_t* frame, uint32_t timeout_ms) {
+    if (transport == NULL || frame == NULL || frame->dlc > CAN_MAX_DLC) {
+        return CAN_ERR_INVALID_ARG;
+    }
+    if (!backend_enter(transport)) {
+        return CAN_ERR_NOT_OPEN;
+    }
+    if (transport->bus_off) {
+        // Don't wait out a TX slot that cannot free up until recovery
+        transport->stats.tx_errors++;
+        backend_leave(transport);
+        return CAN_ERR_BUS_OFF;
+    }
+
+    can_err_t err = transport->ops->send(transport, frame, timeout_ms);
+    backend_leave(transport);
+    if (err == CAN_OK) {
+        transport->stats.tx_frames++;
+    } else if (err == CAN_ERR_TIMEOUT) {
+        transport->stats.tx_timeouts++;
+    } else {
+        transport->stats.tx_errors++;
+    }
+    return err;
+}
+
+void can_transport_flush(can_transport_t* transport) {
+    if (transport != NULL && transport->ops->flush != NULL && backend_enter(transport)) {
+        transport->ops->flush(transport);
+        backend_leave(transport);
+    }
+}
+
+can_err_t can_transport_get_status(can_transport_t* transport, can_bus_status_t* status) {
+    if (transport == NULL || status == NULL) {
+        return CAN_ERR_INVALID_ARG;
+    }
+    if (!backend_enter(transport)) {
+        return CAN_ERR_NOT_OPEN;
+    }
+    can_err_t err = CAN_OK;
+    if (transport->ops->get_status == NULL) {
+        memset(status, 0, sizeof(can_bus_status_t));
+        status->state = CAN_BUS_ERROR_ACTIVE;
+    } else {
+        err = transport->ops->get_status(transport, status);
+    }
+    backend_leave(transport);
+    if (err == CAN_OK) {
+        atomic_store_explicit(&transport->bus_errors, status->bus_errors, memory_order_relaxed);
+    }
+    return err;
+}
+
+uint32_t can_transport_get_bus_errors(can_transport_t* transport) {
+    if (transport == NULL) {
+        return 0;
+    }
+    return atomic_load_explicit(&transport->bus_errors, memory_order_relaxed);
+}
+
+can_err_t can_transport_recover(can_transport_t* transport) {
+    if (transport == NULL) {
+        return CAN_ERR_INVALID_ARG;
+    }
+    if (transport->ops->recover == NULL) {
+        return transport->is_open ? CAN_ERR_INVALID_ARG : CAN_ERR_NOT_OPEN;
+    }
+    if (!backend_enter(transport)) {
+        return CAN_ERR_NOT_OPEN;
+    }
+    can_err_t err = transport->ops->recover(transport);
+    backend_leave(transport);
+    return err;
+}
+
+void can_transport_set_bus_off(can_transport_t* transport, bool down) {
+    if (transport != NULL) {
+        transport->bus_off = down;
+    }
+}
+
+// Next frame passing the software filters (backend entered)
+static can_err_t recv_accepted(can_transport_t* transport, can_frame_t* frame, uint32_t timeout_ms) {
+    uint64_t deadline = can_port_time_us() + (uint64_t)timeout_ms * 1000u;
+    uint32_t remaining = timeout_ms;
+
+    for (;;) {
+        can_err_t err = transport->ops->recv(transport, frame, remaining);
+        if (err != CAN_OK) {
+            if (err != CAN_ERR_TIMEOUT) {
+                transport->stats.rx_errors++;
+            }
+            return err;
+        }
+        if (frame->timestamp_us == 0) {
+            frame->timestamp_us = can_port_time_us();
+        }
+        if (can_transport_filter_match(transport, frame)) {
+            CAN_TRACE_MARK_AT(CAN_TRACE_RX_CAPTURE, frame->timestamp_us);
+            transport->stats.rx_frames++;
+            return CAN_OK;
+        }
+
+        // Rejected by software filter: keep waiting for the rest of the timeout
+        transport->stats.rx_filtered++;
+        if (timeout_ms == 0 || timeout_ms == CAN_PORT_WAIT_FOREVER) {
+            continue;
+        }
+        uint64_t now = can_port_time_us();
+        if (now >= deadline) {
+            return CAN_ERR_TIMEOUT;
+        }
+        remaining = (uint32_t)((deadline - now) / 1000u);
+    }
+}
+
+can_err_t can_transport_recv(can_transport_t* transport, can_frame_t* frame, uint32_t timeout_ms) {
+    if (transport == NULL || frame == NULL) {
+        return CAN_ERR_INVALID_ARG;
+    }
+    if (!backend_enter(transport)) {
+        return CAN_ERR_NOT_OPEN;
+    }
+    can_err_t err = recv_accepted(transport, frame, timeout_ms);
+    backend_leave(transport);
+    return err;
+}
+
+can_err_t can_transport_set_filters(can_transport_t* transport, const can_filter_t* filters, uint8_t count) {
+    if (transport == NULL || (count > 0 && filters == NULL)) {
+        return CAN_ERR_INVALID_ARG;
+    }
+    if (count > CAN_TRANSPORT_MAX_FILTERS) {
+        return CAN_ERR_NO_SPACE;
+    }
+
+    if (count > 0) {
+        memcpy(transport->filters, filters, count * sizeof(can_filter_t));
+    }
+    transport->filter_count = count;
+
+    if (transport->ops->set_filters != NULL && backend_enter(transport)) {
+        can_err_t err = transport->ops->set_filters(transport, transport->filters, count);
+        backend_leave(transport);
+        return err;
+    }
+    return CAN_OK;
+}
+
+const can_transport_stats_t* can_transport_get_stats(const can_transport_t* transport) {
+    return &transport->stats;
+}
+
+const char* can_err_to_name(can_err_t err) {
+    switch (err) {
+        case CAN_OK:              return "OK";
+        case CAN_ERR_TIMEOUT:     return "timeout";
+        case CAN_ERR_NOT_OPEN:    return "not open";
+        case CAN_ERR_INVALID_ARG: return "invalid argument";
+        case CAN_ERR_IO:          return "I/O error";
+        case CAN_ERR_NO_SPACE:    return "no space";
+        case CAN_ERR_BUS_OFF:     return "bus off";
+        default:                  return "unknown";
+    }
+}
+
+const char* can_bus_state_to_name(can_bus_state_t state) {
+    switch (state) {
+        case CAN_BUS_ERROR_ACTIVE:  return "error active";
+        case CAN_BUS_ERROR_WARNING: return "error warning";
+        case CAN_BUS_ERROR_PASSIVE: return "error passive";
+        case CAN_BUS_OFF:           return "bus off";
+        case CAN_BUS_RECOVERING:    return "recovering";
+        case CAN_BUS_STOPPED:       return "stopped";
+        default:                    return "unknown";
+    }
+}
+
+// ==================== Frame Helpers ====================
+
+bool can_transport_filter_match(const can_transport_t* transport, const can_frame_t* frame) {
+    if (transport->filter_count == 0) {
+        return true;
+    }
+
+    bool extended = (frame->flags & CAN_FRAME_FLAG_EXT) != 0;
+    for (uint8_t i = 0; i < transport->filter_count; i++) {
+        const can_filter_t* f = &transport->filters[i];
+        if (f->extended == extended && (frame->id & f->mask) == (f->id & f->mask)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool can_frame_parse(const char* can_id, const char* data, can_frame_t* frame) {
+    if (can_id == NULL || data == NULL || frame == NULL) {
+        return false;
+    }
+
+    memset(frame, 0, sizeof(can_frame_t));
+
+    char* end = NULL;
+    unsigned long id = strtoul(can_id, &end, 16);
+    if (end == can_id || id > CAN_EXT_ID_MASK) {
+        return false;
+    }
+    frame->id = (uint32_t)id;
+    if (id > CAN_STD_ID_MASK) {
+        frame->flags |= CAN_FRAME_FLAG_EXT;
+    }
+
+    // Accept "[0x01, 0x02]", "01 02", "0x01,0x02" ...
+    const char* p = data;
+    while (*p != '\0') {
+        if (isxdigit((unsigned char)*p)) {
+            if (frame->dlc >= CAN_MAX_DLC) {
+                return false;
+            }
+            unsigned long byte = strtoul(p, &end, 16);
+            if (byte > 0xFF) {
+                return false;
+            }
+            frame->data[frame->dlc++] = (uint8_t)byte;
+            p = end;
+        } else {
+            p++;
+        }
+    }
+    return true;
+}
+
+int can_frame_format(const can_frame_t* frame, char* buf, size_t size) {
+    int len = snprintf(buf, size, (frame->flags & CAN_FRAME_FLAG_EXT) ?
+                       "CAN ID: 0x%08X | Data: [" : "CAN ID: 0x%03X | Data: [",
+                       (unsigned)frame->id);
+
+    for (uint8_t i = 0; i < frame->dlc && len > 0 && (size_t)len < size; i++) {
+        len += snprintf(buf + len, size - len, (i == 0) ? "0x%02X" : ", 0x%02X", frame->data[i]);
+    }
+    if (len > 0 && (size_t)len < size) {
+        len += snprintf(buf + len, size - len, "]");
+    }
+    return len;
+}
@@ -0,0 +1,350 @@
+/**
+ * @file can_transport.h
+ * @brief CAN Transport Abstraction
+ *
+ * Hardware-independent interface used by the backend callbacks to reach a
+ * CAN bus. Each backend (ESP32 TWAI, Linux SocketCAN, SLCAN over a serial
+ * port, in-process loopback) provides a can_transport_ops_t table; the functions below add argument
+ * checking, software filtering and statistics on top of it.
+ */
+
+#ifndef CAN_TRANSPORT_H
+#define CAN_TRANSPORT_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdatomic.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// ==================== Frame ====================
+
+#define CAN_MAX_DLC          8
+#define CAN_STD_ID_MASK      0x7FFu
+#define CAN_EXT_ID_MASK      0x1FFFFFFFu
+
+#define CAN_FRAME_FLAG_EXT   0x01   // 29-bit identifier
+#define CAN_FRAME_FLAG_RTR   0x02   // Remote transmission request
+
+/**
+ * @brief Classic CAN frame
+ */
+typedef struct {
+    uint32_t id;                    // Identifier (11 or 29 bit)
+    uint8_t dlc;                    // Data length (0-8)
+    uint8_t flags;                  // CAN_FRAME_FLAG_*
+    uint8_t data[CAN_MAX_DLC];      // Payload
+    uint64_t timestamp_us;          // RX capture / TX completion time
+} can_frame_t;
+
+// ==================== Errors ====================
+
+/**
+ * @brief Transport result codes
+ */
+typedef enum {
+    CAN_OK = 0,
+    CAN_ERR_TIMEOUT,        // No frame / no TX slot within timeout
+    CAN_ERR_NOT_OPEN,       // Transport not opened
+    CAN_ERR_INVALID_ARG,    // Bad frame or configuration
+    CAN_ERR_IO,             // Driver or socket error
+    CAN_ERR_NO_SPACE,       // Filter table or buffer full
+    CAN_ERR_BUS_OFF         // Controller is bus-off or recovering
+} can_err_t;
+
+// ==================== Bus Status ====================
+
+/**
+ * @brief Controller fault confinement state
+ */
+typedef enum {
+    CAN_BUS_ERROR_ACTIVE = 0,   // Normal operation
+    CAN_BUS_ERROR_WARNING,      // An error counter reached 96
+    CAN_BUS_ERROR_PASSIVE,      // An error counter reached 128
+    CAN_BUS_OFF,                // TEC above 255: controller left the bus
+    CAN_BUS_RECOVERING,         // Waiting for 128 x 11 recessive bits
+    CAN_BUS_STOPPED             // Recovered, controller not restarted yet
+} can_bus_state_t;
+
+// Events latched by the backend since the previous status read
+#define CAN_BUS_EVENT_BUS_ERROR     0x01    // Bit, stuff, CRC, form or ACK error
+#define CAN_BUS_EVENT_ERR_WARNING   0x02
+#define CAN_BUS_EVENT_ERR_PASSIVE   0x04
+#define CAN_BUS_EVENT_BUS_OFF       0x08
+#define CAN_BUS_EVENT_RECOVERED     0x10
+#define CAN_BUS_EVENT_RX_OVERRUN    0x20    // Frames lost in the controller / driver
+#define CAN_BUS_EVENT_TX_FAILED     0x40
+
+/**
+ * @brief Controller status snapshot
+ */
+typedef struct {
+    can_bus_state_t state;
+    uint32_t tx_error_counter;  // TEC
+    uint32_t rx_error_counter;  // REC
+    uint32_t bus_errors;        // Total since open
+    uint32_t rx_overruns;       // Total since open
+    uint32_t events;            // CAN_BUS_EVENT_* since the previous read
+} can_bus_status_t;
+
+// ==================== Configuration ====================
+
+#define CAN_TRANSPORT_MAX_FILTERS 8
+
+/**
+ * @brief Acceptance filter: frame accepted when (id & mask) == (filter.id & mask)
+ */
+typedef struct {
+    uint32_t id;
+    uint32_t mask;
+    bool extended;          // Match extended frames (standard otherwise)
+} can_filter_t;
+
+/**
+ * @brief Transport open parameters
+ *
+ * Backends ignore fields that do not apply to them.
+ */
+typedef struct {
+    const char* device;     // Interface or port ("vcan0", "/dev/ttyACM0", "uart1", "usb") or NULL
+    uint32_t bitrate;       // Bits per second (e.g. 500000)
+    int tx_pin;             // Controller TX pin (TWAI)
+    int rx_pin;             // Controller RX pin (TWAI)
+    uint8_t controller;     // Controller index on chips with several (TWAI)
+    bool receive_own;       // Deliver own transmitted frames to recv()
+    uint32_t serial_baud;   // UART baud rate, 0 = 115200 (SLCAN)
+    bool slcan_adapter;     // Act as the adapter and answer host commands (SLCAN)
+} can_transport_config_t;
+
+/**
+ * @brief Transport statistics
+ */
+typedef struct {
+    uint32_t tx_frames;
+    uint32_t rx_frames;
+    uint32_t tx_errors;
+    uint32_t tx_timeouts;
+    uint32_t rx_errors;
+    uint32_t rx_filtered;   // Dropped by software filter
+} can_transport_stats_t;
+
+// ==================== Backend Interface ====================
+
+typedef struct can_transport can_transport_t;
+
+/**
+ * @brief Backend operations table
+ *
+ * set_filters may be NULL; the transport then filters in software only.
+ * flush may be NULL for backends that hand each frame to the driver in send.
+ * get_status may be NULL when the backend cannot see the controller (it is
+ * then reported error-active); recover may be NULL when recovery is left to
+ * the controller or the OS. close is only called once no other operation is
+ * in progress, so it may free the backend state.
+ */
+typedef struct {
+    const char* name;
+    can_err_t (*open)(can_transport_t* transport, const can_transport_config_t* config);
+    void (*close)(can_transport_t* transport);
+    can_err_t (*send)(can_transport_t* transport, const can_frame_t* frame, uint32_t timeout_ms);
+    can_err_t (*recv)(can_transport_t* transport, can_frame_t* frame, uint32_t timeout_ms);
+    can_err_t (*set_filters)(can_transport_t* transport, const can_filter_t* filters, uint8_t count);
+    void (*flush)(can_transport_t* transport);
+    can_err_t (*get_status)(can_transport_t* transport, can_bus_status_t* status);
+    can_err_t (*recover)(can_transport_t* transport);
+} can_transport_ops_t;
+
+/**
+ * @brief Transport instance
+ */
+struct can_transport {
+    const can_transport_ops_t* ops;
+    void* backend;                                  // Backend private state
+    volatile bool is_open;
+    volatile bool bus_off;                          // Set by the health monitor: send fails fast
+    atomic_bool closing;                            // Close waiting for calls in progress
+    atomic_uint_least32_t active;                   // Calls inside the backend
+    atomic_uint_least32_t bus_errors;               // status.bus_errors of the last status read
+    can_transport_stats_t stats;
+    can_filter_t filters[CAN_TRANSPORT_MAX_FILTERS];
+    uint8_t filter_count;
+};
+
+// Available backends
+#ifdef ESP_PLATFORM
+extern const can_transport_ops_t can_transport_twai_ops;
+#endif
+#ifdef __linux__
+extern const can_transport_ops_t can_transport_socketcan_ops;
+#endif
+extern const can_transport_ops_t can_transport_slcan_ops;
+extern const can_transport_ops_t can_transport_loopback_ops;
+
+/**
+ * @brief Take a loopback node off the bus as if its TEC overflowed (fault injection)
+ * @param transport Open loopback transport (other backends are ignored)
+ */
+void can_transport_loopback_inject_bus_off(can_transport_t* transport);
+
+// ==================== Transport API ====================
+
+/**
+ * @brief Bind a transport instance to a backend
+ * @param transport Transport instance
+ * @param ops Backend operations table
+ */
+void can_transport_init(can_transport_t* transport, const can_transport_ops_t* ops);
+
+/**
+ * @brief Open the transport
+ * @param transport Transport instance
+ * @param config Open parameters
+ * @return CAN_OK on success
+ */
+can_err_t can_transport_open(can_transport_t* transport, const can_transport_config_t* config);
+
+/**
+ * @brief Close the transport (no-op if not open)
+ *
+ * New calls fail with CAN_ERR_NOT_OPEN at once; calls already inside the
+ * backend (a recv or send in another task) are waited for, up to their
+ * timeout, before the backend releases its state. Must not be called from
+ * a task that is itself inside recv or send of this transport.
+ *
+ * @param transport Transport instance
+ */
+void can_transport_close(can_transport_t* transport);
+
+/**
+ * @brief Queue a frame for transmission
+ * @param transport Transport instance
+ * @param frame Frame to send
+ * @param timeout_ms Maximum time to wait for a TX slot
+ * @return CAN_OK on success
+ */
+can_err_t can_transport_send(can_transport_t* transport, const can_frame_t* frame, uint32_t timeout_ms);
+
+/**
+ * @brief Push out frames a backend has batched (no-op if not open)
+ *
+ * Backends may hold sent frames back to write them together (SLCAN). Call
+ * after a burst of sends; the TX scheduler flushes once per pass.
+ *
+ * @param transport Transport instance
+ */
+void can_transport_flush(can_transport_t* transport);
+
+/**
+ * @brief Read the controller status (error counters, state, latched events)
+ * @param transport Transport instance
+ * @param status Output status
+ * @return CAN_OK on success
+ */
+can_err_t can_transport_get_status(can_transport_t* transport, can_bus_status_t* status);
+
+/**
+ * @brief Controller bus errors since open, as of the last status read (any task)
+ *
+ * Follows the count the health monitor reads without reading the status
+ * again, which would consume the latched events it polls for.
+ *
+ * @param transport Transport instance
+ * @return Bus errors (0 before the first status read)
+ */
+uint32_t can_transport_get_bus_errors(can_transport_t* transport);
+
+/**
+ * @brief Advance bus-off recovery by one step
+ *
+ * From CAN_BUS_OFF this starts the recovery sequence; from CAN_BUS_STOPPED it
+ * restarts the controller. Recovery completes asynchronously: poll
+ * can_transport_get_status until the state is back to error-active.
+ *
+ * @param transport Transport instance
+ * @return CAN_OK if a step was taken, CAN_ERR_INVALID_ARG if the backend
+ *         cannot recover by itself
+ */
+can_err_t can_transport_recover(can_transport_t* transport);
+
+/**
+ * @brief Mark the bus as down (sends fail with CAN_ERR_BUS_OFF) or up again
+ * @param transport Transport instance
+ * @param down true while the controller is bus-off or recovering
+ */
+void can_transport_set_bus_off(can_transport_t* transport, bool down);
+
+/**
+ * @brief Get a human readable name for a bus state
+ * @param state Bus state
+ * @return Static string
+ */
+const char* can_bus_state_to_name(can_bus_state_t state);
+
+/**
+ * @brief Receive the next frame passing the acceptance filters
+ * @param transport Transport instance
+ * @param frame Output frame (timestamp_us is set to the capture time)
+ * @param timeout_ms Maximum time to wait
+ * @return CAN_OK on success, CAN_ERR_TIMEOUT if nothing arrived
+ */
+can_err_t can_transport_recv(can_transport_t* transport, can_frame_t* frame, uint32_t timeout_ms);
+
+/**
+ * @brief Replace the acceptance filters (count 0 accepts everything)
+ * @param transport Transport instance
+ * @param filters Filter array
+ * @param count Number of filters
+ * @return CAN_OK on success
+ */
+can_err_t can_transport_set_filters(can_transport_t* transport, const can_filter_t* filters, uint8_t count);
+
+/**
+ * @brief Get transport statistics
+ * @param transport Transport instance
+ * @return Pointer to statistics
+ */
+const can_transport_stats_t* can_transport_get_stats(const can_transport_t* transport);
+
+/**
+ * @brief Get a human readable name for an error code
+ * @param err Error code
+ * @return Static string
+ */
+const char* can_err_to_name(can_err_t err);
+
+// ==================== Frame Helpers ====================
+
+/**
+ * @brief Check a frame against the transport's acceptance filters
+ * @param transport Transport instance
+ * @param frame Frame to check
+ * @return true if accepted
+ */
+bool can_transport_filter_match(const can_transport_t* transport, const can_frame_t* frame);
+
+/**
+ * @brief Build a frame from the manual-mode ID and DATA strings
+ * @param can_id ID string (e.g. "0x123"); IDs above 0x7FF become extended
+ * @param data Data string (e.g. "[0x01, 0x02, 0x03]"), up to 8 bytes
+ * @param frame Output frame
+ * @return true if both strings parsed
+ */
+bool can_frame_parse(const char* can_id, const char* data, can_frame_t* frame);
+
+/**
+ * @brief Format a frame as a log line ("CAN ID: 0x123 | Data: [0x01, 0x02]")
+ * @param frame Frame to format
+ * @param buf Output buffer
+ * @param size Buffer size
+ * @return Number of characters written (excluding terminator)
+ */
+int can_frame_format(const can_frame_t* frame, char* buf, size_t size);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // CAN_TRANSPORT_H
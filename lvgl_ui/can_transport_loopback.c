@@ -0,0 +1,209 @@
+/**
+ * @file can_transport_loopback.c
+ * @brief In-Process Loopback CAN Transport
+ *
+ * Software stand-in for a CAN bus: every open loopback transport with the
+ * same device name is a node on the same virtual bus, and a frame sent by one
+ * node is delivered to all the others (and to itself with receive_own).
+ * Works on any platform, so the full backend can be exercised off-target.
+ *
+ * can_transport_loopback_inject_bus_off() takes a node off the bus the way
+ * a TEC overflow would; recover() then walks it through the recovery
+ * sequence, so the health monitor can be tested without hardware.
+ */
+
+#include "can_transport.h"
+#include "can_port.h"
+#include <string.h>
+
+#define LOOPBACK_MAX_NODES   8
+#define LOOPBACK_QUEUE_LEN   256
+#define LOOPBACK_NAME_LEN    16
+#define LOOPBACK_RECOVERY_US 3000   // 128 x 11 recessive bits at 500 kbit/s
+
+typedef struct {
+    bool in_use;
+    bool receive_own;
+    char bus[LOOPBACK_NAME_LEN];
+    can_frame_t queue[LOOPBACK_QUEUE_LEN];
+    uint16_t head;
+    uint16_t count;
+    uint32_t overruns;
+    can_port_sem_t* rx_ready;
+    can_bus_state_t state;
+    uint64_t recovered_us;      // End of the simulated recovery sequence
+    uint32_t events;            // CAN_BUS_EVENT_* since the last status read
+} loopback_node_t;
+
+static loopback_node_t g_nodes[LOOPBACK_MAX_NODES];
+static can_port_mutex_t* g_bus_lock = NULL;   // Created by the first open()
+
+static can_err_t loopback_open(can_transport_t* transport, const can_transport_config_t* config) {
+    if (g_bus_lock == NULL) {
+        g_bus_lock = can_port_mutex_create();
+        if (g_bus_lock == NULL) {
+            return CAN_ERR_IO;
+        }
+    }
+
+    can_port_mutex_lock(g_bus_lock);
+    loopback_node_t* node = NULL;
+    for (uint8_t i = 0; i < LOOPBACK_MAX_NODES; i++) {
+        if (!g_nodes[i].in_use) {
+            node = &g_nodes[i];
+            break;
+        }
+    }
+    if (node == NULL) {
+        can_port_mutex_unlock(g_bus_lock);
+        return CAN_ERR_NO_SPACE;
+    }
+
+    if (node->rx_ready == NULL) {
+        node->rx_ready = can_port_sem_create();
+        if (node->rx_ready == NULL) {
+            can_port_mutex_unlock(g_bus_lock);
+            return CAN_ERR_IO;
+        }
+    }
+    node->in_use = true;
+    node->receive_own = config->receive_own;
+    node->head = 0;
+    node->count = 0;
+    node->overruns = 0;
+    node->state = CAN_BUS_ERROR_ACTIVE;
+    node->events = 0;
+    strncpy(node->bus, (config->device != NULL) ? config->device : "lo", sizeof(node->bus) - 1);
+    node->bus[sizeof(node->bus) - 1] = '\0';
+    can_port_mutex_unlock(g_bus_lock);
+
+    transport->backend = node;
+    return CAN_OK;
+}
+
+static void loopback_close(can_transport_t* transport) {
+    loopback_node_t* node = transport->backend;
+
+    can_port_mutex_lock(g_bus_lock);
+    node->in_use = false;
+    node->count = 0;
+    can_port_mutex_unlock(g_bus_lock);
+
+    // Wake a receiver blocked on this node so it sees the close
+    can_port_sem_give(node->rx_ready);
+    transport->backend = NULL;
+}
+
+static can_err_t loopback_send(can_transport_t* transport, const can_frame_t* frame, uint32_t timeout_ms) {
+    (void)timeout_ms;   // The virtual bus never blocks the sender
+    loopback_node_t* self = transport->backend;
+
+    can_frame_t wire = *frame;
+    wire.timestamp_us = can_port_time_us();
+
+    // State is written by get_status, recover and fault injection on other tasks
+    can_port_mutex_lock(g_bus_lock);
+    if (self->state != CAN_BUS_ERROR_ACTIVE) {
+        can_port_mutex_unlock(g_bus_lock);
+        return CAN_ERR_BUS_OFF;
+    }
+    for (uint8_t i = 0; i < LOOPBACK_MAX_NODES; i++) {
+        loopback_node_t* node = &g_nodes[i];
+        if (!node->in_use || strcmp(node->bus, self->bus) != 0) {
+            continue;
+        }
+        if (node == self && !self->receive_own) {
+            continue;
+        }
+        if (node->count >= LOOPBACK_QUEUE_LEN) {
+            node->overruns++;
+            node->events |= CAN_BUS_EVENT_RX_OVERRUN;
+            continue;
+        }
+        uint16_t tail = (uint16_t)((node->head + node->count) % LOOPBACK_QUEUE_LEN);
+        node->queue[tail] = wire;
+        node->count++;
+        can_port_sem_give(node->rx_ready);
+    }
+    can_port_mutex_unlock(g_bus_lock);
+    return CAN_OK;
+}
+
+static can_err_t loopback_recv(can_transport_t* transport, can_frame_t* frame, uint32_t timeout_ms) {
+    loopback_node_t* node = transport->backend;
+
+    for (;;) {
+        can_port_mutex_lock(g_bus_lock);
+        if (!node->in_use) {
+            can_port_mutex_unlock(g_bus_lock);
+            return CAN_ERR_NOT_OPEN;
+        }
+        if (node->count > 0) {
+            *frame = node->queue[node->head];
+            node->head = (uint16_t)((node->head + 1) % LOOPBACK_QUEUE_LEN);
+            node->count--;
+            can_port_mutex_unlock(g_bus_lock);
+            return CAN_OK;
+        }
+        can_port_mutex_unlock(g_bus_lock);
+
+        if (timeout_ms == 0 || !can_port_sem_take(node->rx_ready, timeout_ms)) {
+            return CAN_ERR_TIMEOUT;
+        }
+    }
+}
+
+static can_err_t loopback_get_status(can_transport_t* transport, can_bus_status_t* status) {
+    loopback_node_t* node = transport->backend;
+
+    can_port_mutex_lock(g_bus_lock);
+    if (node->state == CAN_BUS_RECOVERING && can_port_time_us() >= node->recovered_us) {
+        node->state = CAN_BUS_STOPPED;
+        node->events |= CAN_BUS_EVENT_RECOVERED;
+    }
+    memset(status, 0, sizeof(can_bus_status_t));
+    status->state = node->state;
+    status->tx_error_counter = (node->state == CAN_BUS_OFF) ? 256 : 0;
+    status->rx_overruns = node->overruns;
+    status->events = node->events;
+    node->events = 0;
+    can_port_mutex_unlock(g_bus_lock);
+    return CAN_OK;
+}
+
+static can_err_t loopback_recover(can_transport_t* transport) {
+    loopback_node_t* node = transport->backend;
+
+    can_port_mutex_lock(g_bus_lock);
+    if (node->state == CAN_BUS_OFF) {
+        node->state = CAN_BUS_RECOVERING;
+        node->recovered_us = can_port_time_us() + LOOPBACK_RECOVERY_US;
+    } else if (node->state == CAN_BUS_STOPPED) {
+        node->state = CAN_BUS_ERROR_ACTIVE;
+    }
+    can_port_mutex_unlock(g_bus_lock);
+    return CAN_OK;
+}
+
+void can_transport_loopback_inject_bus_off(can_transport_t* transport) {
+    if (transport == NULL || !transport->is_open || transport->ops != &can_transport_loopback_ops) {
+        return;
+    }
+    loopback_node_t* node = transport->backend;
+
+    can_port_mutex_lock(g_bus_lock);
+    node->state = CAN_BUS_OFF;
+    node->events |= CAN_BUS_EVENT_BUS_OFF;
+    can_port_mutex_unlock(g_bus_lock);
+}
+
+const can_transport_ops_t can_transport_loopback_ops = {
+    .name = "loopback",
+    .open = loopback_open,
+    .close = loopback_close,
+    .send = loopback_send,
+    .recv = loopback_recv,
+    .set_filters = NULL,    // Software filtering in can_transport.c
+    .get_status = loopback_get_status,
+    .recover = loopback_recover
+};
@@ -0,0 +1,564 @@
+/**
+ * @file can_transport_slcan.c
+ * @brief SLCAN (Lawicel ASCII) Serial Transport
+ *
+ * Frames travel as SLCAN lines over a byte stream: a UART or USB Serial/JTAG
+ * port on ESP32, a serial device or pseudo-terminal on POSIX hosts.
+ *
+ *   t<iii><l><dd..>\r        standard frame     r<iii><l>\r        standard RTR
+ *   T<iiiiiiii><l><dd..>\r   extended frame     R<iiiiiiii><l>\r   extended RTR
+ *
+ * Host mode (default) drives an SLCAN adapter and sends "C", "S<n>", "O" on
+ * open. Adapter mode (config->slcan_adapter) makes the panel the adapter: a
+ * PC running slcand sends commands and frames, and the transport answers
+ * them like a Lawicel device.
+ *
+ * Received bytes are parsed one at a time into a fixed line buffer. Sends
+ * are encoded into a batch buffer that goes out in one write when it fills
+ * or on can_transport_flush(), which the TX scheduler calls once per pass.
+ * Nothing is allocated after the port table.
+ */
+
+#ifndef ESP_PLATFORM
+#define _DEFAULT_SOURCE
+#endif
+
+#include "can_transport.h"
+#include "can_port.h"
+#include <string.h>
+
+#ifdef ESP_PLATFORM
+#include "freertos/FreeRTOS.h"
+#include "driver/uart.h"
+#include "driver/usb_serial_jtag.h"
+#else
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <termios.h>
+#include <unistd.h>
+#endif
+
+#define SLCAN_MAX_PORTS         2
+#define SLCAN_LINE_MAX          32      // "T" + 8 ID + DLC + 16 data + 4 timestamp
+#define SLCAN_RX_CHUNK          256     // Bytes read per serial read
+#define SLCAN_TX_BATCH          1024    // Encoded lines per write (~45 frames)
+#define SLCAN_FLUSH_TIMEOUT_MS  20
+#define SLCAN_DEFAULT_BAUD      115200
+#define SLCAN_SERIAL_BUF        4096    // Driver ring buffers (ESP32)
+
+// ==================== Serial Port ====================
+
+typedef struct {
+#ifdef ESP_PLATFORM
+    int uart;                   // UART number, -1 for USB Serial/JTAG
+#else
+    int fd;
+#endif
+} slcan_serial_t;
+
+#ifdef ESP_PLATFORM
+
+static TickType_t timeout_to_ticks(uint32_t timeout_ms) {
+    return (timeout_ms == CAN_PORT_WAIT_FOREVER) ? portMAX_DELAY : pdMS_TO_TICKS(timeout_ms);
+}
+
+// device: "usb" (USB Serial/JTAG CDC) or "uart0".."uart2"
+static can_err_t serial_open(slcan_serial_t* serial, const can_transport_config_t* config) {
+    const char* dev = (config->device != NULL) ? config->device : "usb";
+
+    if (strcmp(dev, "usb") == 0) {
+        usb_serial_jtag_driver_config_t usb_config = {
+            .rx_buffer_size = SLCAN_SERIAL_BUF,
+            .tx_buffer_size = SLCAN_SERIAL_BUF
+        };
+        if (usb_serial_jtag_driver_install(&usb_config) != ESP_OK) {
+            return CAN_ERR_IO;
+        }
+        serial->uart = -1;
+        return CAN_OK;
+    }
+
+    if (strncmp(dev, "uart", 4) != 0 || dev[4] < '0' || dev[4] >= '0' + UART_NUM_MAX || dev[5] != '\0') {
+        return CAN_ERR_INVALID_ARG;
+    }
+    int num = dev[4] - '0';
+    uart_config_t uart_config = {
+        .baud_rate = (int)((config->serial_baud != 0) ? config->serial_baud : SLCAN_DEFAULT_BAUD),
+        .data_bits = UART_DATA_8_BITS,
+        .parity = UART_PARITY_DISABLE,
+        .stop_bits = UART_STOP_BITS_1,
+        .flow_ctrl = UART_HW_FLOWCTRL_DISABLE,
+        .source_clk = UART_SCLK_DEFAULT
+    };
+    if (uart_driver_install(num, SLCAN_SERIAL_BUF, SLCAN_SERIAL_BUF, 0, NULL, 0) != ESP_OK) {
+        return CAN_ERR_IO;
+    }
+    if (uart_param_config(num, &uart_config) != ESP_OK ||
+        uart_set_pin(num, config->tx_pin, config->rx_pin, UART_PIN_NO_CHANGE, UART_PIN_NO_CHANGE) != ESP_OK) {
+        uart_driver_delete(num);
+        return CAN_ERR_IO;
+    }
+    serial->uart = num;
+    return CAN_OK;
+}
+
+static void serial_close(slcan_serial_t* serial) {
+    if (serial->uart < 0) {
+        usb_serial_jtag_driver_uninstall();
+    } else {
+        uart_driver_delete(serial->uart);
+    }
+}
+
+// Returns bytes read (0 on timeout) or -1 on error
+static int serial_read(slcan_serial_t* serial, uint8_t* buf, size_t size, uint32_t timeout_ms) {
+    if (serial->uart < 0) {
+        return usb_serial_jtag_read_bytes(buf, size, timeout_to_ticks(timeout_ms));
+    }
+
+    // Wait for the first byte, then take whatever else is already buffered
+    int n = uart_read_bytes(serial->uart, buf, 1, timeout_to_ticks(timeout_ms));
+    if (n == 1) {
+        size_t avail = 0;
+        uart_get_buffered_data_len(serial->uart, &avail);
+        if (avail > size - 1) {
+            avail = size - 1;
+        }
+        if (avail > 0) {
+            int more = uart_read_bytes(serial->uart, buf + 1, avail, 0);
+            n += (more > 0) ? more : 0;
+        }
+    }
+    return n;
+}
+
+// Returns bytes written
+static size_t serial_write(slcan_serial_t* serial, const char* data, size_t len, uint32_t timeout_ms) {
+    int n;
+    if (serial->uart < 0) {
+        n = usb_serial_jtag_write_bytes(data, len, timeout_to_ticks(timeout_ms));
+    } else {
+        n = uart_write_bytes(serial->uart, data, len);
+    }
+    return (n > 0) ? (size_t)n : 0;
+}
+
+#else // POSIX
+
+static speed_t baud_to_speed(uint32_t baud) {
+    switch (baud) {
+        case 9600:    return B9600;
+        case 57600:   return B57600;
+        case 230400:  return B230400;
+#ifdef B921600
+        case 460800:  return B460800;
+        case 921600:  return B921600;
+#endif
+#ifdef B3000000
+        case 1000000: return B1000000;
+        case 2000000: return B2000000;
+        case 3000000: return B3000000;
+#endif
+        default:      return B115200;
+    }
+}
+
+// device: serial device or pty path ("/dev/ttyACM0", "/dev/pts/3")
+static can_err_t serial_open(slcan_serial_t* serial, const can_transport_config_t* config) {
+    if (config->device == NULL) {
+        return CAN_ERR_INVALID_ARG;
+    }
+    int fd = open(config->device, O_RDWR | O_NOCTTY | O_NONBLOCK);
+    if (fd < 0) {
+        return CAN_ERR_INVALID_ARG;
+    }
+
+    // Raw 8N1; the rate matters for real UARTs only (ptys and CDC ignore it)
+    if (isatty(fd)) {
+        struct termios tio;
+        if (tcgetattr(fd, &tio) == 0) {
+            speed_t speed = baud_to_speed((config->serial_baud != 0) ? config->serial_baud : SLCAN_DEFAULT_BAUD);
+            cfmakeraw(&tio);
+            cfsetispeed(&tio, speed);
+            cfsetospeed(&tio, speed);
+            tcsetattr(fd, TCSANOW, &tio);
+        }
+    }
+    serial->fd = fd;
+    return CAN_OK;
+}
+
+static void serial_close(slcan_serial_t* serial) {
+    close(serial->fd);
+}
+
+// Returns bytes read (0 on timeout) or -1 on error
+static int serial_read(slcan_serial_t* serial, uint8_t* buf, size_t size, uint32_t timeout_ms) {
+    struct pollfd pfd = {.fd = serial->fd, .events = POLLIN};
+    int ready = poll(&pfd, 1, (timeout_ms == CAN_PORT_WAIT_FOREVER) ? -1 : (int)timeout_ms);
+    if (ready <= 0) {
+        return (ready == 0 || errno == EINTR) ? 0 : -1;
+    }
+    if ((pfd.revents & POLLIN) == 0) {
+        // Peer gone (e.g. pty master closed): report it without spinning
+        can_port_sleep_ms((timeout_ms < 100) ? timeout_ms : 100);
+        return -1;
+    }
+    ssize_t n = read(serial->fd, buf, size);
+    if (n < 0) {
+        return (errno == EAGAIN || errno == EINTR) ? 0 : -1;
+    }
+    return (int)n;
+}
+
+// Returns bytes written
+static size_t serial_write(slcan_serial_t* serial, const char* data, size_t len, uint32_t timeout_ms) {
+    size_t done = 0;
+    while (done < len) {
+        ssize_t n = write(serial->fd, data + done, len - done);
+        if (n > 0) {
+            done += (size_t)n;
+            continue;
+        }
+        if (n < 0 && errno != EAGAIN && errno != EINTR) {
+            break;
+        }
+        struct pollfd pfd = {.fd = serial->fd, .events = POLLOUT};
+        if (poll(&pfd, 1, (timeout_ms == CAN_PORT_WAIT_FOREVER) ? -1 : (int)timeout_ms) <= 0) {
+            break;
+        }
+    }
+    return done;
+}
+
+#endif // ESP_PLATFORM
+
+// ==================== Port State ====================
+
+typedef struct {
+    bool in_use;
+    bool adapter;               // Answer host commands (the panel is the adapter)
+    bool channel_open;          // Adapter mode: host sent O/L
+    slcan_serial_t serial;
+    can_port_mutex_t* tx_lock;  // TX batch: frames (TX task) and replies (RX task)
+
+    // RX: bytes read but not parsed yet, and the line being assembled
+    uint8_t rx_buf[SLCAN_RX_CHUNK];
+    uint16_t rx_pos;
+    uint16_t rx_len;
+    char line[SLCAN_LINE_MAX];
+    uint8_t line_len;
+    bool line_overflow;
+
+    // TX: encoded lines waiting for one write
+    char tx_buf[SLCAN_TX_BATCH];
+    uint16_t tx_len;
+} slcan_port_t;
+
+// Opened and closed from one task (the UI task's connection callback)
+static slcan_port_t g_ports[SLCAN_MAX_PORTS];
+
+static const char HEX_DIGITS[] = "0123456789ABCDEF";
+
+// ==================== Encoding ====================
+
+static uint8_t slcan_encode(const can_frame_t* frame, char* out) {
+    bool ext = (frame->flags & CAN_FRAME_FLAG_EXT) != 0;
+    bool rtr = (frame->flags & CAN_FRAME_FLAG_RTR) != 0;
+    uint32_t id = frame->id & (ext ? CAN_EXT_ID_MASK : CAN_STD_ID_MASK);
+    uint8_t n = 0;
+
+    out[n++] = rtr ? (ext ? 'R' : 'r') : (ext ? 'T' : 't');
+    for (int shift = ext ? 28 : 8; shift >= 0; shift -= 4) {
+        out[n++] = HEX_DIGITS[(id >> shift) & 0xF];
+    }
+    out[n++] = (char)('0' + frame->dlc);
+    if (!rtr) {
+        for (uint8_t i = 0; i < frame->dlc; i++) {
+            out[n++] = HEX_DIGITS[frame->data[i] >> 4];
+            out[n++] = HEX_DIGITS[frame->data[i] & 0xF];
+        }
+    }
+    out[n++] = '\r';
+    return n;
+}
+
+static int hex_nibble(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    return -1;
+}
+
+static bool hex_field(const char* s, uint8_t digits, uint32_t* out) {
+    uint32_t v = 0;
+    for (uint8_t i = 0; i < digits; i++) {
+        int nib = hex_nibble(s[i]);
+        if (nib < 0) {
+            return false;
+        }
+        v = (v << 4) | (uint32_t)nib;
+    }
+    *out = v;
+    return true;
+}
+
+// Decode a t/T/r/R line (without CR); a trailing 4-digit timestamp is ignored
+static bool slcan_decode(const char* line, uint8_t len, can_frame_t* frame) {
+    bool ext = (line[0] == 'T' || line[0] == 'R');
+    bool rtr = (line[0] == 'r' || line[0] == 'R');
+    uint8_t id_digits = ext ? 8 : 3;
+    uint32_t id;
+    uint32_t dlc;
+
+    if (len < 2 + id_digits ||
+        !hex_field(&line[1], id_digits, &id) ||
+        !hex_field(&line[1 + id_digits], 1, &dlc) ||
+        dlc > CAN_MAX_DLC || id > (ext ? CAN_EXT_ID_MASK : CAN_STD_ID_MASK)) {
+        return false;
+    }
+    uint8_t data_digits = rtr ? 0 : (uint8_t)(dlc * 2);
+    uint8_t rest = len - (2 + id_digits);
+    if (rest != data_digits && rest != data_digits + 4) {
+        return false;
+    }
+
+    memset(frame, 0, sizeof(can_frame_t));
+    frame->id = id;
+    frame->dlc = (uint8_t)dlc;
+    frame->flags = (ext ? CAN_FRAME_FLAG_EXT : 0) | (rtr ? CAN_FRAME_FLAG_RTR : 0);
+    const char* p = &line[2 + id_digits];
+    for (uint8_t i = 0; i < data_digits / 2; i++) {
+        uint32_t byte;
+        if (!hex_field(&p[i * 2], 2, &byte)) {
+            return false;
+        }
+        frame->data[i] = (uint8_t)byte;
+    }
+    return true;
+}
+
+// ==================== TX Batch ====================
+
+// Write the batch (tx_lock held); keeps what did not fit in time
+static can_err_t tx_write_locked(slcan_port_t* port, uint32_t timeout_ms) {
+    if (port->tx_len == 0) {
+        return CAN_OK;
+    }
+    size_t done = serial_write(&port->serial, port->tx_buf, port->tx_len, timeout_ms);
+    if (done < port->tx_len) {
+        memmove(port->tx_buf, port->tx_buf + done, port->tx_len - done);
+        port->tx_len -= (uint16_t)done;
+        return CAN_ERR_TIMEOUT;
+    }
+    port->tx_len = 0;
+    return CAN_OK;
+}
+
+static can_err_t tx_append(slcan_port_t* port, const char* text, size_t len, uint32_t timeout_ms) {
+    can_err_t err = CAN_OK;
+    can_port_mutex_lock(port->tx_lock);
+    if (port->tx_len + len > sizeof(port->tx_buf)) {
+        err = tx_write_locked(port, timeout_ms);
+    }
+    if (err == CAN_OK) {
+        memcpy(port->tx_buf + port->tx_len, text, len);
+        port->tx_len += (uint16_t)len;
+    }
+    can_port_mutex_unlock(port->tx_lock);
+    return err;
+}
+
+static void tx_flush(slcan_port_t* port) {
+    can_port_mutex_lock(port->tx_lock);
+    tx_write_locked(port, SLCAN_FLUSH_TIMEOUT_MS);
+    can_port_mutex_unlock(port->tx_lock);
+}
+
+static void reply(slcan_port_t* port, const char* text) {
+    tx_append(port, text, strlen(text), SLCAN_FLUSH_TIMEOUT_MS);
+}
+
+// ==================== Line Handling ====================
+
+static char bitrate_code(uint32_t bitrate) {
+    switch (bitrate) {
+        case 10000:   return '0';
+        case 20000:   return '1';
+        case 50000:   return '2';
+        case 100000:  return '3';
+        case 125000:  return '4';
+        case 250000:  return '5';
+        case 500000:  return '6';
+        case 800000:  return '7';
+        case 1000000: return '8';
+        default:      return '\0';
+    }
+}
+
+// Handle one complete line; true if it produced a frame
+static bool handle_line(slcan_port_t* port, can_frame_t* frame) {
+    const char* line = port->line;
+    uint8_t len = port->line_len;
+    char kind = line[0];
+    bool is_frame = (kind == 't' || kind == 'T' || kind == 'r' || kind == 'R');
+
+    if (!port->adapter) {
+        // Host mode: anything else is an adapter reply (z/Z ack, version, ...)
+        return is_frame && slcan_decode(line, len, frame);
+    }
+
+    if (is_frame) {
+        bool ok = port->channel_open && slcan_decode(line, len, frame);
+        reply(port, !ok ? "\a" : (kind == 't' || kind == 'r') ? "z\r" : "Z\r");
+        return ok;
+    }
+    switch (kind) {
+        case 'O':
+        case 'L':
+            port->channel_open = true;
+            reply(port, "\r");
+            break;
+        case 'C':
+            port->channel_open = false;
+            reply(port, "\r");
+            break;
+        case 'V': reply(port, "V1013\r"); break;
+        case 'N': reply(port, "N0001\r"); break;
+        case 'F': reply(port, "F00\r"); break;
+        case 'S': case 's': case 'M': case 'm': case 'Z': case 'Q': case 'W': case 'X':
+            reply(port, "\r");  // Accepted; bus timing belongs to the real transport
+            break;
+        default:
+            reply(port, "\a");
+            break;
+    }
+    return false;
+}
+
+// ==================== Backend Operations ====================
+
+static can_err_t slcan_open(can_transport_t* transport, const can_transport_config_t* config) {
+    char code = bitrate_code(config->bitrate);
+    if (!config->slcan_adapter && code == '\0') {
+        return CAN_ERR_INVALID_ARG;
+    }
+
+    slcan_port_t* port = NULL;
+    for (uint8_t i = 0; i < SLCAN_MAX_PORTS; i++) {
+        if (!g_ports[i].in_use) {
+            port = &g_ports[i];
+            break;
+        }
+    }
+    if (port == NULL) {
+        return CAN_ERR_NO_SPACE;
+    }
+    if (port->tx_lock == NULL) {
+        port->tx_lock = can_port_mutex_create();
+        if (port->tx_lock == NULL) {
+            return CAN_ERR_IO;
+        }
+    }
+
+    can_err_t err = serial_open(&port->serial, config);
+    if (err != CAN_OK) {
+        return err;
+    }
+    port->in_use = true;
+    port->adapter = config->slcan_adapter;
+    port->channel_open = false;
+    port->rx_pos = 0;
+    port->rx_len = 0;
+    port->line_len = 0;
+    port->line_overflow = false;
+    port->tx_len = 0;
+    transport->backend = port;
+
+    if (!port->adapter) {
+        // Clear a half-sent line, then close, set the bitrate and open the channel
+        char init[] = "\rC\rS0\rO\r";
+        init[4] = code;
+        tx_append(port, init, sizeof(init) - 1, SLCAN_FLUSH_TIMEOUT_MS);
+        tx_flush(port);
+    }
+    return CAN_OK;
+}
+
+static void slcan_close(can_transport_t* transport) {
+    slcan_port_t* port = transport->backend;
+    if (!port->adapter) {
+        tx_append(port, "C\r", 2, SLCAN_FLUSH_TIMEOUT_MS);
+    }
+    tx_flush(port);
+    serial_close(&port->serial);
+    port->in_use = false;
+    transport->backend = NULL;
+}
+
+static can_err_t slcan_send(can_transport_t* transport, const can_frame_t* frame, uint32_t timeout_ms) {
+    slcan_port_t* port = transport->backend;
+    char line[SLCAN_LINE_MAX];
+    uint8_t len = slcan_encode(frame, line);
+    return tx_append(port, line, len, timeout_ms);
+}
+
+static void slcan_flush(can_transport_t* transport) {
+    tx_flush((slcan_port_t*)transport->backend);
+}
+
+static can_err_t slcan_recv(can_transport_t* transport, can_frame_t* frame, uint32_t timeout_ms) {
+    slcan_port_t* port = transport->backend;
+    uint64_t deadline = can_port_time_us() + (uint64_t)timeout_ms * 1000u;
+
+    for (;;) {
+        bool got = false;
+        while (!got && port->rx_pos < port->rx_len) {
+            char c = (char)port->rx_buf[port->rx_pos++];
+            if (c == '\r' || c == '\n' || c == '\a') {
+                if (port->line_len > 0 && !port->line_overflow) {
+                    got = handle_line(port, frame);
+                }
+                port->line_len = 0;
+                port->line_overflow = false;
+            } else if (port->line_len < SLCAN_LINE_MAX) {
+                port->line[port->line_len++] = c;
+            } else {
+                port->line_overflow = true;     // Garbage: drop until the next CR
+            }
+        }
+        if (port->adapter) {
+            tx_flush(port);     // Command replies and acks go out right away
+        }
+        if (got) {
+            return CAN_OK;
+        }
+
+        uint32_t wait_ms = timeout_ms;
+        if (timeout_ms != CAN_PORT_WAIT_FOREVER) {
+            uint64_t now = can_port_time_us();
+            wait_ms = (now < deadline) ? (uint32_t)((deadline - now + 999) / 1000u) : 0;
+        }
+        int n = serial_read(&port->serial, port->rx_buf, sizeof(port->rx_buf), wait_ms);
+        if (n < 0) {
+            return CAN_ERR_IO;
+        }
+        if (n == 0) {
+            return CAN_ERR_TIMEOUT;
+        }
+        port->rx_pos = 0;
+        port->rx_len = (uint16_t)n;
+    }
+}
+
+// Filtering is done in software in can_transport.c
+const can_transport_ops_t can_transport_slcan_ops = {
+    .name = "slcan",
+    .open = slcan_open,
+    .close = slcan_close,
+    .send = slcan_send,
+    .recv = slcan_recv,
+    .set_filters = NULL,
+    .flush = slcan_flush
+};
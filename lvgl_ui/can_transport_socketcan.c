@@ -0,0 +1,273 @@
+/**
+ * @file can_transport_socketcan.c
+ * @brief Linux SocketCAN Transport
+ *
+ * Raw CAN socket bound to a network interface. Works with real adapters
+ * (can0) and with the virtual bus driver:
+ *
+ *   sudo modprobe vcan
+ *   sudo ip link add dev vcan0 type vcan && sudo ip link set up vcan0
+ *
+ * The bitrate is configured on the interface (ip link), not here. So is
+ * bus-off recovery: the kernel restarts the controller after restart-ms
+ * (ip link set can0 type can restart-ms 100); error frames keep the status
+ * up to date in the meantime.
+ */
+
+#ifdef __linux__
+
+#define _DEFAULT_SOURCE
+
+#include "can_transport.h"
+#include "can_port.h"
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <poll.h>
+#include <net/if.h>
+#include <sys/ioctl.h>
+#include <sys/socket.h>
+#include <linux/can.h>
+#include <linux/can/raw.h>
+#include <linux/can/error.h>
+
+typedef struct {
+    int fd;
+    can_port_mutex_t* status_lock;
+    can_bus_status_t status;    // Updated from error frames by recv() (status_lock)
+} socketcan_backend_t;
+
+static int timeout_to_poll(uint32_t timeout_ms) {
+    return (timeout_ms == CAN_PORT_WAIT_FOREVER) ? -1 : (int)timeout_ms;
+}
+
+static can_err_t socketcan_open(can_transport_t* transport, const can_transport_config_t* config) {
+    const char* ifname = (config->device != NULL) ? config->device : "vcan0";
+
+    int fd = socket(PF_CAN, SOCK_RAW, CAN_RAW);
+    if (fd < 0) {
+        return CAN_ERR_IO;
+    }
+
+    struct ifreq ifr;
+    memset(&ifr, 0, sizeof(ifr));
+    strncpy(ifr.ifr_name, ifname, IFNAMSIZ - 1);
+    if (ioctl(fd, SIOCGIFINDEX, &ifr) < 0) {
+        close(fd);
+        return CAN_ERR_INVALID_ARG;
+    }
+
+    int recv_own = config->receive_own ? 1 : 0;
+    setsockopt(fd, SOL_CAN_RAW, CAN_RAW_RECV_OWN_MSGS, &recv_own, sizeof(recv_own));
+
+    can_err_mask_t err_mask = CAN_ERR_TX_TIMEOUT | CAN_ERR_CRTL | CAN_ERR_PROT | CAN_ERR_ACK |
+                              CAN_ERR_BUSOFF | CAN_ERR_BUSERROR | CAN_ERR_RESTARTED;
+    setsockopt(fd, SOL_CAN_RAW, CAN_RAW_ERR_FILTER, &err_mask, sizeof(err_mask));
+
+    struct sockaddr_can addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.can_family = AF_CAN;
+    addr.can_ifindex = ifr.ifr_ifindex;
+    if (bind(fd, (struct sockaddr*)&addr, sizeof(addr)) < 0) {
+        close(fd);
+        return CAN_ERR_IO;
+    }
+
+    socketcan_backend_t* backend = malloc(sizeof(socketcan_backend_t));
+    if (backend == NULL) {
+        close(fd);
+        return CAN_ERR_IO;
+    }
+    memset(backend, 0, sizeof(socketcan_backend_t));
+    backend->status_lock = can_port_mutex_create();
+    if (backend->status_lock == NULL) {
+        free(backend);
+        close(fd);
+        return CAN_ERR_IO;
+    }
+    backend->fd = fd;
+    transport->backend = backend;
+    return CAN_OK;
+}
+
+static void socketcan_close(can_transport_t* transport) {
+    socketcan_backend_t* backend = transport->backend;
+    close(backend->fd);
+    can_port_mutex_destroy(backend->status_lock);
+    free(backend);
+    transport->backend = NULL;
+}
+
+static can_err_t socketcan_send(can_transport_t* transport, const can_frame_t* frame, uint32_t timeout_ms) {
+    socketcan_backend_t* backend = transport->backend;
+
+    struct can_frame cf;
+    memset(&cf, 0, sizeof(cf));
+    cf.can_id = frame->id;
+    if (frame->flags & CAN_FRAME_FLAG_EXT) {
+        cf.can_id = (frame->id & CAN_EFF_MASK) | CAN_EFF_FLAG;
+    }
+    if (frame->flags & CAN_FRAME_FLAG_RTR) {
+        cf.can_id |= CAN_RTR_FLAG;
+    }
+    cf.can_dlc = frame->dlc;
+    memcpy(cf.data, frame->data, frame->dlc);
+
+    for (;;) {
+        ssize_t n = write(backend->fd, &cf, sizeof(cf));
+        if (n == (ssize_t)sizeof(cf)) {
+            return CAN_OK;
+        }
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n < 0 && (errno == ENOBUFS || errno == EAGAIN)) {
+            // TX queue of the interface is full: wait for room
+            struct pollfd pfd = { .fd = backend->fd, .events = POLLOUT };
+            int ready = poll(&pfd, 1, timeout_to_poll(timeout_ms));
+            if (ready <= 0) {
+                return CAN_ERR_TIMEOUT;
+            }
+            continue;
+        }
+        return CAN_ERR_IO;
+    }
+}
+
+/**
+ * @brief Fold a kernel error frame into the cached status (status_lock held)
+ */
+static void socketcan_on_error(socketcan_backend_t* backend, const struct can_frame* cf) {
+    can_bus_status_t* st = &backend->status;
+
+    if (cf->can_id & (CAN_ERR_PROT | CAN_ERR_ACK | CAN_ERR_BUSERROR)) {
+        st->bus_errors++;
+        st->events |= CAN_BUS_EVENT_BUS_ERROR;
+    }
+    if (cf->can_id & CAN_ERR_TX_TIMEOUT) {
+        st->events |= CAN_BUS_EVENT_TX_FAILED;
+    }
+    if (cf->can_id & CAN_ERR_CRTL) {
+        uint8_t ctrl = cf->data[1];
+        if (ctrl & CAN_ERR_CRTL_RX_OVERFLOW) {
+            st->rx_overruns++;
+            st->events |= CAN_BUS_EVENT_RX_OVERRUN;
+        }
+        if (ctrl & (CAN_ERR_CRTL_TX_PASSIVE | CAN_ERR_CRTL_RX_PASSIVE)) {
+            st->state = CAN_BUS_ERROR_PASSIVE;
+            st->events |= CAN_BUS_EVENT_ERR_PASSIVE;
+        } else if (ctrl & (CAN_ERR_CRTL_TX_WARNING | CAN_ERR_CRTL_RX_WARNING)) {
+            st->state = CAN_BUS_ERROR_WARNING;
+            st->events |= CAN_BUS_EVENT_ERR_WARNING;
+        } else if (ctrl & CAN_ERR_CRTL_ACTIVE) {
+            st->state = CAN_BUS_ERROR_ACTIVE;
+        }
+    }
+#ifdef CAN_ERR_CNT
+    if (cf->can_id & CAN_ERR_CNT) {
+        st->tx_error_counter = cf->data[6];
+        st->rx_error_counter = cf->data[7];
+    }
+#endif
+    if (cf->can_id & CAN_ERR_BUSOFF) {
+        st->state = CAN_BUS_OFF;
+        st->events |= CAN_BUS_EVENT_BUS_OFF;
+    }
+    if (cf->can_id & CAN_ERR_RESTARTED) {
+        st->state = CAN_BUS_ERROR_ACTIVE;
+        st->tx_error_counter = 0;
+        st->rx_error_counter = 0;
+        st->events |= CAN_BUS_EVENT_RECOVERED;
+    }
+}
+
+static can_err_t socketcan_recv(can_transport_t* transport, can_frame_t* frame, uint32_t timeout_ms) {
+    socketcan_backend_t* backend = transport->backend;
+
+    struct pollfd pfd = { .fd = backend->fd, .events = POLLIN };
+    int ready = poll(&pfd, 1, timeout_to_poll(timeout_ms));
+    if (ready == 0) {
+        return CAN_ERR_TIMEOUT;
+    }
+    if (ready < 0) {
+        return (errno == EINTR) ? CAN_ERR_TIMEOUT : CAN_ERR_IO;
+    }
+
+    struct can_frame cf;
+    ssize_t n = read(backend->fd, &cf, sizeof(cf));
+    if (n != (ssize_t)sizeof(cf)) {
+        return CAN_ERR_IO;
+    }
+    if (cf.can_id & CAN_ERR_FLAG) {
+        can_port_mutex_lock(backend->status_lock);
+        socketcan_on_error(backend, &cf);
+        can_port_mutex_unlock(backend->status_lock);
+        return CAN_ERR_TIMEOUT;     // Not a data frame; the caller polls again
+    }
+
+    memset(frame, 0, sizeof(can_frame_t));
+    frame->timestamp_us = can_port_time_us();
+    if (cf.can_id & CAN_EFF_FLAG) {
+        frame->id = cf.can_id & CAN_EFF_MASK;
+        frame->flags |= CAN_FRAME_FLAG_EXT;
+    } else {
+        frame->id = cf.can_id & CAN_SFF_MASK;
+    }
+    if (cf.can_id & CAN_RTR_FLAG) {
+        frame->flags |= CAN_FRAME_FLAG_RTR;
+    }
+    frame->dlc = (cf.can_dlc > CAN_MAX_DLC) ? CAN_MAX_DLC : cf.can_dlc;
+    memcpy(frame->data, cf.data, frame->dlc);
+    return CAN_OK;
+}
+
+static can_err_t socketcan_set_filters(can_transport_t* transport, const can_filter_t* filters, uint8_t count) {
+    socketcan_backend_t* backend = transport->backend;
+    struct can_filter kfilters[CAN_TRANSPORT_MAX_FILTERS];
+
+    for (uint8_t i = 0; i < count; i++) {
+        if (filters[i].extended) {
+            kfilters[i].can_id = (filters[i].id & CAN_EFF_MASK) | CAN_EFF_FLAG;
+            kfilters[i].can_mask = (filters[i].mask & CAN_EFF_MASK) | CAN_EFF_FLAG;
+        } else {
+            kfilters[i].can_id = filters[i].id & CAN_SFF_MASK;
+            kfilters[i].can_mask = (filters[i].mask & CAN_SFF_MASK) | CAN_EFF_FLAG;
+        }
+    }
+
+    // An empty filter list in the kernel means "receive nothing", so
+    // count 0 installs the default accept-all filter instead
+    struct can_filter accept_all = { .can_id = 0, .can_mask = 0 };
+    const struct can_filter* table = (count > 0) ? kfilters : &accept_all;
+    socklen_t len = (socklen_t)(((count > 0) ? count : 1) * sizeof(struct can_filter));
+
+    if (setsockopt(backend->fd, SOL_CAN_RAW, CAN_RAW_FILTER, table, len) < 0) {
+        return CAN_ERR_IO;
+    }
+    return CAN_OK;
+}
+
+static can_err_t socketcan_get_status(can_transport_t* transport, can_bus_status_t* status) {
+    socketcan_backend_t* backend = transport->backend;
+
+    // recv() folds error frames in on the RX task; the monitor may poll elsewhere
+    can_port_mutex_lock(backend->status_lock);
+    *status = backend->status;
+    backend->status.events = 0;
+    can_port_mutex_unlock(backend->status_lock);
+    return CAN_OK;
+}
+
+const can_transport_ops_t can_transport_socketcan_ops = {
+    .name = "socketcan",
+    .open = socketcan_open,
+    .close = socketcan_close,
+    .send = socketcan_send,
+    .recv = socketcan_recv,
+    .set_filters = socketcan_set_filters,
+    .get_status = socketcan_get_status,
+    .recover = NULL         // Kernel restart-ms
+};
+
+#endif // __linux__
@@ -0,0 +1,234 @@
+/**
+ * @file can_transport_twai.c
+ * @brief ESP32 TWAI CAN Transport
+ *
+ * Wraps the ESP-IDF TWAI driver (handle-based v2 API, so chips with two
+ * controllers can run one transport per bus). Each controller has a single
+ * acceptance filter, so multiple software filters are merged into the widest
+ * mask covering all of them and the exact match is done in can_transport.c.
+ *
+ * Fault confinement is reported through the driver's alerts and status info;
+ * bus-off recovery is initiate_recovery, then start once the controller has
+ * seen 128 x 11 recessive bits and stopped.
+ */
+
+#ifdef ESP_PLATFORM
+
+#include "can_transport.h"
+#include "can_port.h"
+#include "freertos/FreeRTOS.h"
+#include "driver/twai.h"
+#include "soc/soc_caps.h"
+#include <string.h>
+
+#define TWAI_HEALTH_ALERTS  (TWAI_ALERT_BUS_ERROR | TWAI_ALERT_ABOVE_ERR_WARN | TWAI_ALERT_ERR_PASS | \
+                             TWAI_ALERT_BUS_OFF | TWAI_ALERT_BUS_RECOVERED | TWAI_ALERT_RX_QUEUE_FULL | \
+                             TWAI_ALERT_TX_FAILED)
+
+typedef struct {
+    twai_handle_t handle;       // NULL while the controller is free
+    bool receive_own;
+} twai_backend_t;
+
+// One slot per hardware controller (config->controller)
+static twai_backend_t g_controllers[SOC_TWAI_CONTROLLER_NUM];
+
+static bool twai_timing_for_bitrate(uint32_t bitrate, twai_timing_config_t* timing) {
+    switch (bitrate) {
+        case 125000:  *timing = (twai_timing_config_t)TWAI_TIMING_CONFIG_125KBITS(); return true;
+        case 250000:  *timing = (twai_timing_config_t)TWAI_TIMING_CONFIG_250KBITS(); return true;
+        case 500000:  *timing = (twai_timing_config_t)TWAI_TIMING_CONFIG_500KBITS(); return true;
+        case 800000:  *timing = (twai_timing_config_t)TWAI_TIMING_CONFIG_800KBITS(); return true;
+        case 1000000: *timing = (twai_timing_config_t)TWAI_TIMING_CONFIG_1MBITS();   return true;
+        default:      return false;
+    }
+}
+
+static TickType_t timeout_to_ticks(uint32_t timeout_ms) {
+    return (timeout_ms == CAN_PORT_WAIT_FOREVER) ? portMAX_DELAY : pdMS_TO_TICKS(timeout_ms);
+}
+
+/**
+ * @brief Merge filters into one TWAI single-filter configuration
+ */
+static twai_filter_config_t twai_merge_filters(const can_filter_t* filters, uint8_t count) {
+    if (count == 0) {
+        return (twai_filter_config_t)TWAI_FILTER_CONFIG_ACCEPT_ALL();
+    }
+
+    // Bits that are cared about by every filter and agree across all of them
+    bool extended = filters[0].extended;
+    uint32_t care = filters[0].mask;
+    uint32_t code = filters[0].id & filters[0].mask;
+    for (uint8_t i = 1; i < count; i++) {
+        if (filters[i].extended != extended) {
+            return (twai_filter_config_t)TWAI_FILTER_CONFIG_ACCEPT_ALL();
+        }
+        care &= filters[i].mask & ~((filters[i].id ^ code) & care);
+        code &= care;
+    }
+
+    // TWAI single filter: ID is left aligned in the 32-bit acceptance
+    // register and mask bits set to 1 mean "don't care"
+    twai_filter_config_t f = {
+        .single_filter = true
+    };
+    if (extended) {
+        f.acceptance_code = (code & CAN_EXT_ID_MASK) << 3;
+        f.acceptance_mask = ~((care & CAN_EXT_ID_MASK) << 3);
+    } else {
+        f.acceptance_code = (code & CAN_STD_ID_MASK) << 21;
+        f.acceptance_mask = ~((care & CAN_STD_ID_MASK) << 21);
+    }
+    return f;
+}
+
+static can_err_t twai_open(can_transport_t* transport, const can_transport_config_t* config) {
+    twai_timing_config_t t_config;
+    if (config->controller >= SOC_TWAI_CONTROLLER_NUM ||
+        !twai_timing_for_bitrate(config->bitrate, &t_config)) {
+        return CAN_ERR_INVALID_ARG;
+    }
+    twai_backend_t* backend = &g_controllers[config->controller];
+    if (backend->handle != NULL) {
+        return CAN_ERR_NO_SPACE;    // Controller owned by another transport
+    }
+
+    twai_general_config_t g_config = TWAI_GENERAL_CONFIG_DEFAULT_V2(
+        config->controller, config->tx_pin, config->rx_pin, TWAI_MODE_NORMAL);
+    g_config.alerts_enabled = TWAI_HEALTH_ALERTS;
+    twai_filter_config_t f_config = twai_merge_filters(transport->filters, transport->filter_count);
+
+    if (twai_driver_install_v2(&g_config, &t_config, &f_config, &backend->handle) != ESP_OK) {
+        backend->handle = NULL;
+        return CAN_ERR_IO;
+    }
+    if (twai_start_v2(backend->handle) != ESP_OK) {
+        twai_driver_uninstall_v2(backend->handle);
+        backend->handle = NULL;
+        return CAN_ERR_IO;
+    }
+    backend->receive_own = config->receive_own;
+    transport->backend = backend;
+    return CAN_OK;
+}
+
+static void twai_close(can_transport_t* transport) {
+    twai_backend_t* backend = (twai_backend_t*)transport->backend;
+    twai_stop_v2(backend->handle);
+    twai_driver_uninstall_v2(backend->handle);
+    backend->handle = NULL;
+    transport->backend = NULL;
+}
+
+static can_err_t twai_send(can_transport_t* transport, const can_frame_t* frame, uint32_t timeout_ms) {
+    twai_backend_t* backend = (twai_backend_t*)transport->backend;
+
+    twai_message_t msg = {0};
+    msg.identifier = frame->id;
+    msg.extd = (frame->flags & CAN_FRAME_FLAG_EXT) ? 1 : 0;
+    msg.rtr = (frame->flags & CAN_FRAME_FLAG_RTR) ? 1 : 0;
+    msg.self = backend->receive_own ? 1 : 0;    // Self reception request
+    msg.data_length_code = frame->dlc;
+    memcpy(msg.data, frame->data, frame->dlc);
+
+    esp_err_t err = twai_transmit_v2(backend->handle, &msg, timeout_to_ticks(timeout_ms));
+    if (err == ESP_OK) {
+        return CAN_OK;
+    }
+    if (err == ESP_ERR_INVALID_STATE) {
+        return CAN_ERR_BUS_OFF;     // Driver not running: bus-off or recovering
+    }
+    return (err == ESP_ERR_TIMEOUT) ? CAN_ERR_TIMEOUT : CAN_ERR_IO;
+}
+
+static can_err_t twai_recv(can_transport_t* transport, can_frame_t* frame, uint32_t timeout_ms) {
+    twai_backend_t* backend = (twai_backend_t*)transport->backend;
+
+    twai_message_t msg;
+    esp_err_t err = twai_receive_v2(backend->handle, &msg, timeout_to_ticks(timeout_ms));
+    if (err != ESP_OK) {
+        return (err == ESP_ERR_TIMEOUT) ? CAN_ERR_TIMEOUT : CAN_ERR_IO;
+    }
+
+    memset(frame, 0, sizeof(can_frame_t));
+    frame->timestamp_us = can_port_time_us();
+    frame->id = msg.identifier;
+    frame->flags = (msg.extd ? CAN_FRAME_FLAG_EXT : 0) | (msg.rtr ? CAN_FRAME_FLAG_RTR : 0);
+    frame->dlc = (msg.data_length_code > CAN_MAX_DLC) ? CAN_MAX_DLC : msg.data_length_code;
+    memcpy(frame->data, msg.data, frame->dlc);
+    return CAN_OK;
+}
+
+static can_err_t twai_get_status(can_transport_t* transport, can_bus_status_t* status) {
+    twai_backend_t* backend = (twai_backend_t*)transport->backend;
+
+    twai_status_info_t info;
+    if (twai_get_status_info_v2(backend->handle, &info) != ESP_OK) {
+        return CAN_ERR_IO;
+    }
+
+    memset(status, 0, sizeof(can_bus_status_t));
+    status->tx_error_counter = info.tx_error_counter;
+    status->rx_error_counter = info.rx_error_counter;
+    status->bus_errors = info.bus_error_count;
+    status->rx_overruns = info.rx_missed_count + info.rx_overrun_count;
+
+    switch (info.state) {
+        case TWAI_STATE_BUS_OFF:    status->state = CAN_BUS_OFF; break;
+        case TWAI_STATE_RECOVERING: status->state = CAN_BUS_RECOVERING; break;
+        case TWAI_STATE_STOPPED:    status->state = CAN_BUS_STOPPED; break;
+        default: {
+            uint32_t worst = (info.tx_error_counter > info.rx_error_counter) ?
+                             info.tx_error_counter : info.rx_error_counter;
+            status->state = (worst >= 128) ? CAN_BUS_ERROR_PASSIVE :
+                            (worst >= 96)  ? CAN_BUS_ERROR_WARNING : CAN_BUS_ERROR_ACTIVE;
+            break;
+        }
+    }
+
+    // Alerts latch in the driver until read, so short excursions between
+    // two polls are not lost
+    uint32_t alerts = 0;
+    if (twai_read_alerts_v2(backend->handle, &alerts, 0) == ESP_OK) {
+        if (alerts & TWAI_ALERT_BUS_ERROR)       status->events |= CAN_BUS_EVENT_BUS_ERROR;
+        if (alerts & TWAI_ALERT_ABOVE_ERR_WARN)  status->events |= CAN_BUS_EVENT_ERR_WARNING;
+        if (alerts & TWAI_ALERT_ERR_PASS)        status->events |= CAN_BUS_EVENT_ERR_PASSIVE;
+        if (alerts & TWAI_ALERT_BUS_OFF)         status->events |= CAN_BUS_EVENT_BUS_OFF;
+        if (alerts & TWAI_ALERT_BUS_RECOVERED)   status->events |= CAN_BUS_EVENT_RECOVERED;
+        if (alerts & TWAI_ALERT_RX_QUEUE_FULL)   status->events |= CAN_BUS_EVENT_RX_OVERRUN;
+        if (alerts & TWAI_ALERT_TX_FAILED)       status->events |= CAN_BUS_EVENT_TX_FAILED;
+    }
+    return CAN_OK;
+}
+
+static can_err_t twai_recover(can_transport_t* transport) {
+    twai_backend_t* backend = (twai_backend_t*)transport->backend;
+
+    twai_status_info_t info;
+    if (twai_get_status_info_v2(backend->handle, &info) != ESP_OK) {
+        return CAN_ERR_IO;
+    }
+    esp_err_t err = ESP_OK;
+    if (info.state == TWAI_STATE_BUS_OFF) {
+        err = twai_initiate_recovery_v2(backend->handle);
+    } else if (info.state == TWAI_STATE_STOPPED) {
+        err = twai_start_v2(backend->handle);
+    }
+    return (err == ESP_OK) ? CAN_OK : CAN_ERR_IO;
+}
+
+// The acceptance filter can only be changed while the driver is stopped,
+// so it is applied at open(); can_transport.c filters in software meanwhile.
+const can_transport_ops_t can_transport_twai_ops = {
+    .name = "twai",
+    .open = twai_open,
+    .close = twai_close,
+    .send = twai_send,
+    .recv = twai_recv,
+    .set_filters = NULL,
+    .get_status = twai_get_status,
+    .recover = twai_recover
+};
+
+#endif // ESP_PLATFORM
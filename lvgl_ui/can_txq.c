@@ -0,0 +1,187 @@
+/**
+ * @file can_txq.c
+ * @brief Priority TX Queue Implementation
+ *
+ * Frames are sent with a zero timeout: when the driver's TX slots are full
+ * the frame stays at the head of its class and the drain retries after
+ * CAN_TXQ_RETRY_MS, so a lower class can never block a higher one in the
+ * software queue.
+ */
+
+#include "can_txq.h"
+#include <string.h>
+
+#define CAN_TXQ_MASK        (CAN_TXQ_DEPTH - 1)
+#define CAN_TXQ_RETRY_MS    1   // Driver TX slots full
+
+static uint32_t lane_depth(const can_txq_lane_t* lane) {
+    return (uint16_t)(lane->tail - lane->head);
+}
+
+// Add tokens for the time since the last refill (lock held). Only the time
+// the added tokens account for is consumed, so the rounding remainder of
+// frequent refills carries over instead of slowing the class down.
+static void refill(can_txq_lane_t* lane, uint64_t now_us) {
+    if (lane->rate_fps == 0 || now_us <= lane->refill_us) {
+        return;     // No time passed (or the caller read the clock before set_limit)
+    }
+    uint64_t elapsed_us = now_us - lane->refill_us;
+    uint64_t add = (elapsed_us * lane->rate_fps) / 1000u;     // tokens x 1000
+    uint64_t cap = (uint64_t)lane->burst * 1000u;
+    uint64_t tokens = lane->tokens_milli + add;
+
+    if (tokens >= cap) {
+        lane->tokens_milli = (uint32_t)cap;
+        lane->refill_us = now_us;       // Full bucket: nothing left to carry
+    } else {
+        lane->tokens_milli = (uint32_t)tokens;
+        lane->refill_us += (add * 1000u) / lane->rate_fps;
+    }
+}
+
+static bool has_token(const can_txq_lane_t* lane) {
+    return lane->rate_fps == 0 || lane->tokens_milli >= 1000u;
+}
+
+// Milliseconds until the lane earns its next token (lock held)
+static uint32_t token_wait_ms(const can_txq_lane_t* lane) {
+    uint32_t missing = 1000u - lane->tokens_milli;
+    return (missing + lane->rate_fps - 1) / lane->rate_fps;
+}
+
+bool can_txq_init(can_txq_t* txq) {
+    memset(txq, 0, sizeof(can_txq_t));
+    txq->lock = can_port_mutex_create();
+    return txq->lock != NULL;
+}
+
+void can_txq_deinit(can_txq_t* txq) {
+    if (txq->lock != NULL) {
+        can_port_mutex_destroy(txq->lock);
+        txq->lock = NULL;
+    }
+}
+
+void can_txq_set_limit(can_txq_t* txq, can_txq_class_t cls, uint32_t rate_fps, uint32_t burst) {
+    if (cls >= CAN_TXQ_CLASS_COUNT) {
+        return;
+    }
+    can_port_mutex_lock(txq->lock);
+    can_txq_lane_t* lane = &txq->lanes[cls];
+    lane->rate_fps = rate_fps;
+    lane->burst = (burst > 0) ? burst : 1;
+    lane->tokens_milli = lane->burst * 1000u;
+    lane->refill_us = can_port_time_us();
+    can_port_mutex_unlock(txq->lock);
+}
+
+can_err_t can_txq_push(can_txq_t* txq, can_txq_class_t cls, const can_frame_t* frame) {
+    if (cls >= CAN_TXQ_CLASS_COUNT || frame == NULL || frame->dlc > CAN_MAX_DLC) {
+        return CAN_ERR_INVALID_ARG;
+    }
+
+    can_err_t err = CAN_OK;
+    can_port_mutex_lock(txq->lock);
+    can_txq_lane_t* lane = &txq->lanes[cls];
+    if (lane_depth(lane) >= CAN_TXQ_DEPTH) {
+        lane->stats.dropped++;
+        err = CAN_ERR_NO_SPACE;
+    } else {
+        lane->frames[lane->tail & CAN_TXQ_MASK] = *frame;
+#if CAN_TRACE_ENABLE
+        lane->trace[lane->tail & CAN_TXQ_MASK] = (cls == CAN_TXQ_USER) ? CAN_TRACE_CLAIM_TAP() : 0;
+#endif
+        lane->tail++;
+        lane->stats.queued++;
+    }
+    can_port_mutex_unlock(txq->lock);
+    return err;
+}
+
+void can_txq_clear(can_txq_t* txq, can_txq_class_t cls) {
+    if (cls >= CAN_TXQ_CLASS_COUNT) {
+        return;
+    }
+    can_port_mutex_lock(txq->lock);
+    txq->lanes[cls].head = txq->lanes[cls].tail;
+    can_port_mutex_unlock(txq->lock);
+}
+
+uint32_t can_txq_drain(can_txq_t* txq, can_transport_t* bus, uint64_t now_us) {
+    for (uint32_t budget = 0; budget < CAN_TXQ_DRAIN_BUDGET; budget++) {
+        can_frame_t frame;
+        uint32_t trace = 0;
+        uint16_t head = 0;
+        int cls = -1;
+        uint32_t wait_ms = CAN_PORT_WAIT_FOREVER;
+
+        // Highest class with a frame and a token
+        can_port_mutex_lock(txq->lock);
+        for (int i = 0; i < CAN_TXQ_CLASS_COUNT; i++) {
+            can_txq_lane_t* lane = &txq->lanes[i];
+            if (lane_depth(lane) == 0) {
+                continue;
+            }
+            refill(lane, now_us);
+            if (has_token(lane)) {
+                cls = i;
+                head = lane->head;
+                frame = lane->frames[head & CAN_TXQ_MASK];
+#if CAN_TRACE_ENABLE
+                trace = lane->trace[head & CAN_TXQ_MASK];
+#endif
+                break;
+            }
+            uint32_t ms = token_wait_ms(lane);
+            if (ms < wait_ms) {
+                wait_ms = ms;
+            }
+        }
+        can_port_mutex_unlock(txq->lock);
+
+        if (cls < 0) {
+            return wait_ms;     // Empty, or every class waits for tokens
+        }
+
+        can_err_t err = can_transport_send(bus, &frame, 0);
+        if (err == CAN_ERR_TIMEOUT) {
+            return CAN_TXQ_RETRY_MS;
+        }
+
+        can_port_mutex_lock(txq->lock);
+        can_txq_lane_t* lane = &txq->lanes[cls];
+        if (lane->head == head && lane_depth(lane) > 0) {   // Not cleared meanwhile
+            lane->head++;
+        }
+        if (lane->rate_fps != 0) {
+            lane->tokens_milli -= 1000u;
+        }
+        if (err == CAN_OK) {
+            lane->stats.sent++;
+            CAN_TRACE_MARK_FROM(CAN_TRACE_TX_DONE, trace);
+        } else {
+            lane->stats.errors++;
+        }
+        can_port_mutex_unlock(txq->lock);
+    }
+    return 0;   // Budget used up; more may be queued
+}
+
+uint32_t can_txq_depth(can_txq_t* txq, can_txq_class_t cls) {
+    if (cls >= CAN_TXQ_CLASS_COUNT) {
+        return 0;
+    }
+    can_port_mutex_lock(txq->lock);
+    uint32_t depth = lane_depth(&txq->lanes[cls]);
+    can_port_mutex_unlock(txq->lock);
+    return depth;
+}
+
+void can_txq_get_stats(can_txq_t* txq, can_txq_class_t cls, can_txq_stats_t* stats) {
+    if (cls >= CAN_TXQ_CLASS_COUNT || stats == NULL) {
+        return;
+    }
+    can_port_mutex_lock(txq->lock);
+    *stats = txq->lanes[cls].stats;
+    can_port_mutex_unlock(txq->lock);
+}
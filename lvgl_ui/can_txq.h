@@ -0,0 +1,144 @@
+/**
+ * @file can_txq.h
+ * @brief Priority TX Queue with Token-Bucket Rate Limits
+ *
+ * Frames are queued per class and drained by the TX task in strict priority
+ * order: user commands, then periodic frames, then bulk traffic (replay,
+ * fuzzing). Each class has a token bucket that caps its share of the bus, so
+ * a bulk flood can neither starve periodic frames nor sit in front of a
+ * user's one-shot or STOP-triggered frame.
+ *
+ * Any task may push; only the TX task drains.
+ */
+
+#ifndef CAN_TXQ_H
+#define CAN_TXQ_H
+
+#include "can_transport.h"
+#include "can_port.h"
+#include "can_trace.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define CAN_TXQ_DEPTH           32  // Frames per class (power of two)
+#define CAN_TXQ_DRAIN_BUDGET    16  // Frames per drain call
+
+/**
+ * @brief Traffic classes (lower value = higher priority)
+ */
+typedef enum {
+    CAN_TXQ_USER = 0,       // One-shot commands
+    CAN_TXQ_PERIODIC,       // Cyclic frames
+    CAN_TXQ_BULK,           // Replay, sweep, fuzzing
+    CAN_TXQ_CLASS_COUNT
+} can_txq_class_t;
+
+/**
+ * @brief Per-class counters
+ */
+typedef struct {
+    uint32_t queued;
+    uint32_t sent;
+    uint32_t dropped;       // Push refused: class queue full
+    uint32_t errors;        // Transport error other than a full TX slot
+} can_txq_stats_t;
+
+/**
+ * @brief One class: ring buffer and token bucket
+ */
+typedef struct {
+    can_frame_t frames[CAN_TXQ_DEPTH];
+#if CAN_TRACE_ENABLE
+    uint32_t trace[CAN_TXQ_DEPTH];  // Start tag of each frame (user class)
+#endif
+    uint16_t head;          // Next to send
+    uint16_t tail;          // Next free
+    uint32_t rate_fps;      // Refill rate (0 = unlimited)
+    uint32_t burst;         // Bucket size in frames
+    uint32_t tokens_milli;  // Available tokens x 1000
+    uint64_t refill_us;     // Last refill time
+    can_txq_stats_t stats;
+} can_txq_lane_t;
+
+/**
+ * @brief TX queue
+ */
+typedef struct {
+    can_port_mutex_t* lock;
+    can_txq_lane_t lanes[CAN_TXQ_CLASS_COUNT];
+} can_txq_t;
+
+/**
+ * @brief Initialize a queue (all classes unlimited)
+ * @param txq Queue
+ * @return false if the lock could not be created
+ */
+bool can_txq_init(can_txq_t* txq);
+
+/**
+ * @brief Release the lock
+ * @param txq Queue
+ */
+void can_txq_deinit(can_txq_t* txq);
+
+/**
+ * @brief Set a class rate limit
+ * @param txq Queue
+ * @param cls Class
+ * @param rate_fps Sustained frames per second (0 = unlimited)
+ * @param burst Frames that may go back to back after an idle period
+ */
+void can_txq_set_limit(can_txq_t* txq, can_txq_class_t cls, uint32_t rate_fps, uint32_t burst);
+
+/**
+ * @brief Queue a frame (any task)
+ *
+ * A user-class frame claims the pending trace tap (can_trace.h).
+ *
+ * @param txq Queue
+ * @param cls Class
+ * @param frame Frame (copied)
+ * @return CAN_OK, CAN_ERR_NO_SPACE if the class is full, CAN_ERR_INVALID_ARG
+ */
+can_err_t can_txq_push(can_txq_t* txq, can_txq_class_t cls, const can_frame_t* frame);
+
+/**
+ * @brief Drop all frames of a class (any task)
+ * @param txq Queue
+ * @param cls Class
+ */
+void can_txq_clear(can_txq_t* txq, can_txq_class_t cls);
+
+/**
+ * @brief Send queued frames in priority order (TX task)
+ * @param txq Queue
+ * @param bus Transport
+ * @param now_us Current time (can_port_time_us)
+ * @return Milliseconds until the queue needs to run again,
+ *         CAN_PORT_WAIT_FOREVER if it is empty
+ */
+uint32_t can_txq_drain(can_txq_t* txq, can_transport_t* bus, uint64_t now_us);
+
+/**
+ * @brief Frames waiting in a class (any task)
+ * @param txq Queue
+ * @param cls Class
+ * @return Depth
+ */
+uint32_t can_txq_depth(can_txq_t* txq, can_txq_class_t cls);
+
+/**
+ * @brief Copy a class's counters (any task)
+ * @param txq Queue
+ * @param cls Class
+ * @param stats Output
+ */
+void can_txq_get_stats(can_txq_t* txq, can_txq_class_t cls, can_txq_stats_t* stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // CAN_TXQ_H
@@ -0,0 +1,136 @@
+/**
+ * @file can_xform.c
+ * @brief Payload Transforms Implementation
+ *
+ * Both CRC8 variants use a 256-entry table (one lookup per byte), so a full
+ * 8-byte frame costs a few dozen instructions per send.
+ */
+
+#include "can_xform.h"
+
+// SAE J1850, poly 0x1D
+static const uint8_t CRC8_J1850_TABLE[256] = {
+    0x00, 0x1D, 0x3A, 0x27, 0x74, 0x69, 0x4E, 0x53, 0xE8, 0xF5, 0xD2, 0xCF, 0x9C, 0x81, 0xA6, 0xBB,
+    0xCD, 0xD0, 0xF7, 0xEA, 0xB9, 0xA4, 0x83, 0x9E, 0x25, 0x38, 0x1F, 0x02, 0x51, 0x4C, 0x6B, 0x76,
+    0x87, 0x9A, 0xBD, 0xA0, 0xF3, 0xEE, 0xC9, 0xD4, 0x6F, 0x72, 0x55, 0x48, 0x1B, 0x06, 0x21, 0x3C,
+    0x4A, 0x57, 0x70, 0x6D, 0x3E, 0x23, 0x04, 0x19, 0xA2, 0xBF, 0x98, 0x85, 0xD6, 0xCB, 0xEC, 0xF1,
+    0x13, 0x0E, 0x29, 0x34, 0x67, 0x7A, 0x5D, 0x40, 0xFB, 0xE6, 0xC1, 0xDC, 0x8F, 0x92, 0xB5, 0xA8,
+    0xDE, 0xC3, 0xE4, 0xF9, 0xAA, 0xB7, 0x90, 0x8D, 0x36, 0x2B, 0x0C, 0x11, 0x42, 0x5F, 0x78, 0x65,
+    0x94, 0x89, 0xAE, 0xB3, 0xE0, 0xFD, 0xDA, 0xC7, 0x7C, 0x61, 0x46, 0x5B, 0x08, 0x15, 0x32, 0x2F,
+    0x59, 0x44, 0x63, 0x7E, 0x2D, 0x30, 0x17, 0x0A, 0xB1, 0xAC, 0x8B, 0x96, 0xC5, 0xD8, 0xFF, 0xE2,
+    0x26, 0x3B, 0x1C, 0x01, 0x52, 0x4F, 0x68, 0x75, 0xCE, 0xD3, 0xF4, 0xE9, 0xBA, 0xA7, 0x80, 0x9D,
+    0xEB, 0xF6, 0xD1, 0xCC, 0x9F, 0x82, 0xA5, 0xB8, 0x03, 0x1E, 0x39, 0x24, 0x77, 0x6A, 0x4D, 0x50,
+    0xA1, 0xBC, 0x9B, 0x86, 0xD5, 0xC8, 0xEF, 0xF2, 0x49, 0x54, 0x73, 0x6E, 0x3D, 0x20, 0x07, 0x1A,
+    0x6C, 0x71, 0x56, 0x4B, 0x18, 0x05, 0x22, 0x3F, 0x84, 0x99, 0xBE, 0xA3, 0xF0, 0xED, 0xCA, 0xD7,
+    0x35, 0x28, 0x0F, 0x12, 0x41, 0x5C, 0x7B, 0x66, 0xDD, 0xC0, 0xE7, 0xFA, 0xA9, 0xB4, 0x93, 0x8E,
+    0xF8, 0xE5, 0xC2, 0xDF, 0x8C, 0x91, 0xB6, 0xAB, 0x10, 0x0D, 0x2A, 0x37, 0x64, 0x79, 0x5E, 0x43,
+    0xB2, 0xAF, 0x88, 0x95, 0xC6, 0xDB, 0xFC, 0xE1, 0x5A, 0x47, 0x60, 0x7D, 0x2E, 0x33, 0x14, 0x09,
+    0x7F, 0x62, 0x45, 0x58, 0x0B, 0x16, 0x31, 0x2C, 0x97, 0x8A, 0xAD, 0xB0, 0xE3, 0xFE, 0xD9, 0xC4,
+};
+
+// AUTOSAR CRC8H2F, poly 0x2F
+static const uint8_t CRC8_H2F_TABLE[256] = {
+    0x00, 0x2F, 0x5E, 0x71, 0xBC, 0x93, 0xE2, 0xCD, 0x57, 0x78, 0x09, 0x26, 0xEB, 0xC4, 0xB5, 0x9A,
+    0xAE, 0x81, 0xF0, 0xDF, 0x12, 0x3D, 0x4C, 0x63, 0xF9, 0xD6, 0xA7, 0x88, 0x45, 0x6A, 0x1B, 0x34,
+    0x73, 0x5C, 0x2D, 0x02, 0xCF, 0xE0, 0x91, 0xBE, 0x24, 0x0B, 0x7A, 0x55, 0x98, 0xB7, 0xC6, 0xE9,
+    0xDD, 0xF2, 0x83, 0xAC, 0x61, 0x4E, 0x3F, 0x10, 0x8A, 0xA5, 0xD4, 0xFB, 0x36, 0x19, 0x68, 0x47,
+    0xE6, 0xC9, 0xB8, 0x97, 0x5A, 0x75, 0x04, 0x2B, 0xB1, 0x9E, 0xEF, 0xC0, 0x0D, 0x22, 0x53, 0x7C,
+    0x48, 0x67, 0x16, 0x39, 0xF4, 0xDB, 0xAA, 0x85, 0x1F, 0x30, 0x41, 0x6E, 0xA3, 0x8C, 0xFD, 0xD2,
+    0x95, 0xBA, 0xCB, 0xE4, 0x29, 0x06, 0x77, 0x58, 0xC2, 0xED, 0x9C, 0xB3, 0x7E, 0x51, 0x20, 0x0F,
+    0x3B, 0x14, 0x65, 0x4A, 0x87, 0xA8, 0xD9, 0xF6, 0x6C, 0x43, 0x32, 0x1D, 0xD0, 0xFF, 0x8E, 0xA1,
+    0xE3, 0xCC, 0xBD, 0x92, 0x5F, 0x70, 0x01, 0x2E, 0xB4, 0x9B, 0xEA, 0xC5, 0x08, 0x27, 0x56, 0x79,
+    0x4D, 0x62, 0x13, 0x3C, 0xF1, 0xDE, 0xAF, 0x80, 0x1A, 0x35, 0x44, 0x6B, 0xA6, 0x89, 0xF8, 0xD7,
+    0x90, 0xBF, 0xCE, 0xE1, 0x2C, 0x03, 0x72, 0x5D, 0xC7, 0xE8, 0x99, 0xB6, 0x7B, 0x54, 0x25, 0x0A,
+    0x3E, 0x11, 0x60, 0x4F, 0x82, 0xAD, 0xDC, 0xF3, 0x69, 0x46, 0x37, 0x18, 0xD5, 0xFA, 0x8B, 0xA4,
+    0x05, 0x2A, 0x5B, 0x74, 0xB9, 0x96, 0xE7, 0xC8, 0x52, 0x7D, 0x0C, 0x23, 0xEE, 0xC1, 0xB0, 0x9F,
+    0xAB, 0x84, 0xF5, 0xDA, 0x17, 0x38, 0x49, 0x66, 0xFC, 0xD3, 0xA2, 0x8D, 0x40, 0x6F, 0x1E, 0x31,
+    0x76, 0x59, 0x28, 0x07, 0xCA, 0xE5, 0x94, 0xBB, 0x21, 0x0E, 0x7F, 0x50, 0x9D, 0xB2, 0xC3, 0xEC,
+    0xD8, 0xF7, 0x86, 0xA9, 0x64, 0x4B, 0x3A, 0x15, 0x8F, 0xA0, 0xD1, 0xFE, 0x33, 0x1C, 0x6D, 0x42,
+};
+
+static uint8_t crc8_update(const uint8_t* table, uint8_t crc, const uint8_t* data, size_t len) {
+    for (size_t i = 0; i < len; i++) {
+        crc = table[crc ^ data[i]];
+    }
+    return crc;
+}
+
+uint8_t can_crc8_j1850(const uint8_t* data, size_t len) {
+    return crc8_update(CRC8_J1850_TABLE, 0xFF, data, len) ^ 0xFF;
+}
+
+uint8_t can_crc8_autosar(const uint8_t* data, size_t len) {
+    return crc8_update(CRC8_H2F_TABLE, 0xFF, data, len) ^ 0xFF;
+}
+
+bool can_xform_validate(const can_xform_t* xforms, uint8_t count, uint8_t dlc) {
+    if (count > 0 && xforms == NULL) {
+        return false;
+    }
+
+    for (uint8_t i = 0; i < count; i++) {
+        const can_xform_t* xf = &xforms[i];
+        if (xf->pos >= dlc) {
+            return false;
+        }
+        switch (xf->type) {
+            case CAN_XFORM_COUNTER:
+                if (xf->arg == 0) {
+                    return false;
+                }
+                break;
+            case CAN_XFORM_CRC8_J1850:
+            case CAN_XFORM_CRC8_AUTOSAR:
+            case CAN_XFORM_XOR:
+                if (xf->len == 0 || xf->start + xf->len > dlc) {
+                    return false;
+                }
+                break;
+            default:
+                return false;
+        }
+    }
+    return true;
+}
+
+// Checksum over [start, start + len) skipping the target byte
+static uint8_t checksum(const can_xform_t* xf, const uint8_t* data) {
+    const uint8_t* table = (xf->type == CAN_XFORM_CRC8_J1850) ? CRC8_J1850_TABLE : CRC8_H2F_TABLE;
+    uint8_t end = xf->start + xf->len;
+    uint8_t head = (xf->pos >= xf->start && xf->pos < end) ? xf->pos : end;
+
+    if (xf->type == CAN_XFORM_XOR) {
+        uint8_t x = 0;
+        for (uint8_t i = xf->start; i < end; i++) {
+            x ^= data[i];
+        }
+        return (head < end) ? (uint8_t)(x ^ data[head]) : x;
+    }
+
+    uint8_t crc = 0xFF;
+    if (xf->flags & CAN_XFORM_F_DATA_ID) {
+        crc = table[crc ^ xf->arg];
+    }
+    crc = crc8_update(table, crc, &data[xf->start], head - xf->start);
+    if (head < end) {
+        crc = crc8_update(table, crc, &data[head + 1], end - head - 1);
+    }
+    return crc ^ 0xFF;
+}
+
+void can_xform_apply(const can_xform_t* xforms, uint8_t count, uint8_t counter, can_frame_t* frame) {
+    for (uint8_t i = 0; i < count; i++) {
+        const can_xform_t* xf = &xforms[i];
+
+        if (xf->type == CAN_XFORM_COUNTER) {
+            uint8_t mask = xf->arg;
+            uint8_t shift = 0;
+            while (((mask >> shift) & 1u) == 0) {
+                shift++;
+            }
+            frame->data[xf->pos] = (uint8_t)((frame->data[xf->pos] & ~mask) | ((counter << shift) & mask));
+        } else {
+            frame->data[xf->pos] = checksum(xf, frame->data);
+        }
+    }
+}
@@ -0,0 +1,93 @@
+/**
+ * @file can_xform.h
+ * @brief Payload Transforms (Alive Counters and Checksums)
+ *
+ * Transforms rewrite bytes of a cyclic frame right before it is sent: an
+ * alive counter in some bits of a byte, then a CRC8 or XOR over a byte range.
+ * They run in declaration order, so list the counter before the checksum
+ * that covers it.
+ *
+ * Example (counter in byte 1 low nibble, J1850 CRC over bytes 1..7 in byte 0):
+ *   static const can_xform_t XF[] = {
+ *       CAN_XFORM_COUNTER(1, 0x0F),
+ *       CAN_XFORM_CRC8_J1850(0, 1, 7),
+ *   };
+ */
+
+#ifndef CAN_XFORM_H
+#define CAN_XFORM_H
+
+#include "can_transport.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Transform types
+ */
+typedef enum {
+    CAN_XFORM_NONE = 0,
+    CAN_XFORM_COUNTER,          // Counter in the bits of arg (mask) of byte pos
+    CAN_XFORM_CRC8_J1850,       // SAE J1850: poly 0x1D, init/xorout 0xFF
+    CAN_XFORM_CRC8_AUTOSAR,     // AUTOSAR CRC8H2F: poly 0x2F, init/xorout 0xFF
+    CAN_XFORM_XOR               // XOR of the covered bytes
+} can_xform_type_t;
+
+#define CAN_XFORM_F_DATA_ID     0x01    // CRC8: feed arg (data ID) before the bytes
+
+/**
+ * @brief Transform descriptor
+ *
+ * Checksums cover bytes [start, start + len) except pos itself.
+ */
+typedef struct {
+    uint8_t type;       // can_xform_type_t
+    uint8_t pos;        // Target byte
+    uint8_t start;      // First covered byte (checksums)
+    uint8_t len;        // Covered bytes (checksums)
+    uint8_t arg;        // COUNTER: bit mask; CRC8: data ID
+    uint8_t flags;      // CAN_XFORM_F_*
+} can_xform_t;
+
+#define CAN_XFORM_COUNTER(pos, mask)                  {CAN_XFORM_COUNTER, (pos), 0, 0, (mask), 0}
+#define CAN_XFORM_CRC8_J1850(pos, start, len)         {CAN_XFORM_CRC8_J1850, (pos), (start), (len), 0, 0}
+#define CAN_XFORM_CRC8_AUTOSAR(pos, start, len)       {CAN_XFORM_CRC8_AUTOSAR, (pos), (start), (len), 0, 0}
+#define CAN_XFORM_CRC8_J1850_ID(pos, start, len, id)  {CAN_XFORM_CRC8_J1850, (pos), (start), (len), (id), CAN_XFORM_F_DATA_ID}
+#define CAN_XFORM_CRC8_AUTOSAR_ID(pos, start, len, id) \
+                                                      {CAN_XFORM_CRC8_AUTOSAR, (pos), (start), (len), (id), CAN_XFORM_F_DATA_ID}
+#define CAN_XFORM_XOR(pos, start, len)                {CAN_XFORM_XOR, (pos), (start), (len), 0, 0}
+
+/**
+ * @brief Check that every transform fits a frame of the given length
+ * @param xforms Transforms
+ * @param count Number of transforms
+ * @param dlc Frame data length
+ * @return true if valid
+ */
+bool can_xform_validate(const can_xform_t* xforms, uint8_t count, uint8_t dlc);
+
+/**
+ * @brief Apply transforms to a frame (validated transforms only)
+ * @param xforms Transforms
+ * @param count Number of transforms
+ * @param counter Alive counter value for this send
+ * @param frame Frame to rewrite in place
+ */
+void can_xform_apply(const can_xform_t* xforms, uint8_t count, uint8_t counter, can_frame_t* frame);
+
+/**
+ * @brief CRC8 SAE J1850 (check "123456789" = 0x4B)
+ */
+uint8_t can_crc8_j1850(const uint8_t* data, size_t len);
+
+/**
+ * @brief CRC8 AUTOSAR CRC8H2F (check "123456789" = 0xDF)
+ */
+uint8_t can_crc8_autosar(const uint8_t* data, size_t len);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // CAN_XFORM_H
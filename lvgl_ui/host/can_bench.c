@@ -0,0 +1,342 @@
+/**
+ * @file can_bench.c
+ * @brief Off-target CAN transport throughput and latency benchmark
+ *
+ * Opens two nodes on the same bus (in-process loopback or a SocketCAN
+ * interface such as vcan0), streams frames from one to the other and reports
+ * achieved frame rate, loss and one-way latency. Point-to-point links such as
+ * an SLCAN pty pair take the receiving end with --rx-device.
+ *
+ * The tasks follow the firmware's threading model (Tasks in ui_config.h):
+ * sender and receiver are pinned to the CAN core with real-time priorities,
+ * and a UI thread on the other core takes one record per received frame from
+ * a bounded lock-free queue, woken like ui_loop_notify(). The handoff latency
+ * (post to pickup) and the queue high-water and drops show how the UI side
+ * keeps up. SCHED_FIFO needs CAP_SYS_NICE (e.g. sudo); without it the
+ * threads keep the default policy, which the report shows.
+ *
+ * Usage: can_bench [--transport loopback|socketcan|slcan] [--device NAME]
+ *                  [--rx-device NAME] [--frames N] [--batch N]
+ *                  [--can-core N] [--ui-core N] [--queue N]
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "can_transport.h"
+#include "can_port.h"
+#include "can_queue.h"
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define BENCH_RX_TIMEOUT_MS 500
+#define BENCH_UI_WAIT_MS    500     // UI_LOOP_MAX_SLEEP_MS
+
+// Same placement as the Tasks section of ui_config.h
+#define BENCH_UI_CORE       0
+#define BENCH_CAN_CORE      1
+#define BENCH_UI_PRIO       5
+#define BENCH_RX_PRIO       19
+#define BENCH_TX_PRIO       18
+#define BENCH_STACK         65536
+
+typedef struct {
+    const char* name;
+    int core;
+    bool realtime;
+    can_port_sem_t* done;
+} task_info_t;
+
+// One received frame handed to the UI thread
+typedef struct {
+    uint32_t seq;
+    uint32_t post_us;
+} ui_post_t;
+
+typedef struct {
+    task_info_t task;
+    can_transport_t* transport;
+    uint32_t expected;
+    uint32_t received;
+    uint32_t out_of_order;
+    uint32_t* latency_us;
+    can_queue_t* queue;
+    can_port_sem_t* ui_wake;
+    atomic_bool finished;
+} rx_context_t;
+
+typedef struct {
+    task_info_t task;
+    can_transport_t* transport;
+    uint32_t frames;
+    uint32_t batch;
+    uint32_t send_failures;
+} tx_context_t;
+
+typedef struct {
+    task_info_t task;
+    rx_context_t* rx;
+    uint32_t taken;
+    uint32_t wakeups;
+    uint32_t* handoff_us;
+} ui_context_t;
+
+static void put_u32(uint8_t* p, uint32_t v) {
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+    p[2] = (uint8_t)(v >> 16);
+    p[3] = (uint8_t)(v >> 24);
+}
+
+static uint32_t get_u32(const uint8_t* p) {
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static void task_started(task_info_t* task) {
+    task->core = can_port_task_core();
+    task->realtime = can_port_task_is_realtime();
+}
+
+static void rx_task(void* arg) {
+    rx_context_t* ctx = arg;
+    can_frame_t frame;
+    uint32_t next_seq = 0;
+
+    task_started(&ctx->task);
+    while (ctx->received < ctx->expected) {
+        if (can_transport_recv(ctx->transport, &frame, BENCH_RX_TIMEOUT_MS) != CAN_OK) {
+            break;  // Sender finished and the rest was lost
+        }
+        uint32_t now_us = (uint32_t)can_port_time_us();
+        uint32_t seq = get_u32(&frame.data[0]);
+        uint32_t sent_us = get_u32(&frame.data[4]);
+        if (seq != next_seq) {
+            ctx->out_of_order++;
+        }
+        next_seq = seq + 1;
+        ctx->latency_us[ctx->received++] = now_us - sent_us;
+
+        // What ui_binding_add_frame_log() does: post, then wake the UI
+        ui_post_t post = {.seq = seq, .post_us = (uint32_t)can_port_time_us()};
+        can_queue_push(ctx->queue, &post);
+        can_port_sem_give(ctx->ui_wake);
+    }
+
+    atomic_store(&ctx->finished, true);
+    can_port_sem_give(ctx->ui_wake);
+    can_port_sem_give(ctx->task.done);
+}
+
+static void tx_task(void* arg) {
+    tx_context_t* ctx = arg;
+    can_frame_t frame = {
+        .id = 0x123,
+        .dlc = 8
+    };
+
+    task_started(&ctx->task);
+    for (uint32_t seq = 0; seq < ctx->frames; seq++) {
+        put_u32(&frame.data[0], seq);
+        put_u32(&frame.data[4], (uint32_t)can_port_time_us());
+        if (can_transport_send(ctx->transport, &frame, 100) != CAN_OK) {
+            ctx->send_failures++;
+        }
+        // Let the receiver drain between bursts, like a paced TX task would
+        if (ctx->batch > 1 && (seq % ctx->batch) == ctx->batch - 1) {
+            can_transport_flush(ctx->transport);
+            can_port_sleep_ms(1);
+        }
+    }
+    can_transport_flush(ctx->transport);
+    can_port_sem_give(ctx->task.done);
+}
+
+// The UI loop: sleep until notified, then take everything queued
+static void ui_task(void* arg) {
+    ui_context_t* ctx = arg;
+    ui_post_t post;
+
+    task_started(&ctx->task);
+    while (1) {
+        bool finished = atomic_load(&ctx->rx->finished);
+        while (can_queue_pop(ctx->rx->queue, &post)) {
+            ctx->handoff_us[ctx->taken++] = (uint32_t)can_port_time_us() - post.post_us;
+        }
+        if (finished) {
+            break;
+        }
+        can_port_sem_take(ctx->rx->ui_wake, BENCH_UI_WAIT_MS);
+        ctx->wakeups++;
+    }
+    can_port_sem_give(ctx->task.done);
+}
+
+static bool start_task(task_info_t* task, const char* name, uint8_t priority, int core,
+                       can_port_task_fn_t fn) {
+    can_port_task_config_t config = {
+        .name = name,
+        .stack_size = BENCH_STACK,
+        .priority = priority,
+        .core = (int8_t)core
+    };
+    task->name = name;
+    task->done = can_port_sem_create();
+    return task->done != NULL && can_port_task_create(&config, fn, task);
+}
+
+static void print_task(const task_info_t* task, uint8_t priority) {
+    printf("  %-4s core %d, %s %u\n", task->name, task->core,
+           task->realtime ? "SCHED_FIFO" : "default policy, asked", (unsigned)priority);
+}
+
+static int cmp_u32(const void* a, const void* b) {
+    uint32_t x = *(const uint32_t*)a;
+    uint32_t y = *(const uint32_t*)b;
+    return (x > y) - (x < y);
+}
+
+static void print_percentiles(const char* label, uint32_t* values, uint32_t count) {
+    if (count == 0) {
+        return;
+    }
+    qsort(values, count, sizeof(uint32_t), cmp_u32);
+    uint64_t sum = 0;
+    for (uint32_t i = 0; i < count; i++) {
+        sum += values[i];
+    }
+    printf("%-16savg %.1f  p50 %u  p99 %u  max %u\n", label, (double)sum / count,
+           values[count / 2], values[(count * 99) / 100], values[count - 1]);
+}
+
+int main(int argc, char** argv) {
+    const can_transport_ops_t* ops = &can_transport_loopback_ops;
+    const char* device = NULL;
+    const char* rx_device = NULL;
+    uint32_t frames = 100000;
+    uint32_t batch = 128;
+    int can_core = BENCH_CAN_CORE;
+    int ui_core = BENCH_UI_CORE;
+    uint32_t queue_len = 256;   // UI_BINDING_LOG_QUEUE_LEN
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--transport") == 0 && i + 1 < argc) {
+            const char* name = argv[++i];
+            if (strcmp(name, "socketcan") == 0) {
+                ops = &can_transport_socketcan_ops;
+            } else if (strcmp(name, "slcan") == 0) {
+                ops = &can_transport_slcan_ops;
+            } else if (strcmp(name, "loopback") != 0) {
+                fprintf(stderr, "unknown transport: %s\n", name);
+                return 2;
+            }
+        } else if (strcmp(argv[i], "--device") == 0 && i + 1 < argc) {
+            device = argv[++i];
+        } else if (strcmp(argv[i], "--rx-device") == 0 && i + 1 < argc) {
+            rx_device = argv[++i];
+        } else if (strcmp(argv[i], "--frames") == 0 && i + 1 < argc) {
+            frames = (uint32_t)strtoul(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "--batch") == 0 && i + 1 < argc) {
+            batch = (uint32_t)strtoul(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "--can-core") == 0 && i + 1 < argc) {
+            can_core = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--ui-core") == 0 && i + 1 < argc) {
+            ui_core = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--queue") == 0 && i + 1 < argc) {
+            queue_len = (uint32_t)strtoul(argv[++i], NULL, 10);
+        } else {
+            fprintf(stderr, "Usage: %s [--transport loopback|socketcan|slcan] [--device NAME]\n"
+                            "          [--rx-device NAME] [--frames N] [--batch N]\n"
+                            "          [--can-core N] [--ui-core N] [--queue N]\n", argv[0]);
+            return 2;
+        }
+    }
+    if (frames == 0 || batch == 0) {
+        return 2;
+    }
+
+    can_queue_t queue;
+    void* queue_storage = malloc(CAN_QUEUE_SLOT_SIZE(sizeof(ui_post_t)) * queue_len);
+    if (queue_storage == NULL || !can_queue_init(&queue, "ui", queue_storage, sizeof(ui_post_t), queue_len)) {
+        fprintf(stderr, "--queue must be a power of two\n");
+        return 2;
+    }
+
+    can_transport_config_t config = {
+        .device = device,
+        .bitrate = 500000,
+        .receive_own = false
+    };
+    can_transport_config_t rx_config = config;
+    if (rx_device != NULL) {
+        rx_config.device = rx_device;
+    }
+
+    can_transport_t tx_node;
+    can_transport_t rx_node;
+    can_transport_init(&tx_node, ops);
+    can_transport_init(&rx_node, ops);
+
+    can_err_t err = can_transport_open(&rx_node, &rx_config);
+    if (err == CAN_OK) {
+        err = can_transport_open(&tx_node, &config);
+    }
+    if (err != CAN_OK) {
+        fprintf(stderr, "open %s failed: %s\n", ops->name, can_err_to_name(err));
+        return 1;
+    }
+
+    rx_context_t rx = {
+        .transport = &rx_node,
+        .expected = frames,
+        .latency_us = calloc(frames, sizeof(uint32_t)),
+        .queue = &queue,
+        .ui_wake = can_port_sem_create()
+    };
+    tx_context_t tx = {
+        .transport = &tx_node,
+        .frames = frames,
+        .batch = batch
+    };
+    ui_context_t ui = {
+        .rx = &rx,
+        .handoff_us = calloc(frames, sizeof(uint32_t))
+    };
+    atomic_init(&rx.finished, false);
+
+    uint64_t start_us = can_port_time_us();
+    if (!start_task(&ui.task, "ui", BENCH_UI_PRIO, ui_core, ui_task) ||
+        !start_task(&rx.task, "rx", BENCH_RX_PRIO, can_core, rx_task) ||
+        !start_task(&tx.task, "tx", BENCH_TX_PRIO, can_core, tx_task)) {
+        fprintf(stderr, "task creation failed\n");
+        return 1;
+    }
+    can_port_sem_take(tx.task.done, CAN_PORT_WAIT_FOREVER);
+    can_port_sem_take(rx.task.done, CAN_PORT_WAIT_FOREVER);
+    uint64_t elapsed_us = can_port_time_us() - start_us;
+    can_port_sem_take(ui.task.done, CAN_PORT_WAIT_FOREVER);
+
+    can_queue_stats_t qstats;
+    can_queue_get_stats(&queue, &qstats);
+
+    printf("transport:      %s%s%s\n", ops->name, device ? " " : "", device ? device : "");
+    printf("tasks:\n");
+    print_task(&tx.task, BENCH_TX_PRIO);
+    print_task(&rx.task, BENCH_RX_PRIO);
+    print_task(&ui.task, BENCH_UI_PRIO);
+    printf("frames sent:    %u (%u send failures)\n", frames, tx.send_failures);
+    printf("frames recv:    %u (%u lost, %u out of order)\n",
+           rx.received, frames - rx.received, rx.out_of_order);
+    printf("throughput:     %.0f frames/s\n", rx.received * 1e6 / (double)elapsed_us);
+    print_percentiles("latency (us):", rx.latency_us, rx.received);
+    printf("ui queue:       %u/%u high-water, %u dropped, %u taken in %u wakeups\n",
+           qstats.high_water, qstats.capacity, qstats.dropped, ui.taken, ui.wakeups);
+    print_percentiles("handoff (us):", ui.handoff_us, ui.taken);
+
+    free(rx.latency_us);
+    free(ui.handoff_us);
+    free(queue_storage);
+    can_transport_close(&tx_node);
+    can_transport_close(&rx_node);
+    return (rx.received == frames) ? 0 : 1;
+}
@@ -0,0 +1,79 @@
+/**
+ * @file lv_conf.h
+ * @brief LVGL configuration for the headless host build
+ *
+ * Mirrors the ESP32-S3 target (RGB565, 172x640) so render cost and heap use
+ * measured on the host are comparable. Everything not listed here keeps the
+ * LVGL default from lv_conf_internal.h.
+ */
+
+#if 1 /* Set it to "1" to enable content */
+
+#ifndef LV_CONF_H
+#define LV_CONF_H
+
+// ==================== Color ====================
+#define LV_COLOR_DEPTH 16
+
+// ==================== Memory ====================
+// Builtin allocator so lv_mem_monitor() reports heap use and high-water mark
+// UI_MEM_POOLS (CMake option): LVGL allocates from ui_mem.c's block pools
+#if defined(UI_MEM_POOLS) && UI_MEM_POOLS
+#define LV_USE_STDLIB_MALLOC    LV_STDLIB_CUSTOM
+#else
+#define LV_USE_STDLIB_MALLOC    LV_STDLIB_BUILTIN
+#endif
+#define LV_USE_STDLIB_STRING    LV_STDLIB_CLIB
+#define LV_USE_STDLIB_SPRINTF   LV_STDLIB_CLIB
+#define LV_MEM_SIZE             (256 * 1024U)
+
+// ==================== HAL ====================
+#define LV_DEF_REFR_PERIOD      33
+#define LV_USE_OS               LV_OS_NONE
+
+// ==================== Rendering ====================
+#define LV_USE_DRAW_SW          1
+#define LV_DRAW_SW_DRAW_UNIT_CNT 1
+
+// ==================== Logging / debug ====================
+#define LV_USE_LOG              0
+#define LV_USE_ASSERT_NULL      1
+#define LV_USE_ASSERT_MALLOC    1
+#define LV_USE_SYSMON           0
+
+// ==================== Fonts ====================
+#define LV_FONT_MONTSERRAT_10   1
+#define LV_FONT_MONTSERRAT_12   1
+#define LV_FONT_MONTSERRAT_14   1
+
+// Generated subset fonts (UI_FONT_CJK): also the theme default, so dropdown
+// lists show Chinese options
+#if defined(UI_FONT_CJK) && UI_FONT_CJK
+#define LV_FONT_CUSTOM_DECLARE  LV_FONT_DECLARE(ui_font_cjk_12)
+#define LV_FONT_DEFAULT         &ui_font_cjk_12
+#else
+#define LV_FONT_DEFAULT         &lv_font_montserrat_12
+#endif
+#if defined(UI_FONT_COMPRESS) && UI_FONT_COMPRESS
+#define LV_USE_FONT_COMPRESSED  1
+#endif
+
+// ==================== Widgets ====================
+#define LV_USE_LABEL            1
+#define LV_USE_BUTTON           1
+#define LV_USE_SWITCH           1
+#define LV_USE_TEXTAREA         1
+#define LV_USE_DROPDOWN         1
+
+// ==================== Layouts ====================
+#define LV_USE_FLEX             1
+#define LV_USE_GRID             1
+
+// ==================== Examples / demos ====================
+#define LV_BUILD_EXAMPLES       0
+#define LV_USE_DEMO_WIDGETS     0
+#define LV_USE_DEMO_BENCHMARK   0
+
+#endif // LV_CONF_H
+
+#endif // End of "Content enable"
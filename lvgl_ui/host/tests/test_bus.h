@@ -0,0 +1,101 @@
+/**
+ * @file test_bus.h
+ * @brief Recording Transport for the Host Unit Tests
+ *
+ * A backend that keeps every frame sent to it and reports a controller
+ * status the test sets, so the code above the transport (TX queue,
+ * scheduler, health monitor) runs without a bus. Include it in one test
+ * program only, after test_util.h.
+ */
+
+#ifndef TEST_BUS_H
+#define TEST_BUS_H
+
+#include "can_transport.h"
+#include <string.h>
+
+#define TEST_BUS_SENT_MAX 512
+
+typedef struct {
+    can_frame_t sent[TEST_BUS_SENT_MAX];
+    uint32_t sent_count;            // Keeps counting past TEST_BUS_SENT_MAX
+    bool tx_full;                   // Driver TX slots full: send times out
+    can_bus_status_t status;        // Returned by get_status (events cleared on read)
+    bool recover_ok;                // recover takes a step (and counts it)
+    uint32_t recover_calls;
+} test_bus_t;
+
+static test_bus_t g_test_bus;
+
+static can_err_t test_bus_open(can_transport_t* transport, const can_transport_config_t* config) {
+    (void)transport;
+    (void)config;
+    return CAN_OK;
+}
+
+static void test_bus_close(can_transport_t* transport) {
+    (void)transport;
+}
+
+static can_err_t test_bus_send(can_transport_t* transport, const can_frame_t* frame, uint32_t timeout_ms) {
+    (void)transport;
+    (void)timeout_ms;
+    if (g_test_bus.tx_full) {
+        return CAN_ERR_TIMEOUT;
+    }
+    if (g_test_bus.sent_count < TEST_BUS_SENT_MAX) {
+        g_test_bus.sent[g_test_bus.sent_count] = *frame;
+    }
+    g_test_bus.sent_count++;
+    return CAN_OK;
+}
+
+static can_err_t test_bus_recv(can_transport_t* transport, can_frame_t* frame, uint32_t timeout_ms) {
+    (void)transport;
+    (void)frame;
+    (void)timeout_ms;
+    return CAN_ERR_TIMEOUT;
+}
+
+static can_err_t test_bus_get_status(can_transport_t* transport, can_bus_status_t* status) {
+    (void)transport;
+    *status = g_test_bus.status;
+    g_test_bus.status.events = 0;
+    return CAN_OK;
+}
+
+static can_err_t test_bus_recover(can_transport_t* transport) {
+    (void)transport;
+    if (!g_test_bus.recover_ok) {
+        return CAN_ERR_INVALID_ARG;
+    }
+    g_test_bus.recover_calls++;
+    return CAN_OK;
+}
+
+static const can_transport_ops_t TEST_BUS_OPS = {
+    .name = "record",
+    .open = test_bus_open,
+    .close = test_bus_close,
+    .send = test_bus_send,
+    .recv = test_bus_recv,
+    .get_status = test_bus_get_status,
+    .recover = test_bus_recover,
+};
+
+// Forget everything recorded and go back to an idle, error-active bus
+static inline void test_bus_reset(void) {
+    memset(&g_test_bus, 0, sizeof(g_test_bus));
+    g_test_bus.recover_ok = true;
+}
+
+static inline bool test_bus_open_on(can_transport_t* bus) {
+    can_transport_config_t config;
+
+    test_bus_reset();
+    memset(&config, 0, sizeof(config));
+    can_transport_init(bus, &TEST_BUS_OPS);
+    return can_transport_open(bus, &config) == CAN_OK;
+}
+
+#endif // TEST_BUS_H
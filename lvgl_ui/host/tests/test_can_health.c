@@ -0,0 +1,168 @@
+/**
+ * @file test_can_health.c
+ * @brief can_health recovery state machine tests
+ *
+ * The controller is the recording transport of test_bus.h: each test sets
+ * the state get_status reports and polls with explicit times, so backoff
+ * delays are checked to the microsecond.
+ */
+
+#include "can_health.h"
+#include "test_util.h"
+#include "test_bus.h"
+
+#define MS  1000u
+
+static can_transport_t g_bus;
+static can_health_t g_health;
+
+static uint32_t g_recovery_events;
+static uint32_t g_last_backoff_ms;
+
+static void record_event(const can_health_event_t* event, void* user_data) {
+    (void)user_data;
+    if (event->type == CAN_HEALTH_EVENT_RECOVERY) {
+        g_recovery_events++;
+        g_last_backoff_ms = event->backoff_ms;
+    }
+}
+
+static void start(uint64_t now_us) {
+    test_bus_reset();
+    can_health_init(&g_health, &g_bus);
+    can_health_set_event_cb(&g_health, record_event, NULL);
+    can_health_reset(&g_health, now_us);
+    g_recovery_events = 0;
+    g_last_backoff_ms = 0;
+}
+
+static void set_state(can_bus_state_t state) {
+    g_test_bus.status.state = state;
+}
+
+// Take the bus off at now_us and poll until the backoff has run out; returns
+// the time the recovery started
+static uint64_t bus_off_and_recover(uint64_t now_us, uint32_t expected_backoff_ms) {
+    uint32_t attempts = g_recovery_events;
+    uint32_t first_wait_ms = (expected_backoff_ms < CAN_HEALTH_POLL_MS) ? expected_backoff_ms : CAN_HEALTH_POLL_MS;
+
+    set_state(CAN_BUS_OFF);
+    CHECK_EQ(can_health_poll(&g_health, now_us), first_wait_ms);
+    CHECK(g_bus.bus_off);
+    can_health_poll(&g_health, now_us + (uint64_t)expected_backoff_ms * MS - 1);
+    CHECK_EQ(g_recovery_events, attempts);      // Not a microsecond early
+    uint64_t recover_us = now_us + (uint64_t)expected_backoff_ms * MS;
+    CHECK_EQ(can_health_poll(&g_health, recover_us), CAN_HEALTH_RECOVER_POLL_MS);
+    CHECK_EQ(g_recovery_events, attempts + 1);
+    CHECK_EQ(g_last_backoff_ms, expected_backoff_ms);
+
+    // Controller goes through recovery and comes back
+    set_state(CAN_BUS_RECOVERING);
+    CHECK_EQ(can_health_poll(&g_health, recover_us + 1 * MS), CAN_HEALTH_RECOVER_POLL_MS);
+    set_state(CAN_BUS_ERROR_ACTIVE);
+    CHECK_EQ(can_health_poll(&g_health, recover_us + 4 * MS), CAN_HEALTH_POLL_MS);
+    CHECK(!g_bus.bus_off);
+    return recover_us + 4 * MS;
+}
+
+// ==================== Tests ====================
+
+static void test_backoff_doubles_to_cap(void) {
+    uint64_t now_us = 1000000;
+    uint32_t backoff_ms = CAN_HEALTH_BACKOFF_MIN_MS;
+
+    start(now_us);
+    // Bus-offs in a row, each before the bus was stable for long
+    for (int i = 0; i < 10; i++) {
+        now_us = bus_off_and_recover(now_us, backoff_ms) + 100 * MS;
+        backoff_ms = (backoff_ms * 2 < CAN_HEALTH_BACKOFF_MAX_MS) ? backoff_ms * 2 : CAN_HEALTH_BACKOFF_MAX_MS;
+    }
+    CHECK_EQ(backoff_ms, CAN_HEALTH_BACKOFF_MAX_MS);
+    CHECK_EQ(g_health.backoff_ms, CAN_HEALTH_BACKOFF_MAX_MS);
+    CHECK_EQ(g_health.bus_off_count, 10);
+    CHECK_EQ(g_health.recoveries, 10);
+    CHECK_EQ(g_test_bus.recover_calls, 10);
+}
+
+static void test_backoff_resets_after_stable(void) {
+    uint64_t now_us = 5000000;
+
+    start(now_us);
+    now_us = bus_off_and_recover(now_us, CAN_HEALTH_BACKOFF_MIN_MS);
+    now_us = bus_off_and_recover(now_us, CAN_HEALTH_BACKOFF_MIN_MS * 2);
+    CHECK_EQ(g_health.backoff_ms, CAN_HEALTH_BACKOFF_MIN_MS * 4);
+
+    // Just short of stable: the backoff keeps growing
+    can_health_poll(&g_health, now_us + (uint64_t)CAN_HEALTH_STABLE_MS * MS - 1);
+    CHECK_EQ(g_health.backoff_ms, CAN_HEALTH_BACKOFF_MIN_MS * 4);
+
+    // A warning restarts the stable period
+    set_state(CAN_BUS_ERROR_WARNING);
+    can_health_poll(&g_health, now_us + (uint64_t)CAN_HEALTH_STABLE_MS * MS - 1);
+    set_state(CAN_BUS_ERROR_ACTIVE);
+    can_health_poll(&g_health, now_us + (uint64_t)CAN_HEALTH_STABLE_MS * MS);
+    CHECK_EQ(g_health.backoff_ms, CAN_HEALTH_BACKOFF_MIN_MS * 4);
+
+    now_us += 2ull * CAN_HEALTH_STABLE_MS * MS;
+    can_health_poll(&g_health, now_us);
+    CHECK_EQ(g_health.backoff_ms, CAN_HEALTH_BACKOFF_MIN_MS);
+    bus_off_and_recover(now_us + 10 * MS, CAN_HEALTH_BACKOFF_MIN_MS);
+}
+
+static void test_fail_fast_while_down(void) {
+    can_frame_t frame = {.id = 0x123, .dlc = 1};
+    uint64_t now_us = 1000000;
+
+    start(now_us);
+    CHECK_EQ(can_transport_send(&g_bus, &frame, 100), CAN_OK);
+
+    set_state(CAN_BUS_OFF);
+    can_health_poll(&g_health, now_us);
+    CHECK_EQ(can_transport_send(&g_bus, &frame, 100), CAN_ERR_BUS_OFF);
+    CHECK_EQ(g_test_bus.sent_count, 1);         // Never reached the driver
+
+    // Still down through recovery and the restart
+    can_health_poll(&g_health, now_us + CAN_HEALTH_BACKOFF_MIN_MS * MS);
+    set_state(CAN_BUS_STOPPED);
+    CHECK_EQ(can_health_poll(&g_health, now_us + 60 * MS), CAN_HEALTH_RECOVER_POLL_MS);
+    CHECK_EQ(g_test_bus.recover_calls, 2);      // Start recovery, then restart
+    CHECK_EQ(can_transport_send(&g_bus, &frame, 100), CAN_ERR_BUS_OFF);
+
+    set_state(CAN_BUS_ERROR_ACTIVE);
+    can_health_poll(&g_health, now_us + 70 * MS);
+    CHECK_EQ(can_transport_send(&g_bus, &frame, 100), CAN_OK);
+    CHECK_EQ(g_test_bus.sent_count, 2);
+}
+
+static void test_backend_recovers_by_itself(void) {
+    uint64_t now_us = 1000000;
+
+    // No recover step (SocketCAN restart-ms): stays down, keeps polling
+    start(now_us);
+    g_test_bus.recover_ok = false;
+    set_state(CAN_BUS_OFF);
+    can_health_poll(&g_health, now_us);
+    CHECK_EQ(can_health_poll(&g_health, now_us + CAN_HEALTH_BACKOFF_MIN_MS * MS), CAN_HEALTH_POLL_MS);
+    CHECK_EQ(g_recovery_events, 0);
+    CHECK(g_bus.bus_off);
+
+    set_state(CAN_BUS_ERROR_ACTIVE);
+    can_health_poll(&g_health, now_us + 200 * MS);
+    CHECK(!g_bus.bus_off);
+    CHECK_EQ(g_health.recoveries, 1);
+}
+
+int main(void) {
+    if (!test_bus_open_on(&g_bus)) {
+        fprintf(stderr, "recording transport did not open\n");
+        return 1;
+    }
+
+    RUN_TEST(test_backoff_doubles_to_cap);
+    RUN_TEST(test_backoff_resets_after_stable);
+    RUN_TEST(test_fail_fast_while_down);
+    RUN_TEST(test_backend_recovers_by_itself);
+
+    can_transport_close(&g_bus);
+    return TEST_EXIT();
+}
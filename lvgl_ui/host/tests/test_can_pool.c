@@ -0,0 +1,124 @@
+/**
+ * @file test_can_pool.c
+ * @brief can_pool block pool tests
+ *
+ * The size-class selection, heap fallback and in-place realloc built on
+ * these pools live in ui_mem.c, which needs LVGL; the tests here cover
+ * the pool properties they rely on.
+ */
+
+#include "can_pool.h"
+#include "test_util.h"
+#include <string.h>
+
+#define BLOCKS 8
+
+CAN_POOL_STORAGE(g_storage, 20, BLOCKS);     // Rounded up to 24-byte blocks
+CAN_POOL_STORAGE(g_tiny_storage, 1, 2);
+
+static can_pool_t g_pool;
+static can_pool_t g_tiny;       // Pools stay registered for can_pool_format()
+
+static void test_blocks_distinct_and_aligned(void) {
+    void* blocks[BLOCKS];
+
+    can_pool_init(&g_pool, "test", g_storage, 20, BLOCKS);
+    CHECK_EQ(g_pool.stats.block_size, 24);
+    CHECK_EQ(g_pool.stats.capacity, BLOCKS);
+    for (int i = 0; i < BLOCKS; i++) {
+        blocks[i] = can_pool_alloc(&g_pool);
+        CHECK(blocks[i] != NULL);
+        CHECK(can_pool_owns(&g_pool, blocks[i]));
+        CHECK_EQ((uintptr_t)blocks[i] % CAN_POOL_ALIGN, 0);
+        memset(blocks[i], 0xA5, 24);       // Whole block is the caller's
+        for (int j = 0; j < i; j++) {
+            CHECK(blocks[i] != blocks[j]);
+        }
+    }
+    // Address order on a fresh pool
+    CHECK(blocks[0] == (void*)g_storage);
+    CHECK((uint8_t*)blocks[BLOCKS - 1] == g_storage + 24 * (BLOCKS - 1));
+    CHECK(!can_pool_owns(&g_pool, g_storage + sizeof(g_storage)));
+    CHECK(!can_pool_owns(&g_pool, &g_pool));
+
+    for (int i = 0; i < BLOCKS; i++) {
+        can_pool_free(&g_pool, blocks[i]);
+    }
+    CHECK_EQ(g_pool.stats.in_use, 0);
+
+    // Small sizes still hold the free-list link
+    can_pool_init(&g_tiny, "tiny", g_tiny_storage, 1, 2);
+    CHECK_EQ(g_tiny.stats.block_size, CAN_POOL_BLOCK_SIZE(sizeof(void*)));
+}
+
+static void test_free_then_alloc_reuses(void) {
+    can_pool_init(&g_pool, "test", g_storage, 20, BLOCKS);
+    void* a = can_pool_alloc(&g_pool);
+    void* b = can_pool_alloc(&g_pool);
+
+    // A pointer swap each way: the block freed last is handed out next
+    can_pool_free(&g_pool, a);
+    CHECK(can_pool_alloc(&g_pool) == a);
+    can_pool_free(&g_pool, b);
+    can_pool_free(&g_pool, a);
+    CHECK(can_pool_alloc(&g_pool) == a);
+    CHECK(can_pool_alloc(&g_pool) == b);
+    can_pool_free(&g_pool, NULL);              // Ignored
+    CHECK_EQ(g_pool.stats.in_use, 2);
+}
+
+static void test_exhaustion_and_high_water(void) {
+    void* blocks[BLOCKS];
+    can_pool_stats_t stats;
+
+    can_pool_init(&g_pool, "test", g_storage, 20, BLOCKS);
+    for (int i = 0; i < 5; i++) {
+        blocks[i] = can_pool_alloc(&g_pool);
+    }
+    for (int i = 0; i < 5; i++) {
+        can_pool_free(&g_pool, blocks[i]);
+    }
+    for (int i = 0; i < 3; i++) {
+        blocks[i] = can_pool_alloc(&g_pool);
+    }
+    can_pool_get_stats(&g_pool, &stats);
+    CHECK_EQ(stats.in_use, 3);
+    CHECK_EQ(stats.high_water, 5);
+
+    // Empty: refused and counted, so the caller can fall back to the heap
+    for (int i = 3; i < BLOCKS; i++) {
+        blocks[i] = can_pool_alloc(&g_pool);
+        CHECK(blocks[i] != NULL);
+    }
+    CHECK(can_pool_alloc(&g_pool) == NULL);
+    CHECK(can_pool_alloc(&g_pool) == NULL);
+    can_pool_get_stats(&g_pool, &stats);
+    CHECK_EQ(stats.exhausted, 2);
+    CHECK_EQ(stats.high_water, BLOCKS);
+    CHECK_EQ(stats.in_use, BLOCKS);
+
+    can_pool_free(&g_pool, blocks[4]);
+    CHECK(can_pool_alloc(&g_pool) == blocks[4]);
+    can_pool_get_stats(&g_pool, &stats);
+    CHECK_EQ(stats.exhausted, 2);
+}
+
+static void test_format(void) {
+    char buf[256];
+
+    can_pool_init(&g_pool, "test", g_storage, 20, BLOCKS);
+    can_pool_alloc(&g_pool);
+    can_pool_alloc(&g_pool);
+    can_pool_format(buf, sizeof(buf));
+    CHECK(strstr(buf, "test 2/8 hw 2 !0") != NULL);
+    CHECK(strstr(buf, "tiny 0/2 hw 0 !0") != NULL);
+    CHECK_EQ(can_pool_format(buf, 0), 0);
+}
+
+int main(void) {
+    RUN_TEST(test_blocks_distinct_and_aligned);
+    RUN_TEST(test_free_then_alloc_reuses);
+    RUN_TEST(test_exhaustion_and_high_water);
+    RUN_TEST(test_format);
+    return TEST_EXIT();
+}
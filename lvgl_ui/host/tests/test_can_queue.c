@@ -0,0 +1,206 @@
+/**
+ * @file test_can_queue.c
+ * @brief can_queue bounded lock-free queue tests
+ */
+
+#include "can_queue.h"
+#include "can_port.h"
+#include "test_util.h"
+#include <string.h>
+
+#define QUEUE_LEN   8
+
+typedef struct {
+    uint32_t value;
+    uint8_t tag[9];     // Odd size: element not a multiple of the slot alignment
+} elem_t;
+
+CAN_QUEUE_STORAGE(g_storage, sizeof(elem_t), QUEUE_LEN);
+
+static elem_t make_elem(uint32_t value) {
+    elem_t elem;
+
+    memset(&elem, 0, sizeof(elem));
+    elem.value = value;
+    for (uint8_t i = 0; i < sizeof(elem.tag); i++) {
+        elem.tag[i] = (uint8_t)(value + i);
+    }
+    return elem;
+}
+
+static bool elem_is(const elem_t* elem, uint32_t value) {
+    elem_t expected = make_elem(value);
+    return memcmp(elem, &expected, sizeof(elem_t)) == 0;
+}
+
+// Move a fresh queue's free-running positions to base, as if base elements
+// had passed through it (slot i holds sequence number i after init)
+static void start_at(can_queue_t* queue, uint32_t base) {
+    for (uint32_t i = 0; i < QUEUE_LEN; i++) {
+        uint32_t pos = base + i;
+        atomic_store((atomic_uint_least32_t*)(g_storage + (pos & queue->mask) * queue->slot_size), pos);
+    }
+    atomic_store(&queue->head, base);
+    atomic_store(&queue->tail, base);
+}
+
+// ==================== Tests ====================
+
+static void test_init_rejects_bad_capacity(void) {
+    can_queue_t queue;
+
+    CHECK(!can_queue_init(&queue, "bad", g_storage, sizeof(elem_t), 0));
+    CHECK(!can_queue_init(&queue, "bad", g_storage, sizeof(elem_t), 6));
+    CHECK(can_queue_init(&queue, "ok", g_storage, sizeof(elem_t), QUEUE_LEN));
+    CHECK_EQ(queue.slot_size % CAN_QUEUE_ALIGN, 0);
+}
+
+static void test_empty_and_full(void) {
+    can_queue_t queue;
+    can_queue_stats_t stats;
+    elem_t elem;
+
+    CHECK(can_queue_init(&queue, "q", g_storage, sizeof(elem_t), QUEUE_LEN));
+    CHECK(!can_queue_pop(&queue, &elem));
+    CHECK_EQ(can_queue_count(&queue), 0);
+
+    for (uint32_t i = 0; i < QUEUE_LEN; i++) {
+        elem = make_elem(i);
+        CHECK(can_queue_push(&queue, &elem));
+    }
+    CHECK_EQ(can_queue_count(&queue), QUEUE_LEN);
+    elem = make_elem(99);
+    CHECK(!can_queue_push(&queue, &elem));
+    CHECK(!can_queue_push(&queue, &elem));
+
+    can_queue_get_stats(&queue, &stats);
+    CHECK_EQ(stats.capacity, QUEUE_LEN);
+    CHECK_EQ(stats.count, QUEUE_LEN);
+    CHECK_EQ(stats.high_water, QUEUE_LEN);
+    CHECK_EQ(stats.dropped, 2);
+
+    // The refused elements did not overwrite anything
+    for (uint32_t i = 0; i < QUEUE_LEN; i++) {
+        CHECK(can_queue_pop(&queue, &elem));
+        CHECK(elem_is(&elem, i));
+    }
+    CHECK(!can_queue_pop(&queue, &elem));
+    CHECK_EQ(can_queue_count(&queue), 0);
+    can_queue_get_stats(&queue, &stats);
+    CHECK_EQ(stats.high_water, QUEUE_LEN);
+}
+
+static void test_ring_wraparound(void) {
+    can_queue_t queue;
+    can_queue_stats_t stats;
+    elem_t elem;
+    uint32_t next_in = 0;
+    uint32_t next_out = 0;
+
+    // Uneven push/pop batches walk the ring many times over
+    CHECK(can_queue_init(&queue, "q", g_storage, sizeof(elem_t), QUEUE_LEN));
+    for (uint32_t round = 0; round < 1000; round++) {
+        uint32_t pushes = 1 + round % 5;
+        uint32_t pops = 1 + (round * 7) % 5;
+        for (uint32_t i = 0; i < pushes && can_queue_count(&queue) < QUEUE_LEN; i++) {
+            elem = make_elem(next_in++);
+            CHECK(can_queue_push(&queue, &elem));
+        }
+        for (uint32_t i = 0; i < pops && next_out < next_in; i++) {
+            CHECK(can_queue_pop(&queue, &elem));
+            CHECK(elem_is(&elem, next_out));
+            next_out++;
+        }
+        CHECK_EQ(can_queue_count(&queue), next_in - next_out);
+    }
+    CHECK(next_in > 10 * QUEUE_LEN);
+    can_queue_get_stats(&queue, &stats);
+    CHECK_EQ(stats.dropped, 0);
+    CHECK(stats.high_water <= QUEUE_LEN);
+}
+
+static void test_position_counter_wrap(void) {
+    can_queue_t queue;
+    elem_t elem;
+
+    // Fill and drain across the 32-bit wrap of the positions
+    CHECK(can_queue_init(&queue, "q", g_storage, sizeof(elem_t), QUEUE_LEN));
+    start_at(&queue, UINT32_MAX - 3);
+    for (uint32_t round = 0; round < 3; round++) {
+        for (uint32_t i = 0; i < QUEUE_LEN; i++) {
+            elem = make_elem(round * 100 + i);
+            CHECK(can_queue_push(&queue, &elem));
+        }
+        CHECK(!can_queue_push(&queue, &elem));
+        CHECK_EQ(can_queue_count(&queue), QUEUE_LEN);
+        for (uint32_t i = 0; i < QUEUE_LEN; i++) {
+            CHECK(can_queue_pop(&queue, &elem));
+            CHECK(elem_is(&elem, round * 100 + i));
+        }
+        CHECK(!can_queue_pop(&queue, &elem));
+        CHECK_EQ(can_queue_count(&queue), 0);
+    }
+}
+
+// ==================== Concurrent Producers ====================
+
+#define PRODUCERS           3
+#define PRODUCER_ITEMS      20000
+
+static can_queue_t g_shared;
+static atomic_uint g_producers_done;
+
+static void producer_task(void* arg) {
+    uint32_t id = (uint32_t)(uintptr_t)arg;
+
+    for (uint32_t i = 0; i < PRODUCER_ITEMS; i++) {
+        elem_t elem = make_elem((id << 24) | i);
+        while (!can_queue_push(&g_shared, &elem)) {
+            can_port_sleep_ms(0);
+        }
+    }
+    atomic_fetch_add(&g_producers_done, 1);
+}
+
+static void test_concurrent_producers(void) {
+    static const can_port_task_config_t task = {.name = "producer", .stack_size = 64 * 1024, .core = CAN_PORT_CORE_ANY};
+    uint32_t next[PRODUCERS] = {0};
+    uint32_t received = 0;
+    elem_t elem;
+
+    // Every element arrives exactly once and in order per producer
+    CHECK(can_queue_init(&g_shared, "mp", g_storage, sizeof(elem_t), QUEUE_LEN));
+    atomic_store(&g_producers_done, 0);
+    for (uint32_t p = 0; p < PRODUCERS; p++) {
+        CHECK(can_port_task_create(&task, producer_task, (void*)(uintptr_t)p));
+    }
+    while (received < PRODUCERS * PRODUCER_ITEMS) {
+        if (!can_queue_pop(&g_shared, &elem)) {
+            can_port_sleep_ms(0);
+            continue;
+        }
+        uint32_t p = elem.value >> 24;
+        CHECK(p < PRODUCERS);
+        if (p < PRODUCERS) {
+            CHECK(elem_is(&elem, (p << 24) | next[p]));
+            next[p]++;
+        }
+        received++;
+    }
+    while (atomic_load(&g_producers_done) < PRODUCERS) {
+        can_port_sleep_ms(1);
+    }
+    CHECK(!can_queue_pop(&g_shared, &elem));
+    for (uint32_t p = 0; p < PRODUCERS; p++) {
+        CHECK_EQ(next[p], PRODUCER_ITEMS);
+    }
+}
+
+int main(void) {
+    RUN_TEST(test_init_rejects_bad_capacity);
+    RUN_TEST(test_empty_and_full);
+    RUN_TEST(test_ring_wraparound);
+    RUN_TEST(test_position_counter_wrap);
+    RUN_TEST(test_concurrent_producers);
+    return TEST_EXIT();
+}
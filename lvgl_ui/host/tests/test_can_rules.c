@@ -0,0 +1,230 @@
+/**
+ * @file test_can_rules.c
+ * @brief can_rules matching and reply tests
+ *
+ * Replies go through a scheduler into the recording transport of
+ * test_bus.h; one can_scheduler_run_once() after each frame sends them in
+ * the order the rules fired.
+ */
+
+#include "can_rules.h"
+#include "test_util.h"
+#include "test_bus.h"
+
+#define EXACT_RULES 24
+
+static can_transport_t g_bus;
+static can_scheduler_t g_sched;
+static can_rules_t g_rules;
+
+static can_rule_t send_rule(uint32_t id, uint32_t id_mask, uint8_t tag) {
+    can_rule_t rule = {
+        .id = id,
+        .id_mask = id_mask,
+        .action = CAN_RULE_SEND,
+        .reply = {.id = 0x7E8, .dlc = 1, .data = {tag}}
+    };
+    return rule;
+}
+
+// Feed one frame; returns the rules fired and leaves the replies in g_test_bus
+static uint8_t feed(uint32_t id, uint8_t flags, uint8_t dlc, const uint8_t* data) {
+    can_frame_t frame = {.id = id, .dlc = dlc, .flags = flags};
+
+    if (data != NULL) {
+        memcpy(frame.data, data, dlc);
+    }
+    g_test_bus.sent_count = 0;
+    uint8_t fired = can_rules_process(&g_rules, &frame);
+    can_scheduler_run_once(&g_sched);
+    CHECK_EQ(g_test_bus.sent_count, fired);
+    return fired;
+}
+
+// ==================== Tests ====================
+
+static void test_exact_index(void) {
+    static can_rule_t rules[EXACT_RULES + 2];
+
+    // 26 exact rules in 32 buckets: some chains hold several rules
+    for (uint8_t i = 0; i < EXACT_RULES; i++) {
+        rules[i] = send_rule(0x100 + 7u * i, CAN_RULE_ID_EXACT, i);
+    }
+    rules[EXACT_RULES] = send_rule(0x100, CAN_RULE_ID_EXACT, 0xEE);     // Same ID, fires second
+    rules[EXACT_RULES + 1] = send_rule(0x100, CAN_RULE_ID_EXACT, 0xEF);
+    rules[EXACT_RULES + 1].extended = true;
+    CHECK(can_rules_compile(&g_rules, rules, EXACT_RULES + 2, &g_sched));
+    CHECK_EQ(g_rules.wildcard_count, 0);
+    uint8_t longest = 0;
+    for (uint32_t b = 0; b < (1u << CAN_RULES_HASH_BITS); b++) {
+        uint8_t len = 0;
+        for (uint8_t i = g_rules.bucket[b]; i != 0xFF; i = g_rules.next[i]) {
+            len++;
+        }
+        if (len > longest) {
+            longest = len;
+        }
+    }
+    CHECK(longest >= 3);       // The three 0x100 rules at least
+
+    for (uint8_t i = 1; i < EXACT_RULES; i++) {
+        CHECK_EQ(feed(0x100 + 7u * i, 0, 0, NULL), 1);
+        CHECK_EQ(g_test_bus.sent[0].data[0], i);
+        CHECK_EQ(g_rules.hits[i], 1);
+    }
+    CHECK_EQ(feed(0x100, 0, 0, NULL), 2);
+    CHECK_EQ(g_test_bus.sent[0].data[0], 0);
+    CHECK_EQ(g_test_bus.sent[1].data[0], 0xEE);
+    CHECK_EQ(feed(0x100, CAN_FRAME_FLAG_EXT, 0, NULL), 1);
+    CHECK_EQ(g_test_bus.sent[0].data[0], 0xEF);
+
+    // IDs between the rules, and remote frames, fire nothing
+    for (uint32_t id = 0x101; id < 0x100 + 7u * EXACT_RULES; id += 7) {
+        CHECK_EQ(feed(id, 0, 0, NULL), 0);
+    }
+    CHECK_EQ(feed(0x107, CAN_FRAME_FLAG_RTR, 0, NULL), 0);
+}
+
+static void test_wildcard_order(void) {
+    static can_rule_t rules[4];
+
+    rules[0] = send_rule(0x700, 0x700, 0xA0);          // 0x700-0x7FF
+    rules[1] = send_rule(0x7E0, CAN_RULE_ID_EXACT, 0xB0);
+    rules[2] = send_rule(0x7E0, 0x7F0, 0xC0);          // 0x7E0-0x7EF
+    rules[3] = send_rule(0x000, 0x000, 0xD0);          // Every standard ID
+    CHECK(can_rules_compile(&g_rules, rules, 4, &g_sched));
+    CHECK_EQ(g_rules.wildcard_count, 3);
+
+    // Exact-ID rules first, then masked ones in declaration order
+    CHECK_EQ(feed(0x7E0, 0, 0, NULL), 4);
+    CHECK_EQ(g_test_bus.sent[0].data[0], 0xB0);
+    CHECK_EQ(g_test_bus.sent[1].data[0], 0xA0);
+    CHECK_EQ(g_test_bus.sent[2].data[0], 0xC0);
+    CHECK_EQ(g_test_bus.sent[3].data[0], 0xD0);
+
+    CHECK_EQ(feed(0x7F5, 0, 0, NULL), 2);
+    CHECK_EQ(g_test_bus.sent[0].data[0], 0xA0);
+    CHECK_EQ(g_test_bus.sent[1].data[0], 0xD0);
+    CHECK_EQ(feed(0x123, 0, 0, NULL), 1);
+    CHECK_EQ(feed(0x7E0, CAN_FRAME_FLAG_EXT, 0, NULL), 0);    // Standard rules only
+}
+
+static void test_data_mask_and_min_dlc(void) {
+    static can_rule_t rules[3];
+    static const uint8_t request[] = {0x02, 0x3E, 0x80};
+    static const uint8_t other_service[] = {0x02, 0x10, 0x80};
+    static const uint8_t low_nibble[] = {0x12, 0x3E};
+
+    rules[0] = send_rule(0x7DF, CAN_RULE_ID_EXACT, 0x01);
+    rules[0].data_mask[0] = 0x0F;                       // Length nibble only
+    rules[0].data_value[0] = 0x02;
+    rules[0].data_mask[1] = 0xFF;
+    rules[0].data_value[1] = 0x3E;
+    rules[1] = send_rule(0x7DF, CAN_RULE_ID_EXACT, 0x02);
+    rules[1].data_mask[3] = 0xFF;                       // Raises min_dlc to 4
+    rules[1].data_value[3] = 0x00;
+    rules[2] = send_rule(0x7DF, CAN_RULE_ID_EXACT, 0x03);
+    rules[2].min_dlc = 3;
+    CHECK(can_rules_compile(&g_rules, rules, 3, &g_sched));
+    CHECK_EQ(g_rules.match[1].min_dlc, 4);
+
+    CHECK_EQ(feed(0x7DF, 0, 3, request), 2);
+    CHECK_EQ(g_test_bus.sent[0].data[0], 0x01);
+    CHECK_EQ(g_test_bus.sent[1].data[0], 0x03);
+    CHECK_EQ(feed(0x7DF, 0, 2, low_nibble), 1);         // Upper nibble ignored
+    CHECK_EQ(feed(0x7DF, 0, 3, other_service), 1);      // Only the DLC rule
+    CHECK_EQ(g_test_bus.sent[0].data[0], 0x03);
+    CHECK_EQ(feed(0x7DF, 0, 1, request), 0);            // Too short for all three
+
+    // Bytes past the DLC never match a masked zero
+    CHECK_EQ(feed(0x7DF, 0, 3, other_service), 1);
+    CHECK_EQ(g_rules.hits[1], 0);
+}
+
+static void test_copy_mask_reply(void) {
+    static can_rule_t rules[1];
+    static const uint8_t request[] = {0x03, 0x22, 0xF1, 0x90, 0x55};
+
+    rules[0] = send_rule(0x7E0, CAN_RULE_ID_EXACT, 0);
+    rules[0].reply.dlc = 5;
+    rules[0].reply.data[0] = 0x05;
+    rules[0].reply.data[1] = 0x62;
+    rules[0].reply.data[4] = 0xAA;
+    rules[0].copy_mask = (1u << 2) | (1u << 3);         // Echo the DID
+    CHECK(can_rules_compile(&g_rules, rules, 1, &g_sched));
+
+    CHECK_EQ(feed(0x7E0, 0, 5, request), 1);
+    const can_frame_t* reply = &g_test_bus.sent[0];
+    CHECK_EQ(reply->id, 0x7E8);
+    CHECK_EQ(reply->dlc, 5);
+    CHECK_EQ(reply->data[0], 0x05);
+    CHECK_EQ(reply->data[1], 0x62);
+    CHECK_EQ(reply->data[2], 0xF1);
+    CHECK_EQ(reply->data[3], 0x90);
+    CHECK_EQ(reply->data[4], 0xAA);
+}
+
+static void test_periodic_slots(void) {
+    static const can_periodic_def_t heartbeat = {.frame = {.id = 0x500, .dlc = 1}, .period_ms = 1000};
+    static can_rule_t rules[2];
+
+    rules[0] = send_rule(0x600, CAN_RULE_ID_EXACT, 0);
+    rules[0].action = CAN_RULE_START_PERIODIC;
+    rules[0].periodic = &heartbeat;
+    rules[0].slot = 1;
+    rules[1] = send_rule(0x601, CAN_RULE_ID_EXACT, 0);
+    rules[1].action = CAN_RULE_STOP_PERIODIC;
+    rules[1].slot = 1;
+    CHECK(can_rules_compile(&g_rules, rules, 2, &g_sched));
+
+    CHECK_EQ(can_rules_process(&g_rules, &(can_frame_t){.id = 0x600}), 1);
+    int handle = g_rules.slot_handle[1];
+    CHECK(handle >= 0);
+    CHECK_EQ(can_rules_process(&g_rules, &(can_frame_t){.id = 0x600}), 1);     // Already running
+    CHECK_EQ(g_rules.slot_handle[1], handle);
+    CHECK_EQ(can_rules_process(&g_rules, &(can_frame_t){.id = 0x601}), 1);
+    CHECK_EQ(g_rules.slot_handle[1], -1);
+    CHECK_EQ(atomic_load(&g_sched.periodic[handle].run), 0);
+    can_rules_reset(&g_rules);
+    CHECK_EQ(g_rules.hits[0], 0);
+}
+
+static void test_invalid_rules(void) {
+    static can_rule_t bad_dlc[1];
+    static can_rule_t bad_slot[1];
+    static can_rule_t no_def[1];
+
+    bad_dlc[0] = send_rule(0x100, CAN_RULE_ID_EXACT, 0);
+    bad_dlc[0].reply.dlc = CAN_MAX_DLC + 1;
+    bad_slot[0] = send_rule(0x100, CAN_RULE_ID_EXACT, 0);
+    bad_slot[0].action = CAN_RULE_STOP_PERIODIC;
+    bad_slot[0].slot = CAN_RULES_MAX_SLOTS;
+    no_def[0] = send_rule(0x100, CAN_RULE_ID_EXACT, 0);
+    no_def[0].action = CAN_RULE_START_PERIODIC;
+
+    CHECK(!can_rules_compile(&g_rules, bad_dlc, 1, &g_sched));
+    CHECK(!can_rules_compile(&g_rules, bad_slot, 1, &g_sched));
+    CHECK(!can_rules_compile(&g_rules, no_def, 1, &g_sched));
+    CHECK(!can_rules_compile(&g_rules, NULL, 1, &g_sched));
+    CHECK(!can_rules_compile(&g_rules, bad_dlc, CAN_RULES_MAX + 1, &g_sched));
+    CHECK(can_rules_compile(&g_rules, NULL, 0, &g_sched));
+    CHECK_EQ(can_rules_process(&g_rules, &(can_frame_t){.id = 0x100}), 0);
+}
+
+int main(void) {
+    if (!test_bus_open_on(&g_bus) || !can_scheduler_init(&g_sched, &g_bus)) {
+        fprintf(stderr, "recording transport or scheduler did not start\n");
+        return 1;
+    }
+
+    RUN_TEST(test_exact_index);
+    RUN_TEST(test_wildcard_order);
+    RUN_TEST(test_data_mask_and_min_dlc);
+    RUN_TEST(test_copy_mask_reply);
+    RUN_TEST(test_periodic_slots);
+    RUN_TEST(test_invalid_rules);
+
+    can_scheduler_deinit(&g_sched);
+    can_transport_close(&g_bus);
+    return TEST_EXIT();
+}
@@ -0,0 +1,322 @@
+/**
+ * @file test_can_scheduler.c
+ * @brief can_scheduler request, periodic edit, sweep and phase planner tests
+ *
+ * Request, edit and sweep tests drive can_scheduler_run_once() by hand against the
+ * recording transport of test_bus.h. Planner entries are planned against the real millisecond clock, so the cases keep
+ * enough room on the phase circle that a collision-free slot exists whatever
+ * millisecond each add lands on. Collisions are recounted here from the
+ * planned phases with the rule of the planner (phases closer than one
+ * CAN_SCHED_PHASE_SLOT_MS modulo the gcd of the periods).
+ */
+
+#include "can_scheduler.h"
+#include "test_util.h"
+#include "test_bus.h"
+
+// ==================== Sequence Requests ====================
+
+static can_scheduler_t* g_stop_sched;      // Stopped from inside the next CANCELLED event
+static uint32_t g_cancelled;
+
+static void stop_on_cancel(const can_sched_event_t* event, void* user_data) {
+    (void)user_data;
+    if (event->type != CAN_SCHED_EVENT_SEQ_CANCELLED) {
+        return;
+    }
+    g_cancelled++;
+    if (g_stop_sched != NULL) {
+        can_scheduler_t* sched = g_stop_sched;
+        g_stop_sched = NULL;
+        can_scheduler_stop_sequence(sched);
+    }
+}
+
+static void test_stop_between_take_and_start(void) {
+    static const uint8_t first[] = {
+        CAN_SEQ_SEND(0x100, 1, 0x01, 0, 0, 0, 0, 0, 0, 0),
+        CAN_SEQ_WAIT(60000),
+        CAN_SEQ_END
+    };
+    static const uint8_t second[] = {
+        CAN_SEQ_SEND(0x200, 1, 0x02, 0, 0, 0, 0, 0, 0, 0),
+        CAN_SEQ_END
+    };
+    can_transport_t bus;
+    can_scheduler_t sched;
+
+    CHECK(test_bus_open_on(&bus));
+    CHECK(can_scheduler_init(&sched, &bus));
+    can_scheduler_set_event_cb(&sched, stop_on_cancel, NULL);
+    g_cancelled = 0;
+    g_stop_sched = NULL;
+
+    CHECK(can_scheduler_start_sequence(&sched, "FIRST", first, sizeof(first)));
+    can_scheduler_run_once(&sched);
+    CHECK_EQ(g_test_bus.sent_count, 1);
+    CHECK_EQ(can_seq_get_status(&sched.seq), CAN_SEQ_RUNNING);
+
+    // The replaced sequence's CANCELLED event comes after the TX task took
+    // the new request and before it starts it: a STOP there must still win
+    CHECK(can_scheduler_start_sequence(&sched, "SECOND", second, sizeof(second)));
+    g_stop_sched = &sched;
+    can_scheduler_run_once(&sched);
+    CHECK_EQ(g_test_bus.sent_count, 1);
+    CHECK_EQ(can_seq_get_status(&sched.seq), CAN_SEQ_CANCELLED);
+    CHECK_EQ(g_cancelled, 2);
+
+    // A STOP before the TX task sees the request drops the request
+    CHECK(can_scheduler_start_sequence(&sched, "SECOND", second, sizeof(second)));
+    can_scheduler_stop_sequence(&sched);
+    can_scheduler_run_once(&sched);
+    CHECK_EQ(g_test_bus.sent_count, 1);
+
+    // An old STOP does not cancel a later start
+    CHECK(can_scheduler_start_sequence(&sched, "SECOND", second, sizeof(second)));
+    can_scheduler_run_once(&sched);
+    CHECK_EQ(g_test_bus.sent_count, 2);
+    CHECK_EQ(g_test_bus.sent[1].id, 0x200);
+    CHECK_EQ(can_seq_get_status(&sched.seq), CAN_SEQ_DONE);
+
+    can_scheduler_deinit(&sched);
+    can_transport_close(&bus);
+}
+
+// ==================== Periodic Edits ====================
+
+// Run the scheduler until the next frame goes out; false if none does
+static bool run_until_sent(can_scheduler_t* sched) {
+    uint32_t before = g_test_bus.sent_count;
+
+    for (int i = 0; i < 100 && g_test_bus.sent_count == before; i++) {
+        uint32_t wait_ms = can_scheduler_run_once(sched);
+        if (g_test_bus.sent_count == before && wait_ms > 0) {
+            can_port_sleep_ms((wait_ms < 50) ? wait_ms : 50);
+        }
+    }
+    return g_test_bus.sent_count == before + 1;
+}
+
+static void test_live_edit_between_sends(void) {
+    can_periodic_def_t def = {
+        .frame = {.id = 0x3B0, .dlc = 2, .data = {0x00, 0xA0}},
+        .period_ms = 50,
+        .xform_count = 1,
+        .xforms = {CAN_XFORM_COUNTER(0, 0x0F)}
+    };
+    can_transport_t bus;
+    can_scheduler_t sched;
+
+    CHECK(test_bus_open_on(&bus));
+    CHECK(can_scheduler_init(&sched, &bus));
+    int handle = can_scheduler_add_periodic(&sched, &def);
+    CHECK(handle >= 0);
+    can_periodic_t* entry = &sched.periodic[handle];
+
+    CHECK(run_until_sent(&sched));
+    CHECK_EQ(g_test_bus.sent[0].data[1], 0xA0);
+    uint64_t due_us = entry->next_us;
+
+    // New payload: lands on the next send, deadline and counter unchanged
+    def.frame.data[1] = 0xB0;
+    CHECK(can_scheduler_update_periodic(&sched, handle, &def));
+    CHECK_EQ(entry->next_us, due_us);
+    CHECK(run_until_sent(&sched));
+    CHECK_EQ(g_test_bus.sent[1].data[1], 0xB0);
+    CHECK_EQ(g_test_bus.sent[1].data[0], 1);
+    CHECK_EQ(entry->next_us, due_us + 50000);
+    due_us = entry->next_us;
+
+    // New period: the planned send keeps its time, the one after moves
+    def.period_ms = 120;
+    CHECK(can_scheduler_update_periodic(&sched, handle, &def));
+    CHECK_EQ(entry->next_us, due_us);
+    CHECK(run_until_sent(&sched));
+    CHECK_EQ(g_test_bus.sent[2].data[0], 2);
+    CHECK_EQ(entry->next_us, due_us + 120000);
+
+    def.period_ms = 0;
+    CHECK(!can_scheduler_update_periodic(&sched, handle, &def));
+    can_scheduler_remove_periodic(&sched, handle);
+    CHECK(!can_scheduler_update_periodic(&sched, handle, &def));
+
+    can_scheduler_deinit(&sched);
+    can_transport_close(&bus);
+}
+
+// ==================== Sweep ====================
+
+static can_sweep_progress_t g_sweep_done;
+static bool g_sweep_ended;
+
+static void record_sweep(const can_sched_event_t* event, void* user_data) {
+    (void)user_data;
+    if (event->type == CAN_SCHED_EVENT_SWEEP_DONE) {
+        g_sweep_done = *event->sweep;
+        g_sweep_ended = true;
+    }
+}
+
+static void test_sweep_counts_bus_errors(void) {
+    can_sweep_config_t config = {.id_first = 0x600, .id_last = 0x603, .dlc = 1, .per_id = 2};
+    can_transport_t bus;
+    can_scheduler_t sched;
+    can_bus_status_t status;
+
+    CHECK(test_bus_open_on(&bus));
+    CHECK(can_scheduler_init(&sched, &bus));
+    can_scheduler_set_event_cb(&sched, record_sweep, NULL);
+    g_sweep_ended = false;
+
+    // Errors from before the sweep do not count
+    g_test_bus.status.bus_errors = 7;
+    CHECK_EQ(can_transport_get_status(&bus, &status), CAN_OK);
+    CHECK(can_scheduler_start_sweep(&sched, &config));
+    g_test_bus.tx_full = true;          // Keeps the sweep queued for now
+    can_scheduler_run_once(&sched);
+    CHECK(!g_sweep_ended);
+
+    // The health monitor reads the status while the sweep runs
+    g_test_bus.status.bus_errors = 10;
+    CHECK_EQ(can_transport_get_status(&bus, &status), CAN_OK);
+    g_test_bus.tx_full = false;
+    for (int i = 0; i < 10 && !g_sweep_ended; i++) {
+        can_scheduler_run_once(&sched);
+    }
+    CHECK(g_sweep_ended);
+    CHECK_EQ(g_sweep_done.sent, 8);
+    CHECK_EQ(g_sweep_done.total, 8);
+    CHECK_EQ(g_sweep_done.errors, 3);
+    CHECK_EQ(g_sweep_done.current_id, 0x603);
+    CHECK_EQ(g_test_bus.sent_count, 8);
+
+    can_scheduler_deinit(&sched);
+    can_transport_close(&bus);
+}
+
+// ==================== Phase Planner ====================
+
+static uint32_t g_periods[CAN_SCHED_MAX_PERIODIC];   // By handle
+
+static uint32_t gcd(uint32_t a, uint32_t b) {
+    while (b != 0) {
+        uint32_t t = a % b;
+        a = b;
+        b = t;
+    }
+    return a;
+}
+
+static bool collide(const can_scheduler_t* sched, int a, int b) {
+    int32_t g = (int32_t)gcd(g_periods[a], g_periods[b]);
+    int32_t diff = (int32_t)(atomic_load(&sched->periodic[a].phase_ms) - atomic_load(&sched->periodic[b].phase_ms));
+    int32_t d = ((diff % g) + g) % g;
+    if (d > g - d) {
+        d = g - d;
+    }
+    return d < CAN_SCHED_PHASE_SLOT_MS;
+}
+
+// Frames per slot of the worst entry (itself plus every entry it meets)
+static uint8_t count_peak(const can_scheduler_t* sched, const int* handles, int n) {
+    uint8_t peak = 0;
+
+    for (int i = 0; i < n; i++) {
+        uint8_t load = 1;
+        for (int j = 0; j < n; j++) {
+            if (j != i && collide(sched, handles[i], handles[j])) {
+                load++;
+            }
+        }
+        if (load > peak) {
+            peak = load;
+        }
+    }
+    return peak;
+}
+
+static int add_entry(can_scheduler_t* sched, uint32_t id, uint32_t period_ms) {
+    can_periodic_def_t def = {.frame = {.id = id, .dlc = 1}, .period_ms = period_ms};
+    int handle = can_scheduler_add_periodic(sched, &def);
+    if (handle >= 0) {
+        g_periods[handle] = period_ms;
+    }
+    return handle;
+}
+
+static void test_equal_periods_spread(void) {
+    can_scheduler_t sched;
+    int handles[10];
+
+    CHECK(can_scheduler_init(&sched, NULL));
+    CHECK_EQ(can_scheduler_get_peak_load(&sched), 0);
+    for (int i = 0; i < 10; i++) {
+        handles[i] = add_entry(&sched, 0x100 + i, 100);
+        CHECK(handles[i] >= 0);
+    }
+    CHECK_EQ(count_peak(&sched, handles, 10), 1);
+    CHECK_EQ(can_scheduler_get_peak_load(&sched), 1);
+    can_scheduler_deinit(&sched);
+}
+
+static void test_mixed_periods_spread(void) {
+    static const uint32_t periods[] = {10, 20, 40, 100};
+    can_scheduler_t sched;
+    int handles[4];
+
+    CHECK(can_scheduler_init(&sched, NULL));
+    for (int i = 0; i < 4; i++) {
+        handles[i] = add_entry(&sched, 0x200 + i, periods[i]);
+        CHECK(handles[i] >= 0);
+    }
+    CHECK_EQ(count_peak(&sched, handles, 4), 1);
+    CHECK_EQ(can_scheduler_get_peak_load(&sched), 1);
+    can_scheduler_deinit(&sched);
+}
+
+static void test_saturated_circle(void) {
+    can_scheduler_t sched;
+    int handles[12];
+
+    // 12 entries on a 10 ms circle cannot all keep one slot apart
+    CHECK(can_scheduler_init(&sched, NULL));
+    for (int i = 0; i < 12; i++) {
+        handles[i] = add_entry(&sched, 0x300 + i, 10);
+        CHECK(handles[i] >= 0);
+    }
+    uint8_t peak = count_peak(&sched, handles, 12);
+    CHECK(peak >= 2 && peak < 12);
+    CHECK_EQ(can_scheduler_get_peak_load(&sched), peak);
+
+    // Removing entries recomputes the bound
+    for (int i = 2; i < 12; i++) {
+        can_scheduler_remove_periodic(&sched, handles[i]);
+    }
+    CHECK_EQ(can_scheduler_get_peak_load(&sched), count_peak(&sched, handles, 2));
+    can_scheduler_clear_periodic(&sched);
+    CHECK_EQ(can_scheduler_get_peak_load(&sched), 0);
+    can_scheduler_deinit(&sched);
+}
+
+static void test_first_entry_not_delayed(void) {
+    can_scheduler_t sched;
+
+    CHECK(can_scheduler_init(&sched, NULL));
+    uint32_t before_ms = (uint32_t)(can_port_time_us() / 1000u);
+    int handle = add_entry(&sched, 0x400, 1000);
+    uint32_t after_ms = (uint32_t)(can_port_time_us() / 1000u);
+    uint32_t phase_ms = atomic_load(&sched.periodic[handle].phase_ms);
+    CHECK(phase_ms - before_ms <= after_ms - before_ms);
+    can_scheduler_deinit(&sched);
+}
+
+int main(void) {
+    RUN_TEST(test_stop_between_take_and_start);
+    RUN_TEST(test_live_edit_between_sends);
+    RUN_TEST(test_sweep_counts_bus_errors);
+    RUN_TEST(test_equal_periods_spread);
+    RUN_TEST(test_mixed_periods_spread);
+    RUN_TEST(test_saturated_circle);
+    RUN_TEST(test_first_entry_not_delayed);
+    return TEST_EXIT();
+}
@@ -0,0 +1,166 @@
+/**
+ * @file test_can_sequence.c
+ * @brief can_sequence bytecode validation and cancellation tests
+ */
+
+#include "can_sequence.h"
+#include "can_port.h"
+#include "test_util.h"
+
+static void test_valid_program(void) {
+    static const uint8_t code[] = {
+        CAN_SEQ_SEND(0x3B0, 2, 0x01, 0x00, 0, 0, 0, 0, 0, 0),
+        CAN_SEQ_WAIT(20),
+        CAN_SEQ_WAIT_RX(0x7B0, 0x7FF, 500),
+        CAN_SEQ_MARK,
+            CAN_SEQ_SEND_EXT(0x18DAF110, 8, 1, 2, 3, 4, 5, 6, 7, 8),
+            CAN_SEQ_WAIT(100),
+        CAN_SEQ_LOOP(5),
+        CAN_SEQ_END
+    };
+    uint16_t steps = 0;
+
+    CHECK(can_seq_validate(code, sizeof(code), &steps));
+    CHECK_EQ(steps, 5);
+    CHECK(can_seq_validate(code, sizeof(code), NULL));
+}
+
+static void test_nested_loops(void) {
+    static const uint8_t two_levels[] = {
+        CAN_SEQ_MARK,
+            CAN_SEQ_MARK,
+                CAN_SEQ_SEND(0x100, 0, 0, 0, 0, 0, 0, 0, 0, 0),
+            CAN_SEQ_LOOP(3),
+            CAN_SEQ_WAIT(10),
+        CAN_SEQ_LOOP(0),
+        CAN_SEQ_END
+    };
+    static const uint8_t three_levels[] = {
+        CAN_SEQ_MARK, CAN_SEQ_MARK, CAN_SEQ_MARK,
+        CAN_SEQ_WAIT(10),
+        CAN_SEQ_LOOP(2), CAN_SEQ_LOOP(2), CAN_SEQ_LOOP(2),
+        CAN_SEQ_END
+    };
+    uint16_t steps = 0;
+
+    CHECK(can_seq_validate(two_levels, sizeof(two_levels), &steps));
+    CHECK_EQ(steps, 2);
+    CHECK(!can_seq_validate(three_levels, sizeof(three_levels), NULL));
+}
+
+static void test_endless_loop_needs_wait(void) {
+    static const uint8_t no_wait[] = {
+        CAN_SEQ_MARK,
+            CAN_SEQ_SEND(0x100, 1, 0xAA, 0, 0, 0, 0, 0, 0, 0),
+        CAN_SEQ_LOOP(0),
+        CAN_SEQ_END
+    };
+    static const uint8_t rx_wait[] = {
+        CAN_SEQ_MARK,
+            CAN_SEQ_SEND(0x100, 1, 0xAA, 0, 0, 0, 0, 0, 0, 0),
+            CAN_SEQ_WAIT_RX(0x200, 0x7FF, 1000),
+        CAN_SEQ_LOOP(0),
+        CAN_SEQ_END
+    };
+    static const uint8_t counted[] = {
+        CAN_SEQ_MARK,
+            CAN_SEQ_SEND(0x100, 1, 0xAA, 0, 0, 0, 0, 0, 0, 0),
+        CAN_SEQ_LOOP(10),
+        CAN_SEQ_END
+    };
+
+    CHECK(!can_seq_validate(no_wait, sizeof(no_wait), NULL));
+    CHECK(can_seq_validate(rx_wait, sizeof(rx_wait), NULL));
+    CHECK(can_seq_validate(counted, sizeof(counted), NULL));
+}
+
+static void test_unbalanced_loops(void) {
+    static const uint8_t loop_without_mark[] = {
+        CAN_SEQ_WAIT(10),
+        CAN_SEQ_LOOP(2),
+        CAN_SEQ_END
+    };
+    static const uint8_t open_mark[] = {
+        CAN_SEQ_MARK,
+            CAN_SEQ_WAIT(10),
+        CAN_SEQ_END
+    };
+
+    CHECK(!can_seq_validate(loop_without_mark, sizeof(loop_without_mark), NULL));
+    CHECK(!can_seq_validate(open_mark, sizeof(open_mark), NULL));
+}
+
+static void test_malformed_operands(void) {
+    static const uint8_t code[] = {
+        CAN_SEQ_SEND(0x123, 8, 1, 2, 3, 4, 5, 6, 7, 8),
+        CAN_SEQ_WAIT(5),
+        CAN_SEQ_END
+    };
+    static const uint8_t bad_dlc[] = {
+        CAN_SEQ_SEND(0x123, 9, 1, 2, 3, 4, 5, 6, 7, 8),
+        CAN_SEQ_END
+    };
+    static const uint8_t bad_opcode[] = {
+        CAN_SEQ_WAIT(5),
+        0x06,
+        CAN_SEQ_END
+    };
+    static const uint8_t trailing[] = {
+        CAN_SEQ_WAIT(5),
+        CAN_SEQ_END,
+        CAN_SEQ_WAIT(5)
+    };
+
+    CHECK(can_seq_validate(code, sizeof(code), NULL));
+    // Every cut inside the program loses either an operand or the END
+    for (size_t len = 0; len < sizeof(code); len++) {
+        CHECK(!can_seq_validate(code, len, NULL));
+    }
+    CHECK(!can_seq_validate(bad_dlc, sizeof(bad_dlc), NULL));
+    CHECK(!can_seq_validate(bad_opcode, sizeof(bad_opcode), NULL));
+    CHECK(!can_seq_validate(trailing, sizeof(trailing), NULL));
+    CHECK(!can_seq_validate(NULL, 0, NULL));
+}
+
+static void test_start_rejects_invalid(void) {
+    static const uint8_t no_end[] = {
+        CAN_SEQ_WAIT(5)
+    };
+    can_seq_runner_t runner;
+
+    can_seq_runner_init(&runner);
+    CHECK(!can_seq_start(&runner, "BAD", no_end, sizeof(no_end)));
+    CHECK_EQ(can_seq_get_status(&runner), CAN_SEQ_IDLE);
+}
+
+static void test_cancel_before_start(void) {
+    static const uint8_t code[] = {
+        CAN_SEQ_WAIT(5),
+        CAN_SEQ_END
+    };
+    can_seq_runner_t runner;
+
+    // A cancel that races the start ends the program before its first step
+    can_seq_runner_init(&runner);
+    can_seq_cancel(&runner);
+    CHECK(can_seq_start(&runner, "RACE", code, sizeof(code)));
+    CHECK_EQ(can_seq_run(&runner, NULL, 0), CAN_PORT_WAIT_FOREVER);
+    CHECK_EQ(can_seq_get_status(&runner), CAN_SEQ_CANCELLED);
+
+    // Once dropped, it no longer touches the next program
+    can_seq_clear_cancel(&runner);
+    CHECK(can_seq_start(&runner, "NEXT", code, sizeof(code)));
+    CHECK_EQ(can_seq_run(&runner, NULL, 0), 5);
+    CHECK_EQ(can_seq_get_status(&runner), CAN_SEQ_RUNNING);
+}
+
+int main(void) {
+    RUN_TEST(test_valid_program);
+    RUN_TEST(test_nested_loops);
+    RUN_TEST(test_endless_loop_needs_wait);
+    RUN_TEST(test_unbalanced_loops);
+    RUN_TEST(test_malformed_operands);
+    RUN_TEST(test_start_rejects_invalid);
+    RUN_TEST(test_cancel_before_start);
+    return TEST_EXIT();
+}
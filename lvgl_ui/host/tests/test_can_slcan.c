@@ -0,0 +1,202 @@
+/**
+ * @file test_can_slcan.c
+ * @brief SLCAN transport encoder/parser tests
+ *
+ * The transport runs on the slave side of a pty; the test plays the other
+ * end of the serial line on the master side, reading the encoded lines the
+ * transport writes and feeding it lines (valid and malformed) to parse.
+ */
+
+#define _XOPEN_SOURCE 600
+
+#include "can_transport.h"
+#include "test_util.h"
+#include <fcntl.h>
+#include <poll.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#define IO_TIMEOUT_MS   1000    // Generous: only reached when a test fails
+#define QUIET_MS        50      // Wait that proves nothing more arrives
+
+typedef struct {
+    int master;
+    can_transport_t bus;
+} slcan_link_t;
+
+// ==================== Serial Line Helpers ====================
+
+static bool link_open(slcan_link_t* link, bool adapter) {
+    can_transport_config_t config;
+
+    link->master = posix_openpt(O_RDWR | O_NOCTTY);
+    if (link->master < 0 || grantpt(link->master) != 0 || unlockpt(link->master) != 0) {
+        return false;
+    }
+    memset(&config, 0, sizeof(config));
+    config.device = ptsname(link->master);
+    config.bitrate = 500000;
+    config.slcan_adapter = adapter;
+    can_transport_init(&link->bus, &can_transport_slcan_ops);
+    return can_transport_open(&link->bus, &config) == CAN_OK;
+}
+
+static void link_close(slcan_link_t* link) {
+    can_transport_close(&link->bus);
+    close(link->master);
+}
+
+static void line_write(slcan_link_t* link, const char* text) {
+    size_t len = strlen(text);
+    CHECK(write(link->master, text, len) == (ssize_t)len);
+}
+
+// Read exactly len bytes the transport wrote (fewer on timeout)
+static size_t line_read(slcan_link_t* link, char* buf, size_t len) {
+    size_t got = 0;
+
+    while (got < len) {
+        struct pollfd pfd = {.fd = link->master, .events = POLLIN};
+        if (poll(&pfd, 1, IO_TIMEOUT_MS) <= 0) {
+            break;
+        }
+        ssize_t n = read(link->master, buf + got, len - got);
+        if (n <= 0) {
+            break;
+        }
+        got += (size_t)n;
+    }
+    buf[got] = '\0';
+    return got;
+}
+
+static void expect_output(slcan_link_t* link, const char* expected) {
+    char buf[256];
+
+    line_read(link, buf, strlen(expected));
+    if (strcmp(buf, expected) != 0) {
+        fprintf(stderr, "transport wrote \"%s\", expected \"%s\"\n", buf, expected);
+        g_test_failures++;
+    }
+}
+
+static bool frames_equal(const can_frame_t* a, const can_frame_t* b) {
+    return a->id == b->id && a->dlc == b->dlc && a->flags == b->flags &&
+           ((a->flags & CAN_FRAME_FLAG_RTR) != 0 || memcmp(a->data, b->data, a->dlc) == 0);
+}
+
+// ==================== Tests ====================
+
+static const can_frame_t FRAMES[] = {
+    {.id = 0x123, .dlc = 3, .data = {0x11, 0x22, 0x33}},
+    {.id = 0x18DAF110, .dlc = 8, .flags = CAN_FRAME_FLAG_EXT, .data = {0x02, 0x10, 0x03, 0xAA, 0xBB, 0xCC, 0xDD, 0xEE}},
+    {.id = 0x7FF, .dlc = 2, .flags = CAN_FRAME_FLAG_RTR},
+    {.id = 0x1FFFFFFF, .dlc = 0, .flags = CAN_FRAME_FLAG_EXT | CAN_FRAME_FLAG_RTR},
+    {.id = 0x000, .dlc = 0},
+};
+
+static const char FRAME_LINES[] =
+    "t1233112233\r"
+    "T18DAF1108021003AABBCCDDEE\r"
+    "r7FF2\r"
+    "R1FFFFFFF0\r"
+    "t0000\r";
+
+static const size_t FRAME_COUNT = sizeof(FRAMES) / sizeof(FRAMES[0]);
+
+static void test_host_round_trip(void) {
+    slcan_link_t link;
+    can_frame_t frame;
+
+    CHECK(link_open(&link, false));
+    expect_output(&link, "\rC\rS6\rO\r");      // Channel setup for 500 kbit/s
+
+    // Encode
+    for (size_t i = 0; i < FRAME_COUNT; i++) {
+        CHECK_EQ(can_transport_send(&link.bus, &FRAMES[i], IO_TIMEOUT_MS), CAN_OK);
+    }
+    can_transport_flush(&link.bus);
+    expect_output(&link, FRAME_LINES);
+
+    // Decode what was encoded
+    line_write(&link, FRAME_LINES);
+    for (size_t i = 0; i < FRAME_COUNT; i++) {
+        CHECK_EQ(can_transport_recv(&link.bus, &frame, IO_TIMEOUT_MS), CAN_OK);
+        CHECK(frames_equal(&frame, &FRAMES[i]));
+    }
+    CHECK_EQ(can_transport_recv(&link.bus, &frame, QUIET_MS), CAN_ERR_TIMEOUT);
+
+    link_close(&link);
+}
+
+static void test_host_malformed_lines(void) {
+    slcan_link_t link;
+    can_frame_t frame;
+
+    CHECK(link_open(&link, false));
+    expect_output(&link, "\rC\rS6\rO\r");
+
+    line_write(&link,
+               "t12\r"                          // Short ID
+               "t12G1AA\r"                      // Bad hex
+               "t1239\r"                        // DLC 9
+               "t8001AA\r"                      // 12-bit ID
+               "T2000000001AA\r"                // 30-bit ID
+               "t1232AA\r"                      // Missing data
+               "t1231AABB\r"                    // Extra data
+               "r12311\r"                       // RTR with data
+               "t123\r"                         // No DLC
+               "t1231AAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAA\r"  // Over-long line
+               "z\r"                            // Adapter ack
+               "V1013\r"                        // Version reply
+               "\r"
+               "t0011AA\r"                      // Valid
+               "t0021BB1234\r");                // Valid with timestamp
+
+    CHECK_EQ(can_transport_recv(&link.bus, &frame, IO_TIMEOUT_MS), CAN_OK);
+    CHECK_EQ(frame.id, 0x001);
+    CHECK_EQ(frame.dlc, 1);
+    CHECK_EQ(frame.data[0], 0xAA);
+    CHECK_EQ(can_transport_recv(&link.bus, &frame, IO_TIMEOUT_MS), CAN_OK);
+    CHECK_EQ(frame.id, 0x002);
+    CHECK_EQ(frame.dlc, 1);
+    CHECK_EQ(frame.data[0], 0xBB);
+    CHECK_EQ(can_transport_recv(&link.bus, &frame, QUIET_MS), CAN_ERR_TIMEOUT);
+
+    link_close(&link);
+}
+
+static void test_adapter_replies(void) {
+    slcan_link_t link;
+    can_frame_t frame;
+
+    CHECK(link_open(&link, true));
+
+    // Frames before the channel is opened are refused
+    line_write(&link, "t1231AA\r");
+    CHECK_EQ(can_transport_recv(&link.bus, &frame, QUIET_MS), CAN_ERR_TIMEOUT);
+    expect_output(&link, "\a");
+
+    line_write(&link, "V\rS6\rO\r");
+    CHECK_EQ(can_transport_recv(&link.bus, &frame, QUIET_MS), CAN_ERR_TIMEOUT);
+    expect_output(&link, "V1013\r\r\r");
+
+    line_write(&link, "t1231AA\rT18DAF1102AABB\rt12\r?\r");
+    CHECK_EQ(can_transport_recv(&link.bus, &frame, IO_TIMEOUT_MS), CAN_OK);
+    CHECK_EQ(frame.id, 0x123);
+    CHECK_EQ(can_transport_recv(&link.bus, &frame, IO_TIMEOUT_MS), CAN_OK);
+    CHECK_EQ(frame.id, 0x18DAF110);
+    CHECK_EQ(frame.flags, CAN_FRAME_FLAG_EXT);
+    CHECK_EQ(can_transport_recv(&link.bus, &frame, QUIET_MS), CAN_ERR_TIMEOUT);
+    expect_output(&link, "z\rZ\r\a\a");
+
+    link_close(&link);
+}
+
+int main(void) {
+    RUN_TEST(test_host_round_trip);
+    RUN_TEST(test_host_malformed_lines);
+    RUN_TEST(test_adapter_replies);
+    return TEST_EXIT();
+}
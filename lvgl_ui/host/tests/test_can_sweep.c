@@ -0,0 +1,152 @@
+/**
+ * @file test_can_sweep.c
+ * @brief can_sweep generator tests
+ */
+
+#include "can_sweep.h"
+#include "test_util.h"
+#include <string.h>
+
+static void test_range_and_id_at(void) {
+    can_sweep_config_t config = {.id_first = 0x7F0, .id_last = 0x7FF, .dlc = 2, .pattern = CAN_SWEEP_INCREMENT, .per_id = 3};
+    can_sweep_t sweep;
+    can_frame_t frame;
+
+    CHECK(can_sweep_init(&sweep, &config));
+    CHECK_EQ(sweep.total, 16 * 3);
+    for (uint64_t i = 0; i < sweep.total; i++) {
+        CHECK_EQ(can_sweep_id_at(&sweep, i), 0x7F0 + i / 3);
+    }
+    CHECK_EQ(can_sweep_id_at(&sweep, sweep.total), 0x7FF);
+
+    // next() walks the same frames as frame(N), then stops
+    uint64_t count = 0;
+    while (can_sweep_next(&sweep, &frame)) {
+        can_frame_t expected;
+        can_sweep_frame(&sweep, count, &expected);
+        CHECK(memcmp(&frame, &expected, sizeof(frame)) == 0);
+        CHECK_EQ(frame.id, can_sweep_id_at(&sweep, count));
+        CHECK_EQ(frame.flags, 0);
+        count++;
+    }
+    CHECK_EQ(count, sweep.total);
+
+    // Pattern defaults for per_id
+    config.per_id = 0;
+    CHECK(can_sweep_init(&sweep, &config));
+    CHECK_EQ(sweep.per_id, CAN_SWEEP_DEFAULT_INCREMENT);
+    config.pattern = CAN_SWEEP_WALKING_BIT;
+    CHECK(can_sweep_init(&sweep, &config));
+    CHECK_EQ(sweep.per_id, 16);
+    config.pattern = CAN_SWEEP_RANDOM;
+    CHECK(can_sweep_init(&sweep, &config));
+    CHECK_EQ(sweep.per_id, CAN_SWEEP_DEFAULT_RANDOM);
+}
+
+static void test_extended_full_range(void) {
+    can_sweep_config_t config = {.id_first = 0, .id_last = CAN_EXT_ID_MASK, .extended = true, .dlc = 8, .per_id = 1};
+    can_sweep_t sweep;
+    can_frame_t frame;
+
+    CHECK(can_sweep_init(&sweep, &config));
+    CHECK_EQ(sweep.total, (uint64_t)CAN_EXT_ID_MASK + 1);
+    can_sweep_frame(&sweep, sweep.total - 1, &frame);
+    CHECK_EQ(frame.id, CAN_EXT_ID_MASK);
+    CHECK_EQ(frame.flags, CAN_FRAME_FLAG_EXT);
+}
+
+static void test_increment_payloads(void) {
+    can_sweep_config_t config = {.id_first = 0x100, .id_last = 0x101, .dlc = 3, .pattern = CAN_SWEEP_INCREMENT, .per_id = 300};
+    can_sweep_t sweep;
+    can_frame_t frame;
+
+    CHECK(can_sweep_init(&sweep, &config));
+    can_sweep_frame(&sweep, 0, &frame);
+    CHECK_EQ(frame.dlc, 3);
+    CHECK(frame.data[0] == 0 && frame.data[1] == 0 && frame.data[2] == 0);
+    can_sweep_frame(&sweep, 299, &frame);           // Little-endian 299 = 0x012B
+    CHECK_EQ(frame.id, 0x100);
+    CHECK(frame.data[0] == 0x2B && frame.data[1] == 0x01 && frame.data[2] == 0);
+    can_sweep_frame(&sweep, 300 + 5, &frame);       // Restarts for the next ID
+    CHECK_EQ(frame.id, 0x101);
+    CHECK(frame.data[0] == 5 && frame.data[1] == 0);
+}
+
+static void test_walking_bit_payloads(void) {
+    can_sweep_config_t config = {.id_first = 0x200, .id_last = 0x200, .dlc = 2, .pattern = CAN_SWEEP_WALKING_BIT};
+    can_sweep_t sweep;
+    can_frame_t frame;
+
+    CHECK(can_sweep_init(&sweep, &config));
+    CHECK_EQ(sweep.total, 16);
+    for (uint32_t k = 0; k < 16; k++) {
+        can_sweep_frame(&sweep, k, &frame);
+        uint16_t bits = (uint16_t)(frame.data[0] | (frame.data[1] << 8));
+        CHECK_EQ(bits, 1u << k);
+    }
+
+    // Without data there is one empty frame per ID
+    config.dlc = 0;
+    CHECK(can_sweep_init(&sweep, &config));
+    CHECK_EQ(sweep.total, 1);
+    can_sweep_frame(&sweep, 0, &frame);
+    CHECK_EQ(frame.dlc, 0);
+}
+
+static void test_random_reproducible(void) {
+    can_sweep_config_t config = {.id_first = 0x300, .id_last = 0x30F, .dlc = 8, .pattern = CAN_SWEEP_RANDOM, .seed = 42};
+    can_sweep_t a;
+    can_sweep_t b;
+    can_frame_t fa;
+    can_frame_t fb;
+    uint32_t differ = 0;
+
+    CHECK(can_sweep_init(&a, &config));
+    CHECK(can_sweep_init(&b, &config));
+    while (can_sweep_next(&a, &fa)) {
+        CHECK(can_sweep_next(&b, &fb));
+        CHECK(memcmp(&fa, &fb, sizeof(fa)) == 0);
+    }
+    CHECK(!can_sweep_next(&b, &fb));
+
+    // Another seed gives another sequence; consecutive payloads differ
+    config.seed = 43;
+    CHECK(can_sweep_init(&b, &config));
+    for (uint64_t i = 0; i < a.total; i++) {
+        can_sweep_frame(&a, i, &fa);
+        can_sweep_frame(&b, i, &fb);
+        if (memcmp(fa.data, fb.data, 8) != 0) {
+            differ++;
+        }
+    }
+    CHECK_EQ(differ, a.total);
+    can_sweep_frame(&a, 0, &fa);
+    can_sweep_frame(&a, 1, &fb);
+    CHECK(memcmp(fa.data, fb.data, 8) != 0);
+}
+
+static void test_invalid_configs(void) {
+    can_sweep_t sweep;
+    const can_sweep_config_t bad[] = {
+        {.id_first = 0x200, .id_last = 0x100, .dlc = 8},
+        {.id_first = 0x700, .id_last = 0x800, .dlc = 8},                    // Past 11 bits
+        {.id_first = 0, .id_last = CAN_EXT_ID_MASK + 1, .extended = true, .dlc = 8},
+        {.id_first = 0, .id_last = 1, .dlc = 9},
+        {.id_first = 0, .id_last = 1, .dlc = 8, .pattern = CAN_SWEEP_PATTERN_COUNT},
+    };
+
+    for (size_t i = 0; i < sizeof(bad) / sizeof(bad[0]); i++) {
+        CHECK(!can_sweep_init(&sweep, &bad[i]));
+    }
+    CHECK(!can_sweep_init(&sweep, NULL));
+}
+
+int main(void) {
+    RUN_TEST(test_range_and_id_at);
+    RUN_TEST(test_extended_full_range);
+    RUN_TEST(test_increment_payloads);
+    RUN_TEST(test_walking_bit_payloads);
+    RUN_TEST(test_random_reproducible);
+    RUN_TEST(test_invalid_configs);
+    return TEST_EXIT();
+}
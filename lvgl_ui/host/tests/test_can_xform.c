@@ -0,0 +1,122 @@
+/**
+ * @file test_can_xform.c
+ * @brief can_xform CRC and transform tests
+ *
+ * CRC vectors are the check values of the CRC catalogue and the example
+ * data of the AUTOSAR CRC library specification.
+ */
+
+#include "can_xform.h"
+#include "test_util.h"
+#include <string.h>
+
+typedef struct {
+    uint8_t data[9];
+    uint8_t len;
+    uint8_t j1850;
+    uint8_t autosar;
+} crc_vector_t;
+
+static const crc_vector_t CRC_VECTORS[] = {
+    {{'1', '2', '3', '4', '5', '6', '7', '8', '9'}, 9, 0x4B, 0xDF},
+    {{0x00, 0x00, 0x00, 0x00}, 4, 0x59, 0x12},
+    {{0xF2, 0x01, 0x83}, 3, 0x37, 0xC2},
+    {{0x0F, 0xAA, 0x00, 0x55}, 4, 0x79, 0xC6},
+    {{0x00, 0xFF, 0x55, 0x11}, 4, 0xB8, 0x77},
+    {{0x33, 0x22, 0x55, 0xAA, 0xBB, 0xCC, 0xDD, 0xEE, 0xFF}, 9, 0xCB, 0x11},
+    {{0x92, 0x6B, 0x55}, 3, 0x8C, 0x33},
+    {{0xFF, 0xFF, 0xFF, 0xFF}, 4, 0x74, 0x6C},
+};
+
+static void test_crc_vectors(void) {
+    for (size_t i = 0; i < sizeof(CRC_VECTORS) / sizeof(CRC_VECTORS[0]); i++) {
+        const crc_vector_t* v = &CRC_VECTORS[i];
+        CHECK_EQ(can_crc8_j1850(v->data, v->len), v->j1850);
+        CHECK_EQ(can_crc8_autosar(v->data, v->len), v->autosar);
+    }
+}
+
+static void test_counter_then_crc(void) {
+    static const can_xform_t xf[] = {
+        CAN_XFORM_COUNTER(1, 0x0F),
+        CAN_XFORM_CRC8_J1850(0, 1, 7),
+    };
+    can_frame_t frame = {.id = 0x123, .dlc = 8, .data = {0x00, 0xA0, 0x11, 0x22, 0x33, 0x44, 0x55, 0x66}};
+
+    CHECK(can_xform_validate(xf, 2, 8));
+    can_xform_apply(xf, 2, 0x13, &frame);      // Counter wraps into the nibble
+    CHECK_EQ(frame.data[1], 0xA3);
+    CHECK_EQ(frame.data[0], 0x32);
+    CHECK_EQ(frame.data[0], can_crc8_j1850(&frame.data[1], 7));
+}
+
+static void test_crc_with_data_id(void) {
+    static const can_xform_t xf[] = {
+        CAN_XFORM_CRC8_AUTOSAR_ID(0, 1, 7, 0x42),
+    };
+    can_frame_t frame = {.id = 0x123, .dlc = 8, .data = {0x00, 0xA3, 0x11, 0x22, 0x33, 0x44, 0x55, 0x66}};
+
+    can_xform_apply(xf, 1, 0, &frame);
+    CHECK_EQ(frame.data[0], 0x93);
+}
+
+static void test_checksum_skips_target(void) {
+    static const can_xform_t crc[] = {
+        CAN_XFORM_CRC8_J1850(3, 0, 8),
+    };
+    static const can_xform_t xor[] = {
+        CAN_XFORM_XOR(3, 0, 8),
+    };
+    can_frame_t frame = {.dlc = 8, .data = {0x10, 0x20, 0x30, 0xEE, 0x50, 0x60, 0x70, 0x80}};
+    can_frame_t bits = {.dlc = 8, .data = {0x01, 0x02, 0x04, 0xFF, 0x08, 0x10, 0x20, 0x40}};
+    can_frame_t again;
+
+    can_xform_apply(crc, 1, 0, &frame);
+    CHECK_EQ(frame.data[3], 0x58);
+    // The old target value does not feed the new checksum
+    again = frame;
+    can_xform_apply(crc, 1, 0, &again);
+    CHECK(memcmp(frame.data, again.data, 8) == 0);
+
+    can_xform_apply(xor, 1, 0, &bits);
+    CHECK_EQ(bits.data[3], 0x7F);
+}
+
+static void test_counter_mask(void) {
+    static const can_xform_t xf[] = {
+        CAN_XFORM_COUNTER(2, 0xF0),
+    };
+    can_frame_t frame = {.dlc = 3, .data = {0, 0, 0x0A}};
+
+    for (uint8_t counter = 0; counter < 32; counter++) {
+        can_xform_apply(xf, 1, counter, &frame);
+        CHECK_EQ(frame.data[2], ((counter & 0x0F) << 4) | 0x0A);
+    }
+}
+
+static void test_validate(void) {
+    static const can_xform_t past_dlc[] = {CAN_XFORM_CRC8_J1850(0, 1, 7)};
+    static const can_xform_t pos_past_dlc[] = {CAN_XFORM_COUNTER(4, 0x0F)};
+    static const can_xform_t empty_mask[] = {CAN_XFORM_COUNTER(0, 0x00)};
+    static const can_xform_t empty_range[] = {CAN_XFORM_XOR(0, 1, 0)};
+    static const can_xform_t bad_type[] = {{CAN_XFORM_NONE, 0, 0, 0, 0, 0}};
+
+    CHECK(can_xform_validate(past_dlc, 1, 8));
+    CHECK(!can_xform_validate(past_dlc, 1, 7));
+    CHECK(!can_xform_validate(pos_past_dlc, 1, 4));
+    CHECK(!can_xform_validate(empty_mask, 1, 8));
+    CHECK(!can_xform_validate(empty_range, 1, 8));
+    CHECK(!can_xform_validate(bad_type, 1, 8));
+    CHECK(can_xform_validate(NULL, 0, 8));
+    CHECK(!can_xform_validate(NULL, 1, 8));
+}
+
+int main(void) {
+    RUN_TEST(test_crc_vectors);
+    RUN_TEST(test_counter_then_crc);
+    RUN_TEST(test_crc_with_data_id);
+    RUN_TEST(test_checksum_skips_target);
+    RUN_TEST(test_counter_mask);
+    RUN_TEST(test_validate);
+    return TEST_EXIT();
+}
@@ -0,0 +1,369 @@
+/**
+ * @file test_ui_log_store.c
+ * @brief ui_log_store ring, collapse and filter tests
+ *
+ * The store needs no LVGL and is compiled into the test on its own.
+ */
+
+#include "ui_log_store.h"
+#include "test_util.h"
+#include <string.h>
+
+static ui_log_frame_t make_frame(uint32_t id, uint8_t b0) {
+    ui_log_frame_t frame = {.id = id, .dlc = 2, .data = {b0, 0x55}};
+    return frame;
+}
+
+static uint32_t stored_count(void) {
+    uint32_t first;
+    uint32_t next;
+
+    ui_log_store_range(&first, &next);
+    return next - first;
+}
+
+// ==================== Ring ====================
+
+static void test_append_and_get(void) {
+    ui_log_record_t rec;
+    ui_log_frame_t frame = make_frame(0x7E8, 0x02);
+    char text[64];
+    uint32_t first;
+    uint32_t next;
+
+    ui_log_store_init();
+    CHECK(!ui_log_store_get_collapse());
+    CHECK(ui_log_store_add(0, "TX", "Connected"));
+    CHECK(ui_log_store_add_frame(1, "RX", &frame));
+    ui_log_store_range(&first, &next);
+    CHECK_EQ(first, 0);
+    CHECK_EQ(next, 2);
+
+    CHECK(ui_log_store_get(0, &rec));
+    CHECK(!rec.is_frame);
+    CHECK_EQ(rec.channel, 0);
+    CHECK(strcmp(rec.type, "TX") == 0);
+    CHECK(strcmp(ui_log_record_text(&rec, text, sizeof(text)), "Connected") == 0);
+
+    CHECK(ui_log_store_get(1, &rec));
+    CHECK(rec.is_frame);
+    CHECK_EQ(rec.count, 1);
+    CHECK(strcmp(ui_log_record_text(&rec, text, sizeof(text)), "CAN ID: 0x7E8 | Data: [0x02, 0x55]") == 0);
+    CHECK(!ui_log_store_get(2, &rec));
+}
+
+static void test_ring_overwrites_oldest(void) {
+    ui_log_record_t rec;
+    char text[16];
+    uint32_t first;
+    uint32_t next;
+
+    ui_log_store_init();
+    for (uint32_t i = 0; i < UI_LOG_STORE_SIZE + 10; i++) {
+        snprintf(text, sizeof(text), "line %u", (unsigned)i);
+        ui_log_store_add(UI_LOG_NO_CHANNEL, "TX", text);
+    }
+    ui_log_store_range(&first, &next);
+    CHECK_EQ(first, 10);
+    CHECK_EQ(next, UI_LOG_STORE_SIZE + 10);
+    CHECK(!ui_log_store_get(9, &rec));
+    CHECK(ui_log_store_get(10, &rec));
+    CHECK(strcmp(rec.text, "line 10") == 0);
+
+    // Clear empties the store but never reuses a sequence number
+    ui_log_store_clear();
+    CHECK_EQ(stored_count(), 0);
+    CHECK(!ui_log_store_get(next - 1, &rec));
+    ui_log_store_add(UI_LOG_NO_CHANNEL, "TX", "after clear");
+    ui_log_store_range(&first, &next);
+    CHECK_EQ(first, UI_LOG_STORE_SIZE + 10);
+    CHECK_EQ(next, UI_LOG_STORE_SIZE + 11);
+}
+
+static void test_long_text_truncated(void) {
+    char text[UI_LOG_TEXT_LEN + 20];
+    ui_log_record_t rec;
+
+    ui_log_store_init();
+    memset(text, 'a', sizeof(text) - 1);
+    text[sizeof(text) - 1] = '\0';
+    ui_log_store_add(0, "TX", text);
+    CHECK(ui_log_store_get(0, &rec));
+    CHECK_EQ(strlen(rec.text), UI_LOG_TEXT_LEN - 1);
+}
+
+// ==================== Collapse ====================
+
+static void test_collapse_repeats(void) {
+    ui_log_record_t rec;
+    ui_log_frame_t frame = make_frame(0x100, 0x01);
+
+    ui_log_store_init();
+    ui_log_store_set_collapse(true);
+    CHECK(ui_log_store_get_collapse());
+
+    CHECK(ui_log_store_add_frame(0, "TX", &frame));
+    for (int i = 0; i < 99; i++) {
+        CHECK(!ui_log_store_add_frame(0, "TX", &frame));
+    }
+    CHECK_EQ(stored_count(), 1);
+    CHECK(ui_log_store_get(0, &rec));
+    CHECK_EQ(rec.count, 100);
+    CHECK(rec.last_time >= rec.first_time);
+
+    CHECK(ui_log_store_add(0, "TX", "Stopped"));
+    CHECK(!ui_log_store_add(0, "TX", "Stopped"));
+    CHECK_EQ(stored_count(), 2);
+    CHECK(ui_log_store_get(1, &rec));
+    CHECK_EQ(rec.count, 2);
+}
+
+static void test_collapse_needs_identical_newest(void) {
+    ui_log_frame_t frame = make_frame(0x100, 0x01);
+    ui_log_frame_t other_data = make_frame(0x100, 0x02);
+    ui_log_frame_t other_id = make_frame(0x101, 0x01);
+    ui_log_frame_t ext = make_frame(0x100, 0x01);
+    ui_log_frame_t longer = make_frame(0x100, 0x01);
+
+    ext.extended = true;
+    longer.dlc = 3;
+
+    ui_log_store_init();
+    ui_log_store_set_collapse(true);
+    CHECK(ui_log_store_add_frame(0, "TX", &frame));
+    CHECK(ui_log_store_add_frame(0, "TX", &other_data));
+    CHECK(ui_log_store_add_frame(0, "TX", &other_id));
+    CHECK(ui_log_store_add_frame(0, "TX", &ext));
+    CHECK(ui_log_store_add_frame(0, "TX", &longer));
+    CHECK(ui_log_store_add_frame(1, "TX", &longer));            // Other channel
+    CHECK(ui_log_store_add_frame(1, "RX", &longer));            // Other direction
+    CHECK(ui_log_store_add(1, "RX", "CAN ID: 0x100 | Data: [0x01, 0x55, 0x00]"));   // Text, not frame
+    CHECK(ui_log_store_add_frame(1, "RX", &longer));
+    CHECK(ui_log_store_add_frame(0, "TX", &frame));             // Only the newest record merges
+    CHECK_EQ(stored_count(), 10);
+}
+
+static void test_collapse_off(void) {
+    ui_log_store_init();
+    ui_log_store_set_collapse(false);
+    for (int i = 0; i < 5; i++) {
+        CHECK(ui_log_store_add(0, "TX", "same"));
+    }
+    CHECK_EQ(stored_count(), 5);
+}
+
+// ==================== Filtering ====================
+
+static void test_filter_parse(void) {
+    ui_log_filter_t filter;
+    ui_log_filter_t before;
+
+    CHECK(ui_log_filter_parse(" 7E8, 100-1FF,18DAF110 ", "?? 3E x 01", UI_LOG_DIR_RX, &filter));
+    CHECK_EQ(filter.dir, UI_LOG_DIR_RX);
+    CHECK_EQ(filter.range_count, 3);
+    CHECK_EQ(filter.ranges[0].first, 0x7E8);
+    CHECK_EQ(filter.ranges[0].last, 0x7E8);
+    CHECK_EQ(filter.ranges[1].first, 0x100);
+    CHECK_EQ(filter.ranges[1].last, 0x1FF);
+    CHECK_EQ(filter.ranges[2].first, 0x18DAF110);
+    CHECK_EQ(filter.data_mask[0], 0x00);
+    CHECK_EQ(filter.data_mask[1], 0xFF);
+    CHECK_EQ(filter.data_value[1], 0x3E);
+    CHECK_EQ(filter.data_mask[2], 0x00);
+    CHECK_EQ(filter.data_mask[3], 0xFF);
+    CHECK_EQ(filter.data_value[3], 0x01);
+    CHECK(ui_log_filter_is_active(&filter));
+
+    CHECK(ui_log_filter_parse(NULL, "", UI_LOG_DIR_ANY, &filter));
+    CHECK(!ui_log_filter_is_active(&filter));
+    CHECK(ui_log_filter_parse("", NULL, UI_LOG_DIR_TX, &filter));
+    CHECK(ui_log_filter_is_active(&filter));
+
+    // Syntax errors leave the filter as it was
+    static const char* const bad_ids[] = {
+        "xyz", "1FF-100", "100-", "20000000", "1,2,3,4,5", "7E8;7E9",
+    };
+    static const char* const bad_data[] = {
+        "3E4", "G0", "01 02 03 04 05 06 07 08 09", "3E?",
+    };
+    CHECK(ui_log_filter_parse("7E8", "3E", UI_LOG_DIR_TX, &before));
+    for (size_t i = 0; i < sizeof(bad_ids) / sizeof(bad_ids[0]); i++) {
+        filter = before;
+        CHECK(!ui_log_filter_parse(bad_ids[i], NULL, UI_LOG_DIR_ANY, &filter));
+        CHECK(memcmp(&filter, &before, sizeof(filter)) == 0);
+    }
+    for (size_t i = 0; i < sizeof(bad_data) / sizeof(bad_data[0]); i++) {
+        filter = before;
+        CHECK(!ui_log_filter_parse(NULL, bad_data[i], UI_LOG_DIR_ANY, &filter));
+        CHECK(memcmp(&filter, &before, sizeof(filter)) == 0);
+    }
+}
+
+static void test_filter_match(void) {
+    ui_log_filter_t filter;
+    ui_log_record_t event = {.channel = 0, .type = "TX", .is_frame = false};
+    ui_log_record_t frame = {.channel = 0, .type = "RX", .is_frame = true};
+
+    frame.frame = make_frame(0x7E8, 0x03);
+
+    ui_log_filter_clear(&filter);
+    CHECK(ui_log_filter_match(&filter, &event));
+    CHECK(ui_log_filter_match(&filter, &frame));
+
+    // Direction alone also applies to event rows
+    CHECK(ui_log_filter_parse(NULL, NULL, UI_LOG_DIR_RX, &filter));
+    CHECK(!ui_log_filter_match(&filter, &event));
+    CHECK(ui_log_filter_match(&filter, &frame));
+    CHECK(ui_log_filter_parse(NULL, NULL, UI_LOG_DIR_TX, &filter));
+    CHECK(ui_log_filter_match(&filter, &event));
+    CHECK(!ui_log_filter_match(&filter, &frame));
+
+    // ID and payload terms only match frames
+    CHECK(ui_log_filter_parse("700-7FF", NULL, UI_LOG_DIR_ANY, &filter));
+    CHECK(!ui_log_filter_match(&filter, &event));
+    CHECK(ui_log_filter_match(&filter, &frame));
+    CHECK(ui_log_filter_parse("7E0", NULL, UI_LOG_DIR_ANY, &filter));
+    CHECK(!ui_log_filter_match(&filter, &frame));
+
+    CHECK(ui_log_filter_parse(NULL, "03 55", UI_LOG_DIR_ANY, &filter));
+    CHECK(ui_log_filter_match(&filter, &frame));
+    CHECK(ui_log_filter_parse(NULL, "?? 56", UI_LOG_DIR_ANY, &filter));
+    CHECK(!ui_log_filter_match(&filter, &frame));
+    CHECK(ui_log_filter_parse(NULL, "?? ?? 00", UI_LOG_DIR_ANY, &filter));
+    CHECK(!ui_log_filter_match(&filter, &frame));     // Byte beyond the DLC
+}
+
+// Fill the store past one wrap with a fixed mix of IDs, directions and events
+static void fill_mixed(void) {
+    static const uint32_t ids[] = {
+        0x100, 0x101, 0x102, 0x1F0, 0x200, 0x3B0, 0x7DF, 0x7E0, 0x7E8, 0x7E9,
+    };
+    uint32_t lcg = 12345;
+
+    ui_log_store_init();
+    for (uint32_t i = 0; i < UI_LOG_STORE_SIZE * 2 + 37; i++) {
+        lcg = lcg * 1103515245u + 12345u;
+        uint32_t r = lcg >> 16;
+        const char* type = (r & 1) ? "RX" : "TX";
+        if (r % 11 == 0) {
+            ui_log_store_add(UI_LOG_NO_CHANNEL, type, "event");
+            continue;
+        }
+        ui_log_frame_t frame = make_frame(ids[(r >> 1) % 10], (uint8_t)(r >> 5));
+        if ((r >> 9) % 7 == 0) {
+            frame.extended = true;
+            frame.id |= 0x18DA0000;
+        }
+        frame.dlc = (uint8_t)(1 + (r >> 12) % UI_LOG_FRAME_DATA);
+        ui_log_store_add_frame((uint8_t)((r >> 4) & 1), type, &frame);
+    }
+}
+
+// Newest matches by scanning every stored record, oldest first
+static uint32_t scan_matches(const ui_log_filter_t* filter, uint32_t* seqs, uint32_t max) {
+    ui_log_record_t rec;
+    uint32_t first;
+    uint32_t next;
+    uint32_t found = 0;
+
+    ui_log_store_range(&first, &next);
+    for (uint32_t seq = first; seq != next; seq++) {
+        if (ui_log_store_get(seq, &rec) && ui_log_filter_match(filter, &rec)) {
+            seqs[found++] = seq;
+        }
+    }
+    if (found > max) {
+        memmove(seqs, seqs + (found - max), max * sizeof(uint32_t));
+        found = max;
+    }
+    return found;
+}
+
+static void check_query(const char* ids, const char* data, ui_log_dir_t dir, uint32_t max) {
+    ui_log_filter_t filter;
+    uint32_t expected[UI_LOG_STORE_SIZE];
+    uint32_t actual[UI_LOG_STORE_SIZE];
+    uint32_t next;
+    uint32_t last;
+
+    CHECK(ui_log_filter_parse(ids, data, dir, &filter));
+    uint32_t want = scan_matches(&filter, expected, max);
+    uint32_t got = ui_log_store_query(&filter, actual, max, &next);
+    ui_log_store_range(&last, &last);
+    if (got != want || memcmp(actual, expected, got * sizeof(uint32_t)) != 0) {
+        fprintf(stderr, "query ids=\"%s\" data=\"%s\" dir=%d max=%u: %u records, expected %u\n",
+                ids, data, (int)dir, (unsigned)max, (unsigned)got, (unsigned)want);
+        g_test_failures++;
+    }
+    CHECK_EQ(next, last);
+}
+
+static void test_query_matches_scan(void) {
+    fill_mixed();
+
+    check_query("", "", UI_LOG_DIR_ANY, UI_LOG_STORE_SIZE);
+    check_query("", "", UI_LOG_DIR_RX, UI_LOG_STORE_SIZE);
+    check_query("7E8", "", UI_LOG_DIR_ANY, UI_LOG_STORE_SIZE);             // Index lookups
+    check_query("7E8, 100-102", "", UI_LOG_DIR_TX, UI_LOG_STORE_SIZE);
+    check_query("18DA01F0", "", UI_LOG_DIR_ANY, UI_LOG_STORE_SIZE);        // Extended ID
+    check_query("18DA0000-18DA07FF", "", UI_LOG_DIR_ANY, UI_LOG_STORE_SIZE);
+    check_query("100-7FF", "", UI_LOG_DIR_ANY, UI_LOG_STORE_SIZE);         // Index scan
+    check_query("0-1FFFFFFF", "", UI_LOG_DIR_RX, UI_LOG_STORE_SIZE);
+    check_query("7E0-7EF", "?? 55", UI_LOG_DIR_ANY, UI_LOG_STORE_SIZE);
+    check_query("", "x 55 00", UI_LOG_DIR_ANY, UI_LOG_STORE_SIZE);
+    check_query("", "", UI_LOG_DIR_ANY, 5);                                // Newest five
+    check_query("100-1FF", "", UI_LOG_DIR_ANY, 5);
+    check_query("123", "", UI_LOG_DIR_ANY, UI_LOG_STORE_SIZE);             // No such ID
+    check_query("100, 100-101", "", UI_LOG_DIR_ANY, UI_LOG_STORE_SIZE);    // Overlapping ranges
+    check_query("7E0-7EF, 7E8, 7E9", "", UI_LOG_DIR_ANY, UI_LOG_STORE_SIZE);
+    check_query("100-3FF, 200-7FF", "", UI_LOG_DIR_ANY, UI_LOG_STORE_SIZE);
+}
+
+static void test_query_overlapping_ranges(void) {
+    ui_log_filter_t filter;
+    ui_log_frame_t id100 = make_frame(0x100, 0x01);
+    ui_log_frame_t id101 = make_frame(0x101, 0x01);
+    uint32_t seqs[UI_LOG_STORE_SIZE];
+    uint32_t next;
+
+    // An ID in two ranges is still one chain: each record once
+    ui_log_store_init();
+    ui_log_store_add_frame(0, "RX", &id100);
+    ui_log_store_add_frame(0, "RX", &id101);
+    CHECK(ui_log_filter_parse("100, 100-101", NULL, UI_LOG_DIR_ANY, &filter));
+    CHECK_EQ(ui_log_store_query(&filter, seqs, UI_LOG_STORE_SIZE, &next), 2);
+    CHECK_EQ(seqs[0], 0);
+    CHECK_EQ(seqs[1], 1);
+}
+
+static void test_query_after_clear(void) {
+    ui_log_filter_t filter;
+    ui_log_frame_t frame = make_frame(0x7E8, 0x01);
+    uint32_t seqs[UI_LOG_STORE_SIZE];
+    uint32_t next;
+
+    fill_mixed();
+    ui_log_store_clear();
+    CHECK(ui_log_filter_parse("7E8", NULL, UI_LOG_DIR_ANY, &filter));
+    CHECK_EQ(ui_log_store_query(&filter, seqs, UI_LOG_STORE_SIZE, &next), 0);
+
+    // A new record of an ID does not chain to cleared ones
+    ui_log_store_add_frame(0, "RX", &frame);
+    CHECK_EQ(ui_log_store_query(&filter, seqs, UI_LOG_STORE_SIZE, &next), 1);
+    CHECK_EQ(seqs[0], next - 1);
+}
+
+int main(void) {
+    RUN_TEST(test_append_and_get);
+    RUN_TEST(test_ring_overwrites_oldest);
+    RUN_TEST(test_long_text_truncated);
+    RUN_TEST(test_collapse_repeats);
+    RUN_TEST(test_collapse_needs_identical_newest);
+    RUN_TEST(test_collapse_off);
+    RUN_TEST(test_filter_parse);
+    RUN_TEST(test_filter_match);
+    RUN_TEST(test_query_matches_scan);
+    RUN_TEST(test_query_overlapping_ranges);
+    RUN_TEST(test_query_after_clear);
+    return TEST_EXIT();
+}
@@ -0,0 +1,46 @@
+/**
+ * @file test_util.h
+ * @brief Checks for the Host Unit Tests
+ *
+ * Each test program is a plain executable registered with ctest: CHECK()
+ * reports a failed condition with its location and carries on, RUN_TEST()
+ * names the case that failed, and TEST_EXIT() turns the failure count into
+ * the exit status. Tests feed explicit times and fixed inputs so a run never
+ * depends on the machine's load.
+ */
+
+#ifndef TEST_UTIL_H
+#define TEST_UTIL_H
+
+#include <stdio.h>
+
+static int g_test_failures = 0;
+
+#define CHECK(cond) \
+    do { \
+        if (!(cond)) { \
+            fprintf(stderr, "%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #cond); \
+            g_test_failures++; \
+        } \
+    } while (0)
+
+#define CHECK_EQ(actual, expected) \
+    do { \
+        long long a_ = (long long)(actual); \
+        long long e_ = (long long)(expected); \
+        if (a_ != e_) { \
+            fprintf(stderr, "%s:%d: %s == %lld, expected %lld\n", __FILE__, __LINE__, #actual, a_, e_); \
+            g_test_failures++; \
+        } \
+    } while (0)
+
+#define RUN_TEST(fn) \
+    do { \
+        int before_ = g_test_failures; \
+        fn(); \
+        printf("%-40s %s\n", #fn, (g_test_failures == before_) ? "ok" : "FAILED"); \
+    } while (0)
+
+#define TEST_EXIT() ((g_test_failures == 0) ? 0 : 1)
+
+#endif // TEST_UTIL_H
@@ -0,0 +1,480 @@
+/**
+ * @file ui_bench.c
+ * @brief Headless render and memory benchmark for the LVGL UI
+ *
+ * Runs the real UI against an offscreen 172x640 display and drives it through
+ * scripted scenarios. LVGL time is virtual (advanced one refresh period per
+ * frame) so results do not depend on host load; only render time is measured
+ * on the wall clock.
+ *
+ * Usage: ui_bench [--iterations N] [--scenario NAME] [--csv]
+ *                 [--max-render-us US] [--max-heap BYTES] [--max-heap-fallbacks N]
+ *                 [--max-layout-us US]
+ *
+ * heap_fb counts LVGL allocations that missed the block pools (ui_mem.h)
+ * and went to malloc() after ui_init; it should stay 0.
+ *
+ * The layout pass runs separately before each refresh and is timed on its
+ * own (lay_avg/lay_max), so the cost of flex and LV_SIZE_CONTENT relayouts
+ * shows apart from drawing (compare UI_LAYOUT_ABSOLUTE=0 and 1).
+ *
+ * Frames go through the real flush pipeline (ui_display.h) with a transfer
+ * that completes at once. bytes/step is what one scenario step sends to the
+ * panel and areas/fr the transfers per frame, after widening and merging.
+ *
+ * Exits non-zero when a budget given on the command line is exceeded, so CI
+ * can gate on it.
+ */
+
+#define _POSIX_C_SOURCE 199309L
+
+#include "lvgl.h"
+#include "ui_main.h"
+#include "ui_binding.h"
+#include "ui_config.h"
+#include "ui_state.h"
+#include "ui_mem.h"
+#include "ui_display.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+// ==================== Offscreen display ====================
+
+#define BENCH_MAX_FRAMES  65536
+
+static uint32_t virtual_tick = 0;
+
+typedef struct {
+    uint64_t render_ns;       // REFR_START -> REFR_READY
+    uint32_t flushed_px;      // Sum of flushed area
+} frame_sample_t;
+
+static frame_sample_t frames[BENCH_MAX_FRAMES];
+static uint32_t frame_count = 0;
+static uint64_t frame_start_ns = 0;
+static uint32_t frame_flushed_px = 0;
+
+static uint64_t layout_sum_ns = 0;    // Layout passes since the scenario started
+static uint64_t layout_max_ns = 0;
+static uint32_t layout_count = 0;
+
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+static uint32_t bench_tick_get(void) {
+    return virtual_tick;
+}
+
+// Panel transfer that completes immediately (no DMA on the host)
+static bool bench_transfer(const lv_area_t* area, const uint8_t* px, size_t bytes, void* user_data) {
+    (void)px;
+    (void)bytes;
+    (void)user_data;
+    frame_flushed_px += (uint32_t)lv_area_get_size(area);
+    return false;
+}
+
+static void bench_refr_event_cb(lv_event_t* e) {
+    lv_event_code_t code = lv_event_get_code(e);
+
+    if (code == LV_EVENT_REFR_START) {
+        frame_flushed_px = 0;
+        frame_start_ns = now_ns();
+    } else if (code == LV_EVENT_REFR_READY) {
+        if (frame_count < BENCH_MAX_FRAMES && frame_flushed_px > 0) {
+            frames[frame_count].render_ns = now_ns() - frame_start_ns;
+            frames[frame_count].flushed_px = frame_flushed_px;
+            frame_count++;
+        }
+    }
+}
+
+static lv_display_t* bench_display_create(void) {
+    ui_display_config_t config = {
+        .transfer = bench_transfer,
+        .user_data = NULL,
+        .swap_bytes = true,     // Keep the byte swap in the measured render time
+    };
+    lv_display_t* disp = ui_display_create(&config);
+    lv_display_add_event_cb(disp, bench_refr_event_cb, LV_EVENT_REFR_START, NULL);
+    lv_display_add_event_cb(disp, bench_refr_event_cb, LV_EVENT_REFR_READY, NULL);
+    return disp;
+}
+
+/**
+ * @brief Advance virtual time by one refresh period and run LVGL
+ * @param count Number of frames to pump
+ */
+static void pump_frames(uint32_t count) {
+    for (uint32_t i = 0; i < count; i++) {
+        virtual_tick += LV_DEF_REFR_PERIOD;
+        ui_binding_process();
+        ui_state_flush();
+
+        // The refresh would run it first; nothing is left for it afterwards
+        uint64_t start = now_ns();
+        lv_obj_update_layout(lv_screen_active());
+        uint64_t elapsed = now_ns() - start;
+        layout_sum_ns += elapsed;
+        layout_count++;
+        if (elapsed > layout_max_ns) {
+            layout_max_ns = elapsed;
+        }
+
+        lv_timer_handler();
+    }
+}
+
+// ==================== Widget lookup ====================
+
+static uint32_t count_objects(const lv_obj_t* obj) {
+    uint32_t total = 1;
+    uint32_t child_count = lv_obj_get_child_count(obj);
+    for (uint32_t i = 0; i < child_count; i++) {
+        total += count_objects(lv_obj_get_child(obj, (int32_t)i));
+    }
+    return total;
+}
+
+static lv_obj_t* find_child_of_type(lv_obj_t* parent, const lv_obj_class_t* cls, uint32_t nth) {
+    if (parent == NULL) {
+        return NULL;    // Lazy view not built yet
+    }
+    uint32_t child_count = lv_obj_get_child_count(parent);
+    for (uint32_t i = 0; i < child_count; i++) {
+        lv_obj_t* child = lv_obj_get_child(parent, (int32_t)i);
+        if (lv_obj_check_type(child, cls)) {
+            if (nth == 0) {
+                return child;
+            }
+            nth--;
+        }
+    }
+    return NULL;
+}
+
+// ==================== Scenarios ====================
+
+typedef struct {
+    const char* name;
+    const char* description;
+    void (*step)(uint32_t i);
+} bench_scenario_t;
+
+// Burst of TX/RX log lines, as produced by a fast periodic repeat
+static void scenario_log_flood(uint32_t i) {
+    char msg[64];
+    for (uint32_t j = 0; j < 4; j++) {
+        snprintf(msg, sizeof(msg), "CAN ID: 0x%03X | Data: [0x%02X, 0x%02X]",
+                 (unsigned)(0x100 + (j & 0x0F)), (unsigned)(i & 0xFF), (unsigned)j);
+        ui_binding_add_log((j & 1) ? "RX" : "TX", msg);
+    }
+    pump_frames(1);
+}
+
+// The same frame over and over, as logged by a 10 ms repeat (collapse mode
+// turns this into one row whose counter is updated)
+static void scenario_log_repeat(uint32_t i) {
+    (void)i;
+    for (uint32_t j = 0; j < 4; j++) {
+        ui_binding_add_channel_log(0, "TX", "CAN ID: 0x101 | Data: [0x01, 0x00, 0x00, 0x00]");
+    }
+    pump_frames(1);
+}
+
+// Cycle the category dropdown, which rebuilds the function dropdown
+static void scenario_category_switch(uint32_t i) {
+    lv_obj_t* category_dd = find_child_of_type(ui_controls_get_container(), &lv_dropdown_class, 0);
+    if (category_dd != NULL) {
+        lv_dropdown_set_selected(category_dd, i % UI_CATEGORIES_COUNT);
+        lv_obj_send_event(category_dd, LV_EVENT_VALUE_CHANGED, NULL);
+    }
+    pump_frames(2);
+}
+
+// Nothing happens: heap and object count right after boot
+static void scenario_idle(uint32_t i) {
+    (void)i;
+    pump_frames(1);
+}
+
+// Open and close the manual input panel
+static void scenario_manual_toggle(uint32_t i) {
+    if ((i & 1) == 0) {
+        lv_obj_t* manual_btn = find_child_of_type(ui_controls_get_container(), &lv_button_class, 0);
+        if (manual_btn != NULL) {
+            lv_obj_send_event(manual_btn, LV_EVENT_CLICKED, NULL);
+        }
+    } else {
+        lv_obj_t* back_btn = find_child_of_type(ui_manual_input_get_container(), &lv_button_class, 0);
+        if (back_btn != NULL) {
+            lv_obj_send_event(back_btn, LV_EVENT_CLICKED, NULL);
+        }
+    }
+    pump_frames(2);
+}
+
+// Backend status spam: transmission and connection updates every frame
+static void scenario_status_updates(uint32_t i) {
+    ui_binding_update_transmission_status((i % 3) != 0, (i % 6) == 1);
+    ui_binding_update_connection_status(0, true);
+    pump_frames(1);
+}
+
+// Header bus badge cycling through the error states with a changing TEC
+static void scenario_bus_state(uint32_t i) {
+    ui_binding_update_bus_state(0, (uint8_t)(i % (UI_BUS_RECOVERING + 1)), (uint16_t)(i & 0xFF));
+    pump_frames(1);
+}
+
+// One log line per step: the list scrolls by one row
+static void scenario_log_append(uint32_t i) {
+    char msg[64];
+    snprintf(msg, sizeof(msg), "CAN ID: 0x%03X | Data: [0x%02X]", (unsigned)(0x100 + (i & 0x0F)),
+             (unsigned)(i & 0xFF));
+    ui_binding_add_log((i & 1) ? "RX" : "TX", msg);
+    pump_frames(1);
+}
+
+// Footer transmission status only: idle / transmitting / repeating
+static void scenario_footer_status(uint32_t i) {
+    ui_binding_update_transmission_status((i % 3) != 0, (i % 3) == 2);
+    pump_frames(1);
+}
+
+// Open and close the category dropdown list
+static void scenario_dropdown_open(uint32_t i) {
+    lv_obj_t* category_dd = find_child_of_type(ui_controls_get_container(), &lv_dropdown_class, 0);
+    if (category_dd != NULL) {
+        if ((i & 1) == 0) {
+            lv_dropdown_open(category_dd);
+        } else {
+            lv_dropdown_close(category_dd);
+        }
+    }
+    pump_frames(1);
+}
+
+static const bench_scenario_t SCENARIOS[] = {
+    {"log_flood",       "4 log lines per frame",              scenario_log_flood},
+    {"log_repeat",      "4 identical log lines per frame",    scenario_log_repeat},
+    {"category_switch", "category dropdown cycling",          scenario_category_switch},
+    {"manual_toggle",   "manual panel open/close",            scenario_manual_toggle},
+    {"idle",            "no input (boot heap and objects)",   scenario_idle},
+    {"status_updates",  "transmission/connection status spam", scenario_status_updates},
+    {"bus_state",       "header bus badge state changes",     scenario_bus_state},
+    {"log_append",      "1 log line per frame",               scenario_log_append},
+    {"footer_status",   "footer transmission status changes", scenario_footer_status},
+    {"dropdown_open",   "category dropdown list open/close",  scenario_dropdown_open},
+};
+static const uint32_t SCENARIOS_COUNT = sizeof(SCENARIOS) / sizeof(SCENARIOS[0]);
+
+// ==================== Reporting ====================
+
+typedef struct {
+    uint32_t frames;
+    double render_avg_us;
+    double render_p95_us;
+    double render_max_us;
+    double flushed_avg_px;
+    uint32_t flushed_max_px;
+    double layout_avg_us;
+    double layout_max_us;
+    double bytes_per_step;
+    double areas_per_frame;
+    size_t heap_max_used;
+    uint32_t heap_fallbacks;
+    uint32_t objects;
+} bench_result_t;
+
+static int cmp_u64(const void* a, const void* b) {
+    uint64_t x = *(const uint64_t*)a;
+    uint64_t y = *(const uint64_t*)b;
+    return (x > y) - (x < y);
+}
+
+static void summarize(bench_result_t* res, uint32_t iterations) {
+    static uint64_t sorted[BENCH_MAX_FRAMES];
+    uint64_t render_sum = 0;
+    uint64_t flushed_sum = 0;
+
+    memset(res, 0, sizeof(*res));
+    res->frames = frame_count;
+
+    for (uint32_t i = 0; i < frame_count; i++) {
+        sorted[i] = frames[i].render_ns;
+        render_sum += frames[i].render_ns;
+        flushed_sum += frames[i].flushed_px;
+        if (frames[i].flushed_px > res->flushed_max_px) {
+            res->flushed_max_px = frames[i].flushed_px;
+        }
+    }
+
+    if (frame_count > 0) {
+        qsort(sorted, frame_count, sizeof(sorted[0]), cmp_u64);
+        res->render_avg_us = (double)render_sum / frame_count / 1000.0;
+        res->render_p95_us = (double)sorted[(frame_count * 95) / 100] / 1000.0;
+        res->render_max_us = (double)sorted[frame_count - 1] / 1000.0;
+        res->flushed_avg_px = (double)flushed_sum / frame_count;
+    }
+    if (layout_count > 0) {
+        res->layout_avg_us = (double)layout_sum_ns / layout_count / 1000.0;
+        res->layout_max_us = (double)layout_max_ns / 1000.0;
+    }
+
+    ui_display_stats_t disp;
+    ui_display_get_stats(&disp);
+    if (iterations > 0) {
+        res->bytes_per_step = (double)disp.bytes / iterations;
+    }
+    if (disp.frames > 0) {
+        res->areas_per_frame = (double)disp.areas / disp.frames;
+    }
+
+    lv_mem_monitor_t mon;
+    lv_mem_monitor(&mon);
+    res->heap_max_used = mon.max_used;
+
+    ui_mem_stats_t mem;
+    ui_mem_get_stats(&mem);
+    res->heap_fallbacks = mem.heap_allocs_ready;
+    res->objects = count_objects(ui_get_screen());
+}
+
+static void print_header(bool csv) {
+    if (csv) {
+        printf("scenario,frames,render_avg_us,render_p95_us,render_max_us,"
+               "flushed_avg_px,flushed_max_px,layout_avg_us,layout_max_us,"
+               "bytes_per_step,areas_per_frame,heap_max_used,heap_fallbacks,objects\n");
+    } else {
+        printf("%-16s %7s %10s %10s %10s %11s %10s %9s %9s %10s %9s %10s %7s %7s\n",
+               "scenario", "frames", "avg_us", "p95_us", "max_us",
+               "avg_px", "max_px", "lay_avg", "lay_max", "bytes/step", "areas/fr",
+               "heap_hw", "heap_fb", "objs");
+    }
+}
+
+static void print_result(const char* name, const bench_result_t* r, bool csv) {
+    if (csv) {
+        printf("%s,%u,%.1f,%.1f,%.1f,%.0f,%u,%.1f,%.1f,%.0f,%.2f,%zu,%u,%u\n", name, r->frames,
+               r->render_avg_us, r->render_p95_us, r->render_max_us,
+               r->flushed_avg_px, r->flushed_max_px, r->layout_avg_us, r->layout_max_us,
+               r->bytes_per_step, r->areas_per_frame, r->heap_max_used, r->heap_fallbacks, r->objects);
+    } else {
+        printf("%-16s %7u %10.1f %10.1f %10.1f %11.0f %10u %9.1f %9.1f %10.0f %9.2f %10zu %7u %7u\n",
+               name, r->frames, r->render_avg_us, r->render_p95_us, r->render_max_us,
+               r->flushed_avg_px, r->flushed_max_px, r->layout_avg_us, r->layout_max_us,
+               r->bytes_per_step, r->areas_per_frame, r->heap_max_used, r->heap_fallbacks, r->objects);
+    }
+}
+
+// ==================== Entry point ====================
+
+static void usage(const char* prog) {
+    fprintf(stderr,
+            "Usage: %s [--iterations N] [--scenario NAME] [--csv]\n"
+            "          [--max-render-us US] [--max-heap BYTES] [--max-heap-fallbacks N]\n"
+            "          [--max-layout-us US]\n\n"
+            "Scenarios:\n", prog);
+    for (uint32_t i = 0; i < SCENARIOS_COUNT; i++) {
+        fprintf(stderr, "  %-16s %s\n", SCENARIOS[i].name, SCENARIOS[i].description);
+    }
+}
+
+int main(int argc, char** argv) {
+    uint32_t iterations = 500;
+    const char* only = NULL;
+    bool csv = false;
+    double max_render_us = 0;
+    size_t max_heap = 0;
+    long max_heap_fallbacks = -1;
+    double max_layout_us = 0;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--iterations") == 0 && i + 1 < argc) {
+            iterations = (uint32_t)strtoul(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "--scenario") == 0 && i + 1 < argc) {
+            only = argv[++i];
+        } else if (strcmp(argv[i], "--csv") == 0) {
+            csv = true;
+        } else if (strcmp(argv[i], "--max-render-us") == 0 && i + 1 < argc) {
+            max_render_us = strtod(argv[++i], NULL);
+        } else if (strcmp(argv[i], "--max-heap") == 0 && i + 1 < argc) {
+            max_heap = (size_t)strtoul(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "--max-heap-fallbacks") == 0 && i + 1 < argc) {
+            max_heap_fallbacks = strtol(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "--max-layout-us") == 0 && i + 1 < argc) {
+            max_layout_us = strtod(argv[++i], NULL);
+        } else {
+            usage(argv[0]);
+            return 2;
+        }
+    }
+
+    int status = 0;
+    bool ran = false;
+    print_header(csv);
+
+    for (uint32_t s = 0; s < SCENARIOS_COUNT; s++) {
+        if (only != NULL && strcmp(only, SCENARIOS[s].name) != 0) {
+            continue;
+        }
+        ran = true;
+
+        // Fresh LVGL instance per scenario so heap high-water marks are independent
+        lv_init();
+        lv_tick_set_cb(bench_tick_get);
+        bench_display_create();
+        ui_init();
+        ui_binding_update_connection_status(0, true);
+        pump_frames(4);
+
+        frame_count = 0;
+        layout_sum_ns = 0;
+        layout_max_ns = 0;
+        layout_count = 0;
+        ui_display_reset_stats();
+        for (uint32_t i = 0; i < iterations; i++) {
+            SCENARIOS[s].step(i);
+        }
+
+        bench_result_t res;
+        summarize(&res, iterations);
+        print_result(SCENARIOS[s].name, &res, csv);
+
+        if (max_render_us > 0 && res.render_p95_us > max_render_us) {
+            fprintf(stderr, "%s: p95 render %.1f us exceeds budget %.1f us\n",
+                    SCENARIOS[s].name, res.render_p95_us, max_render_us);
+            status = 1;
+        }
+        if (max_heap > 0 && res.heap_max_used > max_heap) {
+            fprintf(stderr, "%s: heap high-water %zu exceeds budget %zu\n",
+                    SCENARIOS[s].name, res.heap_max_used, max_heap);
+            status = 1;
+        }
+        if (max_heap_fallbacks >= 0 && res.heap_fallbacks > (uint32_t)max_heap_fallbacks) {
+            fprintf(stderr, "%s: %u heap fallbacks after startup exceed budget %ld\n",
+                    SCENARIOS[s].name, res.heap_fallbacks, max_heap_fallbacks);
+            status = 1;
+        }
+        if (max_layout_us > 0 && res.layout_max_us > max_layout_us) {
+            fprintf(stderr, "%s: layout pass %.1f us exceeds budget %.1f us\n",
+                    SCENARIOS[s].name, res.layout_max_us, max_layout_us);
+            status = 1;
+        }
+
+        lv_deinit();
+    }
+
+    if (!ran) {
+        usage(argv[0]);
+        return 2;
+    }
+
+    return status;
+}
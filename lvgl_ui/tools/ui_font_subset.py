@@ -0,0 +1,223 @@
+#!/usr/bin/env python3
+"""
+Generate the CJK subset fonts of the UI (ui_font_cjk_<size>.c).
+
+Collects every non-ASCII code point the UI can display: the string literals
+of the C sources (comments are skipped), the text and attribute values of
+globals.xml / project.xml, and any extra --input files (e.g. a scene or
+function list loaded at runtime). Then runs lv_font_conv once per
+UI_FONT_SIZE_* size from ui_config.h.
+
+The fonts only contain those glyphs. Latin text and LV_SYMBOL_* come from
+the Montserrat font of the same size through the LVGL fallback chain, so
+the subset does not repeat them. lv_font_conv emits the glyph table sorted
+by code point, and LVGL looks glyphs up by binary search in it.
+
+Usage:
+    ui_font_subset.py --font NotoSansSC-Regular.otf --out build/fonts
+    ui_font_subset.py --list                    # print the collected text
+    ui_font_subset.py --out DIR --check         # exit 1 if DIR is stale
+
+The used code points are written to DIR/ui_font_cjk_symbols.txt; --check
+compares the sources against it, so CI can catch a new label whose glyphs
+were never generated.
+"""
+
+import argparse
+import glob
+import os
+import re
+import shutil
+import subprocess
+import sys
+import xml.etree.ElementTree as ET
+
+UI_DIR = os.path.normpath(os.path.join(os.path.dirname(os.path.abspath(__file__)), ".."))
+SYMBOLS_FILE = "ui_font_cjk_symbols.txt"
+FONT_PREFIX = "ui_font_cjk_"
+FALLBACK_PREFIX = "lv_font_montserrat_"
+
+# LV_SYMBOL_* live in the Private Use Area and are served by Montserrat
+PUA_FIRST, PUA_LAST = 0xE000, 0xF8FF
+
+SIMPLE_ESCAPES = {"n": 0x0A, "t": 0x09, "r": 0x0D, "0": 0x00, "\\": 0x5C,
+                  "\"": 0x22, "'": 0x27, "a": 0x07, "b": 0x08, "f": 0x0C, "v": 0x0B}
+
+
+# ==================== Sources ====================
+
+def c_string_literals(text):
+    """Yield the raw contents of the string literals of a C file."""
+    i, n = 0, len(text)
+    while i < n:
+        c = text[i]
+        if text.startswith("//", i):
+            i = text.find("\n", i)
+            i = n if i < 0 else i
+        elif text.startswith("/*", i):
+            i = text.find("*/", i + 2)
+            i = n if i < 0 else i + 2
+        elif c == "'":
+            # Character constant: skip it so a '"' does not open a string
+            j = i + 1
+            while j < n and text[j] != "'":
+                j += 2 if text[j] == "\\" else 1
+            i = j + 1
+        elif c == "\"":
+            j = i + 1
+            while j < n and text[j] != "\"":
+                j += 2 if text[j] == "\\" else 1
+            yield text[i + 1:j]
+            i = j + 1
+        else:
+            i += 1
+
+
+def decode_c_literal(body):
+    """Resolve the escapes of a literal; \\x and octal escapes are UTF-8 bytes."""
+    out = bytearray()
+    i, n = 0, len(body)
+    while i < n:
+        c = body[i]
+        if c != "\\" or i + 1 >= n:
+            out += c.encode("utf-8")
+            i += 1
+            continue
+        e = body[i + 1]
+        if e == "x":
+            m = re.match(r"[0-9a-fA-F]{1,2}", body[i + 2:])
+            out.append(int(m.group(0), 16) if m else 0x78)
+            i += 2 + (len(m.group(0)) if m else 0)
+        elif e in "01234567":
+            m = re.match(r"[0-7]{1,3}", body[i + 1:])
+            out.append(int(m.group(0), 8) & 0xFF)
+            i += 1 + len(m.group(0))
+        elif e == "u" or e == "U":
+            digits = 4 if e == "u" else 8
+            out += chr(int(body[i + 2:i + 2 + digits], 16)).encode("utf-8")
+            i += 2 + digits
+        else:
+            out.append(SIMPLE_ESCAPES.get(e, ord(e)))
+            i += 2
+    return out.decode("utf-8", errors="ignore")
+
+
+def xml_strings(path):
+    """Yield the text, tail and attribute values of every element (no comments)."""
+    for elem in ET.parse(path).getroot().iter():
+        for value in (elem.text, elem.tail, *elem.attrib.values()):
+            if value:
+                yield value
+
+
+def default_inputs():
+    files = []
+    for pattern in ("*.c", "*.h"):
+        files += [f for f in glob.glob(os.path.join(UI_DIR, pattern))
+                  if not os.path.basename(f).startswith(FONT_PREFIX)]
+    files += [os.path.join(UI_DIR, "globals.xml"), os.path.join(UI_DIR, "project.xml")]
+    return sorted(f for f in files if os.path.exists(f))
+
+
+def collect_code_points(paths):
+    used = set()
+    for path in paths:
+        if path.endswith(".xml"):
+            strings = xml_strings(path)
+        elif path.endswith((".c", ".h")):
+            with open(path, encoding="utf-8") as f:
+                strings = [decode_c_literal(s) for s in c_string_literals(f.read())]
+        else:
+            with open(path, encoding="utf-8") as f:
+                strings = [f.read()]    # Plain text: every character counts
+        for s in strings:
+            used.update(ord(ch) for ch in s)
+    return sorted(cp for cp in used
+                  if cp > 0x7F and not PUA_FIRST <= cp <= PUA_LAST and not chr(cp).isspace())
+
+
+def config_font_sizes():
+    with open(os.path.join(UI_DIR, "ui_config.h"), encoding="utf-8") as f:
+        sizes = re.findall(r"#define\s+UI_FONT_SIZE_\w+\s+(\d+)", f.read())
+    return sorted({int(s) for s in sizes})
+
+
+# ==================== Generation ====================
+
+def read_symbols(out_dir):
+    path = os.path.join(out_dir, SYMBOLS_FILE)
+    if not os.path.exists(path):
+        return None
+    with open(path, encoding="utf-8") as f:
+        return sorted({ord(ch) for ch in f.read() if not ch.isspace()})
+
+
+def generate(args, code_points, sizes):
+    converter = shutil.which(args.converter)
+    if converter is None:
+        sys.exit("%s not found (npm install -g lv_font_conv)" % args.converter)
+
+    os.makedirs(args.out, exist_ok=True)
+    symbols = "".join(chr(cp) for cp in code_points)
+    for size in sizes:
+        name = "%s%d" % (FONT_PREFIX, size)
+        cmd = [converter, "--font", args.font, "--size", str(size), "--bpp", str(args.bpp),
+               "--format", "lvgl", "--symbols", symbols,
+               "--lv-font-name", name, "--lv-fallback", "%s%d" % (FALLBACK_PREFIX, size),
+               "--lv-include", "lvgl.h", "-o", os.path.join(args.out, name + ".c")]
+        if not args.compress:
+            cmd.append("--no-compress")
+        subprocess.run(cmd, check=True)
+
+    # Written last: a failed run leaves the previous stamp, so --check stays red
+    with open(os.path.join(args.out, SYMBOLS_FILE), "w", encoding="utf-8") as f:
+        f.write(symbols + "\n")
+
+    print("%d glyphs x %d sizes (%s) -> %s" % (len(code_points), len(sizes),
+                                              ", ".join(map(str, sizes)), args.out))
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Generate the CJK subset fonts of the UI")
+    parser.add_argument("--font", help="TTF/OTF with the CJK glyphs (e.g. Noto Sans SC)")
+    parser.add_argument("--out", help="Output directory of ui_font_cjk_<size>.c")
+    parser.add_argument("--input", action="append", default=[],
+                        help="Extra file with displayed text (.c/.h/.xml or plain UTF-8)")
+    parser.add_argument("--sizes", help="Comma-separated sizes (default: UI_FONT_SIZE_* of ui_config.h)")
+    parser.add_argument("--bpp", type=int, default=4, choices=(1, 2, 4, 8), help="Bits per pixel")
+    parser.add_argument("--compress", action="store_true",
+                        help="RLE-compress the bitmaps (needs LV_USE_FONT_COMPRESSED 1)")
+    parser.add_argument("--converter", default="lv_font_conv", help="lv_font_conv executable")
+    parser.add_argument("--list", action="store_true", help="Print the collected characters and exit")
+    parser.add_argument("--check", action="store_true",
+                        help="Exit 1 if --out lacks a character the sources use")
+    args = parser.parse_args()
+
+    code_points = collect_code_points(default_inputs() + args.input)
+    sizes = [int(s) for s in args.sizes.split(",")] if args.sizes else config_font_sizes()
+
+    if args.list:
+        print("".join(chr(cp) for cp in code_points))
+        print("%d characters" % len(code_points), file=sys.stderr)
+        return 0
+
+    if args.out is None:
+        parser.error("--out is required")
+
+    if args.check:
+        generated = read_symbols(args.out)
+        missing = sorted(set(code_points) - set(generated or []))
+        if generated is None or missing:
+            print("%s is stale, missing: %s" % (args.out, "".join(chr(cp) for cp in missing)),
+                  file=sys.stderr)
+            return 1
+        return 0
+
+    if args.font is None:
+        parser.error("--font is required")
+    generate(args, code_points, sizes)
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -1,22 +1,142 @@
 /**
  * @file ui_binding.c
  * @brief Data Binding Layer Implementation
+ *
+ * Backend log entries are copied into a queue drained by the UI task.
+ * Status updates coalesce instead: each kind (per channel) keeps only its
+ * latest value, swapped in and out of a small buffer set without a lock,
+ * and a dirty bit, so a burst can neither be pushed out by a
+ * log flood nor overflow and lose the final state. With
+ * ui_binding_defer_callbacks() the UI callbacks are queued the other way and
+ * run by the backend's control task. The log store and the state are then
+ * only written by the UI task.
  */
 
 #include "ui_binding.h"
 #include "ui_state.h"
+#include "ui_loop.h"
+#include "ui_config.h"
+#include "ui_log_store.h"
+#include "can_port.h"
+#include "can_trace.h"
+#include <stdatomic.h>
+#include <stdio.h>
 #include <string.h>
 
 // Registered callbacks
 static ui_callbacks_t g_callbacks = {0};
 
+// ==================== Queue Records ====================
+
+typedef struct {
+    uint8_t channel;            // UI_LOG_NO_CHANNEL for untagged entries (ui_log_store.h)
+    bool is_frame;
+    char type[4];
+    uint32_t trace;             // RX capture tag (CAN_TRACE_TAG), 0 = untraced
+    union {
+        char text[UI_LOG_TEXT_LEN];
+        ui_log_frame_t frame;
+    };
+} log_post_t;
+
+typedef enum {
+    STATE_POST_TRANSMISSION,
+    STATE_POST_SEQUENCE,
+    STATE_POST_SWEEP,
+    STATE_POST_TX_BACKPRESSURE,     // Per channel from here on
+    STATE_POST_BUS_STATE,
+    STATE_POST_CONNECTION,
+    STATE_POST_KIND_COUNT
+} state_post_kind_t;
+
+// One latest-value slot per kind and channel (bit n of the 32-bit dirty mask)
+#define STATE_SLOT_COUNT    (STATE_POST_KIND_COUNT * UI_CHANNEL_COUNT)
+#define STATE_SLOT_BUFS     4       // Latest + one being read + two posts in flight
+#define STATE_BUF_NONE      0xFFu
+
+_Static_assert(STATE_SLOT_COUNT <= 32, "one dirty bit per state slot");
+
+typedef struct {
+    uint8_t kind;               // state_post_kind_t
+    uint8_t channel;
+    union {
+        struct { bool transmitting; bool repeating; } transmission;
+        struct { char name[8]; uint16_t step; uint16_t total; } sequence;
+        struct { bool active; uint16_t permille; uint32_t rate_fps; uint32_t errors; } sweep;
+        struct { uint8_t state; uint16_t tec; } bus;
+        bool flag;              // Congested / connected
+    };
+} state_post_t;
+
+// A post fills a free buffer and swaps it in as the latest; the UI task
+// swaps the latest out, copies it and frees it. A buffer is only written
+// while its owner holds it, so neither side takes a lock or sees a torn copy.
+typedef struct {
+    state_post_t bufs[STATE_SLOT_BUFS];
+    atomic_uint_least8_t free_mask;     // Bit n: bufs[n] free (0 until ui_binding_init)
+    atomic_uint_least8_t latest;        // Published, not yet taken (STATE_BUF_NONE if none)
+} state_slot_t;
+
+typedef enum {
+    CMD_CONNECTION,
+    CMD_TRANSMIT_AUTO,
+    CMD_TRANSMIT_MANUAL,
+    CMD_MANUAL_UPDATE,
+    CMD_STOP,
+    CMD_SWEEP_START,
+    CMD_SWEEP_STOP,
+    CMD_SCENE,
+    CMD_CLEAR_LOGS
+} cmd_kind_t;
+
+typedef struct {
+    uint8_t kind;               // cmd_kind_t
+    uint8_t channel;
+    union {
+        bool connected;
+        struct { char scene[8]; uint8_t category; uint8_t function; bool repeat; uint32_t interval; } transmit;
+        struct { char can_id[32]; char data[128]; bool repeat; uint32_t interval; } manual;
+        struct { char id_first[16]; char id_last[16]; uint8_t pattern; uint32_t seed; } sweep;
+        char scene[8];
+    };
+} cmd_t;
+
+CAN_QUEUE_STORAGE(g_log_storage, sizeof(log_post_t), UI_BINDING_LOG_QUEUE_LEN);
+CAN_QUEUE_STORAGE(g_cmd_storage, sizeof(cmd_t), UI_BINDING_CMD_QUEUE_LEN);
+
+static can_queue_t g_log_queue;
+static can_queue_t g_cmd_queue;
+static state_slot_t g_state_slots[STATE_SLOT_COUNT];
+static atomic_uint_least32_t g_state_dirty;        // Slots written since the UI task took them
+static can_port_sem_t* g_cmd_sem = NULL;    // Signals the task running the callbacks
+static bool g_defer_callbacks = false;
+static uint32_t g_log_dropped_seen = 0;     // Drops already reported in the log
+
+static void copy_str(char* dst, size_t size, const char* src) {
+    snprintf(dst, size, "%s", (src != NULL) ? src : "");
+}
+
 // Forward declarations of UI update functions
 extern void ui_log_add_message(const char* type, const char* message);
-extern void ui_footer_update_status(bool transmitting, bool repeating);
-extern void ui_header_update_connection(bool connected);
+extern void ui_log_add_channel_message(uint8_t channel, const char* type, const char* message);
+extern void ui_log_add_channel_frame(uint8_t channel, const char* type, uint32_t id, bool extended,
+                                     uint8_t dlc, const uint8_t* data, uint32_t trace);
 
 void ui_binding_init(void) {
     memset(&g_callbacks, 0, sizeof(ui_callbacks_t));
+
+    // Once: backend tasks may already be posting when the UI is rebuilt
+    if (g_cmd_sem == NULL) {
+        can_queue_init(&g_log_queue, "log", g_log_storage, sizeof(log_post_t), UI_BINDING_LOG_QUEUE_LEN);
+        atomic_init(&g_state_dirty, 0);
+        for (uint32_t i = 0; i < STATE_SLOT_COUNT; i++) {
+            atomic_init(&g_state_slots[i].latest, STATE_BUF_NONE);
+            atomic_store_explicit(&g_state_slots[i].free_mask, (1u << STATE_SLOT_BUFS) - 1u,
+                                  memory_order_release);
+        }
+        can_queue_init(&g_cmd_queue, "cmd", g_cmd_storage, sizeof(cmd_t), UI_BINDING_CMD_QUEUE_LEN);
+        g_cmd_sem = can_port_sem_create();
+    }
 }
 
 void ui_binding_register_callbacks(const ui_callbacks_t* callbacks) {
@@ -37,10 +157,19 @@ void ui_binding_register_transmit_manual_callback(transmit_manual_callback_t cal
     g_callbacks.on_transmit_manual = callback;
 }
 
+void ui_binding_register_manual_update_callback(manual_update_callback_t callback) {
+    g_callbacks.on_manual_update = callback;
+}
+
 void ui_binding_register_stop_callback(stop_callback_t callback) {
     g_callbacks.on_stop = callback;
 }
 
+void ui_binding_register_sweep_callbacks(sweep_start_callback_t start, stop_callback_t stop) {
+    g_callbacks.on_sweep_start = start;
+    g_callbacks.on_sweep_stop = stop;
+}
+
 void ui_binding_register_scene_callback(scene_callback_t callback) {
     g_callbacks.on_scene_selected = callback;
 }
@@ -51,58 +180,377 @@ void ui_binding_register_clear_logs_callback(clear_logs_callback_t callback) {
 
 // ==================== UI → Backend (Trigger Events) ====================
 
-void ui_binding_trigger_connection_changed(bool connected) {
-    ui_state_set_connected(connected);
-    if (g_callbacks.on_connection_changed != NULL) {
-        g_callbacks.on_connection_changed(connected);
+static void run_command(const cmd_t* cmd) {
+    switch ((cmd_kind_t)cmd->kind) {
+        case CMD_CONNECTION:
+            if (g_callbacks.on_connection_changed != NULL) {
+                g_callbacks.on_connection_changed(cmd->channel, cmd->connected);
+            }
+            break;
+        case CMD_TRANSMIT_AUTO:
+            if (g_callbacks.on_transmit_auto != NULL) {
+                g_callbacks.on_transmit_auto(cmd->transmit.scene, cmd->transmit.category, cmd->transmit.function,
+                                             cmd->transmit.repeat, cmd->transmit.interval);
+            }
+            break;
+        case CMD_TRANSMIT_MANUAL:
+            if (g_callbacks.on_transmit_manual != NULL) {
+                g_callbacks.on_transmit_manual(cmd->channel, cmd->manual.can_id, cmd->manual.data,
+                                               cmd->manual.repeat, cmd->manual.interval);
+            }
+            break;
+        case CMD_MANUAL_UPDATE:
+            if (g_callbacks.on_manual_update != NULL) {
+                g_callbacks.on_manual_update(cmd->channel, cmd->manual.can_id, cmd->manual.data,
+                                             cmd->manual.interval);
+            }
+            break;
+        case CMD_STOP:
+            if (g_callbacks.on_stop != NULL) {
+                g_callbacks.on_stop();
+            }
+            break;
+        case CMD_SWEEP_START:
+            if (g_callbacks.on_sweep_start != NULL) {
+                g_callbacks.on_sweep_start(cmd->channel, cmd->sweep.id_first, cmd->sweep.id_last,
+                                           cmd->sweep.pattern, cmd->sweep.seed);
+            }
+            break;
+        case CMD_SWEEP_STOP:
+            if (g_callbacks.on_sweep_stop != NULL) {
+                g_callbacks.on_sweep_stop();
+            }
+            break;
+        case CMD_SCENE:
+            if (g_callbacks.on_scene_selected != NULL) {
+                g_callbacks.on_scene_selected(cmd->scene);
+            }
+            break;
+        case CMD_CLEAR_LOGS:
+            if (g_callbacks.on_clear_logs != NULL) {
+                g_callbacks.on_clear_logs();
+            }
+            break;
+    }
+}
+
+// Run the callback now, or hand it to the backend's control task
+static void submit_command(const cmd_t* cmd) {
+    if (!g_defer_callbacks) {
+        run_command(cmd);
+        return;
     }
+    if (!can_queue_push(&g_cmd_queue, cmd)) {
+        ui_log_add_message("TX", "后端忙, 操作已丢弃");
+        ui_state_increment_log_count();
+        return;
+    }
+    can_port_sem_give(g_cmd_sem);
+}
+
+void ui_binding_trigger_connection_changed(uint8_t channel, bool connected) {
+    ui_state_set_connected(channel, connected);
+    cmd_t cmd = {.kind = CMD_CONNECTION, .channel = channel, .connected = connected};
+    submit_command(&cmd);
 }
 
 void ui_binding_trigger_transmit_auto(const char* scene, uint8_t category,
                                       uint8_t function, bool repeat, uint32_t interval) {
-    if (g_callbacks.on_transmit_auto != NULL) {
-        g_callbacks.on_transmit_auto(scene, category, function, repeat, interval);
-    }
+    CAN_TRACE_MARK(CAN_TRACE_BINDING);
+    cmd_t cmd = {.kind = CMD_TRANSMIT_AUTO};
+    copy_str(cmd.transmit.scene, sizeof(cmd.transmit.scene), scene);
+    cmd.transmit.category = category;
+    cmd.transmit.function = function;
+    cmd.transmit.repeat = repeat;
+    cmd.transmit.interval = interval;
+    submit_command(&cmd);
 }
 
-void ui_binding_trigger_transmit_manual(const char* can_id, const char* data,
+void ui_binding_trigger_transmit_manual(uint8_t channel, const char* can_id, const char* data,
                                         bool repeat, uint32_t interval) {
-    if (g_callbacks.on_transmit_manual != NULL) {
-        g_callbacks.on_transmit_manual(can_id, data, repeat, interval);
-    }
+    CAN_TRACE_MARK(CAN_TRACE_BINDING);
+    cmd_t cmd = {.kind = CMD_TRANSMIT_MANUAL, .channel = channel};
+    copy_str(cmd.manual.can_id, sizeof(cmd.manual.can_id), can_id);
+    copy_str(cmd.manual.data, sizeof(cmd.manual.data), data);
+    cmd.manual.repeat = repeat;
+    cmd.manual.interval = interval;
+    submit_command(&cmd);
+}
+
+void ui_binding_trigger_manual_update(uint8_t channel, const char* can_id, const char* data,
+                                      uint32_t interval) {
+    cmd_t cmd = {.kind = CMD_MANUAL_UPDATE, .channel = channel};
+    copy_str(cmd.manual.can_id, sizeof(cmd.manual.can_id), can_id);
+    copy_str(cmd.manual.data, sizeof(cmd.manual.data), data);
+    cmd.manual.interval = interval;
+    submit_command(&cmd);
 }
 
 void ui_binding_trigger_stop(void) {
-    if (g_callbacks.on_stop != NULL) {
-        g_callbacks.on_stop();
-    }
+    cmd_t cmd = {.kind = CMD_STOP};
+    submit_command(&cmd);
+}
+
+void ui_binding_trigger_sweep_start(uint8_t channel, const char* id_first, const char* id_last,
+                                    uint8_t pattern, uint32_t seed) {
+    cmd_t cmd = {.kind = CMD_SWEEP_START, .channel = channel};
+    copy_str(cmd.sweep.id_first, sizeof(cmd.sweep.id_first), id_first);
+    copy_str(cmd.sweep.id_last, sizeof(cmd.sweep.id_last), id_last);
+    cmd.sweep.pattern = pattern;
+    cmd.sweep.seed = seed;
+    submit_command(&cmd);
+}
+
+void ui_binding_trigger_sweep_stop(void) {
+    cmd_t cmd = {.kind = CMD_SWEEP_STOP};
+    submit_command(&cmd);
 }
 
 void ui_binding_trigger_scene_selected(const char* scene) {
-    if (g_callbacks.on_scene_selected != NULL) {
-        g_callbacks.on_scene_selected(scene);
-    }
+    cmd_t cmd = {.kind = CMD_SCENE};
+    copy_str(cmd.scene, sizeof(cmd.scene), scene);
+    submit_command(&cmd);
 }
 
 void ui_binding_trigger_clear_logs(void) {
-    if (g_callbacks.on_clear_logs != NULL) {
-        g_callbacks.on_clear_logs();
-    }
+    cmd_t cmd = {.kind = CMD_CLEAR_LOGS};
+    submit_command(&cmd);
 }
 
 // ==================== Backend → UI (Update Functions) ====================
 
+static void post_log(uint8_t channel, const char* type, const char* message) {
+    if (type == NULL || message == NULL) {
+        return;
+    }
+    log_post_t post = {.channel = channel, .is_frame = false};
+    copy_str(post.type, sizeof(post.type), type);
+    copy_str(post.text, sizeof(post.text), message);
+    can_queue_push(&g_log_queue, &post);    // Full: counted, reported by the UI task
+    ui_loop_mark_activity();
+}
+
+// Take a free buffer of the slot; -1 if all are in use
+static int claim_state_buf(state_slot_t* slot) {
+    uint_least8_t mask = atomic_load_explicit(&slot->free_mask, memory_order_relaxed);
+    while (mask != 0) {
+        int idx = 0;
+        while ((mask & (1u << idx)) == 0) {
+            idx++;
+        }
+        // Acquire: the UI task's copy out of the buffer is complete
+        if (atomic_compare_exchange_weak_explicit(&slot->free_mask, &mask, (uint_least8_t)(mask & ~(1u << idx)),
+                                                  memory_order_acquire, memory_order_relaxed)) {
+            return idx;
+        }
+    }
+    return -1;
+}
+
+static void release_state_buf(state_slot_t* slot, uint_least8_t idx) {
+    atomic_fetch_or_explicit(&slot->free_mask, (uint_least8_t)(1u << idx), memory_order_release);
+}
+
+// Overwrite the kind's latest value; the UI task applies it on its next pass
+static void post_state(const state_post_t* post) {
+    uint8_t channel = (post->kind >= STATE_POST_TX_BACKPRESSURE) ? post->channel : 0;
+    if (channel >= UI_CHANNEL_COUNT) {
+        return;
+    }
+    uint32_t index = (uint32_t)post->kind * UI_CHANNEL_COUNT + channel;
+    state_slot_t* slot = &g_state_slots[index];
+
+    int idx = claim_state_buf(slot);
+    if (idx < 0) {
+        // Before init, or two other posts to this slot are in flight: they
+        // publish after this one would have, so it would be overwritten anyway
+        return;
+    }
+    slot->bufs[idx] = *post;
+    uint_least8_t old = atomic_exchange_explicit(&slot->latest, (uint_least8_t)idx, memory_order_acq_rel);
+    if (old != STATE_BUF_NONE) {
+        release_state_buf(slot, old);   // Superseded before the UI task took it
+    }
+    atomic_fetch_or_explicit(&g_state_dirty, 1u << index, memory_order_release);
+}
+
 void ui_binding_add_log(const char* type, const char* message) {
-    ui_state_increment_log_count();
-    ui_log_add_message(type, message);
+    post_log(UI_LOG_NO_CHANNEL, type, message);
+}
+
+void ui_binding_add_channel_log(uint8_t channel, const char* type, const char* message) {
+    post_log(channel, type, message);
+}
+
+void ui_binding_add_frame_log(uint8_t channel, const char* type, uint32_t id, bool extended,
+                              uint8_t dlc, const uint8_t* data, uint64_t timestamp_us) {
+    if (type == NULL || (data == NULL && dlc > 0)) {
+        return;
+    }
+    log_post_t post = {.channel = channel, .is_frame = true};
+    copy_str(post.type, sizeof(post.type), type);
+    if (strcmp(post.type, "RX") == 0) {
+        post.trace = CAN_TRACE_TAG(timestamp_us);
+    }
+    post.frame.id = id;
+    post.frame.extended = extended;
+    post.frame.dlc = (dlc < UI_LOG_FRAME_DATA) ? dlc : UI_LOG_FRAME_DATA;
+    if (post.frame.dlc > 0) {
+        memcpy(post.frame.data, data, post.frame.dlc);
+    }
+    can_queue_push(&g_log_queue, &post);
+    ui_loop_mark_activity();
 }
 
 void ui_binding_update_transmission_status(bool transmitting, bool repeating) {
-    ui_state_set_transmission(transmitting, repeating);
-    ui_footer_update_status(transmitting, repeating);
+    // Widgets update from the state listeners on the next flush
+    state_post_t post = {.kind = STATE_POST_TRANSMISSION};
+    post.transmission.transmitting = transmitting;
+    post.transmission.repeating = repeating;
+    post_state(&post);
+    ui_loop_mark_activity();
+}
+
+void ui_binding_update_sequence_progress(const char* name, uint16_t step, uint16_t total) {
+    state_post_t post = {.kind = STATE_POST_SEQUENCE};
+    copy_str(post.sequence.name, sizeof(post.sequence.name), name);
+    post.sequence.step = step;
+    post.sequence.total = (name != NULL) ? total : 0;
+    post_state(&post);
+    ui_loop_mark_activity();
+}
+
+void ui_binding_update_sweep_progress(bool active, uint16_t permille, uint32_t rate_fps, uint32_t errors) {
+    state_post_t post = {.kind = STATE_POST_SWEEP};
+    post.sweep.active = active;
+    post.sweep.permille = permille;
+    post.sweep.rate_fps = rate_fps;
+    post.sweep.errors = errors;
+    post_state(&post);
+    ui_loop_mark_activity();
+}
+
+void ui_binding_update_tx_backpressure(uint8_t channel, bool congested) {
+    state_post_t post = {.kind = STATE_POST_TX_BACKPRESSURE, .channel = channel, .flag = congested};
+    post_state(&post);
+    ui_loop_mark_activity();
+}
+
+void ui_binding_update_bus_state(uint8_t channel, uint8_t state, uint16_t tec) {
+    state_post_t post = {.kind = STATE_POST_BUS_STATE, .channel = channel};
+    post.bus.state = state;
+    post.bus.tec = tec;
+    post_state(&post);
+    ui_loop_notify();
+}
+
+void ui_binding_update_connection_status(uint8_t channel, bool connected) {
+    state_post_t post = {.kind = STATE_POST_CONNECTION, .channel = channel, .flag = connected};
+    post_state(&post);
+    ui_loop_notify();
+}
+
+// ==================== Task Handoff ====================
+
+static void apply_state(const state_post_t* post) {
+    switch ((state_post_kind_t)post->kind) {
+        case STATE_POST_TRANSMISSION:
+            ui_state_set_transmission(post->transmission.transmitting, post->transmission.repeating);
+            break;
+        case STATE_POST_SEQUENCE:
+            ui_state_set_sequence(post->sequence.name, post->sequence.step, post->sequence.total);
+            break;
+        case STATE_POST_SWEEP:
+            ui_state_set_sweep(post->sweep.active, post->sweep.permille, post->sweep.rate_fps, post->sweep.errors);
+            break;
+        case STATE_POST_TX_BACKPRESSURE:
+            ui_state_set_tx_congested(post->channel, post->flag);
+            break;
+        case STATE_POST_BUS_STATE:
+            ui_state_set_bus_state(post->channel, (ui_bus_state_t)post->bus.state, post->bus.tec);
+            break;
+        case STATE_POST_CONNECTION:
+            ui_state_set_connected(post->channel, post->flag);
+            break;
+        default:
+            break;
+    }
+}
+
+void ui_binding_process(void) {
+    // Latest value of every slot written since the last pass. A slot written
+    // again meanwhile is dirty again; if this pass already took the newer
+    // value, the next one finds nothing published and skips it.
+    uint32_t dirty = atomic_exchange_explicit(&g_state_dirty, 0, memory_order_acquire);
+    for (uint32_t index = 0; index < STATE_SLOT_COUNT && dirty != 0; index++) {
+        if ((dirty & (1u << index)) == 0) {
+            continue;
+        }
+        dirty &= ~(1u << index);
+
+        state_slot_t* slot = &g_state_slots[index];
+        uint_least8_t idx = atomic_exchange_explicit(&slot->latest, STATE_BUF_NONE, memory_order_acquire);
+        if (idx == STATE_BUF_NONE) {
+            continue;
+        }
+        state_post_t state = slot->bufs[idx];
+        release_state_buf(slot, idx);
+        apply_state(&state);
+    }
+
+    // At most one queue's worth per pass, so a flood cannot stall rendering
+    log_post_t post;
+    uint32_t added = 0;
+    while (added < UI_BINDING_LOG_QUEUE_LEN && can_queue_pop(&g_log_queue, &post)) {
+        if (post.is_frame) {
+            ui_log_add_channel_frame(post.channel, post.type, post.frame.id, post.frame.extended,
+                                     post.frame.dlc, post.frame.data, post.trace);
+        } else {
+            ui_log_add_channel_message(post.channel, post.type, post.text);
+        }
+        added++;
+    }
+
+    can_queue_stats_t stats;
+    can_queue_get_stats(&g_log_queue, &stats);
+    if (stats.dropped != g_log_dropped_seen) {
+        char msg[48];
+        snprintf(msg, sizeof(msg), "日志队列已满, 丢弃 %lu 条",
+                 (unsigned long)(stats.dropped - g_log_dropped_seen));
+        g_log_dropped_seen = stats.dropped;
+        ui_log_add_message("RX", msg);
+        added++;
+    }
+
+    if (added > 0) {
+        ui_state_increment_log_count();     // Renders the new entries on the next flush
+    }
+    if (can_queue_count(&g_log_queue) > 0) {
+        ui_loop_notify();                   // Rest on the next pass
+    }
+}
+
+void ui_binding_defer_callbacks(bool enabled) {
+    g_defer_callbacks = enabled;
+}
+
+uint32_t ui_binding_dispatch_callbacks(uint32_t timeout_ms) {
+    cmd_t cmd;
+    uint32_t count = 0;
+
+    while (!can_queue_pop(&g_cmd_queue, &cmd)) {
+        if (timeout_ms == 0 || g_cmd_sem == NULL || !can_port_sem_take(g_cmd_sem, timeout_ms)) {
+            return 0;
+        }
+    }
+    do {
+        run_command(&cmd);
+        count++;
+    } while (can_queue_pop(&g_cmd_queue, &cmd));
+    return count;
 }
 
-void ui_binding_update_connection_status(bool connected) {
-    ui_state_set_connected(connected);
-    ui_header_update_connection(connected);
+void ui_binding_get_queue_stats(ui_binding_queue_stats_t* stats) {
+    can_queue_get_stats(&g_log_queue, &stats->log);
+    can_queue_get_stats(&g_cmd_queue, &stats->cmd);
 }
@@ -4,6 +4,18 @@
  * 
  * Defines callback interfaces for connecting the LVGL UI to the backend.
  * UI events trigger callbacks, and backend can update UI through provided functions.
+ *
+ * The UI task and the CAN tasks run on different cores (see Tasks in
+ * ui_config.h) and only meet in bounded lock-free queues (can_queue.h)
+ * and lock-free latest-value slots:
+ * - Backend → UI: the update functions copy log entries into a queue and
+ *   status updates into the slot of their kind, and wake the UI task, which applies them in ui_binding_process() before
+ *   the state flush. They never block and may be called from any task once
+ *   ui_init() has run. A log entry that does not fit is dropped; the UI logs
+ *   how many were lost.
+ * - UI → Backend: after ui_binding_defer_callbacks(true) the callbacks are
+ *   queued as well and run by the backend task that calls
+ *   ui_binding_dispatch_callbacks(). Otherwise they run in the UI task.
  */
 
 #ifndef UI_BINDING_H
@@ -11,16 +23,18 @@
 
 #include <stdint.h>
 #include <stdbool.h>
+#include "can_queue.h"
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
 /**
- * @brief Callback when connection state changes
+ * @brief Callback when a channel's connection toggle changes
+ * @param channel Channel index (< UI_CHANNEL_COUNT)
  * @param connected true if connected, false if disconnected
  */
-typedef void (*connection_callback_t)(bool connected);
+typedef void (*connection_callback_t)(uint8_t channel, bool connected);
 
 /**
  * @brief Callback when transmit is requested in auto mode
@@ -35,14 +49,45 @@ typedef void (*transmit_auto_callback_t)(const char* scene, uint8_t category,
 
 /**
  * @brief Callback when transmit is requested in manual mode
+ * @param channel Target channel
  * @param can_id CAN ID string (e.g., "0x123")
  * @param data Data string (e.g., "[0x01, 0x02, 0x03]")
  * @param repeat true if repeat is enabled
  * @param interval Repeat interval in ms
  */
-typedef void (*transmit_manual_callback_t)(const char* can_id, const char* data,
+typedef void (*transmit_manual_callback_t)(uint8_t channel, const char* can_id, const char* data,
                                            bool repeat, uint32_t interval);
 
+/**
+ * @brief Callback when a running manual repeat is edited (Enter or focus leaves a field)
+ * @param channel Target channel
+ * @param can_id CAN ID string
+ * @param data Data string
+ * @param interval Repeat interval in ms
+ */
+typedef void (*manual_update_callback_t)(uint8_t channel, const char* can_id, const char* data,
+                                         uint32_t interval);
+
+/**
+ * @brief Sweep payload patterns (manual mode sweep section)
+ */
+typedef enum {
+    UI_SWEEP_INCREMENT = 0,     // Counter payloads
+    UI_SWEEP_WALKING_BIT,       // One set bit walking across the payload
+    UI_SWEEP_RANDOM             // Seeded random payloads
+} ui_sweep_pattern_t;
+
+/**
+ * @brief Callback when an ID/payload sweep is started in manual mode
+ * @param channel Target channel
+ * @param id_first First CAN ID string (e.g., "0x000")
+ * @param id_last Last CAN ID string, inclusive (e.g., "0x7FF")
+ * @param pattern Payload pattern (ui_sweep_pattern_t)
+ * @param seed Seed for UI_SWEEP_RANDOM
+ */
+typedef void (*sweep_start_callback_t)(uint8_t channel, const char* id_first, const char* id_last,
+                                       uint8_t pattern, uint32_t seed);
+
 /**
  * @brief Callback when stop is requested
  */
@@ -69,6 +114,9 @@ typedef struct {
     stop_callback_t on_stop;
     scene_callback_t on_scene_selected;
     clear_logs_callback_t on_clear_logs;
+    manual_update_callback_t on_manual_update;      // Optional
+    sweep_start_callback_t on_sweep_start;          // Optional
+    stop_callback_t on_sweep_stop;                  // Optional
 } ui_callbacks_t;
 
 /**
@@ -100,12 +148,25 @@ void ui_binding_register_transmit_auto_callback(transmit_auto_callback_t callbac
  */
 void ui_binding_register_transmit_manual_callback(transmit_manual_callback_t callback);
 
+/**
+ * @brief Register manual repeat live-edit callback
+ * @param callback Callback function
+ */
+void ui_binding_register_manual_update_callback(manual_update_callback_t callback);
+
 /**
  * @brief Register stop callback
  * @param callback Callback function
  */
 void ui_binding_register_stop_callback(stop_callback_t callback);
 
+/**
+ * @brief Register sweep start and stop callbacks
+ * @param start Called when a sweep is started
+ * @param stop Called when the running sweep is stopped
+ */
+void ui_binding_register_sweep_callbacks(sweep_start_callback_t start, stop_callback_t stop);
+
 /**
  * @brief Register scene selection callback
  * @param callback Callback function
@@ -120,9 +181,10 @@ void ui_binding_register_clear_logs_callback(clear_logs_callback_t callback);
 
 /**
  * @brief Trigger connection changed event (called by UI)
+ * @param channel Channel index
  * @param connected New connection state
  */
-void ui_binding_trigger_connection_changed(bool connected);
+void ui_binding_trigger_connection_changed(uint8_t channel, bool connected);
 
 /**
  * @brief Trigger transmit auto event (called by UI)
@@ -137,19 +199,46 @@ void ui_binding_trigger_transmit_auto(const char* scene, uint8_t category,
 
 /**
  * @brief Trigger transmit manual event (called by UI)
+ * @param channel Target channel
  * @param can_id CAN ID string
  * @param data Data string
  * @param repeat Repeat enabled
  * @param interval Interval in ms
  */
-void ui_binding_trigger_transmit_manual(const char* can_id, const char* data,
+void ui_binding_trigger_transmit_manual(uint8_t channel, const char* can_id, const char* data,
                                         bool repeat, uint32_t interval);
 
+/**
+ * @brief Trigger manual repeat live edit (called by UI while repeating)
+ * @param channel Target channel
+ * @param can_id CAN ID string
+ * @param data Data string
+ * @param interval Interval in ms
+ */
+void ui_binding_trigger_manual_update(uint8_t channel, const char* can_id, const char* data,
+                                      uint32_t interval);
+
 /**
  * @brief Trigger stop event (called by UI)
  */
 void ui_binding_trigger_stop(void);
 
+/**
+ * @brief Trigger sweep start (called by UI)
+ * @param channel Target channel
+ * @param id_first First CAN ID string
+ * @param id_last Last CAN ID string (inclusive)
+ * @param pattern Payload pattern (ui_sweep_pattern_t)
+ * @param seed Seed for UI_SWEEP_RANDOM
+ */
+void ui_binding_trigger_sweep_start(uint8_t channel, const char* id_first, const char* id_last,
+                                    uint8_t pattern, uint32_t seed);
+
+/**
+ * @brief Trigger sweep stop (called by UI)
+ */
+void ui_binding_trigger_sweep_stop(void);
+
 /**
  * @brief Trigger scene selected event (called by UI)
  * @param scene Scene identifier
@@ -170,6 +259,32 @@ void ui_binding_trigger_clear_logs(void);
  */
 void ui_binding_add_log(const char* type, const char* message);
 
+/**
+ * @brief Add a log message tagged with its channel (called by backend)
+ * @param channel Channel the frame or event belongs to
+ * @param type "TX" or "RX"
+ * @param message Log message content
+ */
+void ui_binding_add_channel_log(uint8_t channel, const char* type, const char* message);
+
+/**
+ * @brief Add a CAN frame to the log (called by backend)
+ *
+ * The frame is stored binary, indexed by ID for the log filter and formatted
+ * only when its row is drawn.
+ *
+ * @param channel Channel the frame was sent or received on
+ * @param type "TX" or "RX"
+ * @param id CAN ID
+ * @param extended true for a 29-bit ID
+ * @param dlc Payload length (0-8)
+ * @param data Payload
+ * @param timestamp_us Frame timestamp (can_frame_t.timestamp_us); RX frames
+ *                     are traced from it to their drawn log row
+ */
+void ui_binding_add_frame_log(uint8_t channel, const char* type, uint32_t id, bool extended,
+                              uint8_t dlc, const uint8_t* data, uint64_t timestamp_us);
+
 /**
  * @brief Update transmission status (called by backend)
  * @param transmitting true if currently transmitting
@@ -177,11 +292,83 @@ void ui_binding_add_log(const char* type, const char* message);
  */
 void ui_binding_update_transmission_status(bool transmitting, bool repeating);
 
+/**
+ * @brief Update scene sequence progress shown in the footer (called by backend)
+ * @param name Sequence name (e.g. scene "IGP"), NULL to clear
+ * @param step Current step (0-based)
+ * @param total Steps in the sequence (0 to clear)
+ */
+void ui_binding_update_sequence_progress(const char* name, uint16_t step, uint16_t total);
+
+/**
+ * @brief Update sweep progress shown in the manual panel (called by backend)
+ * @param active true while the sweep runs, false once it finished or stopped
+ * @param permille Progress (0-1000)
+ * @param rate_fps Achieved frames per second
+ * @param errors Controller bus errors since the sweep started
+ */
+void ui_binding_update_sweep_progress(bool active, uint16_t permille, uint32_t rate_fps, uint32_t errors);
+
+/**
+ * @brief Update TX queue backpressure shown in the footer (called by backend)
+ * @param channel Channel index
+ * @param congested true while the channel's TX queue is backed up
+ */
+void ui_binding_update_tx_backpressure(uint8_t channel, bool congested);
+
+/**
+ * @brief Update the bus health shown in the header (called by backend)
+ * @param channel Channel index
+ * @param state Fault confinement state (ui_bus_state_t)
+ * @param tec TX error counter
+ */
+void ui_binding_update_bus_state(uint8_t channel, uint8_t state, uint16_t tec);
+
 /**
  * @brief Update connection status from backend
+ * @param channel Channel index
  * @param connected Connection state
  */
-void ui_binding_update_connection_status(bool connected);
+void ui_binding_update_connection_status(uint8_t channel, bool connected);
+
+// ==================== Task Handoff ====================
+
+/**
+ * @brief Handoff queue counters
+ */
+typedef struct {
+    can_queue_stats_t log;      // Backend → UI log entries
+    can_queue_stats_t cmd;      // UI → Backend callbacks
+} ui_binding_queue_stats_t;
+
+/**
+ * @brief Apply the queued backend updates (UI task; ui_loop calls it before
+ *        each state flush)
+ */
+void ui_binding_process(void);
+
+/**
+ * @brief Queue the UI callbacks for a backend task instead of running them
+ *        in the UI task
+ * @param enabled true once a task calls ui_binding_dispatch_callbacks()
+ */
+void ui_binding_defer_callbacks(bool enabled);
+
+/**
+ * @brief Run the queued UI callbacks in the calling task
+ * @param timeout_ms Time to wait for the first one (CAN_PORT_WAIT_FOREVER to block)
+ * @return Number of callbacks run
+ */
+uint32_t ui_binding_dispatch_callbacks(uint32_t timeout_ms);
+
+/**
+ * @brief Read the handoff queue counters (depth, high-water, drops)
+ *
+ * Status updates have no queue: they coalesce into latest-value slots.
+ *
+ * @param stats Output
+ */
+void ui_binding_get_queue_stats(ui_binding_queue_stats_t* stats);
 
 #ifdef __cplusplus
 }
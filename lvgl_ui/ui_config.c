@@ -4,8 +4,15 @@
  */
 
 #include "ui_config.h"
+#include "ui_state.h"
 #include <string.h>
 
+// ==================== CAN Channels ====================
+const char* UI_CHANNELS[UI_CHANNEL_COUNT] = {
+    "PT",       // Powertrain
+    "BODY"      // Body
+};
+
 // ==================== Scene Options ====================
 const char* UI_SCENES[] = {
     "B",
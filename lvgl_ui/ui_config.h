@@ -52,6 +52,7 @@ extern "C" {
 #define UI_COLOR_GREEN_400      lv_color_hex(0x4ADE80)  // RX messages
 #define UI_COLOR_RED_600        lv_color_hex(0xDC2626)  // Danger/stop
 #define UI_COLOR_RED_500        lv_color_hex(0xEF4444)  // Danger hover
+#define UI_COLOR_AMBER_400      lv_color_hex(0xFBBF24)  // TX congestion
 
 // Disabled state
 #define UI_COLOR_DISABLED_BG    lv_color_hex(0x374151)  // gray-700
@@ -62,6 +63,30 @@ extern "C" {
 #define UI_FONT_SIZE_NORMAL     12  // Most text
 #define UI_FONT_SIZE_MEDIUM     14  // Headers
 
+// 1 = use the subset fonts ui_font_cjk_<size> generated from the UI strings by
+// tools/ui_font_subset.py. They hold only the Chinese glyphs the UI uses and
+// fall back to Montserrat of the same size for Latin text and LV_SYMBOL_*.
+// 0 = Montserrat only (Chinese text shows as missing glyphs)
+#ifndef UI_FONT_CJK
+#define UI_FONT_CJK 0
+#endif
+
+#define UI_FONT_NAME_(prefix, size) prefix##size
+#define UI_FONT_NAME(prefix, size)  UI_FONT_NAME_(prefix, size)
+
+#if UI_FONT_CJK
+#define UI_FONT_PREFIX          ui_font_cjk_
+LV_FONT_DECLARE(UI_FONT_NAME(UI_FONT_PREFIX, UI_FONT_SIZE_SMALL))
+LV_FONT_DECLARE(UI_FONT_NAME(UI_FONT_PREFIX, UI_FONT_SIZE_NORMAL))
+LV_FONT_DECLARE(UI_FONT_NAME(UI_FONT_PREFIX, UI_FONT_SIZE_MEDIUM))
+#else
+#define UI_FONT_PREFIX          lv_font_montserrat_
+#endif
+
+#define UI_FONT_SMALL           (&UI_FONT_NAME(UI_FONT_PREFIX, UI_FONT_SIZE_SMALL))
+#define UI_FONT_NORMAL          (&UI_FONT_NAME(UI_FONT_PREFIX, UI_FONT_SIZE_NORMAL))
+#define UI_FONT_MEDIUM          (&UI_FONT_NAME(UI_FONT_PREFIX, UI_FONT_SIZE_MEDIUM))
+
 // ==================== Spacing ====================
 #define UI_PADDING_SMALL        4
 #define UI_PADDING_MEDIUM       8
@@ -73,6 +98,98 @@ extern "C" {
 #define UI_RADIUS_SMALL         4
 #define UI_RADIUS_MEDIUM        8
 
+// ==================== Log ====================
+#define UI_LOG_VIEW_ROWS        48  // Rows on screen; the oldest is recycled
+
+// 1 = merge consecutive identical log entries into one row with a repeat
+// counter at boot (toggled at runtime by the log's merge button)
+#ifndef UI_LOG_COLLAPSE_DEFAULT
+#define UI_LOG_COLLAPSE_DEFAULT 1
+#endif
+
+// ==================== Memory ====================
+// Blocks per size class of the pooled LVGL allocator (ui_mem.c, used when
+// LV_USE_STDLIB_MALLOC is LV_STDLIB_CUSTOM). Check the high-water marks in
+// the debug overlay or ui_bench before shrinking them.
+#ifndef UI_MEM_POOL_16
+#define UI_MEM_POOL_16          256
+#define UI_MEM_POOL_32          384
+#define UI_MEM_POOL_64          256
+#define UI_MEM_POOL_128         192
+#define UI_MEM_POOL_256         48
+#define UI_MEM_POOL_512         16
+#endif
+
+// ==================== Debug Overlay ====================
+// 1 = a long-press on the header title toggles the performance overlay (built
+// on the first toggle); 0 = compiled out of the header
+#ifndef UI_DEBUG_OVERLAY_ENABLE
+#define UI_DEBUG_OVERLAY_ENABLE 1
+#endif
+
+// ==================== Lazy Views ====================
+// Views hidden at boot (manual input, debug overlay) are built the first time
+// they are shown. 1 = delete them again when hidden: every open pays the build
+// again, but a closed view costs no LVGL heap (memory-tight builds)
+#ifndef UI_LAZY_DESTROY_ON_HIDE
+#define UI_LAZY_DESTROY_ON_HIDE 0
+#endif
+
+// ==================== Layout ====================
+// 1 = resolve the flex layout of each view once when it is built and pin the
+// result (ui_layout.h): status text updates then redraw only their own label.
+// 0 = keep the flex layout live (e.g. while changing the component layouts)
+#ifndef UI_LAYOUT_ABSOLUTE
+#define UI_LAYOUT_ABSOLUTE 1
+#endif
+
+// ==================== Display ====================
+// Flush pipeline (ui_display.h): rows per partial buffer (two buffers of
+// UI_SCREEN_WIDTH * lines * 2 bytes, DMA-capable RAM on ESP32)
+#ifndef UI_DISPLAY_BUF_LINES
+#define UI_DISPLAY_BUF_LINES    40
+#endif
+
+// Areas at least this wide are widened to full rows
+#ifndef UI_DISPLAY_WIDEN_MIN_W
+#define UI_DISPLAY_WIDEN_MIN_W  (UI_SCREEN_WIDTH / 2)
+#endif
+
+// Full-row bands closer than this many rows are sent as one window
+#ifndef UI_DISPLAY_MERGE_GAP
+#define UI_DISPLAY_MERGE_GAP    8
+#endif
+
+// ==================== Tasks ====================
+// The UI task (LVGL) owns one core; the CAN RX, TX and control tasks are
+// pinned to the other one with higher priorities, so rendering never delays
+// a frame. The two sides only exchange messages through the lock-free
+// queues and latest-value slots of ui_binding.h. Priorities are FreeRTOS priorities (SCHED_FIFO on
+// the host build).
+#ifndef UI_TASK_CORE
+#define UI_TASK_CORE            0
+#define UI_TASK_PRIO            5
+#define UI_TASK_STACK           8192
+
+#define CAN_TASK_CORE           1
+#define CAN_RX_TASK_PRIO        19  // Drains the controller before its FIFO overflows
+#define CAN_TX_TASK_PRIO        18  // Scheduler: periodic deadlines, sequences
+#define CAN_CTL_TASK_PRIO       10  // Runs the UI callbacks (ui_binding_dispatch_callbacks)
+#define CAN_TASK_STACK          4096
+#endif
+
+// Queue lengths (powers of two). Log entries beyond UI_BINDING_LOG_QUEUE_LEN
+// per UI pass are dropped and counted. 256 holds two of can_bench's nominal
+// 128-frame bursts (about 30 KB). Status updates coalesce and need no queue.
+#ifndef UI_BINDING_LOG_QUEUE_LEN
+#define UI_BINDING_LOG_QUEUE_LEN    256
+#define UI_BINDING_CMD_QUEUE_LEN    8
+#endif
+
+// ==================== CAN Channels ====================
+// Short names shown on the header toggles and log rows (UI_CHANNEL_COUNT entries)
+extern const char* UI_CHANNELS[];
+
 // ==================== Scene Options ====================
 extern const char* UI_SCENES[];
 extern const uint8_t UI_SCENES_COUNT;
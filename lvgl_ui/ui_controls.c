@@ -111,7 +111,7 @@ lv_obj_t* ui_controls_create(lv_obj_t* parent, int y_offset) {
     lv_obj_t* scene_label = lv_label_create(controls_container);
     lv_label_set_text(scene_label, "场景发送 (SCENE)");
     lv_obj_set_style_text_color(scene_label, UI_COLOR_TEXT_SECONDARY, 0);
-    lv_obj_set_style_text_font(scene_label, &lv_font_montserrat_12, 0);
+    lv_obj_set_style_text_font(scene_label, UI_FONT_NORMAL, 0);
     lv_obj_set_style_pad_bottom(scene_label, UI_GAP_MEDIUM, 0);
     
     // Scene button grid
@@ -147,7 +147,7 @@ lv_obj_t* ui_controls_create(lv_obj_t* parent, int y_offset) {
         lv_label_set_text(btn_label, UI_SCENES[i]);
         lv_obj_set_style_text_color(btn_label, 
                                     (i == 0) ? UI_COLOR_WHITE : UI_COLOR_TEXT_PRIMARY, 0);
-        lv_obj_set_style_text_font(btn_label, &lv_font_montserrat_12, 0);
+        lv_obj_set_style_text_font(btn_label, UI_FONT_NORMAL, 0);
         lv_obj_center(btn_label);
     }
     
@@ -155,7 +155,7 @@ lv_obj_t* ui_controls_create(lv_obj_t* parent, int y_offset) {
     lv_obj_t* function_label = lv_label_create(controls_container);
     lv_label_set_text(function_label, "功能发送 (FUNCTION)");
     lv_obj_set_style_text_color(function_label, UI_COLOR_TEXT_SECONDARY, 0);
-    lv_obj_set_style_text_font(function_label, &lv_font_montserrat_12, 0);
+    lv_obj_set_style_text_font(function_label, UI_FONT_NORMAL, 0);
     lv_obj_set_style_pad_bottom(function_label, UI_GAP_SMALL, 0);
     lv_obj_set_style_pad_top(function_label, UI_GAP_MEDIUM, 0);
     
@@ -166,7 +166,7 @@ lv_obj_t* ui_controls_create(lv_obj_t* parent, int y_offset) {
     lv_obj_set_style_bg_color(category_dropdown, UI_COLOR_BG_INPUT, 0);
     lv_obj_set_style_border_color(category_dropdown, UI_COLOR_BORDER_LIGHT, 0);
     lv_obj_set_style_text_color(category_dropdown, UI_COLOR_TEXT_PRIMARY, 0);
-    lv_obj_set_style_text_font(category_dropdown, &lv_font_montserrat_12, 0);
+    lv_obj_set_style_text_font(category_dropdown, UI_FONT_NORMAL, 0);
     lv_obj_set_style_pad_ver(category_dropdown, 6, 0);
     lv_obj_add_event_cb(category_dropdown, category_dd_cb, LV_EVENT_VALUE_CHANGED, NULL);
     
@@ -177,7 +177,7 @@ lv_obj_t* ui_controls_create(lv_obj_t* parent, int y_offset) {
     lv_obj_set_style_bg_color(function_dropdown, UI_COLOR_BG_INPUT, 0);
     lv_obj_set_style_border_color(function_dropdown, UI_COLOR_BORDER_LIGHT, 0);
     lv_obj_set_style_text_color(function_dropdown, UI_COLOR_TEXT_PRIMARY, 0);
-    lv_obj_set_style_text_font(function_dropdown, &lv_font_montserrat_12, 0);
+    lv_obj_set_style_text_font(function_dropdown, UI_FONT_NORMAL, 0);
     lv_obj_set_style_pad_ver(function_dropdown, 6, 0);
     lv_obj_set_style_pad_top(function_dropdown, UI_GAP_MEDIUM, 0);
     lv_obj_add_event_cb(function_dropdown, function_dd_cb, LV_EVENT_VALUE_CHANGED, NULL);
@@ -196,7 +196,7 @@ lv_obj_t* ui_controls_create(lv_obj_t* parent, int y_offset) {
     lv_obj_t* manual_label = lv_label_create(manual_btn);
     lv_label_set_text(manual_label, "手动输入");
     lv_obj_set_style_text_color(manual_label, UI_COLOR_TEXT_PRIMARY, 0);
-    lv_obj_set_style_text_font(manual_label, &lv_font_montserrat_12, 0);
+    lv_obj_set_style_text_font(manual_label, UI_FONT_NORMAL, 0);
     lv_obj_center(manual_label);
     
     return controls_container;
@@ -0,0 +1,259 @@
+/**
+ * @file ui_debug_overlay.c
+ * @brief Debug Overlay Component Implementation
+ *
+ * Semi-transparent panel on the top layer showing render load (FPS, render
+ * and flush time, LVGL CPU use, heap), backend queue depths, allocator pool
+ * fill and the latency trace histograms. Toggled by a long-press on the
+ * header title; sampled by a 1 Hz LVGL timer that only exists while the
+ * overlay is visible. Built on the first toggle, and deleted on hide with
+ * UI_LAZY_DESTROY_ON_HIDE.
+ */
+
+#include "lvgl.h"
+#include "ui_config.h"
+#include "ui_main.h"
+#include "can_port.h"
+#include "can_trace.h"
+#include "can_pool.h"
+#include "ui_mem.h"
+#include <stdio.h>
+
+#define DEBUG_OVERLAY_PERIOD_MS   1000
+#define DEBUG_OVERLAY_MAX_QUEUES  12     // Depths and peaks together
+#define DEBUG_OVERLAY_PER_LINE    4
+
+typedef struct {
+    const char* name;
+    ui_debug_queue_depth_cb_t depth_cb;
+    void* user_data;
+    bool peak;                  // Peak / high-water value, not a current depth
+} overlay_queue_t;
+
+static lv_obj_t* overlay_container = NULL;
+static lv_obj_t* perf_label = NULL;
+static lv_obj_t* trace_label = NULL;
+static lv_timer_t* refresh_timer = NULL;
+static lv_display_t* hooked_display = NULL;
+
+static overlay_queue_t queues[DEBUG_OVERLAY_MAX_QUEUES];
+static uint8_t queue_count = 0;
+
+// Render statistics accumulated between samples
+static uint32_t frame_count = 0;
+static uint64_t refr_start_us = 0;
+static uint64_t render_sum_us = 0;
+static uint32_t render_max_us = 0;
+static uint64_t flush_start_us = 0;
+static uint64_t flush_sum_us = 0;
+static uint64_t sample_start_us = 0;
+
+// Display refresh event callback
+static void refr_event_cb(lv_event_t* e) {
+    lv_event_code_t code = lv_event_get_code(e);
+
+    if (code == LV_EVENT_REFR_START) {
+        refr_start_us = can_port_time_us();
+    } else if (code == LV_EVENT_REFR_READY && refr_start_us != 0) {
+        uint32_t render_us = (uint32_t)(can_port_time_us() - refr_start_us);
+        render_sum_us += render_us;
+        if (render_us > render_max_us) {
+            render_max_us = render_us;
+        }
+        frame_count++;
+    }
+}
+
+// Append the depth ("q:") or peak ("pk:") entries, DEBUG_OVERLAY_PER_LINE per line
+static int format_queues(char* text, int len, size_t size, bool peak) {
+    uint8_t shown = 0;
+
+    for (uint8_t i = 0; i < queue_count && len > 0 && (size_t)len < size; i++) {
+        if (queues[i].peak != peak) {
+            continue;
+        }
+        const char* sep = (shown == 0) ? (peak ? "pk: " : "q: ")
+                        : (shown % DEBUG_OVERLAY_PER_LINE == 0) ? "\n    " : "  ";
+        len += snprintf(text + len, size - len, "%s%s %u", sep, queues[i].name,
+                        (unsigned)queues[i].depth_cb(queues[i].user_data));
+        shown++;
+    }
+    if (shown > 0 && len > 0 && (size_t)len < size) {
+        len += snprintf(text + len, size - len, "\n");
+    }
+    return len;
+}
+
+// Periodic refresh callback
+static void overlay_refresh_cb(lv_timer_t* timer) {
+    static char text[512];
+    uint64_t now = can_port_time_us();
+    uint32_t elapsed_us = (uint32_t)(now - sample_start_us);
+
+    if (elapsed_us == 0) {
+        elapsed_us = 1;
+    }
+
+    lv_mem_monitor_t mon;
+    lv_mem_monitor(&mon);
+
+    uint32_t fps_x10 = (uint32_t)((uint64_t)frame_count * 10000000ull / elapsed_us);
+    uint32_t render_avg_us = frame_count ? (uint32_t)(render_sum_us / frame_count) : 0;
+    uint32_t flush_avg_us = frame_count ? (uint32_t)(flush_sum_us / frame_count) : 0;
+
+    int len = snprintf(text, sizeof(text),
+                       "FPS %u.%u  CPU %u%%\n"
+                       "render %u.%02u ms (max %u.%02u)\n"
+                       "flush %u.%02u ms\n"
+                       "heap %u%% used, %u%% frag\n",
+                       (unsigned)(fps_x10 / 10), (unsigned)(fps_x10 % 10),
+                       (unsigned)(100 - lv_timer_get_idle()),
+                       (unsigned)(render_avg_us / 1000), (unsigned)((render_avg_us % 1000) / 10),
+                       (unsigned)(render_max_us / 1000), (unsigned)((render_max_us % 1000) / 10),
+                       (unsigned)(flush_avg_us / 1000), (unsigned)((flush_avg_us % 1000) / 10),
+                       (unsigned)mon.used_pct, (unsigned)mon.frag_pct);
+
+    len = format_queues(text, len, sizeof(text), false);
+    len = format_queues(text, len, sizeof(text), true);
+
+    // Pool fill and heap fallbacks since boot finished
+    ui_mem_stats_t mem;
+    ui_mem_get_stats(&mem);
+    if (len > 0 && (size_t)len < sizeof(text)) {
+        len += snprintf(text + len, sizeof(text) - len, "heap fallback %lu live %lu\n",
+                        (unsigned long)mem.heap_allocs_ready, (unsigned long)mem.heap_live);
+    }
+    if (len > 0 && (size_t)len < sizeof(text)) {
+        can_pool_format(text + len, sizeof(text) - len);
+    }
+    lv_label_set_text(perf_label, text);
+
+#if CAN_TRACE_ENABLE
+    can_trace_format(text, sizeof(text));
+    lv_label_set_text(trace_label, text);
+#endif
+
+    // Start next sample window
+    frame_count = 0;
+    render_sum_us = 0;
+    render_max_us = 0;
+    flush_sum_us = 0;
+    sample_start_us = now;
+}
+
+lv_obj_t* ui_debug_overlay_create(void) {
+    if (overlay_container != NULL) {
+        return overlay_container;
+    }
+
+    // Create container on the top layer so it floats above the screen
+    overlay_container = lv_obj_create(lv_layer_top());
+    lv_obj_set_size(overlay_container, UI_SCREEN_WIDTH, LV_SIZE_CONTENT);
+    lv_obj_align(overlay_container, LV_ALIGN_TOP_MID, 0, UI_HEADER_HEIGHT);
+    lv_obj_set_style_bg_color(overlay_container, UI_COLOR_BLACK, 0);
+    lv_obj_set_style_bg_opa(overlay_container, LV_OPA_80, 0);
+    lv_obj_set_style_border_width(overlay_container, 0, 0);
+    lv_obj_set_style_radius(overlay_container, 0, 0);
+    lv_obj_set_style_pad_all(overlay_container, UI_PADDING_SMALL, 0);
+    lv_obj_set_style_pad_row(overlay_container, UI_GAP_SMALL, 0);
+    lv_obj_set_flex_flow(overlay_container, LV_FLEX_FLOW_COLUMN);
+    lv_obj_clear_flag(overlay_container, LV_OBJ_FLAG_SCROLLABLE);
+    lv_obj_clear_flag(overlay_container, LV_OBJ_FLAG_CLICKABLE);
+    lv_obj_add_flag(overlay_container, LV_OBJ_FLAG_HIDDEN);
+
+    // Render load, heap and queue depths
+    perf_label = lv_label_create(overlay_container);
+    lv_label_set_text(perf_label, "");
+    lv_obj_set_style_text_color(perf_label, UI_COLOR_CYAN_400, 0);
+    lv_obj_set_style_text_font(perf_label, UI_FONT_SMALL, 0);
+
+    // Trace histogram summary
+    trace_label = lv_label_create(overlay_container);
+#if CAN_TRACE_ENABLE
+    lv_label_set_text(trace_label, "");
+#else
+    lv_label_set_text(trace_label, "trace disabled (CAN_TRACE_ENABLE=0)");
+#endif
+    lv_obj_set_style_text_color(trace_label, UI_COLOR_GREEN_400, 0);
+    lv_obj_set_style_text_font(trace_label, UI_FONT_SMALL, 0);
+
+    return overlay_container;
+}
+
+void ui_debug_overlay_set_visible(bool visible) {
+    if (overlay_container == NULL) {
+        ui_debug_overlay_create();
+    }
+
+    if (visible) {
+        lv_obj_clear_flag(overlay_container, LV_OBJ_FLAG_HIDDEN);
+        if (refresh_timer == NULL) {
+            hooked_display = lv_display_get_default();
+            if (hooked_display != NULL) {
+                lv_display_add_event_cb(hooked_display, refr_event_cb, LV_EVENT_REFR_START, NULL);
+                lv_display_add_event_cb(hooked_display, refr_event_cb, LV_EVENT_REFR_READY, NULL);
+            }
+            refresh_timer = lv_timer_create(overlay_refresh_cb, DEBUG_OVERLAY_PERIOD_MS, NULL);
+            frame_count = 0;
+            render_sum_us = 0;
+            render_max_us = 0;
+            flush_sum_us = 0;
+            sample_start_us = can_port_time_us();
+        }
+    } else {
+        lv_obj_add_flag(overlay_container, LV_OBJ_FLAG_HIDDEN);
+        if (refresh_timer != NULL) {
+            lv_timer_delete(refresh_timer);
+            refresh_timer = NULL;
+        }
+        if (hooked_display != NULL) {
+            lv_display_remove_event_cb_with_user_data(hooked_display, refr_event_cb, NULL);
+            hooked_display = NULL;
+        }
+        if (UI_LAZY_DESTROY_ON_HIDE) {
+            lv_obj_delete(overlay_container);
+            overlay_container = NULL;
+            perf_label = NULL;
+            trace_label = NULL;
+        }
+    }
+}
+
+bool ui_debug_overlay_is_visible(void) {
+    return overlay_container != NULL && !lv_obj_has_flag(overlay_container, LV_OBJ_FLAG_HIDDEN);
+}
+
+void ui_debug_overlay_toggle(void) {
+    ui_debug_overlay_set_visible(!ui_debug_overlay_is_visible());
+}
+
+static bool add_queue(const char* name, ui_debug_queue_depth_cb_t depth_cb, void* user_data, bool peak) {
+    if (name == NULL || depth_cb == NULL || queue_count >= DEBUG_OVERLAY_MAX_QUEUES) {
+        return false;
+    }
+    queues[queue_count].name = name;
+    queues[queue_count].depth_cb = depth_cb;
+    queues[queue_count].user_data = user_data;
+    queues[queue_count].peak = peak;
+    queue_count++;
+    return true;
+}
+
+bool ui_debug_overlay_add_queue(const char* name, ui_debug_queue_depth_cb_t depth_cb, void* user_data) {
+    return add_queue(name, depth_cb, user_data, false);
+}
+
+bool ui_debug_overlay_add_peak(const char* name, ui_debug_queue_depth_cb_t depth_cb, void* user_data) {
+    return add_queue(name, depth_cb, user_data, true);
+}
+
+void ui_debug_overlay_flush_begin(void) {
+    flush_start_us = can_port_time_us();
+}
+
+void ui_debug_overlay_flush_end(void) {
+    if (flush_start_us != 0) {
+        flush_sum_us += can_port_time_us() - flush_start_us;
+        flush_start_us = 0;
+    }
+}
@@ -0,0 +1,181 @@
+/**
+ * @file ui_display.c
+ * @brief Double-Buffered Partial Flush Pipeline Implementation
+ *
+ * LVGL swaps the two buffers itself: after flush_cb returns it renders the
+ * next area into the other buffer and only waits (flush_wait_cb) before it
+ * needs the one still being sent.
+ */
+
+#include "lvgl.h"
+#include "ui_config.h"
+#include "ui_display.h"
+#include "ui_main.h"
+#include "can_port.h"
+#include <string.h>
+
+#ifdef ESP_PLATFORM
+#include "esp_attr.h"
+#define UI_DISPLAY_BUF_ATTR     DMA_ATTR
+#else
+#define UI_DISPLAY_BUF_ATTR
+#endif
+
+#define UI_DISPLAY_BUF_PX       (UI_SCREEN_WIDTH * UI_DISPLAY_BUF_LINES)
+#define UI_DISPLAY_MAX_BANDS    8   // Full-row bands tracked per frame
+#define UI_DISPLAY_WAIT_POLL_MS 20  // Re-check in case a completion is missed
+
+static uint16_t buf_a[UI_DISPLAY_BUF_PX] UI_DISPLAY_BUF_ATTR __attribute__((aligned(LV_DRAW_BUF_ALIGN)));
+static uint16_t buf_b[UI_DISPLAY_BUF_PX] UI_DISPLAY_BUF_ATTR __attribute__((aligned(LV_DRAW_BUF_ALIGN)));
+
+static lv_display_t* g_disp = NULL;
+static ui_display_config_t g_config;
+static ui_display_stats_t g_stats;
+static can_port_sem_t* g_flush_sem = NULL;
+static volatile bool g_busy = false;    // A buffer is being sent
+static uint32_t g_frame_areas = 0;      // g_stats.areas at REFR_START
+
+static lv_area_t bands[UI_DISPLAY_MAX_BANDS];
+static uint8_t band_count = 0;
+
+// ==================== Dirty Areas ====================
+
+static bool band_is_near(const lv_area_t* a, const lv_area_t* band) {
+    return a->y1 <= band->y2 + UI_DISPLAY_MERGE_GAP && band->y1 <= a->y2 + UI_DISPLAY_MERGE_GAP;
+}
+
+// LV_EVENT_INVALIDATE_AREA: runs before LVGL stores the area, which it may
+// change. A band grown over an earlier one makes LVGL join the two.
+static void invalidate_cb(lv_event_t* e) {
+    lv_area_t* area = (lv_area_t*)lv_event_get_param(e);
+    int32_t hor_res = lv_display_get_horizontal_resolution(g_disp);
+
+    if (lv_area_get_width(area) < UI_DISPLAY_WIDEN_MIN_W) {
+        return;
+    }
+    if (lv_area_get_width(area) < hor_res) {
+        area->x1 = 0;
+        area->x2 = hor_res - 1;
+        g_stats.widened++;
+    }
+
+    // Absorb nearby bands; a grown band can reach another one
+    bool grew = true;
+    while (grew) {
+        grew = false;
+        for (uint8_t i = 0; i < band_count; ) {
+            if (!band_is_near(area, &bands[i])) {
+                i++;
+                continue;
+            }
+            if (bands[i].y1 < area->y1 || bands[i].y2 > area->y2) {
+                area->y1 = LV_MIN(area->y1, bands[i].y1);
+                area->y2 = LV_MAX(area->y2, bands[i].y2);
+                grew = true;
+            }
+            g_stats.merged++;
+            bands[i] = bands[--band_count];
+        }
+    }
+
+    if (band_count < UI_DISPLAY_MAX_BANDS) {
+        bands[band_count++] = *area;
+    }
+}
+
+static void refr_cb(lv_event_t* e) {
+    if (lv_event_get_code(e) == LV_EVENT_REFR_START) {
+        g_frame_areas = g_stats.areas;
+    } else {
+        if (g_stats.areas != g_frame_areas) {
+            g_stats.frames++;
+        }
+        band_count = 0;     // The invalid areas of this frame are drawn
+    }
+}
+
+// ==================== Flush ====================
+
+// May run in the transfer-complete ISR
+static void transfer_finished(void) {
+#if UI_DEBUG_OVERLAY_ENABLE
+    ui_debug_overlay_flush_end();
+#endif
+    g_busy = false;
+    lv_display_flush_ready(g_disp);
+}
+
+static void flush_cb(lv_display_t* disp, const lv_area_t* area, uint8_t* px_map) {
+    uint32_t px = lv_area_get_size(area);
+    size_t bytes = (size_t)px * sizeof(uint16_t);
+
+#if UI_DEBUG_OVERLAY_ENABLE
+    ui_debug_overlay_flush_begin();     // Byte swap and transfer count as flush time
+#endif
+    if (g_config.swap_bytes) {
+        lv_draw_sw_rgb565_swap(px_map, px);
+    }
+    g_stats.areas++;
+    g_stats.bytes += bytes;
+
+    g_busy = true;
+    if (!g_config.transfer(area, px_map, bytes, g_config.user_data)) {
+        transfer_finished();
+    }
+}
+
+// Called by LVGL when it needs the buffer still being sent
+static void flush_wait_cb(lv_display_t* disp) {
+    uint64_t start = can_port_time_us();
+
+    while (g_busy) {
+        if (g_flush_sem != NULL) {
+            can_port_sem_take(g_flush_sem, UI_DISPLAY_WAIT_POLL_MS);
+        }
+    }
+    g_stats.wait_us += (uint32_t)(can_port_time_us() - start);
+}
+
+// ==================== API ====================
+
+lv_display_t* ui_display_create(const ui_display_config_t* config) {
+    if (config == NULL || config->transfer == NULL) {
+        return NULL;
+    }
+    if (g_flush_sem == NULL) {
+        g_flush_sem = can_port_sem_create();
+    }
+
+    g_config = *config;
+    g_busy = false;
+    band_count = 0;
+    memset(&g_stats, 0, sizeof(g_stats));
+
+    g_disp = lv_display_create(UI_SCREEN_WIDTH, UI_SCREEN_HEIGHT);
+    if (g_disp == NULL) {
+        return NULL;
+    }
+    lv_display_set_color_format(g_disp, LV_COLOR_FORMAT_RGB565);
+    lv_display_set_buffers(g_disp, buf_a, buf_b, sizeof(buf_a), LV_DISPLAY_RENDER_MODE_PARTIAL);
+    lv_display_set_flush_cb(g_disp, flush_cb);
+    lv_display_set_flush_wait_cb(g_disp, flush_wait_cb);
+    lv_display_add_event_cb(g_disp, invalidate_cb, LV_EVENT_INVALIDATE_AREA, NULL);
+    lv_display_add_event_cb(g_disp, refr_cb, LV_EVENT_REFR_START, NULL);
+    lv_display_add_event_cb(g_disp, refr_cb, LV_EVENT_REFR_READY, NULL);
+    return g_disp;
+}
+
+void ui_display_transfer_done(void) {
+    transfer_finished();
+    if (g_flush_sem != NULL) {
+        can_port_sem_give_from_isr(g_flush_sem);
+    }
+}
+
+void ui_display_get_stats(ui_display_stats_t* stats) {
+    *stats = g_stats;
+}
+
+void ui_display_reset_stats(void) {
+    memset(&g_stats, 0, sizeof(g_stats));
+}
@@ -0,0 +1,92 @@
+/**
+ * @file ui_display.h
+ * @brief Double-Buffered Partial Flush Pipeline
+ *
+ * Reference display setup for the 172x640 panel. LVGL renders into two
+ * partial buffers of UI_DISPLAY_BUF_LINES rows: while the panel driver
+ * sends one to the panel (DMA), LVGL renders the next area into the other.
+ * The driver only provides a transfer function that starts the DMA, and
+ * calls ui_display_transfer_done() from its completion callback. When both
+ * buffers are busy the UI task blocks on a semaphore instead of spinning.
+ *
+ * Invalidated areas are adjusted for the tall narrow panel before LVGL
+ * joins them:
+ * - An area at least UI_DISPLAY_WIDEN_MIN_W wide is widened to full rows.
+ *   A full-row window costs few extra pixels and is one contiguous transfer.
+ * - Full-row bands less than UI_DISPLAY_MERGE_GAP rows apart are merged, so
+ *   nearby updates go out as one window instead of one transfer (command
+ *   plus DMA setup) each.
+ */
+
+#ifndef UI_DISPLAY_H
+#define UI_DISPLAY_H
+
+#include "lvgl.h"
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Start sending one rendered area to the panel
+ * @param area Area on the screen (inclusive coordinates)
+ * @param px Pixels, RGB565, row by row
+ * @param bytes Size of px
+ * @param user_data From ui_display_config_t
+ * @return true if the transfer runs asynchronously and the driver will call
+ *         ui_display_transfer_done(); false if it already finished
+ */
+typedef bool (*ui_display_transfer_t)(const lv_area_t* area, const uint8_t* px, size_t bytes, void* user_data);
+
+/**
+ * @brief Display configuration
+ */
+typedef struct {
+    ui_display_transfer_t transfer;
+    void* user_data;
+    bool swap_bytes;        // Big-endian RGB565 (most SPI panels)
+} ui_display_config_t;
+
+/**
+ * @brief Flush counters since ui_display_create or ui_display_reset_stats
+ */
+typedef struct {
+    uint32_t frames;        // Refreshes that flushed at least one area
+    uint32_t areas;         // Transfers
+    uint64_t bytes;         // Bytes sent to the panel
+    uint32_t widened;       // Areas widened to full rows
+    uint32_t merged;        // Bands merged with a nearby band
+    uint32_t wait_us;       // Time LVGL waited for a free buffer
+} ui_display_stats_t;
+
+/**
+ * @brief Create the LVGL display with the double-buffered flush pipeline
+ * @param config Configuration (copied)
+ * @return Display, or NULL on failure
+ */
+lv_display_t* ui_display_create(const ui_display_config_t* config);
+
+/**
+ * @brief Report the end of an asynchronous transfer (from the DMA completion ISR)
+ */
+void ui_display_transfer_done(void);
+
+/**
+ * @brief Read the flush counters
+ * @param stats Output
+ */
+void ui_display_get_stats(ui_display_stats_t* stats);
+
+/**
+ * @brief Reset the flush counters
+ */
+void ui_display_reset_stats(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // UI_DISPLAY_H
@@ -9,6 +9,9 @@
 #include "ui_config.h"
 #include "ui_state.h"
 #include "ui_binding.h"
+#include "ui_main.h"
+#include "ui_layout.h"
+#include "can_trace.h"
 
 static lv_obj_t* footer_container = NULL;
 static lv_obj_t* status_indicator = NULL;
@@ -20,52 +23,74 @@ static lv_obj_t* transmit_btn = NULL;
 static void stop_btn_cb(lv_event_t* e) {
     ui_binding_trigger_stop();
     ui_state_set_transmission(false, false);
-    ui_footer_update_status(false, false);
 }
 
 // TRANSMIT button callback
 static void transmit_btn_cb(lv_event_t* e) {
-    ui_state_t* state = ui_state_get();
+    CAN_TRACE_MARK(CAN_TRACE_TAP);
     
-    if (!state->is_connected) {
+    ui_state_t state;
+    ui_state_snapshot(&state);
+    
+    if (!state.is_connected) {
         return; // Can't transmit if not connected
     }
+    if (state.view_mode == VIEW_MODE_MANUAL && !state.channel_connected[state.manual_channel]) {
+        return; // Manual frames go to one channel, which must be up
+    }
     
-    if (state->view_mode == VIEW_MODE_AUTO) {
+    if (state.view_mode == VIEW_MODE_AUTO) {
         // Auto mode
         uint32_t interval = 0;
         bool is_repeating = ui_config_is_repeating_function(
-            state->selected_category, 
-            state->selected_function, 
+            state.selected_category, 
+            state.selected_function, 
             &interval
         );
         
         ui_binding_trigger_transmit_auto(
-            state->selected_scene,
-            state->selected_category,
-            state->selected_function,
+            state.selected_scene,
+            state.selected_category,
+            state.selected_function,
             is_repeating,
             interval
         );
         
         ui_state_set_transmission(true, is_repeating);
-        ui_footer_update_status(true, is_repeating);
         
     } else {
         // Manual mode
-        if (state->manual_id[0] == '\0' || state->manual_data[0] == '\0') {
+        if (state.manual_id[0] == '\0' || state.manual_data[0] == '\0') {
             return; // Need both ID and data
         }
         
         ui_binding_trigger_transmit_manual(
-            state->manual_id,
-            state->manual_data,
-            state->manual_repeat,
-            state->manual_interval
+            state.manual_channel,
+            state.manual_id,
+            state.manual_data,
+            state.manual_repeat,
+            state.manual_interval
         );
         
-        ui_state_set_transmission(true, state->manual_repeat);
-        ui_footer_update_status(true, state->manual_repeat);
+        ui_state_set_transmission(true, state.manual_repeat);
+    }
+}
+
+// State listener: status text and button enables follow transmission/connection
+static void footer_state_listener(uint32_t changed, const ui_state_t* state, void* user_data) {
+    ui_footer_update_status(state->is_transmitting, state->is_repeating);
+    
+    // Running scene sequence: show "IGP 3/7" instead of the plain status
+    if (state->seq_total > 0 && state->is_transmitting) {
+        uint16_t shown = (state->seq_step < state->seq_total) ? state->seq_step + 1 : state->seq_total;
+        lv_label_set_text_fmt(status_label, "%s %u/%u", state->seq_name,
+                              (unsigned)shown, (unsigned)state->seq_total);
+    }
+    
+    // A TX queue backed up on any channel: amber indicator until it drains
+    if (state->tx_congested) {
+        lv_obj_set_style_bg_color(status_indicator, UI_COLOR_AMBER_400, 0);
+        lv_obj_set_style_text_color(status_label, UI_COLOR_AMBER_400, 0);
     }
 }
 
@@ -105,7 +130,7 @@ lv_obj_t* ui_footer_create(lv_obj_t* parent) {
     
     // Status indicator (circle)
     status_indicator = lv_obj_create(status_left);
-    lv_obj_set_size(status_indicator, 12, 12);
+    lv_obj_set_size(status_indicator, UI_LAYOUT_INDICATOR_SIZE, UI_LAYOUT_INDICATOR_SIZE);
     lv_obj_set_style_radius(status_indicator, LV_RADIUS_CIRCLE, 0);
     lv_obj_set_style_bg_color(status_indicator, UI_COLOR_TEXT_DISABLED, 0);
     lv_obj_set_style_border_width(status_indicator, 0, 0);
@@ -113,11 +138,12 @@ lv_obj_t* ui_footer_create(lv_obj_t* parent) {
     status_label = lv_label_create(status_left);
     lv_label_set_text(status_label, "就绪");
     lv_obj_set_style_text_color(status_label, UI_COLOR_TEXT_SECONDARY, 0);
-    lv_obj_set_style_text_font(status_label, &lv_font_montserrat_12, 0);
+    lv_obj_set_style_text_font(status_label, UI_FONT_NORMAL, 0);
+    ui_layout_fix_label(status_label, UI_LAYOUT_STATUS_LABEL_W);
     
     // STOP button
     stop_btn = lv_btn_create(status_row);
-    lv_obj_set_size(stop_btn, 60, 28);
+    lv_obj_set_size(stop_btn, UI_LAYOUT_STOP_BTN_W, UI_LAYOUT_STOP_BTN_H);
     lv_obj_set_style_bg_color(stop_btn, UI_COLOR_DISABLED_BG, 0);
     lv_obj_set_style_border_width(stop_btn, 0, 0);
     lv_obj_set_style_radius(stop_btn, UI_RADIUS_SMALL, 0);
@@ -127,7 +153,7 @@ lv_obj_t* ui_footer_create(lv_obj_t* parent) {
     lv_obj_t* stop_label = lv_label_create(stop_btn);
     lv_label_set_text(stop_label, LV_SYMBOL_STOP " STOP");
     lv_obj_set_style_text_color(stop_label, UI_COLOR_TEXT_MUTED, 0);
-    lv_obj_set_style_text_font(stop_label, &lv_font_montserrat_12, 0);
+    lv_obj_set_style_text_font(stop_label, UI_FONT_NORMAL, 0);
     lv_obj_center(stop_label);
     
     // TRANSMIT button
@@ -143,9 +169,12 @@ lv_obj_t* ui_footer_create(lv_obj_t* parent) {
     lv_obj_t* transmit_label = lv_label_create(transmit_btn);
     lv_label_set_text(transmit_label, LV_SYMBOL_UPLOAD " TRANSMIT");
     lv_obj_set_style_text_color(transmit_label, UI_COLOR_WHITE, 0);
-    lv_obj_set_style_text_font(transmit_label, &lv_font_montserrat_12, 0);
+    lv_obj_set_style_text_font(transmit_label, UI_FONT_NORMAL, 0);
     lv_obj_center(transmit_label);
     
+    ui_state_subscribe(UI_STATE_F_TRANSMISSION | UI_STATE_F_CONNECTED | UI_STATE_F_SEQUENCE |
+                       UI_STATE_F_TX_CONGESTION, footer_state_listener, NULL);
+    
     return footer_container;
 }
 
@@ -196,8 +225,9 @@ void ui_footer_update_status(bool transmitting, bool repeating) {
         lv_obj_set_style_bg_color(stop_btn, UI_COLOR_DISABLED_BG, 0);
         lv_obj_set_style_text_color(lv_obj_get_child(stop_btn, 0), UI_COLOR_TEXT_MUTED, 0);
         
-        ui_state_t* state = ui_state_get();
-        if (state->is_connected) {
+        ui_state_t state;
+        ui_state_snapshot(&state);
+        if (state.is_connected) {
             lv_obj_clear_state(transmit_btn, LV_STATE_DISABLED);
             lv_obj_set_style_bg_color(transmit_btn, UI_COLOR_CYAN_600, 0);
             lv_obj_set_style_text_color(lv_obj_get_child(transmit_btn, 0), UI_COLOR_WHITE, 0);
@@ -210,8 +240,9 @@ void ui_footer_update_status(bool transmitting, bool repeating) {
 }
 
 void ui_footer_update_connection(bool connected) {
-    ui_state_t* state = ui_state_get();
-    if (!state->is_transmitting && !state->is_repeating) {
+    ui_state_t state;
+    ui_state_snapshot(&state);
+    if (!state.is_transmitting && !state.is_repeating) {
         ui_footer_update_status(false, false);
     }
 }
@@ -2,26 +2,80 @@
  * @file ui_header.c
  * @brief Header Component Implementation
  * 
- * Header with "CAN BUS TX" label, radio icon, and connection toggle switch
+ * Header with "CAN BUS TX" label, radio icon, and one connection toggle
+ * switch per CAN channel. A badge left of the channel name shows the bus
+ * health while it is not error-active (warning, passive, bus-off, recovery).
  */
 
 #include "lvgl.h"
 #include "ui_config.h"
 #include "ui_state.h"
 #include "ui_binding.h"
+#include "ui_main.h"
+#include "ui_layout.h"
 
 static lv_obj_t* header_container = NULL;
-static lv_obj_t* conn_switch = NULL;
+static lv_obj_t* conn_switch[UI_CHANNEL_COUNT] = {NULL};
+static lv_obj_t* bus_badge[UI_CHANNEL_COUNT] = {NULL};
 
-// Switch event callback
+// Switch event callback (user data = channel index)
 static void switch_event_cb(lv_event_t* e) {
     lv_obj_t* sw = lv_event_get_target(e);
+    uint8_t channel = (uint8_t)(uintptr_t)lv_event_get_user_data(e);
     bool is_checked = lv_obj_has_state(sw, LV_STATE_CHECKED);
     
     // Trigger binding event
-    ui_binding_trigger_connection_changed(is_checked);
+    ui_binding_trigger_connection_changed(channel, is_checked);
 }
 
+// Bus health badge of one channel (hidden while error-active or disconnected)
+static void update_bus_badge(uint8_t channel, const ui_state_t* state) {
+    lv_obj_t* badge = bus_badge[channel];
+    ui_bus_state_t bus = state->bus_state[channel];
+    
+    if (!state->channel_connected[channel] || bus == UI_BUS_OK) {
+        lv_obj_add_flag(badge, LV_OBJ_FLAG_HIDDEN);
+        return;
+    }
+    
+    switch (bus) {
+        case UI_BUS_WARNING:
+            lv_label_set_text_fmt(badge, "WARN %u", (unsigned)state->bus_tec[channel]);
+            lv_obj_set_style_text_color(badge, UI_COLOR_AMBER_400, 0);
+            break;
+        case UI_BUS_PASSIVE:
+            lv_label_set_text_fmt(badge, "PASSIVE %u", (unsigned)state->bus_tec[channel]);
+            lv_obj_set_style_text_color(badge, UI_COLOR_AMBER_400, 0);
+            break;
+        case UI_BUS_OFF:
+            lv_label_set_text(badge, "BUS OFF");
+            lv_obj_set_style_text_color(badge, UI_COLOR_RED_500, 0);
+            break;
+        default:
+            lv_label_set_text(badge, "RECOVER");
+            lv_obj_set_style_text_color(badge, UI_COLOR_RED_500, 0);
+            break;
+    }
+    lv_obj_clear_flag(badge, LV_OBJ_FLAG_HIDDEN);
+}
+
+// State listener: keep the switches and bus badges in sync
+static void header_state_listener(uint32_t changed, const ui_state_t* state, void* user_data) {
+    for (uint8_t i = 0; i < UI_CHANNEL_COUNT; i++) {
+        if (changed & UI_STATE_F_CONNECTED) {
+            ui_header_update_connection(i, state->channel_connected[i]);
+        }
+        update_bus_badge(i, state);
+    }
+}
+
+#if UI_DEBUG_OVERLAY_ENABLE
+// Title long-press callback (toggles the performance overlay)
+static void title_long_press_cb(lv_event_t* e) {
+    ui_debug_overlay_toggle();
+}
+#endif
+
 lv_obj_t* ui_header_create(lv_obj_t* parent) {
     // Create header container
     header_container = lv_obj_create(parent);
@@ -34,7 +88,8 @@ lv_obj_t* ui_header_create(lv_obj_t* parent) {
     lv_obj_set_style_border_color(header_container, UI_COLOR_BORDER_LIGHT, 0);
     lv_obj_set_style_border_side(header_container, LV_BORDER_SIDE_BOTTOM, 0);
     lv_obj_set_style_radius(header_container, 0, 0);
-    lv_obj_set_style_pad_all(header_container, UI_PADDING_LARGE, 0);
+    lv_obj_set_style_pad_hor(header_container, UI_PADDING_MEDIUM, 0);
+    lv_obj_set_style_pad_ver(header_container, UI_PADDING_SMALL, 0);
     lv_obj_clear_flag(header_container, LV_OBJ_FLAG_SCROLLABLE);
     
     // Create flex layout for header content
@@ -63,24 +118,74 @@ lv_obj_t* ui_header_create(lv_obj_t* parent) {
     lv_obj_t* label = lv_label_create(left_container);
     lv_label_set_text(label, "CAN BUS TX");
     lv_obj_set_style_text_color(label, UI_COLOR_CYAN_400, 0);
-    lv_obj_set_style_text_font(label, &lv_font_montserrat_12, 0);
+    lv_obj_set_style_text_font(label, UI_FONT_NORMAL, 0);
+#if UI_DEBUG_OVERLAY_ENABLE
+    lv_obj_add_flag(label, LV_OBJ_FLAG_CLICKABLE);
+    lv_obj_add_event_cb(label, title_long_press_cb, LV_EVENT_LONG_PRESSED, NULL);
+#endif
+    
+    // Right side: one "NAME [switch]" row per channel
+    lv_obj_t* right_container = lv_obj_create(header_container);
+    lv_obj_set_size(right_container, LV_SIZE_CONTENT, LV_SIZE_CONTENT);
+    lv_obj_set_style_bg_opa(right_container, LV_OPA_TRANSP, 0);
+    lv_obj_set_style_border_width(right_container, 0, 0);
+    lv_obj_set_style_pad_all(right_container, 0, 0);
+    lv_obj_set_style_pad_row(right_container, UI_GAP_SMALL, 0);
+    lv_obj_set_flex_flow(right_container, LV_FLEX_FLOW_COLUMN);
+    lv_obj_set_flex_align(right_container, LV_FLEX_ALIGN_CENTER, LV_FLEX_ALIGN_END, LV_FLEX_ALIGN_END);
+#if UI_LAYOUT_ABSOLUTE
+    lv_obj_add_flag(right_container, LV_OBJ_FLAG_OVERFLOW_VISIBLE);
+#endif
+    
+    for (uint8_t i = 0; i < UI_CHANNEL_COUNT; i++) {
+        lv_obj_t* row = lv_obj_create(right_container);
+        lv_obj_set_size(row, LV_SIZE_CONTENT, LV_SIZE_CONTENT);
+        lv_obj_set_style_bg_opa(row, LV_OPA_TRANSP, 0);
+        lv_obj_set_style_border_width(row, 0, 0);
+        lv_obj_set_style_pad_all(row, 0, 0);
+        lv_obj_set_style_pad_column(row, UI_GAP_SMALL, 0);
+        lv_obj_set_flex_flow(row, LV_FLEX_FLOW_ROW);
+        lv_obj_set_flex_align(row, LV_FLEX_ALIGN_END, LV_FLEX_ALIGN_CENTER, LV_FLEX_ALIGN_CENTER);
+        
+        bus_badge[i] = lv_label_create(row);
+        lv_label_set_text(bus_badge[i], "");
+        lv_obj_set_style_text_font(bus_badge[i], UI_FONT_SMALL, 0);
+        lv_obj_add_flag(bus_badge[i], LV_OBJ_FLAG_HIDDEN);
+#if UI_LAYOUT_ABSOLUTE
+        // Fixed box left of the row, outside the layout: a bus state change
+        // redraws the badge only (it covers the title while shown)
+        lv_obj_add_flag(bus_badge[i], LV_OBJ_FLAG_FLOATING);
+        lv_obj_add_flag(row, LV_OBJ_FLAG_OVERFLOW_VISIBLE);
+        ui_layout_fix_label(bus_badge[i], UI_LAYOUT_BADGE_W);
+        lv_obj_set_style_text_align(bus_badge[i], LV_TEXT_ALIGN_RIGHT, 0);
+        lv_obj_set_style_bg_color(bus_badge[i], UI_COLOR_BG_CONTAINER, 0);
+        lv_obj_set_style_bg_opa(bus_badge[i], LV_OPA_COVER, 0);
+        lv_obj_align(bus_badge[i], LV_ALIGN_LEFT_MID, -(UI_LAYOUT_BADGE_W + UI_GAP_SMALL), 0);
+#endif
+        
+        lv_obj_t* name = lv_label_create(row);
+        lv_label_set_text(name, UI_CHANNELS[i]);
+        lv_obj_set_style_text_color(name, UI_COLOR_TEXT_SECONDARY, 0);
+        lv_obj_set_style_text_font(name, UI_FONT_SMALL, 0);
+        
+        conn_switch[i] = lv_switch_create(row);
+        lv_obj_set_size(conn_switch[i], 28, 16);
+        lv_obj_set_style_bg_color(conn_switch[i], UI_COLOR_DISABLED_BG, 0);
+        lv_obj_set_style_bg_color(conn_switch[i], UI_COLOR_GREEN_500, LV_PART_INDICATOR | LV_STATE_CHECKED);
+        lv_obj_add_event_cb(conn_switch[i], switch_event_cb, LV_EVENT_VALUE_CHANGED, (void*)(uintptr_t)i);
+    }
     
-    // Right side: Connection switch
-    conn_switch = lv_switch_create(header_container);
-    lv_obj_set_size(conn_switch, 36, 20);
-    lv_obj_set_style_bg_color(conn_switch, UI_COLOR_DISABLED_BG, 0);
-    lv_obj_set_style_bg_color(conn_switch, UI_COLOR_GREEN_500, LV_PART_INDICATOR | LV_STATE_CHECKED);
-    lv_obj_add_event_cb(conn_switch, switch_event_cb, LV_EVENT_VALUE_CHANGED, NULL);
+    ui_state_subscribe(UI_STATE_F_CONNECTED | UI_STATE_F_BUS_STATE, header_state_listener, NULL);
     
     return header_container;
 }
 
-void ui_header_update_connection(bool connected) {
-    if (conn_switch != NULL) {
+void ui_header_update_connection(uint8_t channel, bool connected) {
+    if (channel < UI_CHANNEL_COUNT && conn_switch[channel] != NULL) {
         if (connected) {
-            lv_obj_add_state(conn_switch, LV_STATE_CHECKED);
+            lv_obj_add_state(conn_switch[channel], LV_STATE_CHECKED);
         } else {
-            lv_obj_clear_state(conn_switch, LV_STATE_CHECKED);
+            lv_obj_clear_state(conn_switch[channel], LV_STATE_CHECKED);
         }
     }
 }
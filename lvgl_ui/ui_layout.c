@@ -0,0 +1,118 @@
+/**
+ * @file ui_layout.c
+ * @brief Fixed-Geometry Layout Implementation
+ */
+
+#include "lvgl.h"
+#include "ui_config.h"
+#include "ui_layout.h"
+
+#if UI_LAYOUT_ABSOLUTE
+
+// Children placed by their own alignment, not by the parent's layout
+static bool is_self_positioned(const lv_obj_t* obj) {
+    return lv_obj_has_flag(obj, LV_OBJ_FLAG_IGNORE_LAYOUT) || lv_obj_has_flag(obj, LV_OBJ_FLAG_FLOATING);
+}
+
+// A hidden child can be shown later and must push its siblings away
+static bool has_hidden_child(const lv_obj_t* obj) {
+    uint32_t child_count = lv_obj_get_child_count(obj);
+    for (uint32_t i = 0; i < child_count; i++) {
+        lv_obj_t* child = lv_obj_get_child(obj, (int32_t)i);
+        if (!is_self_positioned(child) && lv_obj_has_flag(child, LV_OBJ_FLAG_HIDDEN)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Replace an alignment by the position it currently resolves to. An aligned
+// container is laid out again whenever one of its children changes size.
+static void pin_position(lv_obj_t* obj) {
+    int32_t x = lv_obj_get_x(obj);
+    int32_t y = lv_obj_get_y(obj);
+
+    lv_obj_set_align(obj, LV_ALIGN_DEFAULT);
+    lv_obj_set_pos(obj, x, y);
+}
+
+static void freeze_obj(lv_obj_t* obj) {
+    bool has_layout = lv_obj_get_style_layout(obj, LV_PART_MAIN) != LV_LAYOUT_NONE;
+    bool keep_layout = has_layout && has_hidden_child(obj);
+    uint32_t child_count = lv_obj_get_child_count(obj);
+
+    // Coordinates are read before anything is written; the setters below only
+    // mark the layout dirty, and the next pass reproduces the same geometry
+    for (uint32_t i = 0; i < child_count; i++) {
+        lv_obj_t* child = lv_obj_get_child(obj, (int32_t)i);
+        bool is_label = lv_obj_check_type(child, &lv_label_class);
+        if (is_self_positioned(child)) {
+            continue;
+        }
+        if (has_layout && !keep_layout) {
+            pin_position(child);
+            if (lv_obj_get_style_flex_grow(child, LV_PART_MAIN) > 0) {
+                lv_obj_set_width(child, lv_obj_get_width(child));
+                lv_obj_set_flex_grow(child, 0);
+            }
+            if (!is_label) {
+                lv_obj_set_size(child, lv_obj_get_width(child), lv_obj_get_height(child));
+            }
+        } else if (!has_layout && !is_label &&
+                   lv_obj_get_style_align(child, LV_PART_MAIN) != LV_ALIGN_DEFAULT) {
+            pin_position(child);    // Centered labels stay centered on new text
+        }
+    }
+    if (has_layout && !keep_layout) {
+        lv_obj_set_layout(obj, LV_LAYOUT_NONE);
+    }
+
+    if (!keep_layout && !lv_obj_check_type(obj, &lv_label_class)) {
+        if (lv_obj_get_style_width(obj, LV_PART_MAIN) == LV_SIZE_CONTENT) {
+            lv_obj_set_width(obj, lv_obj_get_width(obj));
+        }
+        if (lv_obj_get_style_height(obj, LV_PART_MAIN) == LV_SIZE_CONTENT) {
+            lv_obj_set_height(obj, lv_obj_get_height(obj));
+        }
+    }
+
+    for (uint32_t i = 0; i < child_count; i++) {
+        freeze_obj(lv_obj_get_child(obj, (int32_t)i));
+    }
+}
+
+void ui_layout_freeze(lv_obj_t* root) {
+    if (root == NULL) {
+        return;
+    }
+    lv_obj_update_layout(root);
+
+    // The root itself: a pinned position under a parent without layout
+    lv_obj_t* parent = lv_obj_get_parent(root);
+    if (parent != NULL && !is_self_positioned(root) &&
+        lv_obj_get_style_layout(parent, LV_PART_MAIN) == LV_LAYOUT_NONE &&
+        lv_obj_get_style_align(root, LV_PART_MAIN) != LV_ALIGN_DEFAULT) {
+        pin_position(root);
+    }
+    freeze_obj(root);
+}
+
+void ui_layout_fix_label(lv_obj_t* label, int32_t width) {
+    const lv_font_t* font = lv_obj_get_style_text_font(label, LV_PART_MAIN);
+
+    lv_label_set_long_mode(label, LV_LABEL_LONG_DOT);
+    lv_obj_set_size(label, width, lv_font_get_line_height(font));
+}
+
+#else
+
+void ui_layout_freeze(lv_obj_t* root) {
+    (void)root;
+}
+
+void ui_layout_fix_label(lv_obj_t* label, int32_t width) {
+    (void)label;
+    (void)width;
+}
+
+#endif // UI_LAYOUT_ABSOLUTE
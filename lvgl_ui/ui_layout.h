@@ -0,0 +1,81 @@
+/**
+ * @file ui_layout.h
+ * @brief Screen Regions and Fixed-Geometry Layout
+ *
+ * The panel is a fixed 172x640 device, so the screen regions (header, log,
+ * content, footer) are computed here from the ui_config.h dimensions instead
+ * of being measured at runtime.
+ *
+ * The components are still written with flex rows/columns and LV_SIZE_CONTENT
+ * because that is the easiest way to describe them. With UI_LAYOUT_ABSOLUTE
+ * the result is resolved once when a view is built and then frozen by
+ * ui_layout_freeze(): every container gets a fixed position and size and its
+ * layout is removed. A label whose text changes then only redraws its own
+ * rectangle; nothing above it is measured again.
+ *
+ * Labels updated at runtime reserve their width with ui_layout_fix_label()
+ * so that a longer text is cut with "..." rather than resizing the label.
+ * A container that has hidden children (rows shown on demand, the log list)
+ * keeps its flex layout, since its children still move when one is shown.
+ */
+
+#ifndef UI_LAYOUT_H
+#define UI_LAYOUT_H
+
+#include "lvgl.h"
+#include "ui_config.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// ==================== Screen Regions ====================
+#define UI_LAYOUT_LOG_BAR_HEIGHT    60  // Log button row below the list
+
+#define UI_LAYOUT_HEADER_Y          0
+#define UI_LAYOUT_LOG_Y             (UI_LAYOUT_HEADER_Y + UI_HEADER_HEIGHT)
+#define UI_LAYOUT_LOG_H             (UI_LOG_HEIGHT + UI_LAYOUT_LOG_BAR_HEIGHT)
+#define UI_LAYOUT_CONTENT_Y         (UI_LAYOUT_LOG_Y + UI_LAYOUT_LOG_H)
+#define UI_LAYOUT_FOOTER_Y          (UI_SCREEN_HEIGHT - UI_FOOTER_HEIGHT)
+#define UI_LAYOUT_CONTENT_H         (UI_LAYOUT_FOOTER_Y - UI_LAYOUT_CONTENT_Y)
+
+// ==================== Footer ====================
+#define UI_LAYOUT_STOP_BTN_W        60
+#define UI_LAYOUT_STOP_BTN_H        28
+#define UI_LAYOUT_INDICATOR_SIZE    12
+
+// Status text: what is left of the status row next to the indicator and STOP
+#define UI_LAYOUT_STATUS_LABEL_W    (UI_SCREEN_WIDTH - 2 * UI_PADDING_LARGE - UI_LAYOUT_STOP_BTN_W - \
+                                     UI_LAYOUT_INDICATOR_SIZE - 2 * UI_GAP_MEDIUM)
+
+// ==================== Header ====================
+#define UI_LAYOUT_BADGE_W           56  // "PASSIVE 127" in montserrat 10
+
+/**
+ * @brief Resolve the layout of a view once and pin it (UI_LAYOUT_ABSOLUTE)
+ *
+ * Runs the pending layout, then walks the tree: positioned children get
+ * their current coordinates as fixed x/y, LV_SIZE_CONTENT and flex-grow
+ * sizes become fixed sizes and the flex/grid layout is removed. Labels keep
+ * their own size. Does nothing when UI_LAYOUT_ABSOLUTE is 0.
+ *
+ * @param root View to freeze (built and not yet changed by the user)
+ */
+void ui_layout_freeze(lv_obj_t* root);
+
+/**
+ * @brief Reserve a fixed width for a label whose text changes at runtime
+ *
+ * Longer text is cut with "..." instead of growing the label, so a text
+ * update never changes its size. Does nothing when UI_LAYOUT_ABSOLUTE is 0.
+ *
+ * @param label Label
+ * @param width Width in pixels (or lv_pct())
+ */
+void ui_layout_fix_label(lv_obj_t* label, int32_t width);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // UI_LAYOUT_H
@@ -1,42 +1,411 @@
 /**
  * @file ui_log_display.c
  * @brief Log Display Component Implementation
- * 
- * Scrollable log area showing TX/RX messages with timestamps
+ *
+ * Scrollable log area showing TX/RX messages with timestamps; frame rows
+ * carry the channel name ("12:00:01 [PT RX] ...")
+ *
+ * Entries are written to the log store by any task and rendered here on the
+ * LVGL task when the log count changes. The view is a column of at most
+ * UI_LOG_VIEW_ROWS labels; once full, the oldest label is reused for the
+ * newest row. A collapsed repeat only rewrites its row's "×N hh:mm:ss"
+ * badge, which is positioned outside the layout, so nothing moves or scrolls.
+ *
+ * The filter panel (direction, ID ranges, payload bytes) narrows the view.
+ * New records are tested against the active filter as they are rendered;
+ * changing the filter rebuilds the view from the store's per-ID index, so
+ * the rebuild costs about as much as the rows it finds.
+ *
+ * With CAN_TRACE_ENABLE, a traced RX frame is followed to its row: LOG_DRAW
+ * is marked when the display refresh that rendered the row completes.
  */
 
 #include "lvgl.h"
 #include "ui_config.h"
 #include "ui_state.h"
 #include "ui_binding.h"
+#include "ui_log_store.h"
+#include "ui_main.h"
+#include "ui_layout.h"
+#include "can_trace.h"
 #include <stdio.h>
+#include <string.h>
 #include <time.h>
 
+typedef struct {
+    lv_obj_t* label;            // "hh:mm:ss [TAG] message"
+    lv_obj_t* count;            // "×N hh:mm:ss" badge, created on first repeat
+    uint32_t seq;               // Record shown
+    uint32_t shown_count;       // Repeat count currently displayed
+} log_row_t;
+
 static lv_obj_t* log_container = NULL;
-static lv_obj_t* log_textarea = NULL;
+static lv_obj_t* log_list = NULL;
 static lv_obj_t* clear_btn = NULL;
+static lv_obj_t* collapse_btn = NULL;
 static lv_obj_t* status_label = NULL;
+static lv_obj_t* filter_btn = NULL;
+static lv_obj_t* filter_panel = NULL;
+static lv_obj_t* filter_dir_dropdown = NULL;
+static lv_obj_t* filter_id_textarea = NULL;
+static lv_obj_t* filter_data_textarea = NULL;
+
+static ui_log_filter_t view_filter;     // Zeroed: everything passes
+
+// Row ring: rows[row_head] is the oldest of row_count rows
+static log_row_t rows[UI_LOG_VIEW_ROWS];
+static uint8_t row_head = 0;
+static uint8_t row_count = 0;
+static uint32_t next_seq = 0;   // First store record not rendered yet
+
+#if CAN_TRACE_ENABLE
+#define LOG_TRACE_SLOTS 8       // Traced RX rows in flight; more are not sampled
+
+typedef struct {
+    uint32_t seq;               // Record holding the frame
+    uint32_t tag;               // RX capture tag
+    bool drawn;                 // Row rendered, waiting for the refresh to end
+} log_trace_t;
+
+static log_trace_t trace_slots[LOG_TRACE_SLOTS];
+static uint8_t trace_count = 0;
+
+static void trace_add(uint32_t seq, uint32_t tag) {
+    if (tag != 0 && trace_count < LOG_TRACE_SLOTS) {
+        trace_slots[trace_count++] = (log_trace_t){.seq = seq, .tag = tag};
+    }
+}
+
+static void trace_row_drawn(uint32_t seq) {
+    for (uint8_t i = 0; i < trace_count; i++) {
+        if (trace_slots[i].seq == seq) {
+            trace_slots[i].drawn = true;
+        }
+    }
+}
+
+// After a render pass: records it went past without drawing are not shown
+static void trace_drop_hidden(void) {
+    uint8_t kept = 0;
+    for (uint8_t i = 0; i < trace_count; i++) {
+        if (trace_slots[i].drawn || (int32_t)(trace_slots[i].seq - next_seq) >= 0) {
+            trace_slots[kept++] = trace_slots[i];
+        }
+    }
+    trace_count = kept;
+}
+
+// Display refresh done: the rows drawn since the last one are on screen
+static void trace_refr_ready_cb(lv_event_t* e) {
+    uint8_t kept = 0;
+    for (uint8_t i = 0; i < trace_count; i++) {
+        if (trace_slots[i].drawn) {
+            CAN_TRACE_MARK_FROM(CAN_TRACE_LOG_DRAW, trace_slots[i].tag);
+        } else {
+            trace_slots[kept++] = trace_slots[i];
+        }
+    }
+    trace_count = kept;
+}
+#else
+#define trace_add(seq, tag)     ((void)0)
+#define trace_row_drawn(seq)    ((void)0)
+#define trace_drop_hidden()     ((void)0)
+#endif // CAN_TRACE_ENABLE
+
+static void format_time(time_t t, char* buf, size_t size) {
+    struct tm* tm_info = localtime(&t);
+    snprintf(buf, size, "%02d:%02d:%02d", tm_info->tm_hour, tm_info->tm_min, tm_info->tm_sec);
+}
+
+static log_row_t* newest_row(void) {
+    return (row_count > 0) ? &rows[(row_head + row_count - 1) % UI_LOG_VIEW_ROWS] : NULL;
+}
+
+// Show or refresh a row's repeat badge (the only update a collapsed repeat costs)
+static void update_count(log_row_t* row, const ui_log_record_t* rec) {
+    if (rec->count <= 1) {
+        if (row->count != NULL) {
+            lv_obj_add_flag(row->count, LV_OBJ_FLAG_HIDDEN);
+        }
+        row->shown_count = rec->count;
+        return;
+    }
+    
+    if (row->count == NULL) {
+        row->count = lv_label_create(row->label);
+        lv_obj_set_style_text_color(row->count, UI_COLOR_CYAN_400, 0);
+        lv_obj_set_style_text_font(row->count, UI_FONT_SMALL, 0);
+        lv_obj_set_style_bg_color(row->count, UI_COLOR_BG_MAIN, 0);
+        lv_obj_set_style_bg_opa(row->count, LV_OPA_COVER, 0);
+        lv_obj_align(row->count, LV_ALIGN_TOP_RIGHT, 0, 0);
+    }
+    
+    char last_seen[16];
+    format_time(rec->last_time, last_seen, sizeof(last_seen));
+    lv_label_set_text_fmt(row->count, "×%lu %s", (unsigned long)rec->count, last_seen);
+    lv_obj_clear_flag(row->count, LV_OBJ_FLAG_HIDDEN);
+    row->shown_count = rec->count;
+}
+
+// Render a record into a new row, recycling the oldest when the view is full
+static void append_row(const ui_log_record_t* rec) {
+    log_row_t* row;
+    if (row_count < UI_LOG_VIEW_ROWS) {
+        row = &rows[(row_head + row_count) % UI_LOG_VIEW_ROWS];
+        row_count++;
+        if (row->label == NULL) {
+            row->label = lv_label_create(log_list);
+            lv_obj_set_width(row->label, lv_pct(100));
+            lv_label_set_long_mode(row->label, LV_LABEL_LONG_WRAP);
+        } else {
+            lv_obj_clear_flag(row->label, LV_OBJ_FLAG_HIDDEN);
+            lv_obj_move_to_index(row->label, -1);
+        }
+    } else {
+        row = &rows[row_head];
+        row_head = (uint8_t)((row_head + 1) % UI_LOG_VIEW_ROWS);
+        lv_obj_move_to_index(row->label, -1);
+    }
+    
+    char timestamp[16];
+    char text[UI_LOG_TEXT_LEN];
+    format_time(rec->first_time, timestamp, sizeof(timestamp));
+    ui_log_record_text(rec, text, sizeof(text));
+    if (rec->channel < UI_CHANNEL_COUNT) {
+        lv_label_set_text_fmt(row->label, "%s [%s %s] %s", timestamp,
+                              UI_CHANNELS[rec->channel], rec->type, text);
+    } else {
+        lv_label_set_text_fmt(row->label, "%s [%s] %s", timestamp, rec->type, text);
+    }
+    row->seq = rec->seq;
+    update_count(row, rec);
+    trace_row_drawn(rec->seq);
+}
+
+static void log_hide_rows(void) {
+    for (uint8_t i = 0; i < row_count; i++) {
+        lv_obj_add_flag(rows[(row_head + i) % UI_LOG_VIEW_ROWS].label, LV_OBJ_FLAG_HIDDEN);
+    }
+    row_head = 0;
+    row_count = 0;
+}
+
+// Show the newest rows passing the filter (LVGL task)
+static void log_rebuild(void) {
+    static uint32_t seqs[UI_LOG_VIEW_ROWS];
+    uint32_t found = ui_log_store_query(&view_filter, seqs, UI_LOG_VIEW_ROWS, &next_seq);
+    
+    log_hide_rows();
+    ui_log_record_t rec;
+    for (uint32_t i = 0; i < found; i++) {
+        if (ui_log_store_get(seqs[i], &rec)) {
+            append_row(&rec);
+        }
+    }
+    
+    if (status_label != NULL) {
+        uint32_t first;
+        uint32_t next;
+        ui_log_store_range(&first, &next);
+        if (row_count == 0 && first != next) {
+            lv_label_set_text(status_label, "无匹配记录");
+            lv_obj_set_style_text_color(status_label, UI_COLOR_TEXT_DISABLED, 0);
+            lv_obj_clear_flag(status_label, LV_OBJ_FLAG_HIDDEN);
+            lv_obj_center(status_label);
+        } else if (row_count > 0) {
+            lv_obj_add_flag(status_label, LV_OBJ_FLAG_HIDDEN);
+        }
+    }
+    lv_obj_scroll_to_y(log_list, LV_COORD_MAX, LV_ANIM_OFF);
+}
+
+// Render what the store gained since the last pass (LVGL task)
+static void log_render_pending(void) {
+    uint32_t first;
+    uint32_t next;
+    ui_log_store_range(&first, &next);
+    
+    // Repeats merged into the newest rendered row since the last pass
+    ui_log_record_t rec;
+    log_row_t* last = newest_row();
+    if (last != NULL && ui_log_store_get(last->seq, &rec) && rec.count != last->shown_count) {
+        update_count(last, &rec);
+        trace_row_drawn(rec.seq);
+    }
+    
+    if (next == next_seq) {
+        return;
+    }
+    
+    // Records overwritten before they were shown are skipped, and at most a
+    // screenful of the newest ones is rendered. When filtering, the newest
+    // screenful of records may hold fewer matches than older ones: let the
+    // index find them instead.
+    if (next - next_seq > UI_LOG_VIEW_ROWS) {
+        if (ui_log_filter_is_active(&view_filter)) {
+            log_rebuild();
+            return;
+        }
+        next_seq = next - UI_LOG_VIEW_ROWS;
+    }
+    if ((int32_t)(first - next_seq) > 0) {
+        next_seq = first;
+    }
+    
+    bool appended = false;
+    for (; next_seq != next; next_seq++) {
+        if (ui_log_store_get(next_seq, &rec) && ui_log_filter_match(&view_filter, &rec)) {
+            append_row(&rec);
+            appended = true;
+        }
+    }
+    if (!appended) {
+        return;     // Nothing passed the filter
+    }
+    if (status_label != NULL) {
+        lv_obj_add_flag(status_label, LV_OBJ_FLAG_HIDDEN);
+    }
+    
+    // Auto-scroll to bottom (bounded by the content)
+    lv_obj_scroll_to_y(log_list, LV_COORD_MAX, LV_ANIM_OFF);
+}
+
+static void log_clear_rows(void) {
+    log_hide_rows();
+    
+    uint32_t first;
+    ui_log_store_range(&first, &next_seq);
+}
 
 // Clear button callback
 static void clear_btn_cb(lv_event_t* e) {
-    if (log_textarea != NULL) {
-        lv_textarea_set_text(log_textarea, "");
-        ui_state_reset_log_count();
+    if (log_list != NULL) {
+        ui_log_store_clear();
+        log_clear_rows();
+        ui_state_reset_log_count();     // Status message returns via the state listener
         ui_binding_trigger_clear_logs();
-        
-        // Show status message
-        ui_state_t* state = ui_state_get();
-        if (state->is_connected) {
-            lv_label_set_text(status_label, "已连接 - 等待发送...");
-            lv_obj_clear_flag(status_label, LV_OBJ_FLAG_HIDDEN);
-        }
+    }
+}
+
+// Merge button callback (checked = collapse repeats)
+static void collapse_btn_cb(lv_event_t* e) {
+    lv_obj_t* btn = lv_event_get_target(e);
+    ui_log_store_set_collapse(lv_obj_has_state(btn, LV_STATE_CHECKED));
+}
+
+// Filter button callback: show or hide the filter panel
+static void filter_btn_cb(lv_event_t* e) {
+    if (lv_obj_has_flag(filter_panel, LV_OBJ_FLAG_HIDDEN)) {
+        lv_obj_clear_flag(filter_panel, LV_OBJ_FLAG_HIDDEN);
+    } else {
+        lv_obj_add_flag(filter_panel, LV_OBJ_FLAG_HIDDEN);
+    }
+}
+
+// Apply button callback: parse the fields and rebuild the view
+static void filter_apply_cb(lv_event_t* e) {
+    ui_log_filter_t filter;
+    if (!ui_log_filter_parse(lv_textarea_get_text(filter_id_textarea),
+                             lv_textarea_get_text(filter_data_textarea),
+                             (ui_log_dir_t)lv_dropdown_get_selected(filter_dir_dropdown), &filter)) {
+        lv_obj_set_style_border_color(filter_id_textarea, UI_COLOR_RED_500, 0);
+        lv_obj_set_style_border_color(filter_data_textarea, UI_COLOR_RED_500, 0);
+        return;
+    }
+    lv_obj_set_style_border_color(filter_id_textarea, UI_COLOR_BORDER_LIGHT, 0);
+    lv_obj_set_style_border_color(filter_data_textarea, UI_COLOR_BORDER_LIGHT, 0);
+    
+    view_filter = filter;
+    if (ui_log_filter_is_active(&view_filter)) {
+        lv_obj_add_state(filter_btn, LV_STATE_CHECKED);
+    } else {
+        lv_obj_clear_state(filter_btn, LV_STATE_CHECKED);
+    }
+    lv_obj_add_flag(filter_panel, LV_OBJ_FLAG_HIDDEN);
+    log_rebuild();
+}
+
+static lv_obj_t* create_filter_textarea(lv_obj_t* parent, const char* placeholder) {
+    lv_obj_t* ta = lv_textarea_create(parent);
+    lv_obj_set_width(ta, lv_pct(100));
+    lv_textarea_set_one_line(ta, true);
+    lv_textarea_set_placeholder_text(ta, placeholder);
+    lv_obj_set_style_bg_color(ta, UI_COLOR_BG_INPUT, 0);
+    lv_obj_set_style_border_color(ta, UI_COLOR_BORDER_LIGHT, 0);
+    lv_obj_set_style_text_color(ta, UI_COLOR_TEXT_PRIMARY, 0);
+    lv_obj_set_style_text_font(ta, UI_FONT_NORMAL, 0);
+    return ta;
+}
+
+// Filter panel, laid over the top of the row list (hidden until opened)
+static void create_filter_panel(lv_obj_t* parent) {
+    filter_panel = lv_obj_create(parent);
+    lv_obj_set_size(filter_panel, lv_pct(100), LV_SIZE_CONTENT);
+    lv_obj_add_flag(filter_panel, LV_OBJ_FLAG_IGNORE_LAYOUT);
+    lv_obj_add_flag(filter_panel, LV_OBJ_FLAG_HIDDEN);
+    lv_obj_align(filter_panel, LV_ALIGN_TOP_MID, 0, 0);
+    lv_obj_set_style_bg_color(filter_panel, UI_COLOR_BG_CONTAINER, 0);
+    lv_obj_set_style_border_color(filter_panel, UI_COLOR_BORDER_LIGHT, 0);
+    lv_obj_set_style_border_width(filter_panel, 1, 0);
+    lv_obj_set_style_radius(filter_panel, UI_RADIUS_SMALL, 0);
+    lv_obj_set_style_pad_all(filter_panel, UI_PADDING_SMALL, 0);
+    lv_obj_set_style_pad_row(filter_panel, UI_GAP_SMALL, 0);
+    lv_obj_set_flex_flow(filter_panel, LV_FLEX_FLOW_COLUMN);
+    lv_obj_clear_flag(filter_panel, LV_OBJ_FLAG_SCROLLABLE);
+    
+    // Direction + apply
+    lv_obj_t* top_row = lv_obj_create(filter_panel);
+    lv_obj_set_size(top_row, lv_pct(100), LV_SIZE_CONTENT);
+    lv_obj_set_style_bg_opa(top_row, LV_OPA_TRANSP, 0);
+    lv_obj_set_style_border_width(top_row, 0, 0);
+    lv_obj_set_style_pad_all(top_row, 0, 0);
+    lv_obj_set_style_pad_column(top_row, UI_GAP_SMALL, 0);
+    lv_obj_set_flex_flow(top_row, LV_FLEX_FLOW_ROW);
+    lv_obj_clear_flag(top_row, LV_OBJ_FLAG_SCROLLABLE);
+    
+    filter_dir_dropdown = lv_dropdown_create(top_row);
+    lv_dropdown_set_options(filter_dir_dropdown, "全部\nTX\nRX");     // Order of ui_log_dir_t
+    lv_obj_set_flex_grow(filter_dir_dropdown, 1);
+    lv_obj_set_style_bg_color(filter_dir_dropdown, UI_COLOR_BG_INPUT, 0);
+    lv_obj_set_style_border_color(filter_dir_dropdown, UI_COLOR_BORDER_LIGHT, 0);
+    lv_obj_set_style_text_color(filter_dir_dropdown, UI_COLOR_TEXT_PRIMARY, 0);
+    lv_obj_set_style_text_font(filter_dir_dropdown, UI_FONT_NORMAL, 0);
+    
+    lv_obj_t* apply_btn = lv_btn_create(top_row);
+    lv_obj_set_size(apply_btn, 56, 32);
+    lv_obj_set_style_bg_color(apply_btn, UI_COLOR_CYAN_600, 0);
+    lv_obj_set_style_bg_color(apply_btn, UI_COLOR_CYAN_500, LV_STATE_PRESSED);
+    lv_obj_set_style_border_width(apply_btn, 0, 0);
+    lv_obj_set_style_radius(apply_btn, UI_RADIUS_SMALL, 0);
+    lv_obj_add_event_cb(apply_btn, filter_apply_cb, LV_EVENT_CLICKED, NULL);
+    
+    lv_obj_t* apply_label = lv_label_create(apply_btn);
+    lv_label_set_text(apply_label, "应用");
+    lv_obj_set_style_text_color(apply_label, UI_COLOR_WHITE, 0);
+    lv_obj_set_style_text_font(apply_label, UI_FONT_NORMAL, 0);
+    lv_obj_center(apply_label);
+    
+    filter_id_textarea = create_filter_textarea(filter_panel, "ID: 7E8, 100-1FF");
+    lv_obj_add_event_cb(filter_id_textarea, filter_apply_cb, LV_EVENT_READY, NULL);
+    filter_data_textarea = create_filter_textarea(filter_panel, "数据: ?? 3E");
+    lv_obj_add_event_cb(filter_data_textarea, filter_apply_cb, LV_EVENT_READY, NULL);
+}
+
+// State listener: render new entries; placeholder text while the log is empty
+static void log_state_listener(uint32_t changed, const ui_state_t* state, void* user_data) {
+    if (state->log_count == 0) {
+        ui_log_update_status(state->is_connected);
+    } else if (changed & UI_STATE_F_LOG_COUNT) {
+        log_render_pending();
+        trace_drop_hidden();
     }
 }
 
 lv_obj_t* ui_log_display_create(lv_obj_t* parent, int y_offset) {
     // Create main container
     log_container = lv_obj_create(parent);
-    lv_obj_set_size(log_container, UI_SCREEN_WIDTH, UI_LOG_HEIGHT + 60);
+    lv_obj_set_size(log_container, UI_SCREEN_WIDTH, UI_LAYOUT_LOG_H);
     lv_obj_align(log_container, LV_ALIGN_TOP_MID, 0, y_offset);
     lv_obj_set_style_bg_color(log_container, UI_COLOR_BLACK, 0);
     lv_obj_set_style_border_width(log_container, 0, 0);
@@ -45,28 +414,76 @@ lv_obj_t* ui_log_display_create(lv_obj_t* parent, int y_offset) {
     lv_obj_set_flex_flow(log_container, LV_FLEX_FLOW_COLUMN);
     lv_obj_clear_flag(log_container, LV_OBJ_FLAG_SCROLLABLE);
     
-    // Create log text area
-    log_textarea = lv_textarea_create(log_container);
-    lv_obj_set_size(log_textarea, lv_pct(100), UI_LOG_HEIGHT);
-    lv_textarea_set_text(log_textarea, "");
-    lv_obj_set_style_bg_color(log_textarea, UI_COLOR_BG_MAIN, 0);
-    lv_obj_set_style_border_color(log_textarea, UI_COLOR_BORDER_MAIN, 0);
-    lv_obj_set_style_border_width(log_textarea, 1, 0);
-    lv_obj_set_style_radius(log_textarea, UI_RADIUS_SMALL, 0);
-    lv_obj_set_style_text_color(log_textarea, UI_COLOR_TEXT_PRIMARY, 0);
-    lv_obj_set_style_text_font(log_textarea, &lv_font_montserrat_10, 0);
-    lv_obj_set_style_pad_all(log_textarea, UI_PADDING_MEDIUM, 0);
-    lv_textarea_set_one_line(log_textarea, false);
+    // Create log row list
+    log_list = lv_obj_create(log_container);
+    lv_obj_set_size(log_list, lv_pct(100), UI_LOG_HEIGHT);
+    lv_obj_set_style_bg_color(log_list, UI_COLOR_BG_MAIN, 0);
+    lv_obj_set_style_border_color(log_list, UI_COLOR_BORDER_MAIN, 0);
+    lv_obj_set_style_border_width(log_list, 1, 0);
+    lv_obj_set_style_radius(log_list, UI_RADIUS_SMALL, 0);
+    lv_obj_set_style_text_color(log_list, UI_COLOR_TEXT_PRIMARY, 0);
+    lv_obj_set_style_text_font(log_list, UI_FONT_SMALL, 0);
+    lv_obj_set_style_pad_all(log_list, UI_PADDING_MEDIUM, 0);
+    lv_obj_set_style_pad_row(log_list, 0, 0);
+    lv_obj_set_flex_flow(log_list, LV_FLEX_FLOW_COLUMN);
+    lv_obj_set_scrollbar_mode(log_list, LV_SCROLLBAR_MODE_AUTO);
     
     // Create status label (shown when no logs)
-    status_label = lv_label_create(log_textarea);
+    status_label = lv_label_create(log_list);
     lv_label_set_text(status_label, "未连接");
     lv_obj_set_style_text_color(status_label, UI_COLOR_TEXT_DISABLED, 0);
+    lv_obj_add_flag(status_label, LV_OBJ_FLAG_IGNORE_LAYOUT);
     lv_obj_center(status_label);
     
+    create_filter_panel(log_container);
+    
+    // Button row: filter + merge toggle + clear
+    lv_obj_t* btn_row = lv_obj_create(log_container);
+    lv_obj_set_size(btn_row, lv_pct(100), 32);
+    lv_obj_set_style_bg_opa(btn_row, LV_OPA_TRANSP, 0);
+    lv_obj_set_style_border_width(btn_row, 0, 0);
+    lv_obj_set_style_pad_all(btn_row, 0, 0);
+    lv_obj_set_style_pad_column(btn_row, UI_GAP_SMALL, 0);
+    lv_obj_set_flex_flow(btn_row, LV_FLEX_FLOW_ROW);
+    lv_obj_clear_flag(btn_row, LV_OBJ_FLAG_SCROLLABLE);
+    
+    filter_btn = lv_btn_create(btn_row);
+    lv_obj_set_size(filter_btn, 56, lv_pct(100));
+    lv_obj_set_style_bg_color(filter_btn, UI_COLOR_BG_INPUT, 0);
+    lv_obj_set_style_bg_color(filter_btn, UI_COLOR_CYAN_600, LV_STATE_CHECKED);     // Filter active
+    lv_obj_set_style_border_width(filter_btn, 0, 0);
+    lv_obj_set_style_radius(filter_btn, UI_RADIUS_SMALL, 0);
+    lv_obj_add_event_cb(filter_btn, filter_btn_cb, LV_EVENT_CLICKED, NULL);
+    
+    lv_obj_t* filter_label = lv_label_create(filter_btn);
+    lv_label_set_text(filter_label, "筛选");
+    lv_obj_set_style_text_color(filter_label, UI_COLOR_TEXT_SECONDARY, 0);
+    lv_obj_set_style_text_font(filter_label, UI_FONT_NORMAL, 0);
+    lv_obj_center(filter_label);
+    
+    collapse_btn = lv_btn_create(btn_row);
+    lv_obj_set_size(collapse_btn, 56, lv_pct(100));
+    lv_obj_add_flag(collapse_btn, LV_OBJ_FLAG_CHECKABLE);
+    lv_obj_set_style_bg_color(collapse_btn, UI_COLOR_BG_INPUT, 0);
+    lv_obj_set_style_bg_color(collapse_btn, UI_COLOR_CYAN_600, LV_STATE_CHECKED);
+    lv_obj_set_style_border_width(collapse_btn, 0, 0);
+    lv_obj_set_style_radius(collapse_btn, UI_RADIUS_SMALL, 0);
+    lv_obj_add_event_cb(collapse_btn, collapse_btn_cb, LV_EVENT_VALUE_CHANGED, NULL);
+    if (UI_LOG_COLLAPSE_DEFAULT) {
+        lv_obj_add_state(collapse_btn, LV_STATE_CHECKED);
+    }
+    ui_log_store_set_collapse(UI_LOG_COLLAPSE_DEFAULT);
+    
+    lv_obj_t* collapse_label = lv_label_create(collapse_btn);
+    lv_label_set_text(collapse_label, "合并");
+    lv_obj_set_style_text_color(collapse_label, UI_COLOR_TEXT_SECONDARY, 0);
+    lv_obj_set_style_text_font(collapse_label, UI_FONT_NORMAL, 0);
+    lv_obj_center(collapse_label);
+    
     // Create clear button
-    clear_btn = lv_btn_create(log_container);
-    lv_obj_set_size(clear_btn, lv_pct(100), 32);
+    clear_btn = lv_btn_create(btn_row);
+    lv_obj_set_height(clear_btn, lv_pct(100));
+    lv_obj_set_flex_grow(clear_btn, 1);
     lv_obj_set_style_bg_color(clear_btn, UI_COLOR_BG_INPUT, 0);
     lv_obj_set_style_bg_color(clear_btn, UI_COLOR_BG_HOVER, LV_STATE_PRESSED);
     lv_obj_set_style_border_width(clear_btn, 0, 0);
@@ -76,39 +493,58 @@ lv_obj_t* ui_log_display_create(lv_obj_t* parent, int y_offset) {
     lv_obj_t* btn_label = lv_label_create(clear_btn);
     lv_label_set_text(btn_label, LV_SYMBOL_TRASH " 清空日志");
     lv_obj_set_style_text_color(btn_label, UI_COLOR_TEXT_SECONDARY, 0);
-    lv_obj_set_style_text_font(btn_label, &lv_font_montserrat_12, 0);
+    lv_obj_set_style_text_font(btn_label, UI_FONT_NORMAL, 0);
     lv_obj_center(btn_label);
     
+    ui_state_subscribe(UI_STATE_F_CONNECTED | UI_STATE_F_LOG_COUNT, log_state_listener, NULL);
+    
+#if CAN_TRACE_ENABLE
+    lv_display_t* disp = lv_display_get_default();
+    if (disp != NULL) {
+        trace_count = 0;
+        lv_display_remove_event_cb_with_user_data(disp, trace_refr_ready_cb, NULL);
+        lv_display_add_event_cb(disp, trace_refr_ready_cb, LV_EVENT_REFR_READY, NULL);
+    }
+#endif
+    
     return log_container;
 }
 
 void ui_log_add_message(const char* type, const char* message) {
-    if (log_textarea == NULL || type == NULL || message == NULL) {
+    if (type == NULL || message == NULL) {
         return;
     }
-    
-    // Hide status label once we have logs
-    if (status_label != NULL) {
-        lv_obj_add_flag(status_label, LV_OBJ_FLAG_HIDDEN);
+    ui_log_store_add(UI_LOG_NO_CHANNEL, type, message);
+}
+
+void ui_log_add_channel_message(uint8_t channel, const char* type, const char* message) {
+    if (type == NULL || message == NULL) {
+        return;
     }
+    ui_log_store_add((channel < UI_CHANNEL_COUNT) ? channel : UI_LOG_NO_CHANNEL, type, message);
+}
+
+void ui_log_add_channel_frame(uint8_t channel, const char* type, uint32_t id, bool extended,
+                              uint8_t dlc, const uint8_t* data, uint32_t trace) {
+    if (type == NULL || (data == NULL && dlc > 0)) {
+        return;
+    }
+    ui_log_frame_t frame = {
+        .id = id,
+        .extended = extended,
+        .dlc = (dlc < UI_LOG_FRAME_DATA) ? dlc : UI_LOG_FRAME_DATA
+    };
+    if (frame.dlc > 0) {
+        memcpy(frame.data, data, frame.dlc);
+    }
+    ui_log_store_add_frame((channel < UI_CHANNEL_COUNT) ? channel : UI_LOG_NO_CHANNEL, type, &frame);
     
-    // Get current time
-    time_t now = time(NULL);
-    struct tm* tm_info = localtime(&now);
-    char timestamp[16];
-    snprintf(timestamp, sizeof(timestamp), "%02d:%02d:%02d", 
-             tm_info->tm_hour, tm_info->tm_min, tm_info->tm_sec);
-    
-    // Format log entry
-    char log_entry[256];
-    snprintf(log_entry, sizeof(log_entry), "%s [%s] %s\n", 
-             timestamp, type, message);
-    
-    // Add to textarea
-    lv_textarea_add_text(log_textarea, log_entry);
-    
-    // Auto-scroll to bottom
-    lv_obj_scroll_to_y(log_textarea, lv_obj_get_scroll_bottom(log_textarea), LV_ANIM_ON);
+    if (trace != 0) {
+        uint32_t first;
+        uint32_t next;
+        ui_log_store_range(&first, &next);
+        trace_add(next - 1, trace);     // New record, or the newest one it merged into
+    }
 }
 
 void ui_log_update_status(bool connected) {
@@ -116,8 +552,9 @@ void ui_log_update_status(bool connected) {
         return;
     }
     
-    ui_state_t* state = ui_state_get();
-    if (state->log_count == 0) {
+    ui_state_t state;
+    ui_state_snapshot(&state);
+    if (state.log_count == 0) {
         lv_obj_clear_flag(status_label, LV_OBJ_FLAG_HIDDEN);
         if (connected) {
             lv_label_set_text(status_label, "已连接 - 等待发送...");
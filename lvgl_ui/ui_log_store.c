@@ -0,0 +1,465 @@
+/**
+ * @file ui_log_store.c
+ * @brief Log Record Store Implementation
+ */
+
+#include "ui_log_store.h"
+#include "can_port.h"
+#include "can_pool.h"
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define UI_LOG_STORE_MASK (UI_LOG_STORE_SIZE - 1)
+
+// Per-ID index: open addressing, twice the store size so a free or stale slot
+// always exists (at most UI_LOG_STORE_SIZE IDs are live)
+#define UI_LOG_ID_BITS      8
+#define UI_LOG_ID_SLOTS     (1u << UI_LOG_ID_BITS)
+#define UI_LOG_ID_EXT       0x80000000u     // Key bit: 29-bit ID
+#define UI_LOG_RANGE_PROBE  16              // Narrower ranges are looked up ID by ID
+
+typedef struct {
+    uint32_t key;               // ID | UI_LOG_ID_EXT
+    uint32_t head;              // Newest record of the ID
+    bool used;
+} id_slot_t;
+
+static ui_log_record_t g_records[UI_LOG_STORE_SIZE] CAN_POOL_ATTR;     // PSRAM with CAN_POOL_PSRAM
+static id_slot_t g_index[UI_LOG_ID_SLOTS];
+static uint32_t g_first = 0;        // Oldest stored seq
+static uint32_t g_next = 0;         // Next seq to assign
+static atomic_bool g_collapse;
+static can_port_mutex_t* g_lock = NULL;
+
+// ==================== Helpers (lock held) ====================
+
+static bool seq_stored(uint32_t seq) {
+    return seq - g_first < g_next - g_first;    // first <= seq < next, wrap-safe
+}
+
+static uint32_t frame_key(const ui_log_frame_t* frame) {
+    return frame->id | (frame->extended ? UI_LOG_ID_EXT : 0);
+}
+
+static uint32_t key_hash(uint32_t key) {
+    return (key * 2654435761u) >> (32 - UI_LOG_ID_BITS);
+}
+
+// Slot holding key, or NULL
+static id_slot_t* index_find(uint32_t key) {
+    uint32_t h = key_hash(key);
+    for (uint32_t i = 0; i < UI_LOG_ID_SLOTS; i++) {
+        id_slot_t* slot = &g_index[(h + i) & (UI_LOG_ID_SLOTS - 1)];
+        if (!slot->used) {
+            return NULL;
+        }
+        if (slot->key == key) {
+            return slot;
+        }
+    }
+    return NULL;
+}
+
+// Slot for key: its own, else the first stale one on the probe path, else a free one
+static id_slot_t* index_slot(uint32_t key) {
+    uint32_t h = key_hash(key);
+    id_slot_t* stale = NULL;
+    for (uint32_t i = 0; i < UI_LOG_ID_SLOTS; i++) {
+        id_slot_t* slot = &g_index[(h + i) & (UI_LOG_ID_SLOTS - 1)];
+        if (!slot->used) {
+            return (stale != NULL) ? stale : slot;
+        }
+        if (slot->key == key) {
+            return slot;
+        }
+        if (stale == NULL && !seq_stored(slot->head)) {
+            stale = slot;
+        }
+    }
+    return stale;
+}
+
+static bool type_is(const char* type, ui_log_dir_t dir) {
+    switch (dir) {
+        case UI_LOG_DIR_TX: return strcmp(type, "TX") == 0;
+        case UI_LOG_DIR_RX: return strcmp(type, "RX") == 0;
+        default:            return true;
+    }
+}
+
+static bool filter_has_frame_terms(const ui_log_filter_t* filter) {
+    if (filter->range_count > 0) {
+        return true;
+    }
+    for (uint8_t i = 0; i < UI_LOG_FRAME_DATA; i++) {
+        if (filter->data_mask[i] != 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Store a new record; collapse and index handled by the callers
+static ui_log_record_t* push_record(uint8_t channel, const char* type, time_t now) {
+    ui_log_record_t* rec = &g_records[g_next & UI_LOG_STORE_MASK];
+    rec->seq = g_next;
+    rec->count = 1;
+    rec->first_time = now;
+    rec->last_time = now;
+    rec->id_prev = g_next;
+    rec->channel = channel;
+    strncpy(rec->type, type, sizeof(rec->type) - 1);
+    rec->type[sizeof(rec->type) - 1] = '\0';
+    g_next++;
+    if (g_next - g_first > UI_LOG_STORE_SIZE) {
+        g_first = g_next - UI_LOG_STORE_SIZE;   // Oldest overwritten
+    }
+    return rec;
+}
+
+// Merge into the newest record if it is the same entry
+static bool collapse_into_last(uint8_t channel, const char* type, const char* text,
+                               const ui_log_frame_t* frame, time_t now) {
+    if (!atomic_load(&g_collapse) || g_next == g_first) {
+        return false;
+    }
+    ui_log_record_t* last = &g_records[(g_next - 1) & UI_LOG_STORE_MASK];
+    if (last->channel != channel || last->is_frame != (frame != NULL) ||
+        strncmp(last->type, type, sizeof(last->type) - 1) != 0) {
+        return false;
+    }
+    if (frame != NULL) {
+        if (last->frame.id != frame->id || last->frame.extended != frame->extended ||
+            last->frame.dlc != frame->dlc || memcmp(last->frame.data, frame->data, frame->dlc) != 0) {
+            return false;
+        }
+    } else if (strncmp(last->text, text, sizeof(last->text) - 1) != 0) {
+        return false;
+    }
+    last->count++;
+    last->last_time = now;
+    return true;
+}
+
+// ==================== API ====================
+
+void ui_log_store_init(void) {
+    if (g_lock == NULL) {
+        g_lock = can_port_mutex_create();
+    }
+    can_port_mutex_lock(g_lock);
+    g_first = 0;
+    g_next = 0;
+    memset(g_index, 0, sizeof(g_index));
+    can_port_mutex_unlock(g_lock);
+    atomic_store(&g_collapse, false);
+}
+
+void ui_log_store_set_collapse(bool enabled) {
+    atomic_store(&g_collapse, enabled);
+}
+
+bool ui_log_store_get_collapse(void) {
+    return atomic_load(&g_collapse);
+}
+
+bool ui_log_store_add(uint8_t channel, const char* type, const char* text) {
+    time_t now = time(NULL);
+    
+    can_port_mutex_lock(g_lock);
+    if (collapse_into_last(channel, type, text, NULL, now)) {
+        can_port_mutex_unlock(g_lock);
+        return false;
+    }
+    ui_log_record_t* rec = push_record(channel, type, now);
+    rec->is_frame = false;
+    strncpy(rec->text, text, sizeof(rec->text) - 1);
+    rec->text[sizeof(rec->text) - 1] = '\0';
+    can_port_mutex_unlock(g_lock);
+    return true;
+}
+
+bool ui_log_store_add_frame(uint8_t channel, const char* type, const ui_log_frame_t* frame) {
+    time_t now = time(NULL);
+    ui_log_frame_t f = *frame;
+    if (f.dlc > UI_LOG_FRAME_DATA) {
+        f.dlc = UI_LOG_FRAME_DATA;
+    }
+    
+    can_port_mutex_lock(g_lock);
+    if (collapse_into_last(channel, type, NULL, &f, now)) {
+        can_port_mutex_unlock(g_lock);
+        return false;
+    }
+    ui_log_record_t* rec = push_record(channel, type, now);
+    rec->is_frame = true;
+    rec->frame = f;
+    
+    // Link behind the previous record of this ID and make this one the head
+    uint32_t key = frame_key(&f);
+    id_slot_t* slot = index_slot(key);
+    if (slot != NULL) {
+        if (slot->used && slot->key == key && seq_stored(slot->head)) {
+            rec->id_prev = slot->head;
+        }
+        slot->key = key;
+        slot->head = rec->seq;
+        slot->used = true;
+    }
+    can_port_mutex_unlock(g_lock);
+    return true;
+}
+
+void ui_log_store_clear(void) {
+    can_port_mutex_lock(g_lock);
+    g_first = g_next;
+    can_port_mutex_unlock(g_lock);
+}
+
+void ui_log_store_range(uint32_t* first, uint32_t* next) {
+    can_port_mutex_lock(g_lock);
+    *first = g_first;
+    *next = g_next;
+    can_port_mutex_unlock(g_lock);
+}
+
+bool ui_log_store_get(uint32_t seq, ui_log_record_t* out) {
+    bool found = false;
+    
+    can_port_mutex_lock(g_lock);
+    if (seq_stored(seq)) {
+        *out = g_records[seq & UI_LOG_STORE_MASK];
+        found = true;
+    }
+    can_port_mutex_unlock(g_lock);
+    return found;
+}
+
+const char* ui_log_record_text(const ui_log_record_t* rec, char* buf, size_t size) {
+    if (!rec->is_frame) {
+        snprintf(buf, size, "%s", rec->text);
+        return buf;
+    }
+    
+    // Same layout as can_frame_format()
+    int len = snprintf(buf, size, rec->frame.extended ? "CAN ID: 0x%08X | Data: [" : "CAN ID: 0x%03X | Data: [",
+                       (unsigned)rec->frame.id);
+    for (uint8_t i = 0; i < rec->frame.dlc && len > 0 && (size_t)len < size; i++) {
+        len += snprintf(buf + len, size - len, (i == 0) ? "0x%02X" : ", 0x%02X", rec->frame.data[i]);
+    }
+    if (len > 0 && (size_t)len < size) {
+        snprintf(buf + len, size - len, "]");
+    }
+    return buf;
+}
+
+// ==================== Filtering ====================
+
+void ui_log_filter_clear(ui_log_filter_t* filter) {
+    memset(filter, 0, sizeof(ui_log_filter_t));
+}
+
+bool ui_log_filter_is_active(const ui_log_filter_t* filter) {
+    return filter->dir != UI_LOG_DIR_ANY || filter_has_frame_terms(filter);
+}
+
+static const char* skip_separators(const char* p) {
+    while (*p == ' ' || *p == ',') {
+        p++;
+    }
+    return p;
+}
+
+bool ui_log_filter_parse(const char* ids, const char* data, ui_log_dir_t dir, ui_log_filter_t* filter) {
+    ui_log_filter_t f;
+    ui_log_filter_clear(&f);
+    f.dir = dir;
+    
+    // "7E8, 100-1FF"
+    const char* p = skip_separators((ids != NULL) ? ids : "");
+    while (*p != '\0') {
+        if (f.range_count >= UI_LOG_FILTER_RANGES) {
+            return false;
+        }
+        char* end;
+        unsigned long first = strtoul(p, &end, 16);
+        if (end == p || first > 0x1FFFFFFFul) {
+            return false;
+        }
+        unsigned long last = first;
+        p = end;
+        while (*p == ' ') {
+            p++;
+        }
+        if (*p == '-') {
+            p++;
+            last = strtoul(p, &end, 16);
+            if (end == p || last < first || last > 0x1FFFFFFFul) {
+                return false;
+            }
+            p = end;
+        }
+        f.ranges[f.range_count].first = (uint32_t)first;
+        f.ranges[f.range_count].last = (uint32_t)last;
+        f.range_count++;
+        p = skip_separators(p);
+    }
+    
+    // "?? 3E x 01"
+    p = skip_separators((data != NULL) ? data : "");
+    for (uint8_t i = 0; *p != '\0'; i++) {
+        if (i >= UI_LOG_FRAME_DATA) {
+            return false;
+        }
+        if (*p == '?' || *p == 'x' || *p == 'X' || *p == '*') {
+            while (*p == '?' || *p == 'x' || *p == 'X' || *p == '*') {
+                p++;
+            }
+        } else {
+            char* end;
+            unsigned long byte = strtoul(p, &end, 16);
+            if (end == p || byte > 0xFF) {
+                return false;
+            }
+            f.data_mask[i] = 0xFF;
+            f.data_value[i] = (uint8_t)byte;
+            p = end;
+        }
+        if (*p != '\0' && *p != ' ' && *p != ',') {
+            return false;
+        }
+        p = skip_separators(p);
+    }
+    
+    *filter = f;
+    return true;
+}
+
+bool ui_log_filter_match(const ui_log_filter_t* filter, const ui_log_record_t* rec) {
+    if (!type_is(rec->type, filter->dir)) {
+        return false;
+    }
+    if (!rec->is_frame) {
+        return !filter_has_frame_terms(filter);
+    }
+    
+    if (filter->range_count > 0) {
+        bool in_range = false;
+        for (uint8_t i = 0; i < filter->range_count && !in_range; i++) {
+            in_range = rec->frame.id >= filter->ranges[i].first && rec->frame.id <= filter->ranges[i].last;
+        }
+        if (!in_range) {
+            return false;
+        }
+    }
+    for (uint8_t i = 0; i < UI_LOG_FRAME_DATA; i++) {
+        if (filter->data_mask[i] != 0 &&
+            (i >= rec->frame.dlc || (rec->frame.data[i] & filter->data_mask[i]) != filter->data_value[i])) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// True if id lies in one of the first count ranges of the filter
+static bool id_in_ranges(const ui_log_filter_t* filter, uint8_t count, uint32_t id) {
+    for (uint8_t i = 0; i < count; i++) {
+        if (id >= filter->ranges[i].first && id <= filter->ranges[i].last) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Chain heads of the IDs inside the filter's ranges, each once (lock held)
+static uint32_t collect_heads(const ui_log_filter_t* filter, uint32_t* heads) {
+    uint32_t count = 0;
+    uint32_t span = 0;
+    for (uint8_t i = 0; i < filter->range_count; i++) {
+        span += filter->ranges[i].last - filter->ranges[i].first + 1;
+        if (span > UI_LOG_RANGE_PROBE) {
+            break;
+        }
+    }
+    
+    if (span <= UI_LOG_RANGE_PROBE) {
+        // Few IDs: look each one up (standard and extended), skipping IDs an
+        // earlier overlapping range already covered
+        for (uint8_t i = 0; i < filter->range_count; i++) {
+            for (uint32_t id = filter->ranges[i].first; id <= filter->ranges[i].last; id++) {
+                if (id_in_ranges(filter, i, id)) {
+                    continue;
+                }
+                for (int ext = 0; ext < 2; ext++) {
+                    id_slot_t* slot = index_find(id | (ext ? UI_LOG_ID_EXT : 0));
+                    if (slot != NULL && seq_stored(slot->head) && count < UI_LOG_STORE_SIZE) {
+                        heads[count++] = slot->head;
+                    }
+                }
+            }
+        }
+        return count;
+    }
+    
+    // Wide ranges: one pass over the index
+    for (uint32_t s = 0; s < UI_LOG_ID_SLOTS && count < UI_LOG_STORE_SIZE; s++) {
+        const id_slot_t* slot = &g_index[s];
+        if (!slot->used || !seq_stored(slot->head)) {
+            continue;
+        }
+        if (id_in_ranges(filter, filter->range_count, slot->key & ~UI_LOG_ID_EXT)) {
+            heads[count++] = slot->head;
+        }
+    }
+    return count;
+}
+
+uint32_t ui_log_store_query(const ui_log_filter_t* filter, uint32_t* seqs, uint32_t max, uint32_t* next) {
+    uint32_t found = 0;
+    
+    can_port_mutex_lock(g_lock);
+    *next = g_next;
+    
+    if (filter->range_count == 0) {
+        // No index to use: scan newest first until the view is full
+        for (uint32_t seq = g_next; seq != g_first && found < max; ) {
+            seq--;
+            const ui_log_record_t* rec = &g_records[seq & UI_LOG_STORE_MASK];
+            if (ui_log_filter_match(filter, rec)) {
+                seqs[found++] = seq;
+            }
+        }
+    } else {
+        // Merge the per-ID chains newest first: each step takes the newest head
+        static uint32_t heads[UI_LOG_STORE_SIZE];   // Lock held: one query at a time
+        uint32_t head_count = collect_heads(filter, heads);
+        while (head_count > 0 && found < max) {
+            uint32_t newest = 0;
+            for (uint32_t i = 1; i < head_count; i++) {
+                if ((int32_t)(heads[i] - heads[newest]) > 0) {
+                    newest = i;
+                }
+            }
+            const ui_log_record_t* rec = &g_records[heads[newest] & UI_LOG_STORE_MASK];
+            if (ui_log_filter_match(filter, rec)) {
+                seqs[found++] = rec->seq;
+            }
+            if (rec->id_prev != rec->seq && seq_stored(rec->id_prev)) {
+                heads[newest] = rec->id_prev;
+            } else {
+                heads[newest] = heads[--head_count];    // Chain exhausted
+            }
+        }
+    }
+    can_port_mutex_unlock(g_lock);
+    
+    // Collected newest first; the view wants oldest first
+    for (uint32_t i = 0; i < found / 2; i++) {
+        uint32_t t = seqs[i];
+        seqs[i] = seqs[found - 1 - i];
+        seqs[found - 1 - i] = t;
+    }
+    return found;
+}
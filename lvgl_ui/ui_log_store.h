@@ -0,0 +1,215 @@
+/**
+ * @file ui_log_store.h
+ * @brief Log Record Store
+ *
+ * Fixed ring of log records. Any task appends (through ui_binding_add_log);
+ * the LVGL task reads the records added since its last pass and renders only
+ * those. When the ring is full the oldest record is overwritten.
+ *
+ * In collapse mode an entry identical to the newest record (same channel,
+ * direction and text) is not stored again: the newest record's repeat count
+ * and last-seen time are bumped instead, so a frame repeating every 10 ms
+ * costs one record and one label update however long it runs.
+ *
+ * Frames are stored binary (ID, DLC, data) and only formatted when a row is
+ * drawn. Every frame record is linked to the previous record with the same
+ * ID, and a small hash index keeps the newest record of each ID, so a filter
+ * on ID ranges walks only the records of matching IDs instead of the whole
+ * history.
+ */
+
+#ifndef UI_LOG_STORE_H
+#define UI_LOG_STORE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <time.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define UI_LOG_STORE_SIZE   128     // Records kept (power of two)
+#define UI_LOG_TEXT_LEN     96      // Message bytes per record (with terminator)
+#define UI_LOG_NO_CHANNEL   0xFF    // Record not tagged with a channel
+#define UI_LOG_FRAME_DATA   8       // Payload bytes per frame record
+
+#define UI_LOG_FILTER_RANGES 4      // ID ranges per filter
+
+/**
+ * @brief Binary CAN frame of a frame record
+ */
+typedef struct {
+    uint32_t id;
+    bool extended;              // 29-bit ID
+    uint8_t dlc;
+    uint8_t data[UI_LOG_FRAME_DATA];
+} ui_log_frame_t;
+
+/**
+ * @brief One log row (possibly standing for a run of identical entries)
+ */
+typedef struct {
+    uint32_t seq;               // Insertion number, never reused
+    uint32_t count;             // Occurrences (1 unless collapsed)
+    time_t first_time;          // Wall clock of the first occurrence
+    time_t last_time;           // ... and of the latest one
+    uint32_t id_prev;           // Frame records: previous record of the same ID (seq if none)
+    uint8_t channel;            // Channel index or UI_LOG_NO_CHANNEL
+    char type[4];               // "TX", "RX"
+    bool is_frame;              // frame is valid, text is not
+    union {
+        char text[UI_LOG_TEXT_LEN];
+        ui_log_frame_t frame;
+    };
+} ui_log_record_t;
+
+/**
+ * @brief Direction selector of a filter
+ */
+typedef enum {
+    UI_LOG_DIR_ANY = 0,
+    UI_LOG_DIR_TX,
+    UI_LOG_DIR_RX
+} ui_log_dir_t;
+
+/**
+ * @brief Log view filter (all set conditions must hold)
+ *
+ * With no ID range and no payload byte set, event rows (connect, errors...)
+ * pass the direction test like frames do; otherwise only frames can match.
+ */
+typedef struct {
+    ui_log_dir_t dir;
+    uint8_t range_count;                        // 0 = any ID
+    struct {
+        uint32_t first;
+        uint32_t last;                          // Inclusive
+    } ranges[UI_LOG_FILTER_RANGES];
+    uint8_t data_mask[UI_LOG_FRAME_DATA];       // Bits compared per payload byte
+    uint8_t data_value[UI_LOG_FRAME_DATA];
+} ui_log_filter_t;
+
+/**
+ * @brief Initialize the store (empty, collapse mode off)
+ */
+void ui_log_store_init(void);
+
+/**
+ * @brief Enable or disable merging of consecutive identical entries
+ * @param enabled true to collapse repeats
+ */
+void ui_log_store_set_collapse(bool enabled);
+
+/**
+ * @brief Get the collapse mode
+ * @return true if repeats are collapsed
+ */
+bool ui_log_store_get_collapse(void);
+
+/**
+ * @brief Append an entry (any task)
+ * @param channel Channel index or UI_LOG_NO_CHANNEL
+ * @param type Direction ("TX", "RX")
+ * @param text Message (truncated to UI_LOG_TEXT_LEN - 1 bytes)
+ * @return false if it was merged into the newest record
+ */
+bool ui_log_store_add(uint8_t channel, const char* type, const char* text);
+
+/**
+ * @brief Append a frame (any task)
+ * @param channel Channel index or UI_LOG_NO_CHANNEL
+ * @param type Direction ("TX", "RX")
+ * @param frame Frame (dlc clamped to UI_LOG_FRAME_DATA)
+ * @return false if it was merged into the newest record
+ */
+bool ui_log_store_add_frame(uint8_t channel, const char* type, const ui_log_frame_t* frame);
+
+/**
+ * @brief Drop all records (sequence numbers keep counting)
+ */
+void ui_log_store_clear(void);
+
+/**
+ * @brief Get the range of stored records
+ * @param first Output: seq of the oldest stored record
+ * @param next Output: seq the next new record will get (first == next when empty)
+ */
+void ui_log_store_range(uint32_t* first, uint32_t* next);
+
+/**
+ * @brief Copy a record (any task)
+ * @param seq Sequence number
+ * @param out Output record
+ * @return false if the record was overwritten or cleared
+ */
+bool ui_log_store_get(uint32_t seq, ui_log_record_t* out);
+
+/**
+ * @brief Format a record's message ("CAN ID: 0x123 | Data: [...]" for frames)
+ * @param rec Record
+ * @param buf Output buffer
+ * @param size Buffer size
+ * @return buf
+ */
+const char* ui_log_record_text(const ui_log_record_t* rec, char* buf, size_t size);
+
+// ==================== Filtering ====================
+
+/**
+ * @brief Reset a filter to pass everything
+ * @param filter Filter
+ */
+void ui_log_filter_clear(ui_log_filter_t* filter);
+
+/**
+ * @brief Check whether a filter restricts anything
+ * @param filter Filter
+ * @return false if every record passes
+ */
+bool ui_log_filter_is_active(const ui_log_filter_t* filter);
+
+/**
+ * @brief Parse the filter fields of the log view
+ *
+ * IDs: comma separated hex IDs or ranges ("7E8, 100-1FF"). Payload: hex bytes
+ * from byte 0 on, "??" or "x" for a don't-care byte ("?? 3E"). Empty text
+ * leaves that condition unset.
+ *
+ * @param ids ID text (may be NULL)
+ * @param data Payload text (may be NULL)
+ * @param dir Direction
+ * @param filter Output filter
+ * @return false on a syntax error (filter left unchanged)
+ */
+bool ui_log_filter_parse(const char* ids, const char* data, ui_log_dir_t dir, ui_log_filter_t* filter);
+
+/**
+ * @brief Test one record against a filter (used on insert)
+ * @param filter Filter
+ * @param rec Record
+ * @return true if the record is shown
+ */
+bool ui_log_filter_match(const ui_log_filter_t* filter, const ui_log_record_t* rec);
+
+/**
+ * @brief Find the newest records passing a filter
+ *
+ * With ID ranges only the index chains of IDs inside the ranges are walked,
+ * newest first, so the cost follows the number of candidate records rather
+ * than the store size.
+ *
+ * @param filter Filter
+ * @param seqs Output: matching seqs, oldest first
+ * @param max Capacity of seqs
+ * @param next Output: seq the next new record will get (render from there on)
+ * @return Number of seqs written
+ */
+uint32_t ui_log_store_query(const ui_log_filter_t* filter, uint32_t* seqs, uint32_t max, uint32_t* next);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // UI_LOG_STORE_H
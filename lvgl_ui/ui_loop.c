@@ -0,0 +1,161 @@
+/**
+ * @file ui_loop.c
+ * @brief Event-Driven LVGL Task Loop Implementation
+ *
+ * Wakeups use a direct task notification on FreeRTOS and a can_port semaphore
+ * on the host. Activity flags are 32-bit atomics so other tasks and ISRs can
+ * set them without locks; all LVGL calls stay on the loop task.
+ */
+
+#include "ui_loop.h"
+#include "ui_state.h"
+#include "ui_binding.h"
+#include <stdatomic.h>
+
+#ifdef ESP_PLATFORM
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#else
+#include "can_port.h"
+#endif
+
+#define UI_LOOP_MAX_INDEVS 2
+
+#ifdef ESP_PLATFORM
+static TaskHandle_t loop_task = NULL;
+#else
+static can_port_sem_t* loop_sem = NULL;
+#endif
+
+static lv_indev_t* indevs[UI_LOOP_MAX_INDEVS];
+static uint8_t indev_count = 0;
+
+static atomic_uint_least32_t activity_pending;  // Set by any task, cleared by the loop
+static atomic_uint_least32_t idle_mode;         // Written by the loop only
+static uint32_t last_activity_ms = 0;
+
+// Switch the display refresh timer between normal and idle periods
+static void set_idle(bool idle) {
+    lv_display_t* disp = lv_display_get_default();
+    lv_timer_t* refr_timer = (disp != NULL) ? lv_display_get_refr_timer(disp) : NULL;
+
+    if (refr_timer != NULL) {
+        lv_timer_set_period(refr_timer, idle ? UI_LOOP_IDLE_REFR_MS : LV_DEF_REFR_PERIOD);
+        if (!idle) {
+            lv_timer_ready(refr_timer);     // Draw pending changes right away
+        }
+    }
+    atomic_store_explicit(&idle_mode, idle ? 1 : 0, memory_order_relaxed);
+}
+
+static void loop_wait(uint32_t timeout_ms) {
+#ifdef ESP_PLATFORM
+    TickType_t ticks = pdMS_TO_TICKS(timeout_ms);
+    ulTaskNotifyTake(pdTRUE, (ticks > 0) ? ticks : 1);
+#else
+    can_port_sem_take(loop_sem, timeout_ms);
+#endif
+}
+
+void ui_loop_init(void) {
+#ifdef ESP_PLATFORM
+    loop_task = xTaskGetCurrentTaskHandle();
+#else
+    if (loop_sem == NULL) {
+        loop_sem = can_port_sem_create();
+    }
+#endif
+    atomic_store_explicit(&activity_pending, 0, memory_order_relaxed);
+    atomic_store_explicit(&idle_mode, 0, memory_order_relaxed);
+    last_activity_ms = lv_tick_get();
+}
+
+void ui_loop_add_indev(lv_indev_t* indev) {
+    if (indev == NULL || indev_count >= UI_LOOP_MAX_INDEVS) {
+        return;
+    }
+    lv_indev_set_mode(indev, LV_INDEV_MODE_EVENT);
+    indevs[indev_count++] = indev;
+}
+
+void ui_loop_run_once(void) {
+    // Read event-mode input devices; a press counts as activity
+    for (uint8_t i = 0; i < indev_count; i++) {
+        lv_indev_read(indevs[i]);
+        if (lv_indev_get_state(indevs[i]) == LV_INDEV_STATE_PRESSED) {
+            atomic_store_explicit(&activity_pending, 1, memory_order_relaxed);
+        }
+    }
+
+    bool idle = atomic_load_explicit(&idle_mode, memory_order_relaxed) != 0;
+    if (atomic_exchange_explicit(&activity_pending, 0, memory_order_relaxed) != 0) {
+        last_activity_ms = lv_tick_get();
+        if (idle) {
+            set_idle(false);
+            idle = false;
+        }
+    }
+
+    uint32_t idle_elapsed_ms = lv_tick_elaps(last_activity_ms);
+    if (!idle && idle_elapsed_ms >= UI_LOOP_IDLE_AFTER_MS) {
+        set_idle(true);
+        idle = true;
+    }
+
+    // Take the backend's updates, push state changes to widgets, then render
+    // them in the same pass
+    ui_binding_process();
+    ui_state_flush();
+    uint32_t sleep_ms = lv_timer_handler();     // LV_NO_TIMER_READY is clamped below
+    if (sleep_ms > UI_LOOP_MAX_SLEEP_MS) {
+        sleep_ms = UI_LOOP_MAX_SLEEP_MS;
+    }
+    if (ui_state_pending() != 0) {
+        sleep_ms = 0;   // Changed by an event handler during this pass
+    }
+    if (!idle && idle_elapsed_ms < UI_LOOP_IDLE_AFTER_MS &&
+        sleep_ms > UI_LOOP_IDLE_AFTER_MS - idle_elapsed_ms) {
+        sleep_ms = UI_LOOP_IDLE_AFTER_MS - idle_elapsed_ms;
+    }
+
+    loop_wait(sleep_ms);
+}
+
+void ui_loop_run(void) {
+    while (1) {
+        ui_loop_run_once();
+    }
+}
+
+void ui_loop_notify(void) {
+#ifdef ESP_PLATFORM
+    if (loop_task != NULL) {
+        xTaskNotifyGive(loop_task);
+    }
+#else
+    if (loop_sem != NULL) {
+        can_port_sem_give(loop_sem);
+    }
+#endif
+}
+
+void ui_loop_notify_from_isr(void) {
+#ifdef ESP_PLATFORM
+    if (loop_task != NULL) {
+        BaseType_t woken = pdFALSE;
+        vTaskNotifyGiveFromISR(loop_task, &woken);
+        portYIELD_FROM_ISR(woken);
+    }
+#else
+    ui_loop_notify();
+#endif
+}
+
+void ui_loop_mark_activity(void) {
+    atomic_store_explicit(&activity_pending, 1, memory_order_relaxed);
+    ui_loop_notify();
+}
+
+bool ui_loop_is_idle(void) {
+    return atomic_load_explicit(&idle_mode, memory_order_relaxed) != 0;
+}
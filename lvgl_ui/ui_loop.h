@@ -0,0 +1,84 @@
+/**
+ * @file ui_loop.h
+ * @brief Event-Driven LVGL Task Loop
+ *
+ * Replaces the fixed "lv_timer_handler(); delay 10 ms" loop. The UI task sleeps
+ * until the next LVGL timer deadline or until another task, an ISR or the touch
+ * driver notifies it. After a period without bus activity or input the display
+ * refresh period is stretched, and restored on the next event.
+ */
+
+#ifndef UI_LOOP_H
+#define UI_LOOP_H
+
+#include "lvgl.h"
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifndef UI_LOOP_MAX_SLEEP_MS
+#define UI_LOOP_MAX_SLEEP_MS    500     // Upper bound on one sleep
+#endif
+
+#ifndef UI_LOOP_IDLE_AFTER_MS
+#define UI_LOOP_IDLE_AFTER_MS   5000    // No activity for this long -> idle
+#endif
+
+#ifndef UI_LOOP_IDLE_REFR_MS
+#define UI_LOOP_IDLE_REFR_MS    200     // Display refresh period while idle
+#endif
+
+/**
+ * @brief Initialize the loop (call from the task that will run it)
+ */
+void ui_loop_init(void);
+
+/**
+ * @brief Switch an input device to event mode and read it on each wakeup
+ *
+ * The touch driver must then call ui_loop_notify_from_isr() (or
+ * ui_loop_notify()) whenever the controller reports new data.
+ *
+ * @param indev Input device (at most 2 are tracked)
+ */
+void ui_loop_add_indev(lv_indev_t* indev);
+
+/**
+ * @brief Run LVGL timers once and sleep until the next deadline or event
+ */
+void ui_loop_run_once(void);
+
+/**
+ * @brief Run the loop forever
+ */
+void ui_loop_run(void);
+
+/**
+ * @brief Wake the UI task (any task)
+ */
+void ui_loop_notify(void);
+
+/**
+ * @brief Wake the UI task from an interrupt (touch IRQ)
+ */
+void ui_loop_notify_from_isr(void);
+
+/**
+ * @brief Record bus activity (any task); leaves idle mode and wakes the UI task
+ */
+void ui_loop_mark_activity(void);
+
+/**
+ * @brief Check whether the display is in reduced refresh mode
+ * @return true if idle
+ */
+bool ui_loop_is_idle(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // UI_LOOP_H
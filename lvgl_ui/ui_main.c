@@ -9,12 +9,16 @@
 #include "ui_config.h"
 #include "ui_state.h"
 #include "ui_binding.h"
+#include "ui_log_store.h"
+#include "ui_mem.h"
+#include "ui_layout.h"
+#include "ui_main.h"
 
 // Component creation functions
 extern lv_obj_t* ui_header_create(lv_obj_t* parent);
 extern lv_obj_t* ui_log_display_create(lv_obj_t* parent, int y_offset);
 extern lv_obj_t* ui_controls_create(lv_obj_t* parent, int y_offset);
-extern lv_obj_t* ui_manual_input_create(lv_obj_t* parent, int y_offset);
+extern void ui_manual_input_init(lv_obj_t* parent, int y_offset);
 extern lv_obj_t* ui_footer_create(lv_obj_t* parent);
 extern void ui_log_update_status(bool connected);
 
@@ -36,6 +40,7 @@ lv_obj_t* ui_init(void) {
     
     // Initialize binding
     ui_binding_init();
+    ui_log_store_init();
     
     // Create main screen
     main_screen = lv_obj_create(NULL);
@@ -49,15 +54,12 @@ lv_obj_t* ui_init(void) {
     ui_header_create(main_screen);
     
     // Create log display (below header)
-    ui_log_display_create(main_screen, UI_HEADER_HEIGHT);
-    
-    // Create scrollable content area
-    int content_y = UI_HEADER_HEIGHT + UI_LOG_HEIGHT + 60;
-    int content_height = UI_SCREEN_HEIGHT - content_y - UI_FOOTER_HEIGHT;
+    ui_log_display_create(main_screen, UI_LAYOUT_LOG_Y);
     
+    // Create scrollable content area (between the log and the footer)
     lv_obj_t* content_area = lv_obj_create(main_screen);
-    lv_obj_set_size(content_area, UI_SCREEN_WIDTH, content_height);
-    lv_obj_align(content_area, LV_ALIGN_TOP_MID, 0, content_y);
+    lv_obj_set_size(content_area, UI_SCREEN_WIDTH, UI_LAYOUT_CONTENT_H);
+    lv_obj_align(content_area, LV_ALIGN_TOP_MID, 0, UI_LAYOUT_CONTENT_Y);
     lv_obj_set_style_bg_opa(content_area, LV_OPA_TRANSP, 0);
     lv_obj_set_style_border_width(content_area, 0, 0);
     lv_obj_set_style_pad_all(content_area, 0, 0);
@@ -66,15 +68,21 @@ lv_obj_t* ui_init(void) {
     // Create auto mode controls
     controls_container = ui_controls_create(content_area, 0);
     
-    // Create manual input mode (hidden initially)
-    ui_manual_input_create(content_area, 0);
+    // Manual input mode: built by ui_manual_input_show() on first use
+    ui_manual_input_init(content_area, 0);
     
     // Create footer (bottom)
     ui_footer_create(main_screen);
     
+    // Pin the geometry resolved above (UI_LAYOUT_ABSOLUTE)
+    ui_layout_freeze(main_screen);
+    
     // Load the screen
     lv_scr_load(main_screen);
     
+    // From here on every LVGL allocation should come from the pools
+    ui_mem_mark_ready();
+    
     return main_screen;
 }
 
@@ -31,12 +31,46 @@ lv_obj_t* ui_get_screen(void);
 lv_obj_t* ui_controls_get_container(void);
 
 // Component update functions (used by binding layer)
-void ui_header_update_connection(bool connected);
+void ui_header_update_connection(uint8_t channel, bool connected);
 void ui_log_add_message(const char* type, const char* message);
+void ui_log_add_channel_message(uint8_t channel, const char* type, const char* message);
+void ui_log_add_channel_frame(uint8_t channel, const char* type, uint32_t id, bool extended,
+                              uint8_t dlc, const uint8_t* data, uint32_t trace);
 void ui_log_update_status(bool connected);
 void ui_footer_update_status(bool transmitting, bool repeating);
 void ui_footer_update_connection(bool connected);
 void ui_manual_input_show(void);
+lv_obj_t* ui_manual_input_get_container(void);
+
+// Debug overlay (render load, heap, queue depths, latency trace histograms)
+typedef uint32_t (*ui_debug_queue_depth_cb_t)(void* user_data);
+
+lv_obj_t* ui_debug_overlay_create(void);
+void ui_debug_overlay_set_visible(bool visible);
+bool ui_debug_overlay_is_visible(void);
+void ui_debug_overlay_toggle(void);
+
+/**
+ * @brief Register a backend queue whose depth is shown on the overlay
+ * @param name Short static label (e.g. "tx")
+ * @param depth_cb Returns the current depth; called from the LVGL task at 1 Hz
+ * @param user_data Passed to depth_cb
+ * @return false if the table (12 entries, shared with peaks) is full
+ */
+bool ui_debug_overlay_add_queue(const char* name, ui_debug_queue_depth_cb_t depth_cb, void* user_data);
+
+/**
+ * @brief Register a peak or high-water value, shown on its own "pk:" line
+ * @param name Short static label (e.g. "logHW")
+ * @param depth_cb Returns the value; called from the LVGL task at 1 Hz
+ * @param user_data Passed to depth_cb
+ * @return false if the table (12 entries, shared with depths) is full
+ */
+bool ui_debug_overlay_add_peak(const char* name, ui_debug_queue_depth_cb_t depth_cb, void* user_data);
+
+// Display driver hooks around flush_cb work (for the overlay flush time)
+void ui_debug_overlay_flush_begin(void);
+void ui_debug_overlay_flush_end(void);
 
 #ifdef __cplusplus
 }
@@ -2,31 +2,66 @@
  * @file ui_manual_input.c
  * @brief Manual Input Mode Component Implementation
  * 
- * Manual CAN ID/Data input with repeat settings
+ * Manual CAN ID/Data input with target channel and repeat settings, and an
+ * ID/payload sweep section for robustness tests
+ *
+ * The panel is built the first time ui_manual_input_show() runs, not at boot:
+ * ui_init only records where it goes. With UI_LAZY_DESTROY_ON_HIDE the panel
+ * is deleted again when the user goes back; the form is refilled from
+ * ui_state (and the sweep fields from a small cache) when it is rebuilt.
  */
 
 #include "lvgl.h"
 #include "ui_config.h"
 #include "ui_state.h"
 #include "ui_binding.h"
+#include "ui_layout.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static lv_obj_t* manual_parent = NULL;
+static int manual_y_offset = 0;
+
+// Sweep fields are not part of ui_state: kept here while the panel is deleted
+static char saved_sweep_first[12] = "0x000";
+static char saved_sweep_last[12] = "0x7FF";
+static char saved_sweep_seed[12] = "1";
+static uint16_t saved_sweep_pattern = 0;
 
 static lv_obj_t* manual_container = NULL;
+static lv_obj_t* channel_dropdown = NULL;
 static lv_obj_t* id_textarea = NULL;
 static lv_obj_t* data_textarea = NULL;
 static lv_obj_t* repeat_switch = NULL;
 static lv_obj_t* interval_textarea = NULL;
 static lv_obj_t* interval_container = NULL;
+static lv_obj_t* sweep_container = NULL;
+static lv_obj_t* sweep_first_textarea = NULL;
+static lv_obj_t* sweep_last_textarea = NULL;
+static lv_obj_t* sweep_pattern_dropdown = NULL;
+static lv_obj_t* sweep_seed_textarea = NULL;
+static lv_obj_t* sweep_btn = NULL;
+static lv_obj_t* sweep_btn_label = NULL;
+static lv_obj_t* sweep_bar = NULL;
+static lv_obj_t* sweep_status_label = NULL;
 
 // Forward declarations
 extern lv_obj_t* ui_controls_get_container(void);
+static void manual_input_build(void);
+static void manual_input_destroy(void);
 
 // Back button callback
 static void back_btn_cb(lv_event_t* e) {
     ui_state_set_view_mode(VIEW_MODE_AUTO);
     
-    // Hide manual container, show auto controls
+    // Hide (or delete) manual container, show auto controls
     if (manual_container != NULL) {
-        lv_obj_add_flag(manual_container, LV_OBJ_FLAG_HIDDEN);
+        if (UI_LAZY_DESTROY_ON_HIDE) {
+            manual_input_destroy();
+        } else {
+            lv_obj_add_flag(manual_container, LV_OBJ_FLAG_HIDDEN);
+        }
     }
     
     lv_obj_t* controls = ui_controls_get_container();
@@ -35,6 +70,12 @@ static void back_btn_cb(lv_event_t* e) {
     }
 }
 
+// Channel dropdown callback
+static void channel_dropdown_cb(lv_event_t* e) {
+    lv_obj_t* dd = lv_event_get_target(e);
+    ui_state_set_manual_channel((uint8_t)lv_dropdown_get_selected(dd));
+}
+
 // ID textarea callback
 static void id_textarea_cb(lv_event_t* e) {
     lv_obj_t* ta = lv_event_get_target(e);
@@ -63,8 +104,9 @@ static void repeat_switch_cb(lv_event_t* e) {
         }
     }
     
-    ui_state_t* state = ui_state_get();
-    ui_state_set_manual_repeat(is_checked, state->manual_interval);
+    ui_state_t state;
+    ui_state_snapshot(&state);
+    ui_state_set_manual_repeat(is_checked, state.manual_interval);
 }
 
 // Interval textarea callback
@@ -74,15 +116,255 @@ static void interval_textarea_cb(lv_event_t* e) {
     uint32_t interval = atoi(text);
     if (interval < 100) interval = 100; // Minimum 100ms
     
-    ui_state_t* state = ui_state_get();
-    ui_state_set_manual_repeat(state->manual_repeat, interval);
+    ui_state_t state;
+    ui_state_snapshot(&state);
+    ui_state_set_manual_repeat(state.manual_repeat, interval);
+}
+
+// Apply edits to a running manual repeat (Enter or focus leaving a field)
+static void live_edit_cb(lv_event_t* e) {
+    ui_state_t state;
+    ui_state_snapshot(&state);
+    if (state.is_repeating && state.view_mode == VIEW_MODE_MANUAL) {
+        ui_binding_trigger_manual_update(state.manual_channel, state.manual_id,
+                                         state.manual_data, state.manual_interval);
+    }
+}
+
+// Sweep section toggle
+static void sweep_switch_cb(lv_event_t* e) {
+    lv_obj_t* sw = lv_event_get_target(e);
+    if (lv_obj_has_state(sw, LV_STATE_CHECKED)) {
+        lv_obj_clear_flag(sweep_container, LV_OBJ_FLAG_HIDDEN);
+    } else {
+        lv_obj_add_flag(sweep_container, LV_OBJ_FLAG_HIDDEN);
+    }
+}
+
+// Start or stop a sweep on the selected channel
+static void sweep_btn_cb(lv_event_t* e) {
+    ui_state_t state;
+    ui_state_snapshot(&state);
+    
+    if (state.sweep_active) {
+        ui_binding_trigger_sweep_stop();
+        return;
+    }
+    if (!state.channel_connected[state.manual_channel]) {
+        return;
+    }
+    
+    ui_binding_trigger_sweep_start(state.manual_channel,
+                                   lv_textarea_get_text(sweep_first_textarea),
+                                   lv_textarea_get_text(sweep_last_textarea),
+                                   (uint8_t)lv_dropdown_get_selected(sweep_pattern_dropdown),
+                                   (uint32_t)strtoul(lv_textarea_get_text(sweep_seed_textarea), NULL, 10));
+}
+
+// State listener: sweep button, progress bar and rate/error line
+static void sweep_state_listener(uint32_t changed, const ui_state_t* state, void* user_data) {
+    if (manual_container == NULL) {
+        return;     // Panel not built (or deleted): synced when it is built
+    }
+    
+    bool can_start = state->channel_connected[state->manual_channel];
+    
+    if (state->sweep_active) {
+        lv_label_set_text(sweep_btn_label, LV_SYMBOL_STOP " 停止扫描");
+        lv_obj_set_style_bg_color(sweep_btn, UI_COLOR_RED_600, 0);
+        lv_obj_clear_state(sweep_btn, LV_STATE_DISABLED);
+    } else {
+        lv_label_set_text(sweep_btn_label, LV_SYMBOL_PLAY " 开始扫描");
+        lv_obj_set_style_bg_color(sweep_btn, can_start ? UI_COLOR_CYAN_600 : UI_COLOR_DISABLED_BG, 0);
+        if (can_start) {
+            lv_obj_clear_state(sweep_btn, LV_STATE_DISABLED);
+        } else {
+            lv_obj_add_state(sweep_btn, LV_STATE_DISABLED);
+        }
+    }
+    
+    if (changed & UI_STATE_F_SWEEP) {
+        lv_bar_set_value(sweep_bar, state->sweep_permille, LV_ANIM_OFF);
+        lv_label_set_text_fmt(sweep_status_label, "%u.%u%%  %lu 帧/s  错误 %lu",
+                              (unsigned)(state->sweep_permille / 10), (unsigned)(state->sweep_permille % 10),
+                              (unsigned long)state->sweep_rate_fps, (unsigned long)state->sweep_errors);
+    }
+}
+
+static lv_obj_t* create_sweep_textarea(lv_obj_t* parent, const char* text) {
+    lv_obj_t* ta = lv_textarea_create(parent);
+    lv_obj_set_flex_grow(ta, 1);
+    lv_textarea_set_one_line(ta, true);
+    lv_textarea_set_text(ta, text);
+    lv_obj_set_style_bg_color(ta, UI_COLOR_BG_INPUT, 0);
+    lv_obj_set_style_border_color(ta, UI_COLOR_BORDER_LIGHT, 0);
+    lv_obj_set_style_text_color(ta, UI_COLOR_TEXT_PRIMARY, 0);
+    lv_obj_set_style_text_font(ta, UI_FONT_NORMAL, 0);
+    return ta;
+}
+
+static lv_obj_t* create_sweep_row(lv_obj_t* parent, const char* label_text) {
+    lv_obj_t* row = lv_obj_create(parent);
+    lv_obj_set_size(row, lv_pct(100), LV_SIZE_CONTENT);
+    lv_obj_set_style_bg_opa(row, LV_OPA_TRANSP, 0);
+    lv_obj_set_style_border_width(row, 0, 0);
+    lv_obj_set_style_pad_all(row, 0, 0);
+    lv_obj_set_style_pad_column(row, UI_GAP_MEDIUM, 0);
+    lv_obj_set_flex_flow(row, LV_FLEX_FLOW_ROW);
+    lv_obj_set_flex_align(row, LV_FLEX_ALIGN_SPACE_BETWEEN, LV_FLEX_ALIGN_CENTER, LV_FLEX_ALIGN_CENTER);
+    
+    lv_obj_t* label = lv_label_create(row);
+    lv_label_set_text(label, label_text);
+    lv_obj_set_style_text_color(label, UI_COLOR_TEXT_SECONDARY, 0);
+    lv_obj_set_style_text_font(label, UI_FONT_NORMAL, 0);
+    return row;
+}
+
+static void create_sweep_section(lv_obj_t* parent) {
+    // Section toggle
+    lv_obj_t* toggle_row = create_sweep_row(parent, "扫描测试");
+    lv_obj_set_style_pad_top(toggle_row, UI_GAP_MEDIUM, 0);
+    
+    lv_obj_t* sweep_switch = lv_switch_create(toggle_row);
+    lv_obj_set_size(sweep_switch, 36, 20);
+    lv_obj_set_style_bg_color(sweep_switch, UI_COLOR_DISABLED_BG, 0);
+    lv_obj_set_style_bg_color(sweep_switch, UI_COLOR_CYAN_500, LV_PART_INDICATOR | LV_STATE_CHECKED);
+    lv_obj_add_event_cb(sweep_switch, sweep_switch_cb, LV_EVENT_VALUE_CHANGED, NULL);
+    
+    // Section body (hidden by default)
+    sweep_container = lv_obj_create(parent);
+    lv_obj_set_size(sweep_container, lv_pct(100), LV_SIZE_CONTENT);
+    lv_obj_set_style_bg_opa(sweep_container, LV_OPA_TRANSP, 0);
+    lv_obj_set_style_border_width(sweep_container, 0, 0);
+    lv_obj_set_style_pad_all(sweep_container, 0, 0);
+    lv_obj_set_style_pad_row(sweep_container, UI_GAP_MEDIUM, 0);
+    lv_obj_set_flex_flow(sweep_container, LV_FLEX_FLOW_COLUMN);
+    lv_obj_add_flag(sweep_container, LV_OBJ_FLAG_HIDDEN);
+    
+    // ID range
+    lv_obj_t* range_row = create_sweep_row(sweep_container, "ID");
+    sweep_first_textarea = create_sweep_textarea(range_row, saved_sweep_first);
+    lv_obj_t* dash_label = lv_label_create(range_row);
+    lv_label_set_text(dash_label, "-");
+    lv_obj_set_style_text_color(dash_label, UI_COLOR_TEXT_SECONDARY, 0);
+    sweep_last_textarea = create_sweep_textarea(range_row, saved_sweep_last);
+    
+    // Payload pattern
+    lv_obj_t* pattern_row = create_sweep_row(sweep_container, "负载");
+    sweep_pattern_dropdown = lv_dropdown_create(pattern_row);
+    lv_dropdown_set_options_static(sweep_pattern_dropdown, "递增\n走位\n随机");   // ui_sweep_pattern_t order
+    lv_dropdown_set_selected(sweep_pattern_dropdown, saved_sweep_pattern);
+    lv_obj_set_width(sweep_pattern_dropdown, 100);
+    lv_obj_set_style_bg_color(sweep_pattern_dropdown, UI_COLOR_BG_INPUT, 0);
+    lv_obj_set_style_border_color(sweep_pattern_dropdown, UI_COLOR_BORDER_LIGHT, 0);
+    lv_obj_set_style_text_color(sweep_pattern_dropdown, UI_COLOR_TEXT_PRIMARY, 0);
+    lv_obj_set_style_text_font(sweep_pattern_dropdown, UI_FONT_NORMAL, 0);
+    
+    // Random seed
+    lv_obj_t* seed_row = create_sweep_row(sweep_container, "种子");
+    sweep_seed_textarea = create_sweep_textarea(seed_row, saved_sweep_seed);
+    lv_textarea_set_accepted_chars(sweep_seed_textarea, "0123456789");
+    lv_textarea_set_max_length(sweep_seed_textarea, 10);
+    
+    // Start/stop
+    sweep_btn = lv_btn_create(sweep_container);
+    lv_obj_set_size(sweep_btn, lv_pct(100), 32);
+    lv_obj_set_style_bg_color(sweep_btn, UI_COLOR_DISABLED_BG, 0);
+    lv_obj_set_style_border_width(sweep_btn, 0, 0);
+    lv_obj_set_style_radius(sweep_btn, UI_RADIUS_SMALL, 0);
+    lv_obj_add_state(sweep_btn, LV_STATE_DISABLED);
+    lv_obj_add_event_cb(sweep_btn, sweep_btn_cb, LV_EVENT_CLICKED, NULL);
+    
+    sweep_btn_label = lv_label_create(sweep_btn);
+    lv_label_set_text(sweep_btn_label, LV_SYMBOL_PLAY " 开始扫描");
+    lv_obj_set_style_text_color(sweep_btn_label, UI_COLOR_WHITE, 0);
+    lv_obj_set_style_text_font(sweep_btn_label, UI_FONT_NORMAL, 0);
+    lv_obj_center(sweep_btn_label);
+    
+    // Progress
+    sweep_bar = lv_bar_create(sweep_container);
+    lv_obj_set_size(sweep_bar, lv_pct(100), 6);
+    lv_bar_set_range(sweep_bar, 0, 1000);
+    lv_obj_set_style_bg_color(sweep_bar, UI_COLOR_BG_INPUT, 0);
+    lv_obj_set_style_bg_color(sweep_bar, UI_COLOR_CYAN_500, LV_PART_INDICATOR);
+    
+    sweep_status_label = lv_label_create(sweep_container);
+    lv_label_set_text(sweep_status_label, "");
+    lv_obj_set_style_text_color(sweep_status_label, UI_COLOR_TEXT_MUTED, 0);
+    lv_obj_set_style_text_font(sweep_status_label, UI_FONT_SMALL, 0);
+    ui_layout_fix_label(sweep_status_label, lv_pct(100));
+}
+
+// Refill the form from the state (the panel may be newer than the values)
+static void manual_input_sync(void) {
+    ui_state_t state;
+    ui_state_snapshot(&state);
+    
+    lv_dropdown_set_selected(channel_dropdown, state.manual_channel);
+    lv_textarea_set_text(id_textarea, state.manual_id);
+    lv_textarea_set_text(data_textarea, state.manual_data);
+    
+    char interval[12];
+    snprintf(interval, sizeof(interval), "%lu", (unsigned long)state.manual_interval);
+    lv_textarea_set_text(interval_textarea, interval);
+    if (state.manual_repeat) {
+        lv_obj_add_state(repeat_switch, LV_STATE_CHECKED);
+        lv_obj_clear_flag(interval_container, LV_OBJ_FLAG_HIDDEN);
+    }
+    
+    sweep_state_listener(UI_STATE_F_SWEEP | UI_STATE_F_CONNECTED | UI_STATE_F_MANUAL_CHANNEL, &state, NULL);
+}
+
+static void copy_text(char* dst, size_t size, lv_obj_t* ta) {
+    strncpy(dst, lv_textarea_get_text(ta), size - 1);
+    dst[size - 1] = '\0';
 }
 
-lv_obj_t* ui_manual_input_create(lv_obj_t* parent, int y_offset) {
+// Drop the pointers into a panel that is (being) deleted
+static void manual_input_forget(void) {
+    manual_container = NULL;
+    channel_dropdown = NULL;
+    id_textarea = NULL;
+    data_textarea = NULL;
+    repeat_switch = NULL;
+    interval_textarea = NULL;
+    interval_container = NULL;
+    sweep_container = NULL;
+    sweep_first_textarea = NULL;
+    sweep_last_textarea = NULL;
+    sweep_pattern_dropdown = NULL;
+    sweep_seed_textarea = NULL;
+    sweep_btn = NULL;
+    sweep_btn_label = NULL;
+    sweep_bar = NULL;
+    sweep_status_label = NULL;
+}
+
+// Delete the panel, keeping what ui_state does not hold
+static void manual_input_destroy(void) {
+    copy_text(saved_sweep_first, sizeof(saved_sweep_first), sweep_first_textarea);
+    copy_text(saved_sweep_last, sizeof(saved_sweep_last), sweep_last_textarea);
+    copy_text(saved_sweep_seed, sizeof(saved_sweep_seed), sweep_seed_textarea);
+    saved_sweep_pattern = lv_dropdown_get_selected(sweep_pattern_dropdown);
+    
+    // Called from the panel's own back button: delete after the event returns
+    lv_obj_delete_async(manual_container);
+    manual_input_forget();
+}
+
+// Panel deleted with its screen (or by lv_deinit): forget it. A panel
+// already forgotten by manual_input_destroy() is not the current one.
+static void manual_container_delete_cb(lv_event_t* e) {
+    if (lv_event_get_target(e) == manual_container) {
+        manual_input_forget();
+    }
+}
+
+static void manual_input_build(void) {
     // Create main container
-    manual_container = lv_obj_create(parent);
+    manual_container = lv_obj_create(manual_parent);
     lv_obj_set_size(manual_container, UI_SCREEN_WIDTH, LV_SIZE_CONTENT);
-    lv_obj_align(manual_container, LV_ALIGN_TOP_MID, 0, y_offset);
+    lv_obj_align(manual_container, LV_ALIGN_TOP_MID, 0, manual_y_offset);
     lv_obj_set_style_bg_opa(manual_container, LV_OPA_TRANSP, 0);
     lv_obj_set_style_border_width(manual_container, 0, 0);
     lv_obj_set_style_pad_all(manual_container, UI_PADDING_LARGE, 0);
@@ -90,6 +372,7 @@ lv_obj_t* ui_manual_input_create(lv_obj_t* parent, int y_offset) {
     lv_obj_set_flex_flow(manual_container, LV_FLEX_FLOW_COLUMN);
     lv_obj_add_flag(manual_container, LV_OBJ_FLAG_HIDDEN); // Hidden by default
     lv_obj_clear_flag(manual_container, LV_OBJ_FLAG_SCROLLABLE);
+    lv_obj_add_event_cb(manual_container, manual_container_delete_cb, LV_EVENT_DELETE, NULL);
     
     // Back button
     lv_obj_t* back_btn = lv_btn_create(manual_container);
@@ -104,14 +387,40 @@ lv_obj_t* ui_manual_input_create(lv_obj_t* parent, int y_offset) {
     lv_obj_t* back_label = lv_label_create(back_btn);
     lv_label_set_text(back_label, LV_SYMBOL_LEFT " 返回");
     lv_obj_set_style_text_color(back_label, UI_COLOR_TEXT_PRIMARY, 0);
-    lv_obj_set_style_text_font(back_label, &lv_font_montserrat_12, 0);
+    lv_obj_set_style_text_font(back_label, UI_FONT_NORMAL, 0);
     lv_obj_center(back_label);
     
+    // Channel selector
+    lv_obj_t* channel_row = lv_obj_create(manual_container);
+    lv_obj_set_size(channel_row, lv_pct(100), LV_SIZE_CONTENT);
+    lv_obj_set_style_bg_opa(channel_row, LV_OPA_TRANSP, 0);
+    lv_obj_set_style_border_width(channel_row, 0, 0);
+    lv_obj_set_style_pad_all(channel_row, 0, 0);
+    lv_obj_set_flex_flow(channel_row, LV_FLEX_FLOW_ROW);
+    lv_obj_set_flex_align(channel_row, LV_FLEX_ALIGN_SPACE_BETWEEN, LV_FLEX_ALIGN_CENTER, LV_FLEX_ALIGN_CENTER);
+    
+    lv_obj_t* channel_label = lv_label_create(channel_row);
+    lv_label_set_text(channel_label, "通道");
+    lv_obj_set_style_text_color(channel_label, UI_COLOR_TEXT_SECONDARY, 0);
+    lv_obj_set_style_text_font(channel_label, UI_FONT_NORMAL, 0);
+    
+    channel_dropdown = lv_dropdown_create(channel_row);
+    lv_dropdown_clear_options(channel_dropdown);
+    for (uint8_t i = 0; i < UI_CHANNEL_COUNT; i++) {
+        lv_dropdown_add_option(channel_dropdown, UI_CHANNELS[i], LV_DROPDOWN_POS_LAST);
+    }
+    lv_obj_set_width(channel_dropdown, 80);
+    lv_obj_set_style_bg_color(channel_dropdown, UI_COLOR_BG_INPUT, 0);
+    lv_obj_set_style_border_color(channel_dropdown, UI_COLOR_BORDER_LIGHT, 0);
+    lv_obj_set_style_text_color(channel_dropdown, UI_COLOR_TEXT_PRIMARY, 0);
+    lv_obj_set_style_text_font(channel_dropdown, UI_FONT_NORMAL, 0);
+    lv_obj_add_event_cb(channel_dropdown, channel_dropdown_cb, LV_EVENT_VALUE_CHANGED, NULL);
+    
     // CAN ID Input
     lv_obj_t* id_label = lv_label_create(manual_container);
     lv_label_set_text(id_label, "CAN ID");
     lv_obj_set_style_text_color(id_label, UI_COLOR_TEXT_SECONDARY, 0);
-    lv_obj_set_style_text_font(id_label, &lv_font_montserrat_12, 0);
+    lv_obj_set_style_text_font(id_label, UI_FONT_NORMAL, 0);
     
     id_textarea = lv_textarea_create(manual_container);
     lv_obj_set_width(id_textarea, lv_pct(100));
@@ -120,14 +429,16 @@ lv_obj_t* ui_manual_input_create(lv_obj_t* parent, int y_offset) {
     lv_obj_set_style_bg_color(id_textarea, UI_COLOR_BG_INPUT, 0);
     lv_obj_set_style_border_color(id_textarea, UI_COLOR_BORDER_LIGHT, 0);
     lv_obj_set_style_text_color(id_textarea, UI_COLOR_TEXT_PRIMARY, 0);
-    lv_obj_set_style_text_font(id_textarea, &lv_font_montserrat_12, 0);
+    lv_obj_set_style_text_font(id_textarea, UI_FONT_NORMAL, 0);
     lv_obj_add_event_cb(id_textarea, id_textarea_cb, LV_EVENT_VALUE_CHANGED, NULL);
+    lv_obj_add_event_cb(id_textarea, live_edit_cb, LV_EVENT_READY, NULL);
+    lv_obj_add_event_cb(id_textarea, live_edit_cb, LV_EVENT_DEFOCUSED, NULL);
     
     // DATA Input
     lv_obj_t* data_label = lv_label_create(manual_container);
     lv_label_set_text(data_label, "DATA");
     lv_obj_set_style_text_color(data_label, UI_COLOR_TEXT_SECONDARY, 0);
-    lv_obj_set_style_text_font(data_label, &lv_font_montserrat_12, 0);
+    lv_obj_set_style_text_font(data_label, UI_FONT_NORMAL, 0);
     lv_obj_set_style_pad_top(data_label, UI_GAP_MEDIUM, 0);
     
     data_textarea = lv_textarea_create(manual_container);
@@ -137,8 +448,9 @@ lv_obj_t* ui_manual_input_create(lv_obj_t* parent, int y_offset) {
     lv_obj_set_style_bg_color(data_textarea, UI_COLOR_BG_INPUT, 0);
     lv_obj_set_style_border_color(data_textarea, UI_COLOR_BORDER_LIGHT, 0);
     lv_obj_set_style_text_color(data_textarea, UI_COLOR_TEXT_PRIMARY, 0);
-    lv_obj_set_style_text_font(data_textarea, &lv_font_montserrat_12, 0);
+    lv_obj_set_style_text_font(data_textarea, UI_FONT_NORMAL, 0);
     lv_obj_add_event_cb(data_textarea, data_textarea_cb, LV_EVENT_VALUE_CHANGED, NULL);
+    lv_obj_add_event_cb(data_textarea, live_edit_cb, LV_EVENT_DEFOCUSED, NULL);
     
     // Repeat toggle
     lv_obj_t* repeat_row = lv_obj_create(manual_container);
@@ -153,7 +465,7 @@ lv_obj_t* ui_manual_input_create(lv_obj_t* parent, int y_offset) {
     lv_obj_t* repeat_label = lv_label_create(repeat_row);
     lv_label_set_text(repeat_label, "周期发送");
     lv_obj_set_style_text_color(repeat_label, UI_COLOR_TEXT_SECONDARY, 0);
-    lv_obj_set_style_text_font(repeat_label, &lv_font_montserrat_12, 0);
+    lv_obj_set_style_text_font(repeat_label, UI_FONT_NORMAL, 0);
     
     repeat_switch = lv_switch_create(repeat_row);
     lv_obj_set_size(repeat_switch, 36, 20);
@@ -172,7 +484,7 @@ lv_obj_t* ui_manual_input_create(lv_obj_t* parent, int y_offset) {
     lv_obj_t* interval_label = lv_label_create(interval_container);
     lv_label_set_text(interval_label, "周期间隔 (ms)");
     lv_obj_set_style_text_color(interval_label, UI_COLOR_TEXT_SECONDARY, 0);
-    lv_obj_set_style_text_font(interval_label, &lv_font_montserrat_12, 0);
+    lv_obj_set_style_text_font(interval_label, UI_FONT_NORMAL, 0);
     lv_obj_set_style_pad_bottom(interval_label, UI_GAP_SMALL, 0);
     
     interval_textarea = lv_textarea_create(interval_container);
@@ -183,13 +495,31 @@ lv_obj_t* ui_manual_input_create(lv_obj_t* parent, int y_offset) {
     lv_obj_set_style_bg_color(interval_textarea, UI_COLOR_BG_INPUT, 0);
     lv_obj_set_style_border_color(interval_textarea, UI_COLOR_BORDER_LIGHT, 0);
     lv_obj_set_style_text_color(interval_textarea, UI_COLOR_TEXT_PRIMARY, 0);
-    lv_obj_set_style_text_font(interval_textarea, &lv_font_montserrat_12, 0);
+    lv_obj_set_style_text_font(interval_textarea, UI_FONT_NORMAL, 0);
     lv_obj_add_event_cb(interval_textarea, interval_textarea_cb, LV_EVENT_VALUE_CHANGED, NULL);
+    lv_obj_add_event_cb(interval_textarea, live_edit_cb, LV_EVENT_READY, NULL);
+    lv_obj_add_event_cb(interval_textarea, live_edit_cb, LV_EVENT_DEFOCUSED, NULL);
     
-    return manual_container;
+    create_sweep_section(manual_container);
+    ui_layout_freeze(manual_container);
+    manual_input_sync();
+}
+
+void ui_manual_input_init(lv_obj_t* parent, int y_offset) {
+    // A panel of an earlier ui_init went with its display (lv_deinit)
+    manual_input_forget();
+    manual_parent = parent;
+    manual_y_offset = y_offset;
+    
+    // ui_state_init (run by ui_init just before) dropped all subscriptions
+    ui_state_subscribe(UI_STATE_F_SWEEP | UI_STATE_F_CONNECTED | UI_STATE_F_MANUAL_CHANNEL,
+                       sweep_state_listener, NULL);
 }
 
 void ui_manual_input_show(void) {
+    if (manual_container == NULL && manual_parent != NULL) {
+        manual_input_build();
+    }
     if (manual_container != NULL) {
         lv_obj_clear_flag(manual_container, LV_OBJ_FLAG_HIDDEN);
     }
@@ -0,0 +1,192 @@
+/**
+ * @file ui_mem.c
+ * @brief Pooled LVGL Allocator Implementation
+ *
+ * Implements the lv_*_core hooks LVGL calls when LV_USE_STDLIB_MALLOC is
+ * LV_STDLIB_CUSTOM. LVGL allocates only on the LVGL task, so the pools need
+ * no lock.
+ */
+
+#include "lvgl.h"
+#include "ui_config.h"
+#include "ui_mem.h"
+#include "can_pool.h"
+#include <stdlib.h>
+#include <string.h>
+
+#if LV_USE_STDLIB_MALLOC == LV_STDLIB_CUSTOM
+
+#define UI_MEM_CLASS_COUNT 6
+
+CAN_POOL_STORAGE(pool_16, 16, UI_MEM_POOL_16);
+CAN_POOL_STORAGE(pool_32, 32, UI_MEM_POOL_32);
+CAN_POOL_STORAGE(pool_64, 64, UI_MEM_POOL_64);
+CAN_POOL_STORAGE(pool_128, 128, UI_MEM_POOL_128);
+CAN_POOL_STORAGE(pool_256, 256, UI_MEM_POOL_256);
+CAN_POOL_STORAGE(pool_512, 512, UI_MEM_POOL_512);
+
+typedef struct {
+    const char* name;
+    uint32_t size;
+    uint32_t count;
+    uint8_t* storage;
+} mem_class_t;
+
+static const mem_class_t CLASSES[UI_MEM_CLASS_COUNT] = {
+    {"lv16",  16,  UI_MEM_POOL_16,  pool_16},
+    {"lv32",  32,  UI_MEM_POOL_32,  pool_32},
+    {"lv64",  64,  UI_MEM_POOL_64,  pool_64},
+    {"lv128", 128, UI_MEM_POOL_128, pool_128},
+    {"lv256", 256, UI_MEM_POOL_256, pool_256},
+    {"lv512", 512, UI_MEM_POOL_512, pool_512},
+};
+
+static can_pool_t pools[UI_MEM_CLASS_COUNT];
+static ui_mem_stats_t g_stats;
+static bool g_ready = false;
+
+// Pool a block belongs to, or -1 for a heap block
+static int class_of(const void* p) {
+    for (int i = 0; i < UI_MEM_CLASS_COUNT; i++) {
+        if (can_pool_owns(&pools[i], p)) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+static void* heap_alloc(size_t size) {
+    void* p = malloc(size);
+    if (p != NULL) {
+        g_stats.heap_allocs++;
+        g_stats.heap_live++;
+        if (g_ready) {
+            g_stats.heap_allocs_ready++;
+        }
+    }
+    return p;
+}
+
+// ==================== LVGL Hooks ====================
+
+void lv_mem_init(void) {
+    for (int i = 0; i < UI_MEM_CLASS_COUNT; i++) {
+        can_pool_init(&pools[i], CLASSES[i].name, CLASSES[i].storage, CLASSES[i].size, CLASSES[i].count);
+    }
+    memset(&g_stats, 0, sizeof(g_stats));
+    g_ready = false;
+}
+
+void lv_mem_deinit(void) {
+    // Pool blocks are dropped with the pools on the next lv_mem_init
+}
+
+lv_mem_pool_t lv_mem_add_pool(void* mem, size_t bytes) {
+    (void)mem;
+    (void)bytes;
+    return NULL;    // Pools are sized at build time (ui_config.h)
+}
+
+void lv_mem_remove_pool(lv_mem_pool_t pool) {
+    (void)pool;
+}
+
+void* lv_malloc_core(size_t size) {
+    // Smallest class that fits; a larger class before the heap when it is empty
+    for (int i = 0; i < UI_MEM_CLASS_COUNT; i++) {
+        if (size <= CLASSES[i].size) {
+            void* p = can_pool_alloc(&pools[i]);
+            if (p != NULL) {
+                return p;
+            }
+        }
+    }
+    return heap_alloc(size);
+}
+
+void lv_free_core(void* p) {
+    if (p == NULL) {
+        return;
+    }
+    int c = class_of(p);
+    if (c >= 0) {
+        can_pool_free(&pools[c], p);
+    } else {
+        free(p);
+        g_stats.heap_live--;
+    }
+}
+
+void* lv_realloc_core(void* p, size_t new_size) {
+    if (p == NULL) {
+        return lv_malloc_core(new_size);
+    }
+    int c = class_of(p);
+    if (c < 0) {
+        void* q = realloc(p, new_size);
+        if (q != NULL && g_ready) {
+            g_stats.heap_allocs_ready++;
+        }
+        return q;
+    }
+    if (new_size <= CLASSES[c].size) {
+        return p;       // Still fits: a rewritten label text stays in place
+    }
+    void* q = lv_malloc_core(new_size);
+    if (q != NULL) {
+        memcpy(q, p, CLASSES[c].size);
+        can_pool_free(&pools[c], p);
+    }
+    return q;
+}
+
+void lv_mem_monitor_core(lv_mem_monitor_t* mon_p) {
+    memset(mon_p, 0, sizeof(lv_mem_monitor_t));
+    for (int i = 0; i < UI_MEM_CLASS_COUNT; i++) {
+        const can_pool_stats_t* s = &pools[i].stats;
+        uint32_t free_blocks = s->capacity - s->in_use;
+        mon_p->total_size += (size_t)s->block_size * s->capacity;
+        mon_p->free_size += (size_t)s->block_size * free_blocks;
+        mon_p->free_cnt += free_blocks;
+        mon_p->used_cnt += s->in_use;
+        // Upper bound: the classes need not have peaked at the same time
+        mon_p->max_used += (size_t)s->block_size * s->high_water;
+        if (free_blocks > 0) {
+            mon_p->free_biggest_size = s->block_size;
+        }
+    }
+    mon_p->used_cnt += g_stats.heap_live;
+    mon_p->used_pct = (mon_p->total_size > 0) ?
+        (uint8_t)(100 - (mon_p->free_size * 100) / mon_p->total_size) : 0;
+    mon_p->frag_pct = 0;    // Fixed blocks do not fragment
+}
+
+lv_result_t lv_mem_test_core(void) {
+    for (int i = 0; i < UI_MEM_CLASS_COUNT; i++) {
+        if (pools[i].stats.in_use > pools[i].stats.capacity) {
+            return LV_RESULT_INVALID;
+        }
+    }
+    return LV_RESULT_OK;
+}
+
+// ==================== API ====================
+
+void ui_mem_mark_ready(void) {
+    g_ready = true;
+}
+
+void ui_mem_get_stats(ui_mem_stats_t* stats) {
+    *stats = g_stats;
+}
+
+#else
+
+void ui_mem_mark_ready(void) {
+}
+
+void ui_mem_get_stats(ui_mem_stats_t* stats) {
+    memset(stats, 0, sizeof(ui_mem_stats_t));
+}
+
+#endif // LV_USE_STDLIB_MALLOC == LV_STDLIB_CUSTOM
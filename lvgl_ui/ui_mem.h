@@ -0,0 +1,56 @@
+/**
+ * @file ui_mem.h
+ * @brief Pooled LVGL Allocator
+ *
+ * With LV_USE_STDLIB_MALLOC set to LV_STDLIB_CUSTOM, ui_mem.c provides
+ * LVGL's allocator from size-class block pools (can_pool.h) instead of one
+ * shared heap. Objects, styles and label texts all land in fixed blocks, so
+ * hours of log traffic cannot fragment memory, and a label whose text is
+ * rewritten with a similar length keeps its block: lv_realloc returns the
+ * same pointer without touching any heap.
+ *
+ * Requests larger than the biggest class, or made while their class and
+ * every larger one are empty, fall back to malloc() and are counted. After
+ * ui_mem_mark_ready() (end of ui_init) such fallbacks mean a hot path still
+ * uses the general heap, and the pool sizes in ui_config.h need raising.
+ *
+ * lv_mem_monitor() reports max_used as the sum of each class's high-water
+ * mark, an upper bound on the real peak: the classes need not have peaked
+ * at the same time.
+ */
+
+#ifndef UI_MEM_H
+#define UI_MEM_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Heap fallback counters
+ */
+typedef struct {
+    uint32_t heap_allocs;           // malloc() fallbacks since lv_init
+    uint32_t heap_allocs_ready;     // ... since ui_mem_mark_ready
+    uint32_t heap_live;             // Fallback blocks not freed yet
+} ui_mem_stats_t;
+
+/**
+ * @brief Mark the end of startup (later heap fallbacks are hot-path misses)
+ */
+void ui_mem_mark_ready(void);
+
+/**
+ * @brief Read the heap fallback counters (all zero without the pooled allocator)
+ * @param stats Output
+ */
+void ui_mem_get_stats(ui_mem_stats_t* stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // UI_MEM_H
@@ -1,15 +1,70 @@
 /**
  * @file ui_state.c
  * @brief UI State Management Implementation
+ *
+ * The state is guarded by a sequence counter (seqlock). Writers serialize on a
+ * mutex and bump the counter to odd before and to even after each update;
+ * readers copy the struct and retry if the counter was odd or changed, so the
+ * read path never blocks or takes a lock.
+ *
+ * Setters that change a value OR its field bit into a dirty mask; the LVGL
+ * task drains the mask with ui_state_flush() and calls the subscribers of the
+ * changed fields once. Setters that store the value already present do nothing.
  */
 
 #include "ui_state.h"
+#include "can_port.h"
+#include <stdatomic.h>
 #include <string.h>
 
+#define UI_STATE_MAX_LISTENERS 8
+
+typedef struct {
+    uint32_t fields;
+    ui_state_listener_t listener;
+    void* user_data;
+} state_subscription_t;
+
 // Global UI state
 static ui_state_t g_ui_state = {0};
 
+// Sequence counter (odd while an update is in progress) and writer lock
+static atomic_uint_least32_t g_state_seq;
+static can_port_mutex_t* g_write_mutex = NULL;
+
+// Fields changed since the last flush
+static atomic_uint_least32_t g_dirty_mask;
+
+// Subscribers (LVGL task only)
+static state_subscription_t g_subscriptions[UI_STATE_MAX_LISTENERS];
+static uint8_t g_subscription_count = 0;
+
+static void state_lock(void) {
+    can_port_mutex_lock(g_write_mutex);
+}
+
+static void state_unlock(void) {
+    can_port_mutex_unlock(g_write_mutex);
+}
+
+static void state_write_begin(void) {
+    atomic_fetch_add_explicit(&g_state_seq, 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+}
+
+static void state_write_end(uint32_t fields) {
+    atomic_fetch_add_explicit(&g_state_seq, 1, memory_order_release);
+    atomic_fetch_or_explicit(&g_dirty_mask, fields, memory_order_release);
+}
+
 void ui_state_init(void) {
+    if (g_write_mutex == NULL) {
+        g_write_mutex = can_port_mutex_create();
+    }
+    g_subscription_count = 0;
+    
+    state_lock();
+    state_write_begin();
     memset(&g_ui_state, 0, sizeof(ui_state_t));
     
     // Set defaults
@@ -25,71 +80,272 @@ void ui_state_init(void) {
     
     g_ui_state.manual_id[0] = '\0';
     g_ui_state.manual_data[0] = '\0';
+    g_ui_state.manual_channel = 0;
     g_ui_state.manual_repeat = false;
     g_ui_state.manual_interval = 1000;
     
     g_ui_state.log_count = 0;
+    state_write_end(UI_STATE_F_ALL);    // First flush syncs every subscriber
+    state_unlock();
 }
 
-ui_state_t* ui_state_get(void) {
-    return &g_ui_state;
+void ui_state_snapshot(ui_state_t* out) {
+    uint32_t seq_begin;
+    uint32_t seq_end = 0;
+    
+    do {
+        seq_begin = atomic_load_explicit(&g_state_seq, memory_order_acquire);
+        if (seq_begin & 1u) {
+            continue;   // Writer in progress
+        }
+        memcpy(out, &g_ui_state, sizeof(ui_state_t));
+        atomic_thread_fence(memory_order_acquire);
+        seq_end = atomic_load_explicit(&g_state_seq, memory_order_relaxed);
+    } while ((seq_begin & 1u) || seq_begin != seq_end);
+}
+
+uint32_t ui_state_get_version(void) {
+    return atomic_load_explicit(&g_state_seq, memory_order_acquire) >> 1;
+}
+
+// ==================== Subscriptions ====================
+
+bool ui_state_subscribe(uint32_t fields, ui_state_listener_t listener, void* user_data) {
+    if (listener == NULL || fields == 0 || g_subscription_count >= UI_STATE_MAX_LISTENERS) {
+        return false;
+    }
+    g_subscriptions[g_subscription_count].fields = fields;
+    g_subscriptions[g_subscription_count].listener = listener;
+    g_subscriptions[g_subscription_count].user_data = user_data;
+    g_subscription_count++;
+    return true;
 }
 
-void ui_state_set_connected(bool connected) {
-    g_ui_state.is_connected = connected;
+uint32_t ui_state_pending(void) {
+    return atomic_load_explicit(&g_dirty_mask, memory_order_relaxed);
+}
+
+uint32_t ui_state_flush(void) {
+    uint32_t changed = atomic_exchange_explicit(&g_dirty_mask, 0, memory_order_acquire);
+    if (changed == 0) {
+        return 0;
+    }
+    
+    ui_state_t state;
+    ui_state_snapshot(&state);
+    
+    for (uint8_t i = 0; i < g_subscription_count; i++) {
+        uint32_t fields = g_subscriptions[i].fields & changed;
+        if (fields != 0) {
+            g_subscriptions[i].listener(fields, &state, g_subscriptions[i].user_data);
+        }
+    }
+    return changed;
+}
+
+// ==================== Setters ====================
+
+void ui_state_set_connected(uint8_t channel, bool connected) {
+    if (channel < UI_CHANNEL_COUNT) {
+        state_lock();
+        if (g_ui_state.channel_connected[channel] != connected) {
+            state_write_begin();
+            g_ui_state.channel_connected[channel] = connected;
+            g_ui_state.is_connected = false;
+            for (uint8_t i = 0; i < UI_CHANNEL_COUNT; i++) {
+                g_ui_state.is_connected |= g_ui_state.channel_connected[i];
+            }
+            state_write_end(UI_STATE_F_CONNECTED);
+        }
+        state_unlock();
+    }
 }
 
 void ui_state_set_transmission(bool transmitting, bool repeating) {
-    g_ui_state.is_transmitting = transmitting;
-    g_ui_state.is_repeating = repeating;
+    state_lock();
+    if (g_ui_state.is_transmitting != transmitting || g_ui_state.is_repeating != repeating) {
+        state_write_begin();
+        g_ui_state.is_transmitting = transmitting;
+        g_ui_state.is_repeating = repeating;
+        state_write_end(UI_STATE_F_TRANSMISSION);
+    }
+    state_unlock();
 }
 
 void ui_state_set_scene(const char* scene) {
     if (scene != NULL) {
-        strncpy(g_ui_state.selected_scene, scene, sizeof(g_ui_state.selected_scene) - 1);
-        g_ui_state.selected_scene[sizeof(g_ui_state.selected_scene) - 1] = '\0';
+        state_lock();
+        if (strncmp(g_ui_state.selected_scene, scene, sizeof(g_ui_state.selected_scene) - 1) != 0) {
+            state_write_begin();
+            strncpy(g_ui_state.selected_scene, scene, sizeof(g_ui_state.selected_scene) - 1);
+            g_ui_state.selected_scene[sizeof(g_ui_state.selected_scene) - 1] = '\0';
+            state_write_end(UI_STATE_F_SCENE);
+        }
+        state_unlock();
     }
 }
 
 void ui_state_set_category(ui_category_t category) {
     if (category < CATEGORY_COUNT) {
-        g_ui_state.selected_category = category;
-        // Reset function to first in category
-        g_ui_state.selected_function = 0;
+        state_lock();
+        if (g_ui_state.selected_category != category) {
+            state_write_begin();
+            g_ui_state.selected_category = category;
+            // Reset function to first in category
+            g_ui_state.selected_function = 0;
+            state_write_end(UI_STATE_F_CATEGORY | UI_STATE_F_FUNCTION);
+        }
+        state_unlock();
     }
 }
 
 void ui_state_set_function(uint8_t function_index) {
-    g_ui_state.selected_function = function_index;
+    state_lock();
+    if (g_ui_state.selected_function != function_index) {
+        state_write_begin();
+        g_ui_state.selected_function = function_index;
+        state_write_end(UI_STATE_F_FUNCTION);
+    }
+    state_unlock();
 }
 
 void ui_state_set_view_mode(ui_view_mode_t mode) {
-    g_ui_state.view_mode = mode;
+    state_lock();
+    if (g_ui_state.view_mode != mode) {
+        state_write_begin();
+        g_ui_state.view_mode = mode;
+        state_write_end(UI_STATE_F_VIEW_MODE);
+    }
+    state_unlock();
 }
 
 void ui_state_set_manual_id(const char* id) {
     if (id != NULL) {
-        strncpy(g_ui_state.manual_id, id, sizeof(g_ui_state.manual_id) - 1);
-        g_ui_state.manual_id[sizeof(g_ui_state.manual_id) - 1] = '\0';
+        state_lock();
+        if (strncmp(g_ui_state.manual_id, id, sizeof(g_ui_state.manual_id) - 1) != 0) {
+            state_write_begin();
+            strncpy(g_ui_state.manual_id, id, sizeof(g_ui_state.manual_id) - 1);
+            g_ui_state.manual_id[sizeof(g_ui_state.manual_id) - 1] = '\0';
+            state_write_end(UI_STATE_F_MANUAL_ID);
+        }
+        state_unlock();
     }
 }
 
 void ui_state_set_manual_data(const char* data) {
     if (data != NULL) {
-        strncpy(g_ui_state.manual_data, data, sizeof(g_ui_state.manual_data) - 1);
-        g_ui_state.manual_data[sizeof(g_ui_state.manual_data) - 1] = '\0';
+        state_lock();
+        if (strncmp(g_ui_state.manual_data, data, sizeof(g_ui_state.manual_data) - 1) != 0) {
+            state_write_begin();
+            strncpy(g_ui_state.manual_data, data, sizeof(g_ui_state.manual_data) - 1);
+            g_ui_state.manual_data[sizeof(g_ui_state.manual_data) - 1] = '\0';
+            state_write_end(UI_STATE_F_MANUAL_DATA);
+        }
+        state_unlock();
+    }
+}
+
+void ui_state_set_manual_channel(uint8_t channel) {
+    if (channel < UI_CHANNEL_COUNT) {
+        state_lock();
+        if (g_ui_state.manual_channel != channel) {
+            state_write_begin();
+            g_ui_state.manual_channel = channel;
+            state_write_end(UI_STATE_F_MANUAL_CHANNEL);
+        }
+        state_unlock();
     }
 }
 
 void ui_state_set_manual_repeat(bool repeat, uint32_t interval) {
-    g_ui_state.manual_repeat = repeat;
-    g_ui_state.manual_interval = interval;
+    state_lock();
+    if (g_ui_state.manual_repeat != repeat || g_ui_state.manual_interval != interval) {
+        state_write_begin();
+        g_ui_state.manual_repeat = repeat;
+        g_ui_state.manual_interval = interval;
+        state_write_end(UI_STATE_F_MANUAL_REPEAT);
+    }
+    state_unlock();
+}
+
+void ui_state_set_sequence(const char* name, uint16_t step, uint16_t total) {
+    if (name == NULL || total == 0) {
+        name = "";
+        step = 0;
+        total = 0;
+    }
+    
+    state_lock();
+    if (g_ui_state.seq_step != step || g_ui_state.seq_total != total ||
+        strncmp(g_ui_state.seq_name, name, sizeof(g_ui_state.seq_name) - 1) != 0) {
+        state_write_begin();
+        strncpy(g_ui_state.seq_name, name, sizeof(g_ui_state.seq_name) - 1);
+        g_ui_state.seq_name[sizeof(g_ui_state.seq_name) - 1] = '\0';
+        g_ui_state.seq_step = step;
+        g_ui_state.seq_total = total;
+        state_write_end(UI_STATE_F_SEQUENCE);
+    }
+    state_unlock();
+}
+
+void ui_state_set_tx_congested(uint8_t channel, bool congested) {
+    if (channel < UI_CHANNEL_COUNT) {
+        uint8_t bit = (uint8_t)(1u << channel);
+        state_lock();
+        if (((g_ui_state.tx_congested & bit) != 0) != congested) {
+            state_write_begin();
+            g_ui_state.tx_congested ^= bit;
+            state_write_end(UI_STATE_F_TX_CONGESTION);
+        }
+        state_unlock();
+    }
+}
+
+void ui_state_set_sweep(bool active, uint16_t permille, uint32_t rate_fps, uint32_t errors) {
+    if (permille > 1000) {
+        permille = 1000;
+    }
+    
+    state_lock();
+    if (g_ui_state.sweep_active != active || g_ui_state.sweep_permille != permille ||
+        g_ui_state.sweep_rate_fps != rate_fps || g_ui_state.sweep_errors != errors) {
+        state_write_begin();
+        g_ui_state.sweep_active = active;
+        g_ui_state.sweep_permille = permille;
+        g_ui_state.sweep_rate_fps = rate_fps;
+        g_ui_state.sweep_errors = errors;
+        state_write_end(UI_STATE_F_SWEEP);
+    }
+    state_unlock();
+}
+
+void ui_state_set_bus_state(uint8_t channel, ui_bus_state_t state, uint16_t tec) {
+    if (channel < UI_CHANNEL_COUNT) {
+        state_lock();
+        if (g_ui_state.bus_state[channel] != state || g_ui_state.bus_tec[channel] != tec) {
+            state_write_begin();
+            g_ui_state.bus_state[channel] = state;
+            g_ui_state.bus_tec[channel] = tec;
+            state_write_end(UI_STATE_F_BUS_STATE);
+        }
+        state_unlock();
+    }
 }
 
 void ui_state_increment_log_count(void) {
+    state_lock();
+    state_write_begin();
     g_ui_state.log_count++;
+    state_write_end(UI_STATE_F_LOG_COUNT);
+    state_unlock();
 }
 
 void ui_state_reset_log_count(void) {
-    g_ui_state.log_count = 0;
+    state_lock();
+    if (g_ui_state.log_count != 0) {
+        state_write_begin();
+        g_ui_state.log_count = 0;
+        state_write_end(UI_STATE_F_LOG_COUNT);
+    }
+    state_unlock();
 }
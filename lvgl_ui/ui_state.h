@@ -5,6 +5,10 @@
  * Centralized state management for the LVGL v9 UI.
  * Maintains all application state including connection status,
  * transmission state, mode selection, and user inputs.
+ *
+ * Setters may be called from any task (writers are serialized); readers use
+ * ui_state_snapshot() and never block. Components subscribe to the fields they
+ * display and are updated from ui_state_flush() once per refresh.
  */
 
 #ifndef UI_STATE_H
@@ -17,6 +21,8 @@
 extern "C" {
 #endif
 
+#define UI_CHANNEL_COUNT 2     // CAN channels (display names in UI_CHANNELS)
+
 /**
  * @brief Function categories for auto mode
  */
@@ -35,12 +41,24 @@ typedef enum {
     VIEW_MODE_MANUAL = 1   // Manual CAN ID/Data input mode
 } ui_view_mode_t;
 
+/**
+ * @brief Bus health of a channel (controller fault confinement state)
+ */
+typedef enum {
+    UI_BUS_OK = 0,          // Error-active
+    UI_BUS_WARNING,         // An error counter reached 96
+    UI_BUS_PASSIVE,         // An error counter reached 128
+    UI_BUS_OFF,             // Bus-off: TX fails until recovery
+    UI_BUS_RECOVERING       // Automatic recovery in progress
+} ui_bus_state_t;
+
 /**
  * @brief Main UI state structure
  */
 typedef struct {
-    // Connection state
+    // Connection state (is_connected = any channel connected)
     bool is_connected;
+    bool channel_connected[UI_CHANNEL_COUNT];
     
     // Transmission state
     bool is_transmitting;
@@ -57,29 +75,115 @@ typedef struct {
     // Manual mode state
     char manual_id[32];               // CAN ID input (e.g., "0x123")
     char manual_data[128];            // Data input (e.g., "[0x01, 0x02]")
+    uint8_t manual_channel;           // Target channel
     bool manual_repeat;               // Repeat enabled
     uint32_t manual_interval;         // Repeat interval in ms
     
     // Log count
     uint16_t log_count;
+    
+    // Scene sequence progress (seq_total = 0 when none is running)
+    char seq_name[8];
+    uint16_t seq_step;
+    uint16_t seq_total;
+    
+    // TX queue backpressure (frames waiting or dropped), bit per channel
+    uint8_t tx_congested;
+    
+    // ID/payload sweep progress (manual mode)
+    bool sweep_active;
+    uint16_t sweep_permille;          // Frames sent / total x 1000
+    uint32_t sweep_rate_fps;          // Achieved frames per second
+    uint32_t sweep_errors;            // Controller bus errors during the sweep
+    
+    // Bus health per channel (header)
+    ui_bus_state_t bus_state[UI_CHANNEL_COUNT];
+    uint16_t bus_tec[UI_CHANNEL_COUNT];         // TX error counter
 } ui_state_t;
 
+/**
+ * @brief State field bits (change masks and subscriptions)
+ */
+typedef enum {
+    UI_STATE_F_CONNECTED      = 1u << 0,     // is_connected, channel_connected
+    UI_STATE_F_TRANSMISSION   = 1u << 1,     // is_transmitting, is_repeating
+    UI_STATE_F_SCENE          = 1u << 2,     // selected_scene
+    UI_STATE_F_CATEGORY       = 1u << 3,     // selected_category
+    UI_STATE_F_FUNCTION       = 1u << 4,     // selected_function
+    UI_STATE_F_VIEW_MODE      = 1u << 5,     // view_mode
+    UI_STATE_F_MANUAL_ID      = 1u << 6,     // manual_id
+    UI_STATE_F_MANUAL_DATA    = 1u << 7,     // manual_data
+    UI_STATE_F_MANUAL_REPEAT  = 1u << 8,     // manual_repeat, manual_interval
+    UI_STATE_F_LOG_COUNT      = 1u << 9,     // log_count
+    UI_STATE_F_SEQUENCE       = 1u << 10,    // seq_name, seq_step, seq_total
+    UI_STATE_F_TX_CONGESTION  = 1u << 11,    // tx_congested
+    UI_STATE_F_MANUAL_CHANNEL = 1u << 12,    // manual_channel
+    UI_STATE_F_SWEEP          = 1u << 13,    // sweep_active, sweep_permille, sweep_rate_fps, sweep_errors
+    UI_STATE_F_BUS_STATE      = 1u << 14,    // bus_state, bus_tec
+    UI_STATE_F_ALL            = (1u << 15) - 1
+} ui_state_field_t;
+
+/**
+ * @brief Subscriber callback (LVGL task, from ui_state_flush)
+ * @param changed Changed fields, limited to the subscribed mask
+ * @param state Snapshot taken after the changes
+ * @param user_data Value passed to ui_state_subscribe
+ */
+typedef void (*ui_state_listener_t)(uint32_t changed, const ui_state_t* state, void* user_data);
+
 /**
  * @brief Initialize UI state with default values
+ *
+ * Clears all subscriptions and marks every field changed.
  */
 void ui_state_init(void);
 
 /**
- * @brief Get pointer to current UI state
- * @return Pointer to global UI state
+ * @brief Copy a consistent snapshot of the UI state (any task, lock-free)
+ *
+ * Retries while an update is in progress, so multi-field values such as
+ * manual_id/manual_data are never observed half-written.
+ *
+ * @param out Output state copy
+ */
+void ui_state_snapshot(ui_state_t* out);
+
+/**
+ * @brief Get the state version (incremented by every setter)
+ * @return Version counter
+ */
+uint32_t ui_state_get_version(void);
+
+/**
+ * @brief Subscribe to changes of a set of fields (LVGL task)
+ * @param fields Mask of ui_state_field_t bits
+ * @param listener Callback
+ * @param user_data Passed to the callback
+ * @return false if the table (8 entries) is full
  */
-ui_state_t* ui_state_get(void);
+bool ui_state_subscribe(uint32_t fields, ui_state_listener_t listener, void* user_data);
 
 /**
- * @brief Set connection state
+ * @brief Deliver pending changes to subscribers (LVGL task, once per refresh)
+ *
+ * Called by ui_loop before lv_timer_handler(); custom loops must do the same.
+ *
+ * @return Mask of fields that were flushed (0 if nothing changed)
+ */
+uint32_t ui_state_flush(void);
+
+/**
+ * @brief Get the fields changed since the last flush (any task)
+ * @return Pending change mask
+ */
+uint32_t ui_state_pending(void);
+
+/**
+ * @brief Set the connection state of a channel
+ * @param channel Channel index (< UI_CHANNEL_COUNT)
  * @param connected true if connected, false otherwise
  */
-void ui_state_set_connected(bool connected);
+void ui_state_set_connected(uint8_t channel, bool connected);
 
 /**
  * @brief Set transmission state
@@ -124,6 +228,12 @@ void ui_state_set_manual_id(const char* id);
  */
 void ui_state_set_manual_data(const char* data);
 
+/**
+ * @brief Set manual mode target channel
+ * @param channel Channel index (< UI_CHANNEL_COUNT)
+ */
+void ui_state_set_manual_channel(uint8_t channel);
+
 /**
  * @brief Set manual repeat settings
  * @param repeat Enable/disable repeat
@@ -131,6 +241,38 @@ void ui_state_set_manual_data(const char* data);
  */
 void ui_state_set_manual_repeat(bool repeat, uint32_t interval);
 
+/**
+ * @brief Set scene sequence progress
+ * @param name Sequence name (NULL or total 0 to clear)
+ * @param step Current step (0-based)
+ * @param total Steps in the sequence
+ */
+void ui_state_set_sequence(const char* name, uint16_t step, uint16_t total);
+
+/**
+ * @brief Set TX queue congestion of a channel
+ * @param channel Channel index (< UI_CHANNEL_COUNT)
+ * @param congested true while the channel's TX queue is backed up
+ */
+void ui_state_set_tx_congested(uint8_t channel, bool congested);
+
+/**
+ * @brief Set sweep progress
+ * @param active true while a sweep is running
+ * @param permille Progress (0-1000)
+ * @param rate_fps Achieved frames per second
+ * @param errors Controller bus errors since the sweep started
+ */
+void ui_state_set_sweep(bool active, uint16_t permille, uint32_t rate_fps, uint32_t errors);
+
+/**
+ * @brief Set the bus health of a channel
+ * @param channel Channel index (< UI_CHANNEL_COUNT)
+ * @param state Fault confinement state
+ * @param tec TX error counter
+ */
+void ui_state_set_bus_state(uint8_t channel, ui_bus_state_t state, uint16_t tec);
+
 /**
  * @brief Increment log count
  */